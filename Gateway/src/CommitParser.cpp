@@ -0,0 +1,158 @@
+#include "CommitParser.h"
+
+#include <cctype>
+
+namespace {
+
+class JsonScanner {
+public:
+    JsonScanner(const char* text, size_t length) : _p(text), _end(text + length) {}
+
+    void skipSpace() {
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) _p++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (_p < _end && *_p == c) {
+            _p++;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return _p < _end && *_p == c;
+    }
+
+    // String contents between the quotes, escapes left as they are
+    bool string(std::string& out) {
+        if (!consume('"')) return false;
+        const char* start = _p;
+        while (_p < _end && *_p != '"') {
+            if (*_p == '\\') _p++;
+            _p++;
+        }
+        if (_p >= _end) return false;
+        out.assign(start, _p - start);
+        _p++;
+        return true;
+    }
+
+    // Skip any value; [start, end) is its text
+    bool value(const char*& start, const char*& end) {
+        skipSpace();
+        start = _p;
+        if (!skipValue(0)) return false;
+        end = _p;
+        return true;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return _p == _end;
+    }
+
+    // Iterate "key": value pairs of an object; call after '{'
+    template <typename OnMember>
+    bool members(OnMember onMember) {
+        if (consume('}')) return true;
+        do {
+            std::string key;
+            if (!string(key) || !consume(':') || !onMember(key)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+private:
+    static const int MAX_DEPTH = 32;
+
+    bool skipValue(int depth) {
+        if (depth > MAX_DEPTH) return false;
+        skipSpace();
+        if (_p >= _end) return false;
+        std::string ignored;
+        switch (*_p) {
+            case '"':
+                return string(ignored);
+            case '{':
+                _p++;
+                return members([&](const std::string&) { return skipValue(depth + 1); });
+            case '[':
+                _p++;
+                if (consume(']')) return true;
+                do {
+                    if (!skipValue(depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            default:
+                // Number, true, false, null
+                const char* start = _p;
+                while (_p < _end && (isalnum((unsigned char)*_p) || *_p == '-' || *_p == '+' || *_p == '.')) _p++;
+                return _p > start;
+        }
+    }
+
+    const char* _p;
+    const char* _end;
+};
+
+}  // namespace
+
+bool parseCommit(const char* body, size_t length, std::vector<DocumentWrite>& writes,
+                 std::string& error) {
+    JsonScanner json(body, length);
+    const char* start;
+    const char* end;
+
+    auto parseWrite = [&](DocumentWrite& write) {
+        bool hasUpdate = false;
+        return json.members([&](const std::string& key) {
+            if (key == "update") {
+                hasUpdate = true;
+                if (!json.consume('{')) return false;
+                return json.members([&](const std::string& member) {
+                    if (member == "name") return json.string(write.name);
+                    if (member != "fields") return json.value(start, end);
+                    if (!json.consume('{')) return false;
+                    return json.members([&](const std::string& field) {
+                        if (!json.value(start, end)) return false;
+                        write.fields.emplace_back(field, std::string(start, end - start));
+                        return true;
+                    });
+                });
+            }
+            if (key == "updateMask") {
+                write.merge = true;
+                return json.value(start, end);  // Mask is rebuilt from the fields
+            }
+            error = "unsupported write member " + key;
+            return false;
+        }) && hasUpdate;
+    };
+
+    bool ok = json.consume('{') && json.members([&](const std::string& key) {
+        if (key != "writes") return json.value(start, end);
+        if (!json.consume('[')) return false;
+        if (json.consume(']')) return true;
+        do {
+            writes.emplace_back();
+            if (!json.consume('{') || !parseWrite(writes.back())) return false;
+            if (databaseOf(writes.back().name).empty()) {
+                error = "bad document name";
+                return false;
+            }
+        } while (json.consume(','));
+        return json.consume(']');
+    }) && json.atEnd();
+
+    if (!ok && error.empty()) error = "malformed commit body";
+    return ok;
+}
+
+std::string databaseOf(const std::string& name) {
+    size_t documents = name.find("/documents/");
+    if (name.compare(0, 9, "projects/") != 0 || documents == std::string::npos) return "";
+    return name.substr(0, documents);
+}
@@ -0,0 +1,33 @@
+/*
+ * CommitParser - reads the Firestore documents:commit bodies the devices
+ * send (FirestoreBatch) without building a JSON tree
+ *
+ * Only what the gateway needs is extracted: each write's document name,
+ * whether it carries an update mask (merge), and its fields as
+ * name -> raw JSON value text, so values are forwarded byte for byte.
+ * Strings stay in their escaped form.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// "name": raw JSON value, e.g. {"integerValue":"512"}
+typedef std::pair<std::string, std::string> RawField;
+
+struct DocumentWrite {
+    std::string name;               // projects/<p>/databases/<d>/documents/<path>
+    bool merge = false;             // updateMask present: only these fields are written
+    std::vector<RawField> fields;
+};
+
+// Parse a commit body. Returns false (with a reason) on malformed JSON or
+// writes other than plain updates (deletes, transforms, preconditions).
+bool parseCommit(const char* body, size_t length, std::vector<DocumentWrite>& writes,
+                 std::string& error);
+
+// The database part of a document name ("projects/<p>/databases/<d>"),
+// or an empty string if name is not a document name
+std::string databaseOf(const std::string& name);
@@ -0,0 +1,250 @@
+#include "Gateway.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+const size_t MAX_PROXY_QUEUE = 1024;
+const uint32_t RETRY_BACKOFF_MIN_MS = 250;
+const uint32_t RETRY_BACKOFF_MAX_MS = 30000;
+
+static bool endsWith(const std::string& path, const char* suffix) {
+    size_t length = strlen(suffix);
+    return path.size() >= length && path.compare(path.size() - length, length, suffix) == 0;
+}
+
+static HttpResponse errorResponse(int status, const std::string& message) {
+    HttpResponse response;
+    response.status = status;
+    response.body = "{\"error\":{\"code\":" + std::to_string(status) + ",\"message\":\"" + message + "\"}}";
+    return response;
+}
+
+Gateway::Gateway(const GatewayConfig& config)
+    : _config(config),
+      _aggregator(config.maxPending),
+      _server(config.port, config.ingestThreads,
+              [this](HttpRequest&& request, Responder responder) { handle(std::move(request), responder); }) {}
+
+Gateway::~Gateway() {
+    stop();
+}
+
+bool Gateway::start() {
+    _discard = _config.upstream == "none";
+    if (!_discard && !_endpoint.parse(_config.upstream)) {
+        fprintf(stderr, "✗ Upstream must be http(s)://host[:port] or none: %s\n", _config.upstream.c_str());
+        return false;
+    }
+    if (!_server.start()) {
+        fprintf(stderr, "✗ Cannot listen on port %u\n", _config.port);
+        return false;
+    }
+
+    _running = true;
+    _proxying = true;
+    unsigned threads = _config.upstreamThreads ? _config.upstreamThreads : 1;
+    for (unsigned i = 0; i < threads; i++) {
+        _forwarders.emplace_back([this] { forwardLoop(); });
+        _proxies.emplace_back([this] { proxyLoop(); });
+    }
+    return true;
+}
+
+// Proxies first (they answer through the ingest loops), then the server
+// (no new writes), then the forwarders once they have drained the rest
+void Gateway::stop() {
+    if (!_running.load()) return;
+
+    {
+        std::lock_guard<std::mutex> guard(_proxyLock);
+        _proxying = false;
+    }
+    _proxyReady.notify_all();
+    for (std::thread& thread : _proxies) thread.join();
+    _proxies.clear();
+
+    _server.stop();
+
+    _running = false;
+    _wake.notify_all();
+    for (std::thread& thread : _forwarders) thread.join();
+    _forwarders.clear();
+}
+
+GatewayStats Gateway::stats() const {
+    GatewayStats stats;
+    stats.requests = _server.requestCount();
+    stats.connections = _server.connectionCount();
+    stats.received = _aggregator.receivedCount();
+    stats.coalesced = _aggregator.coalescedCount();
+    stats.rejected = _aggregator.rejectedCount();
+    stats.forwarded = _forwarded.load(std::memory_order_relaxed);
+    stats.dropped = _dropped.load(std::memory_order_relaxed);
+    stats.commits = _commits.load(std::memory_order_relaxed);
+    stats.retries = _retries.load(std::memory_order_relaxed);
+    stats.proxied = _proxied.load(std::memory_order_relaxed);
+    stats.pending = _aggregator.pending();
+    return stats;
+}
+
+// Runs on an ingest thread: parse and queue, never wait on upstream
+void Gateway::handle(HttpRequest&& request, Responder responder) {
+    std::string path = request.target.substr(0, request.target.find('?'));
+
+    if (request.method == "GET" && path == "/healthz") {
+        GatewayStats current = stats();
+        HttpResponse response;
+        char body[256];
+        snprintf(body, sizeof(body),
+                 "{\"pending\":%zu,\"received\":%llu,\"coalesced\":%llu,\"forwarded\":%llu,"
+                 "\"commits\":%llu,\"rejected\":%llu}",
+                 current.pending, (unsigned long long)current.received,
+                 (unsigned long long)current.coalesced, (unsigned long long)current.forwarded,
+                 (unsigned long long)current.commits, (unsigned long long)current.rejected);
+        response.body = body;
+        responder.send(std::move(response));
+        return;
+    }
+    if (request.method != "POST") {
+        responder.send(errorResponse(404, "not found"));
+        return;
+    }
+
+    if (endsWith(path, "/documents:commit")) {
+        std::vector<DocumentWrite> writes;
+        std::string error;
+        if (!parseCommit(request.body.data(), request.body.size(), writes, error)) {
+            responder.send(errorResponse(400, error));
+            return;
+        }
+        if (!_aggregator.add(writes, queryParameter(request.target, "key"))) {
+            responder.send(errorResponse(503, "gateway queue full"));
+            return;
+        }
+        if (underPressure()) _wake.notify_one();
+        HttpResponse response;
+        response.body = "{}";
+        responder.send(std::move(response));
+        return;
+    }
+
+    if (endsWith(path, "/documents:batchGet")) {
+        if (_discard) {
+            responder.send(errorResponse(502, "no upstream"));
+            return;
+        }
+        std::unique_lock<std::mutex> guard(_proxyLock);
+        if (!_proxying || _proxyJobs.size() >= MAX_PROXY_QUEUE) {
+            guard.unlock();
+            responder.send(errorResponse(503, "gateway busy"));
+            return;
+        }
+        _proxyJobs.push_back(ProxyJob{request.target, std::move(request.body), responder});
+        guard.unlock();
+        _proxyReady.notify_one();
+        return;
+    }
+
+    responder.send(errorResponse(404, "not found"));
+}
+
+// Half the queue used: forward early rather than start answering 503
+bool Gateway::underPressure() const {
+    return _aggregator.pending() >= _config.maxPending / 2;
+}
+
+void Gateway::forwardLoop() {
+    std::unique_ptr<UpstreamClient> client;
+    if (!_discard) client.reset(new UpstreamClient(_endpoint));
+    uint32_t backoffMs = 0;
+
+    for (;;) {
+        bool running = _running.load();
+        if (running) {
+            std::unique_lock<std::mutex> guard(_wakeLock);
+            uint32_t waitMs = backoffMs ? backoffMs : _config.flushMs;
+            _wake.wait_for(guard, std::chrono::milliseconds(waitMs), [&] {
+                return !_running.load() || (!backoffMs && underPressure());
+            });
+        }
+
+        // Send what was pending when the interval ended; later writes wait
+        // for the next one and keep folding into their documents meanwhile
+        size_t due = running ? _aggregator.pending() : SIZE_MAX;
+        size_t sent = 0;
+        CommitBatch batch;
+        bool sentAll = true;
+        while (sent < due && _aggregator.take(_config.maxBatch, batch)) {
+            sent += batch.writes.size();
+            if (!forward(client.get(), batch)) {
+                _aggregator.putBack(batch);
+                sentAll = false;
+                break;
+            }
+        }
+
+        if (sentAll) {
+            backoffMs = 0;
+        } else {
+            _retries.fetch_add(1, std::memory_order_relaxed);
+            backoffMs = backoffMs ? std::min(backoffMs * 2, RETRY_BACKOFF_MAX_MS) : RETRY_BACKOFF_MIN_MS;
+            if (!running) return;  // Upstream down at shutdown: give up on the rest
+        }
+        if (!running && _aggregator.pending() == 0) return;
+    }
+}
+
+// True when the batch is done with (sent, or refused for good)
+bool Gateway::forward(UpstreamClient* client, CommitBatch& batch) {
+    if (!client) {
+        _forwarded.fetch_add(batch.writes.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    std::string path = "/v1/" + batch.database + "/documents:commit";
+    if (!batch.apiKey.empty()) path += "?key=" + batch.apiKey;
+    std::string response;
+    int status = client->request("POST", path, WriteAggregator::commitBody(batch), &response);
+    _commits.fetch_add(1, std::memory_order_relaxed);
+
+    if (status >= 200 && status < 300) {
+        _forwarded.fetch_add(batch.writes.size(), std::memory_order_relaxed);
+        return true;
+    }
+    if (status >= 400 && status < 500 && status != 429) {
+        _dropped.fetch_add(batch.writes.size(), std::memory_order_relaxed);
+        fprintf(stderr, "✗ Upstream refused %zu writes for %s (HTTP %d): %.200s\n", batch.writes.size(),
+                batch.database.c_str(), status, response.c_str());
+        return true;
+    }
+    fprintf(stderr, "⚠ Upstream commit failed (HTTP %d), %zu writes kept\n", status, batch.writes.size());
+    return false;
+}
+
+void Gateway::proxyLoop() {
+    std::unique_ptr<UpstreamClient> client;
+    if (!_discard) client.reset(new UpstreamClient(_endpoint));
+
+    for (;;) {
+        std::unique_lock<std::mutex> guard(_proxyLock);
+        _proxyReady.wait(guard, [&] { return !_proxying || !_proxyJobs.empty(); });
+        if (_proxyJobs.empty()) return;
+        ProxyJob job = std::move(_proxyJobs.front());
+        _proxyJobs.pop_front();
+        guard.unlock();
+
+        HttpResponse response;
+        int status = client ? client->request("POST", job.path, job.body, &response.body) : -1;
+        if (status < 0) {
+            response = errorResponse(502, "upstream unreachable");
+        } else {
+            response.status = status;
+        }
+        _proxied.fetch_add(1, std::memory_order_relaxed);
+        job.responder.send(std::move(response));
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Gateway - LAN endpoint that stands in for Firestore in front of a fleet
+ *
+ * Devices point firestoreHost at the gateway (plain HTTP, firestoreTls
+ * false) and keep sending the same requests:
+ *   POST .../documents:commit    queued in the WriteAggregator, answered
+ *                                200 at once (503 when the queue is full)
+ *   POST .../documents:batchGet  proxied upstream as is (config, commands)
+ * Every flushMs, forwarder threads drain the aggregator into commits of
+ * up to maxBatch writes, so upstream sees a few large commits per interval
+ * instead of one small commit per device report, and a status document
+ * reported several times within the interval is written once. A batch that fails with 5xx or a
+ * transport error is put back and retried after a backoff; a 4xx batch is
+ * dropped (retrying cannot fix it).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "IngestServer.h"
+#include "UpstreamClient.h"
+#include "WriteAggregator.h"
+
+struct GatewayConfig {
+    uint16_t port = 8080;
+    unsigned ingestThreads = 4;
+    std::string upstream = "https://firestore.googleapis.com";  // "none" discards writes
+    unsigned upstreamThreads = 2;       // Forwarders, plus as many batchGet proxies
+    uint32_t flushMs = 1000;            // Longest a write waits before it is forwarded
+    size_t maxBatch = 500;              // Firestore's limit per commit
+    size_t maxPending = 200000;         // Documents waiting; more is answered 503
+};
+
+struct GatewayStats {
+    uint64_t requests;
+    uint64_t connections;
+    uint64_t received;
+    uint64_t coalesced;
+    uint64_t rejected;
+    uint64_t forwarded;                 // Writes acknowledged upstream
+    uint64_t dropped;                   // Writes in batches upstream refused (4xx)
+    uint64_t commits;                   // Upstream commit requests
+    uint64_t retries;
+    uint64_t proxied;
+    size_t pending;
+};
+
+class Gateway {
+public:
+    explicit Gateway(const GatewayConfig& config);
+    ~Gateway();
+
+    // False if the upstream URL is invalid or the port cannot be bound
+    bool start();
+    // Forward whatever is still pending, then stop every thread
+    void stop();
+
+    uint16_t port() const { return _server.port(); }
+    GatewayStats stats() const;
+
+private:
+    struct ProxyJob {
+        std::string path;
+        std::string body;
+        Responder responder;
+    };
+
+    void handle(HttpRequest&& request, Responder responder);
+    bool underPressure() const;
+    void forwardLoop();
+    void proxyLoop();
+    bool forward(UpstreamClient* client, CommitBatch& batch);
+
+    GatewayConfig _config;
+    Endpoint _endpoint;
+    bool _discard = false;
+    WriteAggregator _aggregator;
+    IngestServer _server;
+
+    std::atomic<bool> _running{false};
+    std::mutex _wakeLock;
+    std::condition_variable _wake;      // Forwarders: a full batch is waiting, or stopping
+    std::vector<std::thread> _forwarders;
+
+    std::mutex _proxyLock;
+    std::condition_variable _proxyReady;
+    std::deque<ProxyJob> _proxyJobs;
+    bool _proxying = false;             // Guarded by _proxyLock
+    std::vector<std::thread> _proxies;
+
+    std::atomic<uint64_t> _forwarded{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _commits{0};
+    std::atomic<uint64_t> _retries{0};
+    std::atomic<uint64_t> _proxied{0};
+};
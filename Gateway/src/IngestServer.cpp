@@ -0,0 +1,391 @@
+#include "IngestServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+const int MAX_EVENTS = 256;
+const size_t READ_CHUNK = 16384;
+
+static const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+class IngestLoop {
+public:
+    IngestLoop(const HttpHandler& handler, size_t maxBodyBytes)
+        : _handler(handler), _maxBodyBytes(maxBodyBytes) {}
+
+    ~IngestLoop() {
+        for (auto& entry : _connections) ::close(entry.second.fd);
+        if (_listenFd >= 0) ::close(_listenFd);
+        if (_wakeFd >= 0) ::close(_wakeFd);
+        if (_epollFd >= 0) ::close(_epollFd);
+    }
+
+    bool bind(uint16_t& port) {
+        _listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (_listenFd < 0) return false;
+        int one = 1, zero = 0;
+        setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(_listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        setsockopt(_listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+
+        sockaddr_in6 address = {};
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        if (::bind(_listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(_listenFd, 1024) != 0) {
+            return false;
+        }
+        socklen_t length = sizeof(address);
+        getsockname(_listenFd, (sockaddr*)&address, &length);
+        port = ntohs(address.sin6_port);  // Port 0 binds an ephemeral port; the rest share it
+
+        _epollFd = epoll_create1(0);
+        _wakeFd = eventfd(0, EFD_NONBLOCK);
+        watch(_listenFd, EPOLLIN, LISTEN_ID);
+        watch(_wakeFd, EPOLLIN, WAKE_ID);
+        return _epollFd >= 0 && _wakeFd >= 0;
+    }
+
+    void run() {
+        _thread = std::this_thread::get_id();
+        epoll_event events[MAX_EVENTS];
+        while (!_stopping.load(std::memory_order_relaxed)) {
+            int count = epoll_wait(_epollFd, events, MAX_EVENTS, 500);
+            for (int i = 0; i < count; i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == LISTEN_ID) {
+                    acceptAll();
+                } else if (id == WAKE_ID) {
+                    drainCompletions();
+                } else {
+                    auto it = _connections.find(id);
+                    if (it == _connections.end()) continue;
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                        closeConnection(it->first);
+                        continue;
+                    }
+                    if (events[i].events & EPOLLOUT) {
+                        // flush() closes the connection after a final write or an error
+                        flush(it->second);
+                        if (_connections.find(id) == _connections.end()) continue;
+                    }
+                    if (events[i].events & EPOLLIN) readFrom(id);
+                }
+            }
+        }
+    }
+
+    void stop() {
+        _stopping = true;
+        uint64_t one = 1;
+        (void)!write(_wakeFd, &one, sizeof(one));
+    }
+
+    void complete(uint64_t id, HttpResponse&& response) {
+        if (std::this_thread::get_id() == _thread) {
+            respond(id, std::move(response));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(_completionsLock);
+            _completions.emplace_back(id, std::move(response));
+        }
+        uint64_t one = 1;
+        (void)!write(_wakeFd, &one, sizeof(one));
+    }
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> accepted{0};
+
+private:
+    static const uint64_t LISTEN_ID = 0;
+    static const uint64_t WAKE_ID = 1;
+
+    struct Connection {
+        int fd;
+        std::string in;
+        std::string out;
+        size_t outOffset = 0;
+        bool busy = false;              // A request is with the handler
+        bool closeAfterWrite = false;
+        bool wantWrite = false;
+    };
+
+    void watch(int fd, uint32_t events, uint64_t id) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            uint64_t id = _nextId++;
+            Connection& connection = _connections[id];
+            connection.fd = fd;
+            watch(fd, EPOLLIN | EPOLLRDHUP, id);
+            accepted.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void readFrom(uint64_t id) {
+        auto it = _connections.find(id);
+        if (it == _connections.end()) return;
+        Connection& connection = it->second;
+        char chunk[READ_CHUNK];
+        for (;;) {
+            ssize_t received = recv(connection.fd, chunk, sizeof(chunk), 0);
+            if (received > 0) {
+                connection.in.append(chunk, received);
+                continue;
+            }
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                closeConnection(id);
+                return;
+            }
+            break;
+        }
+        parseRequests(id);
+    }
+
+    // Hand complete requests to the handler, one at a time per connection
+    void parseRequests(uint64_t id) {
+        for (;;) {
+            auto it = _connections.find(id);
+            if (it == _connections.end()) return;
+            Connection& connection = it->second;
+            if (connection.busy || connection.closeAfterWrite) return;
+
+            size_t headerEnd = connection.in.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) {
+                if (connection.in.size() > 8192) closeConnection(id);
+                return;
+            }
+
+            HttpRequest request;
+            size_t lineEnd = connection.in.find("\r\n");
+            std::string line = connection.in.substr(0, lineEnd);
+            size_t space1 = line.find(' ');
+            size_t space2 = line.find(' ', space1 + 1);
+            if (space1 == std::string::npos || space2 == std::string::npos) {
+                closeConnection(id);
+                return;
+            }
+            request.method = line.substr(0, space1);
+            request.target = line.substr(space1 + 1, space2 - space1 - 1);
+
+            size_t contentLength = 0;
+            bool keepAlive = line.compare(space2 + 1, std::string::npos, "HTTP/1.0") != 0;
+            for (size_t pos = lineEnd + 2; pos < headerEnd;) {
+                size_t end = connection.in.find("\r\n", pos);
+                const char* header = connection.in.c_str() + pos;
+                if (!strncasecmp(header, "Content-Length:", 15)) contentLength = strtoul(header + 15, nullptr, 10);
+                if (!strncasecmp(header, "Connection:", 11)) {
+                    const char* value = header + 11;
+                    while (*value == ' ') value++;
+                    if (!strncasecmp(value, "close", 5)) keepAlive = false;
+                    if (!strncasecmp(value, "keep-alive", 10)) keepAlive = true;
+                }
+                pos = end + 2;
+            }
+
+            if (contentLength > _maxBodyBytes) {
+                connection.closeAfterWrite = true;
+                HttpResponse tooLarge;
+                tooLarge.status = 413;
+                tooLarge.body = "{\"error\":\"body too large\"}";
+                queueResponse(connection, tooLarge);
+                flush(connection);
+                return;
+            }
+            size_t total = headerEnd + 4 + contentLength;
+            if (connection.in.size() < total) return;
+
+            request.body.assign(connection.in, headerEnd + 4, contentLength);
+            connection.in.erase(0, total);
+            connection.busy = true;
+            connection.closeAfterWrite = !keepAlive;
+            requests.fetch_add(1, std::memory_order_relaxed);
+            _handler(std::move(request), Responder(this, id));
+        }
+    }
+
+    void respond(uint64_t id, HttpResponse&& response) {
+        auto it = _connections.find(id);
+        if (it == _connections.end()) return;  // Client went away meanwhile
+        Connection& connection = it->second;
+        connection.busy = false;
+        queueResponse(connection, response);
+        flush(connection);
+        if (_connections.count(id) && !connection.closeAfterWrite) parseRequests(id);
+    }
+
+    void queueResponse(Connection& connection, const HttpResponse& response) {
+        char head[160];
+        int length = snprintf(head, sizeof(head),
+                              "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n"
+                              "Content-Length: %zu\r\nConnection: %s\r\n\r\n",
+                              response.status, reasonPhrase(response.status), response.body.size(),
+                              connection.closeAfterWrite ? "close" : "keep-alive");
+        connection.out.append(head, length);
+        connection.out += response.body;
+    }
+
+    void flush(Connection& connection) {
+        while (connection.outOffset < connection.out.size()) {
+            ssize_t sent = send(connection.fd, connection.out.data() + connection.outOffset,
+                                connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                connection.outOffset += sent;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                setWantWrite(connection, true);
+                return;
+            }
+            closeByFd(connection.fd);
+            return;
+        }
+        connection.out.clear();
+        connection.outOffset = 0;
+        setWantWrite(connection, false);
+        if (connection.closeAfterWrite && !connection.busy) closeByFd(connection.fd);
+    }
+
+    void setWantWrite(Connection& connection, bool want) {
+        if (connection.wantWrite == want) return;
+        connection.wantWrite = want;
+        for (auto& entry : _connections) {
+            if (&entry.second != &connection) continue;
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLRDHUP | (want ? (uint32_t)EPOLLOUT : 0u);
+            event.data.u64 = entry.first;
+            epoll_ctl(_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+            return;
+        }
+    }
+
+    void closeByFd(int fd) {
+        for (auto& entry : _connections) {
+            if (entry.second.fd == fd) {
+                closeConnection(entry.first);
+                return;
+            }
+        }
+    }
+
+    void closeConnection(uint64_t id) {
+        auto it = _connections.find(id);
+        if (it == _connections.end()) return;
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        _connections.erase(it);
+    }
+
+    void drainCompletions() {
+        uint64_t counter;
+        (void)!read(_wakeFd, &counter, sizeof(counter));
+        std::vector<std::pair<uint64_t, HttpResponse>> completions;
+        {
+            std::lock_guard<std::mutex> guard(_completionsLock);
+            completions.swap(_completions);
+        }
+        for (auto& completion : completions) respond(completion.first, std::move(completion.second));
+    }
+
+    const HttpHandler& _handler;
+    const size_t _maxBodyBytes;
+    int _listenFd = -1;
+    int _epollFd = -1;
+    int _wakeFd = -1;
+    std::thread::id _thread;
+    std::atomic<bool> _stopping{false};
+
+    std::unordered_map<uint64_t, Connection> _connections;
+    uint64_t _nextId = 2;
+
+    std::mutex _completionsLock;
+    std::vector<std::pair<uint64_t, HttpResponse>> _completions;
+};
+
+void Responder::send(HttpResponse&& response) {
+    _loop->complete(_connection, std::move(response));
+}
+
+IngestServer::IngestServer(uint16_t port, unsigned threads, HttpHandler handler, size_t maxBodyBytes)
+    : _port(port), _threadCount(threads ? threads : 1), _handler(std::move(handler)),
+      _maxBodyBytes(maxBodyBytes) {}
+
+IngestServer::~IngestServer() {
+    stop();
+}
+
+bool IngestServer::start() {
+    for (unsigned i = 0; i < _threadCount; i++) {
+        _loops.emplace_back(new IngestLoop(_handler, _maxBodyBytes));
+        if (!_loops.back()->bind(_port)) return false;
+    }
+    for (auto& loop : _loops) {
+        IngestLoop* raw = loop.get();
+        _threads.emplace_back([raw] { raw->run(); });
+    }
+    return true;
+}
+
+void IngestServer::stop() {
+    for (auto& loop : _loops) loop->stop();
+    for (std::thread& thread : _threads) thread.join();
+    _threads.clear();
+    _loops.clear();
+}
+
+uint64_t IngestServer::requestCount() const {
+    uint64_t total = 0;
+    for (auto& loop : _loops) total += loop->requests.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t IngestServer::connectionCount() const {
+    uint64_t total = 0;
+    for (auto& loop : _loops) total += loop->accepted.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::string queryParameter(const std::string& target, const char* name) {
+    size_t query = target.find('?');
+    if (query == std::string::npos) return "";
+    std::string key = std::string(name) + "=";
+    for (size_t pos = query + 1; pos < target.size();) {
+        size_t end = target.find('&', pos);
+        if (end == std::string::npos) end = target.size();
+        if (target.compare(pos, key.size(), key) == 0) {
+            return target.substr(pos + key.size(), end - pos - key.size());
+        }
+        pos = end + 1;
+    }
+    return "";
+}
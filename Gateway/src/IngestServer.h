@@ -0,0 +1,75 @@
+/*
+ * IngestServer - HTTP/1.1 server for device traffic on the LAN
+ *
+ * Each ingest thread owns a listening socket (SO_REUSEPORT, so the kernel
+ * spreads new connections across threads) and an epoll loop over its
+ * non-blocking keep-alive connections; no state is shared between
+ * threads. Handlers usually answer inline; a handler that has to wait
+ * (a proxied read) keeps the Responder and answers later from any
+ * thread, and the owning loop is woken through an eventfd.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct HttpRequest {
+    std::string method;
+    std::string target;                 // Path and query
+    std::string body;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string body;
+};
+
+class IngestLoop;
+
+// Answers one request, exactly once, from any thread
+class Responder {
+public:
+    Responder(IngestLoop* loop, uint64_t connection) : _loop(loop), _connection(connection) {}
+    void send(HttpResponse&& response);
+
+private:
+    IngestLoop* _loop;
+    uint64_t _connection;
+};
+
+typedef std::function<void(HttpRequest&& request, Responder responder)> HttpHandler;
+
+class IngestServer {
+public:
+    // Larger bodies are answered 413 and the connection closed
+    static const size_t DEVICE_MAX_BODY = 65536;
+
+    IngestServer(uint16_t port, unsigned threads, HttpHandler handler,
+                 size_t maxBodyBytes = DEVICE_MAX_BODY);
+    ~IngestServer();
+
+    // Bind every thread's socket and start serving; false if the port is taken
+    bool start();
+    void stop();
+
+    uint16_t port() const { return _port; }
+    uint64_t requestCount() const;
+    uint64_t connectionCount() const;
+
+private:
+    uint16_t _port;
+    unsigned _threadCount;
+    HttpHandler _handler;
+    size_t _maxBodyBytes;
+    std::vector<std::unique_ptr<IngestLoop>> _loops;
+    std::vector<std::thread> _threads;
+};
+
+// "key" query parameter of a request target, or ""
+std::string queryParameter(const std::string& target, const char* name);
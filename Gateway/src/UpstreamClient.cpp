@@ -0,0 +1,232 @@
+#include "UpstreamClient.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+
+const int UPSTREAM_TIMEOUT_SEC = 15;
+const size_t READ_CHUNK = 16384;
+
+static SSL_CTX* sharedContext() {
+    static SSL_CTX* context = [] {
+        SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_default_verify_paths(ctx);
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+        SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+        return ctx;
+    }();
+    return context;
+}
+
+bool Endpoint::parse(const std::string& url) {
+    std::string rest;
+    if (url.compare(0, 8, "https://") == 0) {
+        tls = true;
+        port = 443;
+        rest = url.substr(8);
+    } else if (url.compare(0, 7, "http://") == 0) {
+        tls = false;
+        port = 80;
+        rest = url.substr(7);
+    } else {
+        return false;
+    }
+    if (!rest.empty() && rest.back() == '/') rest.pop_back();
+    size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        port = (uint16_t)atoi(rest.c_str() + colon + 1);
+        rest.resize(colon);
+    }
+    host = rest;
+    return !host.empty() && port != 0;
+}
+
+int UpstreamClient::request(const char* method, const std::string& path, const std::string& body,
+                            std::string* response) {
+    std::string request = std::string(method) + " " + path + " HTTP/1.1\r\nHost: " + _endpoint.host +
+                          "\r\nContent-Type: application/json\r\nContent-Length: " +
+                          std::to_string(body.size()) + "\r\nConnection: keep-alive\r\n\r\n" + body;
+    _requests++;
+
+    bool reusing = _fd >= 0;
+    int status = exchange(request, response);
+    if (status < 0 && reusing) status = exchange(request, response);
+    if (status < 0) close();
+    return status;
+}
+
+int UpstreamClient::exchange(const std::string& request, std::string* response) {
+    if (_fd < 0 && !connect()) return -1;
+    if (!sendAll(request.data(), request.size())) {
+        close();
+        return -1;
+    }
+
+    std::string line;
+    if (!readLine(line) || line.compare(0, 5, "HTTP/") != 0) {
+        close();
+        return -1;
+    }
+    int status = atoi(line.c_str() + line.find(' ') + 1);
+
+    long contentLength = -1;
+    bool chunked = false;
+    bool keepAlive = true;
+    while (readLine(line) && !line.empty()) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        const char* value = line.c_str() + colon + 1;
+        while (*value == ' ') value++;
+        if (!strcasecmp(name.c_str(), "Content-Length")) contentLength = atol(value);
+        if (!strcasecmp(name.c_str(), "Transfer-Encoding")) chunked = strcasestr(value, "chunked") != nullptr;
+        if (!strcasecmp(name.c_str(), "Connection")) keepAlive = strcasecmp(value, "close") != 0;
+    }
+    if (line.size() > 0) {
+        close();
+        return -1;
+    }
+
+    if (response) response->clear();
+    bool ok = true;
+    if (chunked) {
+        for (;;) {
+            if (!readLine(line)) {
+                ok = false;
+                break;
+            }
+            size_t size = strtoul(line.c_str(), nullptr, 16);
+            if (size == 0) {
+                while (readLine(line) && !line.empty()) {}  // Trailers
+                break;
+            }
+            if (!readBytes(size, response) || !readLine(line)) {
+                ok = false;
+                break;
+            }
+        }
+    } else if (contentLength >= 0) {
+        ok = readBytes(contentLength, response);
+    } else {
+        // Body runs to the end of the connection
+        while (fill()) {}
+        if (response) response->append(_buffer, _offset, std::string::npos);
+        keepAlive = false;
+    }
+
+    if (!ok) {
+        close();
+        return -1;
+    }
+    if (!keepAlive) close();
+    return status;
+}
+
+bool UpstreamClient::connect() {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(_endpoint.host.c_str(), std::to_string(_endpoint.port).c_str(), &hints,
+                    &addresses) != 0) {
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address && _fd < 0; address = address->ai_next) {
+        _fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (_fd < 0) continue;
+        timeval timeout = {UPSTREAM_TIMEOUT_SEC, 0};
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        int one = 1;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(_fd, address->ai_addr, address->ai_addrlen) != 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (_fd < 0) return false;
+
+    if (_endpoint.tls) {
+        _ssl = SSL_new(sharedContext());
+        SSL_set_fd(_ssl, _fd);
+        SSL_set_tlsext_host_name(_ssl, _endpoint.host.c_str());
+        SSL_set1_host(_ssl, _endpoint.host.c_str());
+        if (SSL_connect(_ssl) != 1) {
+            ERR_clear_error();
+            close();
+            return false;
+        }
+    }
+    _buffer.clear();
+    _offset = 0;
+    _connects++;
+    return true;
+}
+
+void UpstreamClient::close() {
+    if (_ssl) {
+        SSL_free(_ssl);
+        _ssl = nullptr;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _buffer.clear();
+    _offset = 0;
+}
+
+bool UpstreamClient::sendAll(const char* data, size_t length) {
+    while (length > 0) {
+        int sent = _ssl ? SSL_write(_ssl, data, (int)length)
+                        : (int)send(_fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+bool UpstreamClient::fill() {
+    if (_offset > 0 && _offset == _buffer.size()) {
+        _buffer.clear();
+        _offset = 0;
+    }
+    char chunk[READ_CHUNK];
+    int received = _ssl ? SSL_read(_ssl, chunk, sizeof(chunk))
+                        : (int)recv(_fd, chunk, sizeof(chunk), 0);
+    if (received <= 0) return false;
+    _buffer.append(chunk, received);
+    return true;
+}
+
+bool UpstreamClient::readLine(std::string& line) {
+    for (;;) {
+        size_t end = _buffer.find("\r\n", _offset);
+        if (end != std::string::npos) {
+            line.assign(_buffer, _offset, end - _offset);
+            _offset = end + 2;
+            return true;
+        }
+        if (!fill()) return false;
+    }
+}
+
+bool UpstreamClient::readBytes(size_t count, std::string* out) {
+    while (_buffer.size() - _offset < count) {
+        if (!fill()) return false;
+    }
+    if (out) out->append(_buffer, _offset, count);
+    _offset += count;
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * UpstreamClient - blocking HTTP/1.1 client with keep-alive, over TLS
+ * (OpenSSL, certificate and host name verified) for Firestore or plain
+ * TCP for a local stand-in
+ *
+ * One instance per thread; the connection is reused until the server
+ * closes it or a request fails.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+typedef struct ssl_st SSL;
+
+struct Endpoint {
+    std::string host;
+    uint16_t port = 443;
+    bool tls = true;
+
+    // "https://host[:port]" or "http://host[:port]"; false on anything else
+    bool parse(const std::string& url);
+};
+
+class UpstreamClient {
+public:
+    explicit UpstreamClient(const Endpoint& endpoint) : _endpoint(endpoint) {}
+    ~UpstreamClient() { close(); }
+    UpstreamClient(const UpstreamClient&) = delete;
+    UpstreamClient& operator=(const UpstreamClient&) = delete;
+
+    // HTTP status, or -1 on a transport failure. A failure on a reused
+    // connection is retried once on a fresh one (idle keep-alive closed).
+    int request(const char* method, const std::string& path, const std::string& body,
+                std::string* response = nullptr);
+
+    void close();
+
+    uint64_t connectCount() const { return _connects; }
+    uint64_t requestCount() const { return _requests; }
+
+private:
+    int exchange(const std::string& request, std::string* response);
+    bool connect();
+    bool sendAll(const char* data, size_t length);
+    bool fill();                        // Read more into _buffer
+    bool readLine(std::string& line);
+    bool readBytes(size_t count, std::string* out);
+
+    Endpoint _endpoint;
+    int _fd = -1;
+    SSL* _ssl = nullptr;
+    std::string _buffer;                // Received but not yet consumed
+    size_t _offset = 0;
+
+    uint64_t _connects = 0;
+    uint64_t _requests = 0;
+};
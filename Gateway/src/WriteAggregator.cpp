@@ -0,0 +1,135 @@
+#include "WriteAggregator.h"
+
+#include <functional>
+
+WriteAggregator::Shard& WriteAggregator::shardOf(const std::string& name) {
+    return _shards[std::hash<std::string>()(name) % SHARDS];
+}
+
+void WriteAggregator::fold(DocumentWrite& older, DocumentWrite&& newer) {
+    if (!newer.merge) {
+        older = std::move(newer);
+        return;
+    }
+    // Merge: overlay the newer fields; a replace stays a replace
+    for (RawField& field : newer.fields) {
+        bool found = false;
+        for (RawField& existing : older.fields) {
+            if (existing.first == field.first) {
+                existing.second = std::move(field.second);
+                found = true;
+                break;
+            }
+        }
+        if (!found) older.fields.push_back(std::move(field));
+    }
+}
+
+bool WriteAggregator::add(std::vector<DocumentWrite>& writes, const std::string& apiKey) {
+    if (writes.empty()) return true;
+    if (_pending.load(std::memory_order_relaxed) + writes.size() > _maxPending) {
+        _rejected.fetch_add(writes.size(), std::memory_order_relaxed);
+        return false;
+    }
+
+    if (!apiKey.empty()) {
+        std::string database = databaseOf(writes.front().name);
+        std::lock_guard<std::mutex> guard(_keysLock);
+        _apiKeys[database] = apiKey;
+    }
+
+    for (DocumentWrite& write : writes) {
+        Shard& shard = shardOf(write.name);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.documents.find(write.name);
+        if (it == shard.documents.end()) {
+            std::string name = write.name;
+            shard.documents.emplace(std::move(name), std::move(write));
+            _pending.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            fold(it->second, std::move(write));
+            _coalesced.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    _received.fetch_add(writes.size(), std::memory_order_relaxed);
+    return true;
+}
+
+bool WriteAggregator::take(size_t maxWrites, CommitBatch& batch) {
+    batch.database.clear();
+    batch.writes.clear();
+
+    size_t first = _nextShard.fetch_add(1, std::memory_order_relaxed);
+    for (size_t visited = 0; visited < SHARDS && batch.writes.size() < maxWrites; visited++) {
+        Shard& shard = _shards[(first + visited) % SHARDS];
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for (auto it = shard.documents.begin();
+             it != shard.documents.end() && batch.writes.size() < maxWrites;) {
+            std::string database = databaseOf(it->first);
+            if (batch.database.empty()) batch.database = database;
+            if (database != batch.database) {
+                ++it;
+                continue;
+            }
+            batch.writes.push_back(std::move(it->second));
+            it = shard.documents.erase(it);
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    if (batch.writes.empty()) return false;
+
+    std::lock_guard<std::mutex> guard(_keysLock);
+    auto key = _apiKeys.find(batch.database);
+    batch.apiKey = key == _apiKeys.end() ? "" : key->second;
+    return true;
+}
+
+void WriteAggregator::putBack(CommitBatch& batch) {
+    for (DocumentWrite& write : batch.writes) {
+        Shard& shard = shardOf(write.name);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.documents.find(write.name);
+        if (it == shard.documents.end()) {
+            std::string name = write.name;
+            shard.documents.emplace(std::move(name), std::move(write));
+            _pending.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            fold(write, std::move(it->second));
+            it->second = std::move(write);
+        }
+    }
+    batch.writes.clear();
+}
+
+std::string WriteAggregator::commitBody(const CommitBatch& batch) {
+    std::string body = "{\"writes\":[";
+    for (size_t i = 0; i < batch.writes.size(); i++) {
+        const DocumentWrite& write = batch.writes[i];
+        if (i) body += ',';
+        body += "{\"update\":{\"name\":\"";
+        body += write.name;
+        body += "\",\"fields\":{";
+        for (size_t f = 0; f < write.fields.size(); f++) {
+            if (f) body += ',';
+            body += '"';
+            body += write.fields[f].first;
+            body += "\":";
+            body += write.fields[f].second;
+        }
+        body += "}}";
+        if (write.merge) {
+            body += ",\"updateMask\":{\"fieldPaths\":[";
+            for (size_t f = 0; f < write.fields.size(); f++) {
+                if (f) body += ',';
+                body += '"';
+                body += write.fields[f].first;
+                body += '"';
+            }
+            body += "]}";
+        }
+        body += '}';
+    }
+    body += "]}";
+    return body;
+}
@@ -0,0 +1,75 @@
+/*
+ * WriteAggregator - pending Firestore writes from every device, one entry
+ * per document
+ *
+ * A second write to a document that is still pending is folded into the
+ * first (a replace wins, a merge overlays its fields), so a status
+ * heartbeat sent every few seconds costs one upstream write per flush,
+ * not one per report. Documents are spread over mutex-protected shards
+ * so ingest threads rarely contend.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CommitParser.h"
+
+// Writes for one database, ready to be sent as one documents:commit
+struct CommitBatch {
+    std::string database;
+    std::string apiKey;
+    std::vector<DocumentWrite> writes;
+};
+
+class WriteAggregator {
+public:
+    static const size_t SHARDS = 32;
+
+    explicit WriteAggregator(size_t maxPending) : _maxPending(maxPending) {}
+
+    // Queue writes received from a device. Returns false without queueing
+    // anything when maxPending documents are already waiting.
+    bool add(std::vector<DocumentWrite>& writes, const std::string& apiKey);
+
+    // Move up to maxWrites pending writes of one database into batch;
+    // returns false when nothing is pending
+    bool take(size_t maxWrites, CommitBatch& batch);
+
+    // A batch that could not be sent goes back, underneath anything newer
+    // that arrived for the same documents meanwhile
+    void putBack(CommitBatch& batch);
+
+    size_t pending() const { return _pending.load(std::memory_order_relaxed); }
+    uint64_t receivedCount() const { return _received.load(std::memory_order_relaxed); }
+    uint64_t coalescedCount() const { return _coalesced.load(std::memory_order_relaxed); }
+    uint64_t rejectedCount() const { return _rejected.load(std::memory_order_relaxed); }
+
+    // {"writes":[...]} for a batch
+    static std::string commitBody(const CommitBatch& batch);
+
+private:
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<std::string, DocumentWrite> documents;
+    };
+
+    // older becomes older-then-newer
+    static void fold(DocumentWrite& older, DocumentWrite&& newer);
+    Shard& shardOf(const std::string& name);
+
+    Shard _shards[SHARDS];
+    std::atomic<size_t> _nextShard{0};  // Where take() starts, so no shard starves
+    std::mutex _keysLock;
+    std::unordered_map<std::string, std::string> _apiKeys;  // Latest key seen per database
+
+    const size_t _maxPending;
+    std::atomic<size_t> _pending{0};
+    std::atomic<uint64_t> _received{0};
+    std::atomic<uint64_t> _coalesced{0};
+    std::atomic<uint64_t> _rejected{0};
+};
@@ -0,0 +1,419 @@
+/*
+ * gateway-bench - thousands of simulated devices against one gateway
+ *
+ *   gateway-bench [--devices 5000] [--threads 4] [--seconds 10]
+ *                 [--interval-ms 1000] [--gateway host:port]
+ *
+ * Each device holds one keep-alive connection and sends what the firmware
+ * sends per report: a documents:commit with a new logs/<n> document and a
+ * merge of its status document. --interval-ms 0 sends the next report as
+ * soon as the previous one is answered (throughput); otherwise every
+ * device reports on its own timer (latency at a fleet's steady rate).
+ *
+ * Without --gateway an in-process gateway (4 ingest threads) is started,
+ * forwarding to an in-process stand-in for Firestore that counts the
+ * writes and commits it receives, so the report shows the reduction.
+ */
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../CommitParser.h"
+#include "../Gateway.h"
+#include "../IngestServer.h"
+
+typedef std::chrono::steady_clock BenchClock;
+
+struct BenchOptions {
+    unsigned devices = 5000;
+    unsigned threads = 4;
+    unsigned seconds = 10;
+    unsigned intervalMs = 1000;
+    std::string gatewayHost = "127.0.0.1";
+    uint16_t gatewayPort = 0;           // 0: start one in process
+};
+
+struct Device {
+    int fd = -1;
+    unsigned id = 0;
+    uint32_t sequence = 0;
+    std::string out;
+    size_t outOffset = 0;
+    std::string in;
+    bool waiting = false;               // Request sent, response pending
+    BenchClock::time_point sentAt;
+    BenchClock::time_point nextAt;
+};
+
+struct ThreadResult {
+    std::vector<uint32_t> latencyUs;
+    uint64_t responses = 0;
+    uint64_t errors = 0;                // Non-200 answers
+    uint64_t failures = 0;              // Connections lost
+};
+
+static std::atomic<bool> benchRunning{true};
+
+static uint64_t microsSince(BenchClock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(BenchClock::now() - start).count();
+}
+
+// Same shape as FirestoreBatch output: a log entry and a status merge
+static std::string reportRequest(const Device& device, const std::string& host) {
+    char name[96];
+    snprintf(name, sizeof(name), "projects/bench/databases/(default)/documents/plantData/ESP8266_%06X",
+             device.id);
+    unsigned moisture = 400 + (device.id * 7 + device.sequence * 3) % 200;
+    unsigned epoch = 1790000000 + device.sequence;
+
+    char body[1024];
+    int length = snprintf(body, sizeof(body),
+        "{\"writes\":["
+        "{\"update\":{\"name\":\"%s/logs/%u\",\"fields\":{"
+        "\"moisture\":{\"integerValue\":\"%u\"},\"pumpState\":{\"stringValue\":\"MONITORING\"},"
+        "\"systemState\":{\"stringValue\":\"ONLINE\"},\"timestamp\":{\"integerValue\":\"%u\"}}}},"
+        "{\"update\":{\"name\":\"%s\",\"fields\":{"
+        "\"moisture\":{\"integerValue\":\"%u\"},\"pumpState\":{\"stringValue\":\"MONITORING\"},"
+        "\"systemState\":{\"stringValue\":\"ONLINE\"},\"lockedFault\":{\"booleanValue\":false},"
+        "\"rssi\":{\"integerValue\":\"-61\"},\"freeHeap\":{\"integerValue\":\"31200\"},"
+        "\"lastSeen\":{\"integerValue\":\"%u\"}}},"
+        "\"updateMask\":{\"fieldPaths\":[\"moisture\",\"pumpState\",\"systemState\",\"lockedFault\","
+        "\"rssi\",\"freeHeap\",\"lastSeen\"]}}]}",
+        name, epoch, moisture, epoch, name, moisture, epoch);
+
+    char head[256];
+    int headLength = snprintf(head, sizeof(head),
+        "POST /v1/projects/bench/databases/(default)/documents:commit?key=bench HTTP/1.1\r\n"
+        "Host: %s\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n",
+        host.c_str(), length);
+    return std::string(head, headLength) + std::string(body, length);
+}
+
+static int connectTo(const sockaddr_storage& address, socklen_t length) {
+    int fd = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (const sockaddr*)&address, length) != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+class DeviceThread {
+public:
+    DeviceThread(const BenchOptions& options, const sockaddr_storage& address, socklen_t length,
+                 unsigned firstId, unsigned count)
+        : _options(options), _address(address), _addressLength(length), _devices(count) {
+        for (unsigned i = 0; i < count; i++) _devices[i].id = firstId + i;
+    }
+
+    void run() {
+        _epoll = epoll_create1(0);
+        BenchClock::time_point start = BenchClock::now();
+        for (size_t i = 0; i < _devices.size(); i++) {
+            Device& device = _devices[i];
+            // Spread first reports over one interval so devices are not in lockstep
+            device.nextAt = start + std::chrono::microseconds(
+                _options.intervalMs ? (uint64_t)_options.intervalMs * 1000 * i / _devices.size() : 0);
+            open(i);
+        }
+
+        epoll_event events[512];
+        while (benchRunning.load(std::memory_order_relaxed)) {
+            BenchClock::time_point now = BenchClock::now();
+            for (size_t i = 0; i < _devices.size(); i++) {
+                Device& device = _devices[i];
+                if (device.fd >= 0 && !device.waiting && device.nextAt <= now) send(i);
+            }
+            int count = epoll_wait(_epoll, events, 512, 1);
+            for (int e = 0; e < count; e++) {
+                size_t i = events[e].data.u64;
+                if (events[e].events & (EPOLLERR | EPOLLHUP)) {
+                    lost(i);
+                    continue;
+                }
+                if (events[e].events & EPOLLOUT) flush(i);
+                if (events[e].events & EPOLLIN) receive(i);
+            }
+        }
+        for (Device& device : _devices) {
+            if (device.fd >= 0) close(device.fd);
+        }
+        close(_epoll);
+    }
+
+    ThreadResult result;
+
+private:
+    void open(size_t i) {
+        Device& device = _devices[i];
+        device.fd = connectTo(_address, _addressLength);
+        device.waiting = false;
+        device.in.clear();
+        if (device.fd < 0) return;
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = i;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, device.fd, &event);
+    }
+
+    void lost(size_t i) {
+        Device& device = _devices[i];
+        result.failures++;
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, device.fd, nullptr);
+        close(device.fd);
+        open(i);  // Reconnect, as a device would
+    }
+
+    void send(size_t i) {
+        Device& device = _devices[i];
+        device.sequence++;
+        device.out = reportRequest(device, _options.gatewayHost);
+        device.outOffset = 0;
+        device.waiting = true;
+        device.sentAt = BenchClock::now();
+        flush(i);
+    }
+
+    void flush(size_t i) {
+        Device& device = _devices[i];
+        while (device.outOffset < device.out.size()) {
+            ssize_t sent = ::send(device.fd, device.out.data() + device.outOffset,
+                                  device.out.size() - device.outOffset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                device.outOffset += sent;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOTCONN) {
+                watchWrite(device, i, true);
+                return;
+            } else {
+                lost(i);
+                return;
+            }
+        }
+        watchWrite(device, i, false);
+    }
+
+    void watchWrite(Device& device, size_t i, bool want) {
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP | (want ? (uint32_t)EPOLLOUT : 0u);
+        event.data.u64 = i;
+        epoll_ctl(_epoll, EPOLL_CTL_MOD, device.fd, &event);
+    }
+
+    void receive(size_t i) {
+        Device& device = _devices[i];
+        char chunk[4096];
+        for (;;) {
+            ssize_t received = recv(device.fd, chunk, sizeof(chunk), 0);
+            if (received > 0) {
+                device.in.append(chunk, received);
+                continue;
+            }
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                lost(i);
+                return;
+            }
+            break;
+        }
+
+        size_t headerEnd = device.in.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) return;
+        const char* length = strcasestr(device.in.c_str(), "Content-Length:");
+        size_t total = headerEnd + 4 + (length ? strtoul(length + 15, nullptr, 10) : 0);
+        if (device.in.size() < total) return;
+
+        int status = atoi(device.in.c_str() + 9);  // "HTTP/1.1 200"
+        device.in.erase(0, total);
+        device.waiting = false;
+        result.responses++;
+        if (status != 200) result.errors++;
+        result.latencyUs.push_back((uint32_t)std::min<uint64_t>(microsSince(device.sentAt), UINT32_MAX));
+
+        BenchClock::time_point now = BenchClock::now();
+        device.nextAt = _options.intervalMs ? device.nextAt + std::chrono::milliseconds(_options.intervalMs)
+                                            : now;
+        if (device.nextAt < now - std::chrono::seconds(1)) device.nextAt = now;  // Fell behind
+    }
+
+    const BenchOptions& _options;
+    sockaddr_storage _address;
+    socklen_t _addressLength;
+    std::vector<Device> _devices;
+    int _epoll = -1;
+};
+
+// Stand-in for Firestore: accepts commits and counts what arrives
+struct FakeFirestore {
+    std::atomic<uint64_t> commits{0};
+    std::atomic<uint64_t> writes{0};
+
+    void handle(HttpRequest&& request, Responder responder) {
+        std::vector<DocumentWrite> parsed;
+        std::string error;
+        HttpResponse response;
+        if (parseCommit(request.body.data(), request.body.size(), parsed, error)) {
+            commits.fetch_add(1, std::memory_order_relaxed);
+            writes.fetch_add(parsed.size(), std::memory_order_relaxed);
+            response.body = "{\"writeResults\":[]}";
+        } else {
+            response.status = 400;
+            response.body = "{\"error\":\"" + error + "\"}";
+        }
+        responder.send(std::move(response));
+    }
+};
+
+static bool resolve(const std::string& host, uint16_t port, sockaddr_storage& address, socklen_t& length) {
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found) return false;
+    memcpy(&address, found->ai_addr, found->ai_addrlen);
+    length = found->ai_addrlen;
+    freeaddrinfo(found);
+    return true;
+}
+
+static void raiseFileLimit(unsigned needed) {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    if (limit.rlim_cur < needed) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, needed);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur < needed) {
+        fprintf(stderr, "⚠ Open file limit %llu is below the %u sockets needed\n",
+                (unsigned long long)limit.rlim_cur, needed);
+    }
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* option = argv[i];
+        const char* value = argv[i + 1];
+        if (!strcmp(option, "--devices")) options.devices = (unsigned)atoi(value);
+        else if (!strcmp(option, "--threads")) options.threads = (unsigned)atoi(value);
+        else if (!strcmp(option, "--seconds")) options.seconds = (unsigned)atoi(value);
+        else if (!strcmp(option, "--interval-ms")) options.intervalMs = (unsigned)atoi(value);
+        else if (!strcmp(option, "--gateway")) {
+            std::string target = value;
+            size_t colon = target.rfind(':');
+            if (colon == std::string::npos) {
+                fprintf(stderr, "--gateway expects host:port\n");
+                return 2;
+            }
+            options.gatewayHost = target.substr(0, colon);
+            options.gatewayPort = (uint16_t)atoi(target.c_str() + colon + 1);
+        } else {
+            fprintf(stderr, "unknown option %s\n", option);
+            return 2;
+        }
+    }
+    if (options.threads == 0) options.threads = 1;
+    signal(SIGPIPE, SIG_IGN);
+    raiseFileLimit(options.devices * 2 + 256);  // Both ends when the gateway runs in process
+
+    FakeFirestore firestore;
+    std::unique_ptr<IngestServer> upstream;
+    std::unique_ptr<Gateway> gateway;
+    if (options.gatewayPort == 0) {
+        upstream.reset(new IngestServer(0, 1, [&](HttpRequest&& request, Responder responder) {
+            firestore.handle(std::move(request), responder);
+        }, 16 << 20));  // Commits of 500 writes
+        if (!upstream->start()) return 1;
+
+        GatewayConfig config;
+        config.port = 0;
+        config.upstream = "http://127.0.0.1:" + std::to_string(upstream->port());
+        gateway.reset(new Gateway(config));
+        if (!gateway->start()) return 1;
+        options.gatewayPort = gateway->port();
+    }
+
+    sockaddr_storage address;
+    socklen_t addressLength;
+    if (!resolve(options.gatewayHost, options.gatewayPort, address, addressLength)) {
+        fprintf(stderr, "✗ Cannot resolve %s\n", options.gatewayHost.c_str());
+        return 1;
+    }
+
+    printf("%u devices on %u threads for %u s, %s, gateway %s:%u%s\n", options.devices, options.threads,
+           options.seconds,
+           options.intervalMs ? (std::to_string(options.intervalMs) + " ms report interval").c_str()
+                              : "closed loop",
+           options.gatewayHost.c_str(), options.gatewayPort, gateway ? " (in process)" : "");
+
+    std::vector<std::unique_ptr<DeviceThread>> workers;
+    std::vector<std::thread> threads;
+    unsigned perThread = (options.devices + options.threads - 1) / options.threads;
+    for (unsigned first = 0; first < options.devices; first += perThread) {
+        unsigned count = std::min(perThread, options.devices - first);
+        workers.emplace_back(new DeviceThread(options, address, addressLength, first, count));
+    }
+    BenchClock::time_point start = BenchClock::now();
+    for (auto& worker : workers) {
+        DeviceThread* raw = worker.get();
+        threads.emplace_back([raw] { raw->run(); });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+    benchRunning = false;
+    for (std::thread& thread : threads) thread.join();
+    double elapsed = microsSince(start) / 1e6;
+
+    std::vector<uint32_t> latencies;
+    uint64_t responses = 0, errors = 0, failures = 0;
+    for (auto& worker : workers) {
+        const ThreadResult& result = worker->result;
+        latencies.insert(latencies.end(), result.latencyUs.begin(), result.latencyUs.end());
+        responses += result.responses;
+        errors += result.errors;
+        failures += result.failures;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    printf("\nReports:    %llu (%.0f/s), %llu non-200, %llu connections lost\n",
+           (unsigned long long)responses, responses / elapsed, (unsigned long long)errors,
+           (unsigned long long)failures);
+    printf("Latency:    p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", percentile(latencies, 0.50) / 1000.0,
+           percentile(latencies, 0.99) / 1000.0, percentile(latencies, 1.0) / 1000.0);
+
+    if (gateway) {
+        gateway->stop();  // Forwards the remainder
+        GatewayStats stats = gateway->stats();
+        printf("Gateway:    %llu writes in, %llu coalesced, %llu rejected, %llu retried batches\n",
+               (unsigned long long)stats.received, (unsigned long long)stats.coalesced,
+               (unsigned long long)stats.rejected, (unsigned long long)stats.retries);
+        printf("Upstream:   %llu writes in %llu commits (device commits: %llu, %.1fx fewer writes, "
+               "%.0fx fewer requests)\n",
+               (unsigned long long)firestore.writes.load(), (unsigned long long)firestore.commits.load(),
+               (unsigned long long)responses,
+               firestore.writes ? (double)stats.received / firestore.writes.load() : 0.0,
+               firestore.commits ? (double)responses / firestore.commits.load() : 0.0);
+        upstream->stop();
+    }
+    return errors || failures ? 1 : 0;
+}
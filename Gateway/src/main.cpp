@@ -0,0 +1,81 @@
+/*
+ * irrigation-gateway - batches device writes on the LAN before Firestore
+ *
+ *   irrigation-gateway [--port 8080] [--threads 4] [--upstream URL|none]
+ *                      [--upstream-threads 2] [--flush-ms 1000]
+ *                      [--max-batch 500] [--max-pending 200000]
+ *
+ * Prints a one-line summary every 10 s; SIGINT/SIGTERM forwards what is
+ * pending and exits.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "Gateway.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: irrigation-gateway [--port N] [--threads N] [--upstream URL|none]\n"
+            "                          [--upstream-threads N] [--flush-ms N] [--max-batch N]\n"
+            "                          [--max-pending N]\n");
+}
+
+int main(int argc, char** argv) {
+    GatewayConfig config;
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (!strcmp(option, "--port")) config.port = (uint16_t)atoi(value);
+        else if (!strcmp(option, "--threads")) config.ingestThreads = (unsigned)atoi(value);
+        else if (!strcmp(option, "--upstream")) config.upstream = value;
+        else if (!strcmp(option, "--upstream-threads")) config.upstreamThreads = (unsigned)atoi(value);
+        else if (!strcmp(option, "--flush-ms")) config.flushMs = (uint32_t)atol(value);
+        else if (!strcmp(option, "--max-batch")) config.maxBatch = (size_t)atol(value);
+        else if (!strcmp(option, "--max-pending")) config.maxPending = (size_t)atol(value);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (config.maxBatch == 0 || config.maxBatch > 500) config.maxBatch = 500;  // Firestore commit limit
+
+    Gateway gateway(config);
+    if (!gateway.start()) return 1;
+    printf("✓ Gateway on port %u, %u ingest threads, upstream %s (flush %u ms, batch %zu)\n",
+           gateway.port(), config.ingestThreads, config.upstream.c_str(), config.flushMs, config.maxBatch);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (unsigned tick = 1; !stopRequested; tick++) {
+        usleep(100000);
+        if (tick % 100 != 0) continue;
+        GatewayStats stats = gateway.stats();
+        printf("[STATUS] requests %llu, writes %llu (coalesced %llu, rejected %llu), "
+               "forwarded %llu in %llu commits, pending %zu, dropped %llu\n",
+               (unsigned long long)stats.requests, (unsigned long long)stats.received,
+               (unsigned long long)stats.coalesced, (unsigned long long)stats.rejected,
+               (unsigned long long)stats.forwarded, (unsigned long long)stats.commits, stats.pending,
+               (unsigned long long)stats.dropped);
+        fflush(stdout);
+    }
+
+    printf("Stopping, forwarding %zu pending writes\n", gateway.stats().pending);
+    gateway.stop();
+    return 0;
+}
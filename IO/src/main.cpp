@@ -1,4 +1,10 @@
 #include <Arduino.h>
+#include "ArduinoHal.h"
+#include "MoistureSampler.h"
+#include "PumpController.h"
+#ifdef DEEP_SLEEP
+#include "SleepState.h"
+#endif
 
 constexpr uint8_t PUMP_CTRL_PIN = D1;   // ULN2003 IN1/O1
 constexpr uint8_t SENSOR_PIN = A0;      // Moisture sensor output
@@ -7,112 +13,187 @@ constexpr uint16_t WET_THRESHOLD = 440; // Stop pumping when moisture reaches 44
 
 // Timing variables
 unsigned long lastDisplayTime = 0;           // For 3-second display updates
-unsigned long lastPumpActionTime = 0;        // For pump cycle timing
 const unsigned long DISPLAY_INTERVAL = 3000; // 3 seconds in milliseconds
 const unsigned long PUMP_RUN_TIME = 2000;    // 2 second pump run time
 const unsigned long PUMP_WAIT_TIME = 60000; // 1 minutes wait time (60 seconds)
 
-// Pump state variables
-enum PumpState
+// Hardware abstraction (shared with the WiFi firmware and host builds)
+ArduinoClock boardClock;
+ArduinoGpio boardGpio;
+ArduinoAdc boardAdc;
+SamplerConfig samplerConfig;
+MoistureSampler sampler(boardAdc, boardClock, SENSOR_PIN, samplerConfig);
+
+#ifdef DEEP_SLEEP
+// Deep-sleep build: each RTC timer wake takes one reading, restores the
+// controller's phase from RTC memory, steps it once and sleeps again.
+// GPIO16 (D0) must be wired to RST.
+const unsigned long MONITOR_SLEEP_TIME = 600000; // 10 minutes between readings; moisture changes over hours
+const unsigned long WAKE_SLACK_TIME = 2000;      // Rest of a wait short enough to finish awake
+const uint32_t RTC_SLEEP_STATE_OFFSET = 0;
+
+// Rough draw of a bare ESP-12 for the battery estimate; a NodeMCU's
+// regulator and USB bridge add several mA while asleep
+const float AWAKE_MA = 20.0f; // Radio off (woken with WAKE_RF_DISABLED)
+const float SLEEP_MA = 0.02f;
+
+EspRtcMemory boardRtc;
+SleepState sleepState(boardRtc, boardClock, RTC_SLEEP_STATE_OFFSET);
+// The controller times its phases on the running clock, across sleeps
+SleepClock pumpClock(sleepState);
+#else
+ArduinoClock& pumpClock = boardClock;
+#endif
+
+// The shared state machine (lib/IrrigationCore), built with CORE_MINIMAL:
+// no fault lock, effectiveness check or persistence, and pumpUntilWet
+// keeps the 2 s / 1 min cycles going until the soil is back at the wet
+// threshold
+PumpConfig pumpConfig;
+PumpController pump(pumpClock, boardGpio, PUMP_CTRL_PIN, pumpConfig);
+
+class SerialLog : public PumpListener
 {
-  MONITORING,   // Waiting for moisture to reach 480
-  PUMP_RUNNING, // Pump is currently running
-  PUMP_WAITING  // Waiting 1 minutes before next check
+public:
+  void onPumpStarted(ActivationMethod, uint16_t moisture) override
+  {
+    Serial.printf("PUMP: ON (moisture %u)\n", moisture);
+#ifdef DEEP_SLEEP
+    sleepState.savePhase(pump.phase()); // A reset during the run resumes as waiting
+#endif
+  }
+
+  void onPumpStopped() override
+  {
+    Serial.println("PUMP: OFF (run completed, waiting 1 minute)");
+  }
+
+  void onMonitoringResumed() override
+  {
+    uint16_t moisture = sampler.moisture();
+    if (moisture <= WET_THRESHOLD)
+    {
+      Serial.printf("TARGET REACHED: Moisture %u <= %u, returning to monitoring\n", moisture, WET_THRESHOLD);
+    }
+  }
 };
 
-PumpState currentState = MONITORING;
-unsigned long pumpStartTime = 0;
+SerialLog serialLog;
+
+void setupPump()
+{
+  pumpConfig.dryThreshold = DRY_THRESHOLD;
+  pumpConfig.wetThreshold = WET_THRESHOLD;
+  pumpConfig.pumpRunTimeMs = PUMP_RUN_TIME;
+  pumpConfig.minIntervalSec = PUMP_WAIT_TIME / 1000;
+  pumpConfig.pumpUntilWet = true;
+  pump.setListener(&serialLog);
+  pump.begin(); // pump OFF
+}
+
+#ifdef DEEP_SLEEP
+// How long to sleep after this step, or 0 to stay awake: the pump pin is
+// not held through deep sleep, so a run ends awake, and so does the tail
+// of a wait
+unsigned long sleepTimeMs()
+{
+  switch (pump.state())
+  {
+  case PUMP_RUNNING:
+    return 0;
+  case PUMP_WAITING:
+  {
+    unsigned long waited = pumpClock.millis() - pump.phase().sinceMs;
+    unsigned long wait = pumpConfig.minIntervalSec * 1000UL;
+    return waited + WAKE_SLACK_TIME < wait ? wait - waited : 0;
+  }
+  default:
+    return MONITOR_SLEEP_TIME;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  setupPump();
+
+  if (!sleepState.begin())
+  {
+    Serial.println("Smart Irrigation System Started (deep sleep)");
+    Serial.printf("Dry threshold: %u, Wet threshold: %u\n", DRY_THRESHOLD, WET_THRESHOLD);
+  }
+  else
+  {
+    pump.restorePhase(sleepState.phase());
+
+    // Average current over the running clock, for battery sizing
+    float dutyPct = sleepState.dutyCyclePct();
+    float meanMa = (dutyPct * AWAKE_MA + (100.0f - dutyPct) * SLEEP_MA) / 100.0f;
+    Serial.printf("Wake %lu: last awake %lu ms (max %lu, mean %lu), duty %.3f%%, ~%.3f mA average\n",
+                  (unsigned long)sleepState.wakeCount() + 1, (unsigned long)sleepState.lastAwakeUs() / 1000,
+                  (unsigned long)sleepState.maxAwakeUs() / 1000, (unsigned long)sleepState.meanAwakeMs(),
+                  dutyPct, meanMa);
+  }
+
+  // Median of a burst; no EMA, the previous sample is minutes old
+  sampler.begin();
+  uint16_t moisture = sampler.moisture();
+  sleepState.setMoisture(moisture);
+  Serial.printf("Moisture Level: %u | State: %s\n", moisture, pumpStateName(pump.state()));
+
+  // One step of the shared controller, then finish what cannot sleep
+  pump.update(moisture);
+  unsigned long sleepTime;
+  while ((sleepTime = sleepTimeMs()) == 0)
+  {
+    delay(10);
+    pump.update(moisture);
+  }
+
+  sleepState.savePhase(pump.phase());
+  Serial.flush();
+  sleepState.prepareSleep(sleepTime);
+  ESP.deepSleep(sleepTime * 1000ULL, WAKE_RF_DISABLED);
+}
 
+void loop()
+{
+  // Not reached: every wake ends in deep sleep from setup()
+}
+#else
 void setup()
 {
   Serial.begin(115200);
-  pinMode(PUMP_CTRL_PIN, OUTPUT);
-  digitalWrite(PUMP_CTRL_PIN, LOW); // pump OFF
+  setupPump();
+  sampler.begin();
 
   Serial.println("Smart Irrigation System Started");
-  Serial.println("Dry threshold: 520, Wet threshold: 420");
+  Serial.printf("Dry threshold: %u, Wet threshold: %u\n", DRY_THRESHOLD, WET_THRESHOLD);
   Serial.println("Display updates every 3 seconds");
 }
 
 void loop()
 {
-  unsigned long currentTime = millis();
+  unsigned long currentTime = boardClock.millis();
 
-  // 1. Display moisture reading every 3 seconds
+  // 1. Sample (median + EMA every 250 ms) and advance the state machine
+  sampler.update();
+  pump.update(sampler.moisture());
+
+  // 2. Display moisture reading every 3 seconds
   if (currentTime - lastDisplayTime >= DISPLAY_INTERVAL)
   {
-    uint16_t displayMoisture = analogRead(SENSOR_PIN);
     Serial.print("Moisture Level: ");
-    Serial.print(displayMoisture);
+    Serial.print(sampler.moisture());
     Serial.print(" | State: ");
-
-    switch (currentState)
-    {
-    case MONITORING:
-      Serial.println("MONITORING");
-      break;
-    case PUMP_RUNNING:
-      Serial.println("PUMP_RUNNING");
-      break;
-    case PUMP_WAITING:
-      Serial.println("PUMP_WAITING");
-      break;
-    }
+    Serial.println(pumpStateName(pump.state()));
 
     lastDisplayTime = currentTime;
   }
 
-  // 2. State machine for pump control
-  switch (currentState)
-  {
-  case MONITORING:
-  {
-    uint16_t moisture = analogRead(SENSOR_PIN);
-    if (moisture >= DRY_THRESHOLD)
-    {
-      // Soil is dry (520 or higher) → start pumping
-      digitalWrite(PUMP_CTRL_PIN, HIGH);
-      currentState = PUMP_RUNNING;
-      pumpStartTime = currentTime;
-      Serial.println("PUMP: ON (moisture >= 520)");
-    }
-  }
-  break;
-
-  case PUMP_RUNNING:
-    if (currentTime - pumpStartTime >= PUMP_RUN_TIME)
-    {
-      // Turn pump OFF after 1 second
-      digitalWrite(PUMP_CTRL_PIN, LOW);
-      currentState = PUMP_WAITING;
-      lastPumpActionTime = currentTime;
-      Serial.println("PUMP: OFF (1 second completed, waiting 2 minutes)");
-    }
-    break;
-
-  case PUMP_WAITING:
-    if (currentTime - lastPumpActionTime >= PUMP_WAIT_TIME)
-    {
-      // 2 minutes have passed, check moisture level
-      uint16_t moisture = analogRead(SENSOR_PIN);
-      Serial.print("2-minute check - Moisture: ");
-      Serial.println(moisture);
-
-      if (moisture <= WET_THRESHOLD)
-      {
-        // Soil is wet enough (420 or below) → stop pumping cycle
-        currentState = MONITORING;
-        Serial.println("TARGET REACHED: Moisture <= 420, returning to monitoring");
-      }
-      else
-      {
-        // Still too dry → pump again for 1 second
-        digitalWrite(PUMP_CTRL_PIN, HIGH);
-        currentState = PUMP_RUNNING;
-        pumpStartTime = currentTime;
-        Serial.println("PUMP: ON again (moisture still > 420)");
-      }
-    }
-    break;
-  }
+  // Idle until the next sample; poll closely while the pump runs so the run stays 2 s
+  uint32_t idleMs = sampler.msUntilDue();
+  if (pump.state() == PUMP_RUNNING && idleMs > 10) idleMs = 10;
+  delay(idleMs);
 }
+#endif  // DEEP_SLEEP
@@ -0,0 +1,129 @@
+#include "ParameterSweep.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+bool parseAxis(const std::string& text, std::vector<double>& values) {
+    values.clear();
+    char* end;
+    if (text.find(':') != std::string::npos) {
+        double from, to, step;
+        if (sscanf(text.c_str(), "%lf:%lf:%lf", &from, &to, &step) != 3 || step <= 0) return false;
+        for (double value = from; value <= to + step * 1e-9; value += step) {
+            values.push_back(value);
+        }
+        return !values.empty();
+    }
+
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        double value = strtod(item.c_str(), &end);
+        if (end == item.c_str()) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+bool parseDosing(const std::string& text, std::vector<double>& values) {
+    values.clear();
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item == "fixed") values.push_back(0);
+        else if (item == "adaptive") values.push_back(1);
+        else return false;
+    }
+    return !values.empty();
+}
+
+namespace {
+
+std::vector<PumpConfig> expand(const PumpConfig& base, const SweepAxes& axes) {
+    std::vector<PumpConfig> configs;
+    for (double dry : axes.dryThreshold)
+    for (double wet : axes.wetThreshold)
+    for (double run : axes.pumpRunTimeMs)
+    for (double interval : axes.minIntervalSec)
+    for (double settle : axes.settleMs)
+    for (double repeats : axes.maxNoEffectRepeats)
+    for (double adaptive : axes.adaptiveDosing) {
+        if (wet >= dry) continue;
+        PumpConfig config = base;
+        config.dryThreshold = (uint16_t)dry;
+        config.wetThreshold = (uint16_t)wet;
+        config.pumpRunTimeMs = (uint32_t)run;
+        config.minIntervalSec = (uint32_t)interval;
+        config.settleMs = (uint32_t)settle;
+        config.maxNoEffectRepeats = (uint8_t)repeats;
+        config.adaptiveDosing = adaptive != 0;
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+void accumulate(SimulationResult& sum, const SimulationResult& run) {
+    sum.waterUsedMl += run.waterUsedMl;
+    sum.drainedMl += run.drainedMl;
+    sum.pumpCycles += run.pumpCycles;
+    sum.effectivenessChecks += run.effectivenessChecks;
+    sum.noEffectChecks += run.noEffectChecks;
+    sum.faultLocks += run.faultLocks;
+    sum.falseFaultLocks += run.falseFaultLocks;
+    sum.inBandFraction += run.inBandFraction;
+    sum.tooDryFraction += run.tooDryFraction;
+    sum.tooWetFraction += run.tooWetFraction;
+    sum.lockedFraction += run.lockedFraction;
+    sum.cyclesToBand += run.cyclesToBand;
+    sum.minRaw += run.minRaw;
+    sum.events += run.events;
+}
+
+}  // namespace
+
+std::vector<SweepRow> runSweep(const SimulationConfig& base, const SweepAxes& axes,
+                               uint32_t seeds, unsigned threads) {
+    std::vector<PumpConfig> configs = expand(base.pump, axes);
+    std::vector<SweepRow> rows(configs.size());
+    std::vector<SimulationResult> runs(configs.size() * seeds);
+
+    // Each worker claims the next (config, seed) job; results land in fixed slots
+    std::atomic<size_t> nextJob{0};
+    auto worker = [&]() {
+        for (size_t job = nextJob++; job < runs.size(); job = nextJob++) {
+            SimulationConfig config = base;
+            config.pump = configs[job / seeds];
+            config.seed = base.seed + (uint32_t)(job % seeds);
+            runs[job] = runSimulation(config);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) pool.emplace_back(worker);
+    for (std::thread& thread : pool) thread.join();
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        rows[i].pump = configs[i];
+        SimulationResult sum;
+        for (uint32_t seed = 0; seed < seeds; seed++) accumulate(sum, runs[i * seeds + seed]);
+
+        SimulationResult& mean = rows[i].mean;
+        mean.waterUsedMl = sum.waterUsedMl / seeds;
+        mean.drainedMl = sum.drainedMl / seeds;
+        mean.pumpCycles = (sum.pumpCycles + seeds / 2) / seeds;
+        mean.effectivenessChecks = (sum.effectivenessChecks + seeds / 2) / seeds;
+        mean.noEffectChecks = (sum.noEffectChecks + seeds / 2) / seeds;
+        rows[i].faultLocks = sum.faultLocks;
+        rows[i].falseFaultLocks = sum.falseFaultLocks;
+        mean.inBandFraction = sum.inBandFraction / seeds;
+        mean.tooDryFraction = sum.tooDryFraction / seeds;
+        mean.tooWetFraction = sum.tooWetFraction / seeds;
+        mean.lockedFraction = sum.lockedFraction / seeds;
+        mean.cyclesToBand = (sum.cyclesToBand + seeds / 2) / seeds;
+        mean.minRaw = sum.minRaw / seeds;
+        mean.events = sum.events;
+    }
+    return rows;
+}
@@ -0,0 +1,36 @@
+/*
+ * ParameterSweep - runs the cartesian product of watering parameters
+ * across worker threads, several seeds per combination
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+struct SweepAxes {
+    std::vector<double> dryThreshold{520};
+    std::vector<double> wetThreshold{420};
+    std::vector<double> pumpRunTimeMs{2000};
+    std::vector<double> minIntervalSec{30};
+    std::vector<double> settleMs{20000};
+    std::vector<double> maxNoEffectRepeats{10};
+    std::vector<double> adaptiveDosing{0};      // 0 fixed pulses, 1 adaptive
+};
+
+struct SweepRow {
+    PumpConfig pump;
+    SimulationResult mean;      // Averaged over seeds
+    uint32_t faultLocks;        // Totals over all seeds: too rare to average
+    uint32_t falseFaultLocks;
+};
+
+// Parse "a:b:step" (inclusive range) or "a,b,c"; returns false on bad input
+bool parseAxis(const std::string& text, std::vector<double>& values);
+// Parse "fixed", "adaptive" or "fixed,adaptive" into 0/1 values
+bool parseDosing(const std::string& text, std::vector<double>& values);
+
+std::vector<SweepRow> runSweep(const SimulationConfig& base, const SweepAxes& axes,
+                               uint32_t seeds, unsigned threads);
@@ -0,0 +1,165 @@
+#include "Simulation.h"
+
+#include <queue>
+#include <vector>
+
+namespace {
+
+const uint8_t PUMP_PIN = 5;
+const uint64_t MS_PER_DAY = 86400000ULL;
+
+// 64-bit virtual time; millis() wraps every 49.7 days like the real one
+class SimClock : public Clock {
+public:
+    uint32_t millis() override { return (uint32_t)nowMs; }
+    uint32_t epoch() override { return START_EPOCH + (uint32_t)(nowMs / 1000); }
+
+    static const uint32_t START_EPOCH = 1700000000;  // Midnight UTC
+    uint64_t nowMs = 0;
+};
+
+// Drives pumped water only; the real pin level is tracked by the controller's Gpio
+class SimGpio : public Gpio {
+public:
+    void setOutput(uint8_t) override {}
+    void setInputPullup(uint8_t) override {}
+    void write(uint8_t, bool high) override { pumpOn = high; }
+    bool read(uint8_t) override { return pumpOn; }
+
+    bool pumpOn = false;
+};
+
+enum EventType : uint8_t {
+    SENSOR_TICK,    // Periodic controller step
+    DEADLINE,       // Controller step the state machine is waiting for
+    FAULT_CLEAR     // User unlocks auto-watering
+};
+
+struct Event {
+    uint64_t timeMs;
+    EventType type;
+    bool operator>(const Event& other) const { return timeMs > other.timeMs; }
+};
+
+typedef std::priority_queue<Event, std::vector<Event>, std::greater<Event>> EventQueue;
+
+class Recorder : public PumpListener {
+public:
+    Recorder(const SimulationConfig& config, SimClock& clock, EventQueue& events, bool& pumpWorks,
+             const PumpController& pump)
+        : _config(config), _clock(clock), _events(events), _pumpWorks(pumpWorks), _pump(pump) {}
+
+    void onPumpStarted(ActivationMethod, uint16_t) override {
+        result.pumpCycles++;
+        _events.push({_clock.nowMs + _pump.pulseMs(), DEADLINE});
+    }
+
+    void onPumpStopped() override {
+        _events.push({_clock.nowMs + _config.pump.settleMs, DEADLINE});
+        _events.push({_clock.nowMs + (uint64_t)_config.pump.minIntervalSec * 1000, DEADLINE});
+    }
+
+    void onEffectivenessChecked(const EffectivenessResult& check) override {
+        result.effectivenessChecks++;
+        if (!check.effective) result.noEffectChecks++;
+    }
+
+    void onFaultLocked(uint8_t) override {
+        result.faultLocks++;
+        if (_pumpWorks) result.falseFaultLocks++;
+        _lockedSinceMs = _clock.nowMs;
+        _events.push({_clock.nowMs + _config.faultClearDelayMs, FAULT_CLEAR});
+    }
+
+    void onFaultCleared() { _lockedMs += _clock.nowMs - _lockedSinceMs; }
+    uint64_t lockedMs() const { return _lockedMs; }
+
+    SimulationResult result;
+
+private:
+    const SimulationConfig& _config;
+    SimClock& _clock;
+    EventQueue& _events;
+    bool& _pumpWorks;
+    const PumpController& _pump;
+    uint64_t _lockedSinceMs = 0;
+    uint64_t _lockedMs = 0;
+};
+
+}  // namespace
+
+SimulationResult runSimulation(const SimulationConfig& config) {
+    SimClock clock;
+    SimGpio gpio;
+    SoilModel soil(config.soil, config.seed);
+    PumpController pump(clock, gpio, PUMP_PIN, config.pump);
+    EventQueue events;
+    bool pumpWorks = true;
+    Recorder recorder(config, clock, events, pumpWorks, pump);
+    pump.setListener(&recorder);
+    pump.begin();
+
+    const uint64_t endMs = config.days * MS_PER_DAY;
+    const uint64_t failMs = config.pumpFailsAfterDays * MS_PER_DAY;
+    uint64_t inBandMs = 0, tooDryMs = 0, tooWetMs = 0;
+    bool reachedBand = false;
+    double minRaw = soil.trueRaw();
+
+    events.push({0, SENSOR_TICK});
+    while (!events.empty() && events.top().timeMs <= endMs) {
+        Event event = events.top();
+        events.pop();
+        recorder.result.events++;
+
+        // Score the interval since the last event on the state it had
+        uint64_t elapsed = event.timeMs - clock.nowMs;
+        double raw = soil.trueRaw();
+        if (raw > config.pump.dryThreshold) {
+            tooDryMs += elapsed;
+        } else if (raw < config.pump.wetThreshold) {
+            tooWetMs += elapsed;
+        } else {
+            inBandMs += elapsed;
+        }
+        if (!reachedBand && raw <= config.pump.dryThreshold) {
+            reachedBand = true;
+            recorder.result.cyclesToBand = recorder.result.pumpCycles;
+            minRaw = raw;
+        }
+        if (reachedBand && raw < minRaw) minRaw = raw;
+
+        if (failMs > 0 && event.timeMs >= failMs) pumpWorks = false;
+        soil.advance(event.timeMs, gpio.pumpOn && pumpWorks);
+        clock.nowMs = event.timeMs;
+
+        switch (event.type) {
+            case SENSOR_TICK:
+                events.push({event.timeMs + config.sensorTickMs, SENSOR_TICK});
+                pump.update(soil.readSensor());
+                break;
+            case DEADLINE:
+                pump.update(soil.readSensor());
+                break;
+            case FAULT_CLEAR:
+                if (pump.clearFault()) recorder.onFaultCleared();
+                break;
+        }
+    }
+    if (pump.lockedFault()) {
+        clock.nowMs = endMs;
+        recorder.onFaultCleared();
+    }
+
+    SimulationResult result = recorder.result;
+    double total = (double)(inBandMs + tooDryMs + tooWetMs);
+    if (total > 0) {
+        result.inBandFraction = inBandMs / total;
+        result.tooDryFraction = tooDryMs / total;
+        result.tooWetFraction = tooWetMs / total;
+        result.lockedFraction = recorder.lockedMs() / total;
+    }
+    result.minRaw = minRaw;
+    result.waterUsedMl = soil.pumpedMl();
+    result.drainedMl = soil.drainedMl();
+    return result;
+}
@@ -0,0 +1,42 @@
+/*
+ * Simulation - one run of the firmware pump logic against a SoilModel
+ *
+ * Discrete-event: the controller is only stepped at sensor ticks and at
+ * the deadlines it is waiting for (pump stop, settle, minimum interval),
+ * so a month of virtual time takes a few hundred thousand events.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "PumpController.h"
+#include "SoilModel.h"
+
+struct SimulationConfig {
+    PumpConfig pump;
+    SoilParams soil;
+    uint32_t days = 30;
+    uint32_t sensorTickMs = 60000;          // Controller steps while nothing else is due
+    uint32_t faultClearDelayMs = 43200000;  // User clears a locked fault after 12 hours
+    uint32_t pumpFailsAfterDays = 0;        // Reservoir runs dry (0 = never), for true faults
+    uint32_t seed = 1;
+};
+
+struct SimulationResult {
+    double waterUsedMl = 0;
+    double drainedMl = 0;
+    uint32_t pumpCycles = 0;
+    uint32_t effectivenessChecks = 0;
+    uint32_t noEffectChecks = 0;
+    uint32_t faultLocks = 0;
+    uint32_t falseFaultLocks = 0;           // Locked while the pump was delivering water
+    double inBandFraction = 0;              // True moisture between wet and dry thresholds
+    double tooDryFraction = 0;
+    double tooWetFraction = 0;
+    double lockedFraction = 0;
+    uint32_t cyclesToBand = 0;              // Started before the reading first fell to dryThreshold
+    double minRaw = 0;                      // Lowest true reading after that (overshoot below wet)
+    uint64_t events = 0;
+};
+
+SimulationResult runSimulation(const SimulationConfig& config);
@@ -0,0 +1,81 @@
+#include "SoilModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double MS_PER_HOUR = 3600000.0;
+const uint64_t MS_PER_DAY = 86400000ULL;
+const double MAX_STEP_SEC = 60;
+}
+
+SoilModel::SoilModel(const SoilParams& params, uint32_t seed)
+    : _params(params), _rng(seed), _noise(0.0, std::max(params.sensorNoiseCounts, 1e-9)),
+      _waterMl(params.initialMl) {}
+
+void SoilModel::advance(uint64_t nowMs, bool pumpOn) {
+    if (nowMs <= _nowMs) return;
+
+    if (pumpOn) {
+        double ml = _params.pumpFlowMlPerSec * (nowMs - _nowMs) / 1000.0;
+        _pumpedMl += ml;
+        _inFlight.push_back({_nowMs + _params.infiltrationDelayMs, ml});
+    }
+
+    // Fixed-size substeps, shorter while water is soaking in
+    while (_nowMs < nowMs) {
+        double stepSec = MAX_STEP_SEC;
+        if (_surfaceMl > 0.01 || !_inFlight.empty()) {
+            stepSec = std::min(stepSec, _params.infiltrationTauMs / 4000.0);
+        }
+        uint64_t stepMs = std::min<uint64_t>((uint64_t)(stepSec * 1000), nowMs - _nowMs);
+        step(_nowMs, stepMs / 1000.0);
+        _nowMs += stepMs;
+    }
+}
+
+void SoilModel::step(uint64_t fromMs, double dtSec) {
+    uint64_t toMs = fromMs + (uint64_t)(dtSec * 1000);
+    while (!_inFlight.empty() && _inFlight.front().arrivalMs <= toMs) {
+        _surfaceMl += _inFlight.front().ml;
+        _inFlight.pop_front();
+    }
+
+    // Infiltration into the root zone
+    double soaked = _surfaceMl * (1.0 - std::exp(-dtSec * 1000.0 / _params.infiltrationTauMs));
+    _surfaceMl -= soaked;
+    _waterMl += soaked;
+
+    // Evaporation: diurnal cycle peaking at 14:00, slowing as the soil dries
+    double hourOfDay = (fromMs % MS_PER_DAY) / MS_PER_HOUR;
+    double diurnal = 1.0 + _params.diurnalAmplitude * std::sin(2 * M_PI * (hourOfDay - 8) / 24);
+    double wetness = (_waterMl - _params.residualMl) /
+                     (_params.fieldCapacityMl - _params.residualMl);
+    double evaporated = _params.evaporationMlPerHour * diurnal *
+                        std::clamp(wetness, 0.0, 1.0) * dtSec / 3600.0;
+    _waterMl -= evaporated;
+
+    // Drainage above field capacity, and a hard cap at saturation
+    if (_waterMl > _params.fieldCapacityMl) {
+        double excess = _waterMl - _params.fieldCapacityMl;
+        double drained = excess * (1.0 - std::exp(-dtSec / (_params.drainageTauHours * 3600)));
+        _waterMl -= drained;
+        _drainedMl += drained;
+    }
+    if (_waterMl > _params.saturationMl) {
+        _drainedMl += _waterMl - _params.saturationMl;
+        _waterMl = _params.saturationMl;
+    }
+    _waterMl = std::max(_waterMl, _params.residualMl);
+}
+
+double SoilModel::trueRaw() const {
+    double fraction = (_waterMl - _params.residualMl) / (_params.saturationMl - _params.residualMl);
+    return _params.sensorRawDry - (_params.sensorRawDry - _params.sensorRawWet) * fraction;
+}
+
+uint16_t SoilModel::readSensor() {
+    double noise = _params.sensorNoiseCounts > 0 ? _noise(_rng) : 0;
+    double raw = std::round(trueRaw() + noise);
+    return (uint16_t)std::clamp(raw, 0.0, 1023.0);
+}
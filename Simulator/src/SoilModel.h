@@ -0,0 +1,71 @@
+/*
+ * SoilModel - water balance of one potted plant plus its moisture sensor
+ *
+ * Pumped water reaches the root zone after a dead time and then soaks in
+ * exponentially. Evaporation follows a day/night cycle and slows as the
+ * soil dries; water above field capacity drains out of the pot. The
+ * sensor maps water content linearly onto capacitive ADC counts
+ * (higher = drier) with Gaussian noise.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <random>
+
+struct SoilParams {
+    double saturationMl = 400;          // Water held by a saturated pot
+    double fieldCapacityMl = 300;       // Above this, water drains out
+    double residualMl = 40;             // Plants cannot pull the soil below this
+    double initialMl = 200;
+
+    double evaporationMlPerHour = 4;    // Daily mean rate at field capacity
+    double diurnalAmplitude = 0.7;      // 0 = constant, 1 = no evaporation at night
+    double drainageTauHours = 2;
+
+    double pumpFlowMlPerSec = 15;
+    uint32_t infiltrationDelayMs = 10000;   // Dead time until water reaches the sensor
+    uint32_t infiltrationTauMs = 30000;     // Soak-in time constant after that
+
+    uint16_t sensorRawDry = 620;        // ADC counts at residual water
+    uint16_t sensorRawWet = 330;        // ADC counts at saturation
+    double sensorNoiseCounts = 4;       // Standard deviation
+};
+
+class SoilModel {
+public:
+    SoilModel(const SoilParams& params, uint32_t seed);
+
+    // Integrate up to nowMs; pumpOn applies to the whole interval since the last call
+    void advance(uint64_t nowMs, bool pumpOn);
+
+    // Noisy ADC reading as the firmware would see it
+    uint16_t readSensor();
+    // Noise-free reading, used for scoring
+    double trueRaw() const;
+
+    double waterMl() const { return _waterMl; }
+    double pumpedMl() const { return _pumpedMl; }
+    double drainedMl() const { return _drainedMl; }
+
+private:
+    struct Packet {
+        uint64_t arrivalMs;
+        double ml;
+    };
+
+    void step(uint64_t fromMs, double dtSec);
+
+    SoilParams _params;
+    std::mt19937 _rng;
+    std::normal_distribution<double> _noise;
+
+    uint64_t _nowMs = 0;
+    double _waterMl;            // Root zone
+    double _surfaceMl = 0;      // Arrived, still soaking in
+    std::deque<Packet> _inFlight;
+
+    double _pumpedMl = 0;
+    double _drainedMl = 0;
+};
@@ -0,0 +1,56 @@
+"""
+Compress web/index.html into src/DashboardAsset.h as a PROGMEM byte array.
+
+Runs before every build as a PlatformIO pre: script and only rewrites the
+header when the page changed. Can also be run by hand:
+    python scripts/embed_web.py
+"""
+
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(PROJECT_DIR, "web", "index.html")
+TARGET = os.path.join(PROJECT_DIR, "src", "DashboardAsset.h")
+
+
+def render(html):
+    # mtime=0 keeps the output (and the ETag) stable between builds
+    data = gzip.compress(html, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(data).hexdigest()[:16]
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return (
+        "// Generated by scripts/embed_web.py from web/index.html - do not edit\n"
+        "\n"
+        "#pragma once\n"
+        "\n"
+        "#include <Arduino.h>\n"
+        "\n"
+        "const char DASHBOARD_ETAG[] = \"\\\"%s\\\"\";\n"
+        "const size_t DASHBOARD_GZ_LENGTH = %d;  // %d bytes uncompressed\n"
+        "const uint8_t DASHBOARD_GZ[] PROGMEM = {\n"
+        "%s\n"
+        "};\n" % (etag, len(data), len(html), "\n".join(lines))
+    )
+
+
+def embed():
+    with open(SOURCE, "rb") as f:
+        header = render(f.read())
+    if os.path.exists(TARGET):
+        with open(TARGET) as f:
+            if f.read() == header:
+                return
+    with open(TARGET, "w") as f:
+        f.write(header)
+    print("Embedded web/index.html -> src/DashboardAsset.h")
+
+
+embed()
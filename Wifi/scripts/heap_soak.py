@@ -0,0 +1,127 @@
+"""
+Heap soak test: poll a device's /metrics and check that the largest free
+heap block stays flat.
+
+    python scripts/heap_soak.py 192.168.1.50 --hours 24 --csv soak.csv
+
+Samples irrigation_heap_* gauges every --interval seconds (optionally also
+hammering /status to add web load), writes them to CSV, and at the end fits
+a line through irrigation_heap_max_block_bytes. Exits non-zero if the block
+shrinks faster than --max-slope bytes/hour or ever falls below --min-block.
+Requires a build with -D LOOP_METRICS (the default nodemcuv2 environment).
+"""
+
+import argparse
+import csv
+import sys
+import time
+import urllib.request
+
+GAUGES = (
+    "irrigation_heap_free_bytes",
+    "irrigation_heap_max_block_bytes",
+    "irrigation_heap_max_block_min_bytes",
+    "irrigation_heap_fragmentation_percent",
+)
+
+
+def fetch(url, timeout=5):
+    with urllib.request.urlopen(url, timeout=timeout) as response:
+        return response.read().decode("utf-8", "replace")
+
+
+def parse_gauges(text):
+    values = {}
+    for line in text.splitlines():
+        if line.startswith("#"):
+            continue
+        parts = line.split()
+        if len(parts) == 2 and parts[0] in GAUGES:
+            values[parts[0]] = float(parts[1])
+    return values
+
+
+def slope_per_hour(samples):
+    # Least-squares slope of max block size against elapsed hours
+    n = len(samples)
+    if n < 2:
+        return 0.0
+    xs = [t / 3600.0 for t, _ in samples]
+    ys = [v for _, v in samples]
+    mean_x = sum(xs) / n
+    mean_y = sum(ys) / n
+    var_x = sum((x - mean_x) ** 2 for x in xs)
+    if var_x == 0:
+        return 0.0
+    return sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys)) / var_x
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("host", help="device IP or hostname")
+    parser.add_argument("--hours", type=float, default=24.0)
+    parser.add_argument("--interval", type=float, default=60.0, help="seconds between samples")
+    parser.add_argument("--status-rate", type=float, default=0.0,
+                        help="extra /status requests per second between samples")
+    parser.add_argument("--csv", help="write samples to this file")
+    parser.add_argument("--max-slope", type=float, default=-64.0,
+                        help="fail if max block trends below this many bytes/hour")
+    parser.add_argument("--min-block", type=float, default=8192.0,
+                        help="fail if max block ever drops below this (TLS needs ~6-8 KB)")
+    args = parser.parse_args()
+
+    base = "http://%s" % args.host
+    writer = None
+    if args.csv:
+        out = open(args.csv, "w", newline="")
+        writer = csv.writer(out)
+        writer.writerow(("elapsed_s",) + GAUGES)
+
+    samples = []
+    failures = 0
+    start = time.monotonic()
+    deadline = start + args.hours * 3600
+    while time.monotonic() < deadline:
+        next_sample = time.monotonic() + args.interval
+        try:
+            values = parse_gauges(fetch(base + "/metrics"))
+        except OSError as error:
+            failures += 1
+            print("sample failed: %s" % error, file=sys.stderr)
+            values = None
+
+        if values and "irrigation_heap_max_block_bytes" in values:
+            elapsed = time.monotonic() - start
+            samples.append((elapsed, values["irrigation_heap_max_block_bytes"]))
+            row = [round(elapsed)] + [values.get(name, "") for name in GAUGES]
+            if writer:
+                writer.writerow(row)
+                out.flush()
+            print("%7.0fs free=%s max_block=%s min_block=%s frag=%s%%" % tuple(row))
+
+        while time.monotonic() < next_sample:
+            if args.status_rate > 0:
+                try:
+                    fetch(base + "/status")
+                except OSError:
+                    pass
+                time.sleep(1.0 / args.status_rate)
+            else:
+                time.sleep(max(0.0, next_sample - time.monotonic()))
+
+    if not samples:
+        print("no samples collected", file=sys.stderr)
+        return 2
+
+    slope = slope_per_hour(samples)
+    lowest = min(v for _, v in samples)
+    print("samples=%d failed=%d first=%.0f last=%.0f lowest=%.0f slope=%.1f B/h"
+          % (len(samples), failures, samples[0][1], samples[-1][1], lowest, slope))
+
+    ok = slope >= args.max_slope and lowest >= args.min_block
+    print("PASS: max block is flat" if ok else "FAIL: max block is shrinking or too small")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
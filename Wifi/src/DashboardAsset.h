@@ -0,0 +1,79 @@
+// Generated by scripts/embed_web.py from web/index.html - do not edit
+
+#pragma once
+
+#include <Arduino.h>
+
+const char DASHBOARD_ETAG[] = "\"c2c5ace1d2579db7\"";
+const size_t DASHBOARD_GZ_LENGTH = 1089;  // 2373 bytes uncompressed
+const uint8_t DASHBOARD_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x56, 0xcd, 0x6e, 0xe3, 0x36,
+    0x10, 0xbe, 0xe7, 0x29, 0xb8, 0x4e, 0x00, 0xca, 0x68, 0xfc, 0x93, 0xa4, 0x4d, 0x17, 0xb2, 0xad,
+    0x60, 0x6b, 0x27, 0x40, 0xd0, 0xdd, 0x24, 0xd8, 0xa4, 0x08, 0x8a, 0xc5, 0x1e, 0x68, 0x91, 0xb2,
+    0x98, 0x48, 0xa4, 0x40, 0x52, 0xf1, 0xba, 0xde, 0x00, 0x3d, 0xec, 0x71, 0x81, 0x02, 0x6d, 0x4f,
+    0x45, 0x81, 0xf6, 0xd4, 0x9e, 0x7b, 0xeb, 0xf3, 0xec, 0x0b, 0xb4, 0x8f, 0xd0, 0x21, 0x45, 0xcb,
+    0x76, 0x9c, 0x5c, 0x7a, 0xb1, 0xc5, 0xe1, 0x7c, 0xdf, 0xfc, 0x8f, 0xd4, 0x7f, 0x36, 0x3a, 0x1f,
+    0x5e, 0x7d, 0x7b, 0x71, 0x8c, 0x52, 0x93, 0x67, 0xd1, 0x56, 0x7f, 0xf1, 0xc7, 0x08, 0x85, 0xbf,
+    0x9c, 0x19, 0x82, 0xe2, 0x94, 0x28, 0xcd, 0xcc, 0xa0, 0x51, 0x9a, 0xa4, 0xf5, 0xbc, 0x01, 0x62,
+    0xc3, 0x4d, 0xc6, 0xa2, 0xcb, 0x9c, 0x28, 0x83, 0x4e, 0x95, 0xe2, 0x13, 0x62, 0xb8, 0x14, 0xfd,
+    0x4e, 0x25, 0xf7, 0x30, 0x41, 0x72, 0x36, 0x68, 0xdc, 0x71, 0x36, 0x2d, 0xa4, 0x32, 0x0d, 0x14,
+    0x4b, 0x61, 0x98, 0x00, 0x9a, 0x29, 0xa7, 0x26, 0x1d, 0x50, 0x76, 0xc7, 0x63, 0xd6, 0x72, 0x87,
+    0x5d, 0xc4, 0x05, 0x37, 0x9c, 0x64, 0x2d, 0x1d, 0x93, 0x8c, 0x0d, 0xf6, 0xac, 0x11, 0x6d, 0x66,
+    0x96, 0x6c, 0x2c, 0xe9, 0x6c, 0x9e, 0x00, 0xb6, 0x95, 0x90, 0x9c, 0x67, 0xb3, 0xf0, 0x85, 0x02,
+    0xc5, 0x1e, 0xd8, 0x9e, 0x70, 0x11, 0xee, 0x77, 0x8b, 0x77, 0xbd, 0xfb, 0xad, 0xb6, 0x36, 0xc4,
+    0x94, 0x7a, 0x5e, 0x10, 0x4a, 0xb9, 0x98, 0x84, 0x7b, 0x56, 0xec, 0x55, 0xec, 0x33, 0xea, 0xf6,
+    0xc6, 0x52, 0x51, 0xa6, 0x5a, 0x8a, 0x50, 0x5e, 0xea, 0xf0, 0x8b, 0x0a, 0x26, 0x45, 0xc6, 0x05,
+    0x9b, 0x8f, 0x49, 0x7c, 0x3b, 0x51, 0xb2, 0x14, 0x34, 0xdc, 0xa6, 0x9f, 0x33, 0x4a, 0x49, 0xef,
+    0x1e, 0xb5, 0x65, 0x92, 0x6c, 0xdc, 0x26, 0xcf, 0xe9, 0x97, 0xd5, 0x6d, 0x42, 0xca, 0xcc, 0xac,
+    0xdf, 0x25, 0x87, 0xe3, 0xc3, 0x71, 0x2f, 0x96, 0x99, 0x54, 0xe1, 0x34, 0xe5, 0x86, 0x81, 0x89,
+    0x71, 0x69, 0x8c, 0x14, 0x6b, 0x8e, 0xa1, 0xfd, 0x15, 0xef, 0xac, 0x23, 0x2e, 0x3a, 0xcd, 0xbf,
+    0x63, 0xe1, 0xde, 0x21, 0x1c, 0xe3, 0x52, 0x69, 0x60, 0x28, 0x24, 0x87, 0x84, 0x29, 0xe0, 0xd8,
+    0x66, 0x4a, 0x49, 0x35, 0xaf, 0x88, 0xb7, 0xc7, 0xdd, 0x2e, 0xc8, 0xfa, 0x1d, 0x9f, 0x9f, 0x7e,
+    0xc7, 0xd7, 0xca, 0x26, 0xca, 0x56, 0x6e, 0x2f, 0xfa, 0xf7, 0xb7, 0x8f, 0x7f, 0xa1, 0x87, 0xd5,
+    0x41, 0x97, 0x33, 0x6d, 0x58, 0x0e, 0xea, 0x7b, 0xa0, 0x45, 0xf9, 0x1d, 0xe2, 0x74, 0xd0, 0xa8,
+    0xf2, 0x06, 0xc5, 0xc9, 0x88, 0xd6, 0x8b, 0x23, 0xf2, 0x91, 0xdb, 0x2a, 0xa4, 0xfb, 0xd1, 0xa5,
+    0x13, 0x86, 0xa8, 0xaf, 0x0b, 0x22, 0x1c, 0xaa, 0xaa, 0x9d, 0x95, 0x83, 0xce, 0xa7, 0xef, 0xff,
+    0x00, 0x67, 0xe0, 0x2a, 0x02, 0xee, 0x7d, 0x80, 0x14, 0x11, 0xd4, 0x4e, 0x49, 0x31, 0x89, 0x46,
+    0x4e, 0x0f, 0x9d, 0x8e, 0x42, 0xeb, 0xae, 0x13, 0x6d, 0xb0, 0x9c, 0xd2, 0x46, 0x54, 0xe3, 0x8b,
+    0x35, 0xf8, 0x2b, 0xc9, 0xb5, 0x29, 0x15, 0x7b, 0x14, 0x9d, 0xfb, 0xcb, 0x27, 0xd1, 0x17, 0x65,
+    0x5e, 0x3c, 0x8a, 0x2c, 0xe0, 0xc2, 0xfb, 0xfe, 0x04, 0xf4, 0x9a, 0x9f, 0xf0, 0x47, 0xa1, 0x53,
+    0x9e, 0xf0, 0x87, 0x28, 0x77, 0xe1, 0xba, 0xe1, 0x4c, 0x02, 0x27, 0x4a, 0x39, 0xa5, 0x4c, 0x44,
+    0x9f, 0x7e, 0xf9, 0xfd, 0x9f, 0xbf, 0x7f, 0x40, 0x0b, 0xca, 0x93, 0x17, 0xdf, 0xbc, 0xbc, 0x42,
+    0x2f, 0xcf, 0x87, 0x5f, 0x1f, 0x8f, 0x96, 0xcc, 0x2d, 0x64, 0xbd, 0x44, 0xa4, 0x28, 0x18, 0xcc,
+    0x18, 0x4c, 0x01, 0x4b, 0x12, 0x16, 0x1b, 0x7e, 0xc7, 0x2a, 0xf2, 0x0e, 0xd4, 0xa9, 0xb6, 0xe1,
+    0xba, 0xa0, 0x51, 0x99, 0x85, 0xc2, 0x1c, 0x44, 0x43, 0xe8, 0x1b, 0x25, 0x33, 0x0d, 0x79, 0x3f,
+    0xb0, 0x0d, 0xe0, 0x5a, 0x0d, 0x49, 0x11, 0x67, 0x3c, 0xbe, 0x85, 0x38, 0xa5, 0x36, 0x01, 0xee,
+    0x4c, 0x21, 0x52, 0x85, 0x9b, 0x0d, 0x68, 0x8b, 0x1f, 0xff, 0x44, 0xd7, 0xf6, 0x84, 0xce, 0xe4,
+    0xb4, 0xdf, 0xa9, 0xf4, 0x97, 0x40, 0x6b, 0x23, 0xce, 0xc0, 0x91, 0x13, 0x1b, 0x4c, 0x63, 0x83,
+    0x68, 0x79, 0x07, 0x6c, 0x75, 0x98, 0xbf, 0xfe, 0x84, 0x86, 0xf6, 0x02, 0xb9, 0x9b, 0x4d, 0xd6,
+    0x9a, 0x85, 0x27, 0x01, 0xac, 0x80, 0x84, 0xab, 0x3c, 0xc0, 0xaf, 0x19, 0x2c, 0x14, 0x64, 0xd3,
+    0x7c, 0x84, 0x9b, 0x4d, 0xcf, 0xaf, 0xac, 0xd0, 0xca, 0x2a, 0x67, 0x7f, 0xfe, 0x80, 0x96, 0x6a,
+    0x4b, 0xde, 0x45, 0xe4, 0x09, 0x9f, 0x94, 0xca, 0xef, 0x1d, 0x17, 0x7e, 0x11, 0x8d, 0xd4, 0x0c,
+    0x5d, 0xa5, 0x40, 0x93, 0xca, 0x8c, 0xae, 0xf5, 0xab, 0x9a, 0xd5, 0xf2, 0x8d, 0xa2, 0x5f, 0x83,
+    0x89, 0x47, 0x51, 0x53, 0x66, 0x9e, 0x46, 0xb9, 0xba, 0xbd, 0x2e, 0x05, 0xba, 0xe2, 0x39, 0x0b,
+    0x1f, 0x74, 0x17, 0xc8, 0xad, 0xb8, 0x06, 0xa1, 0x5c, 0x2f, 0x70, 0xaf, 0xb8, 0x40, 0xa7, 0x76,
+    0xae, 0xef, 0x48, 0xb6, 0x0a, 0xcb, 0xb9, 0x58, 0x88, 0x2f, 0x59, 0xbc, 0x44, 0x6a, 0x16, 0xfb,
+    0x82, 0xeb, 0x58, 0xf1, 0xc2, 0x44, 0x5b, 0x49, 0x29, 0x62, 0x37, 0xd0, 0x3b, 0x01, 0xa7, 0xcd,
+    0xb9, 0x62, 0x30, 0x05, 0x02, 0x51, 0x19, 0x97, 0x39, 0xac, 0xd7, 0xf6, 0x84, 0x99, 0xe3, 0x8c,
+    0xd9, 0xc7, 0xaf, 0x66, 0xa7, 0xd4, 0xaa, 0xc0, 0xb6, 0xa8, 0x31, 0x10, 0xcc, 0x34, 0xd0, 0xcd,
+    0xf9, 0x16, 0x42, 0x6f, 0xf0, 0xca, 0x18, 0xe3, 0x5d, 0xbc, 0x18, 0x47, 0x78, 0x5c, 0xcc, 0x16,
+    0x3c, 0xd6, 0xc3, 0x62, 0x35, 0x56, 0xd2, 0x08, 0xc7, 0xd5, 0xfc, 0x78, 0x4d, 0x1f, 0xb8, 0xa5,
+    0x58, 0x8b, 0x07, 0xbf, 0x05, 0x83, 0x08, 0x96, 0xa6, 0x54, 0xc7, 0x24, 0x4e, 0x83, 0x85, 0x3f,
+    0xc1, 0x6d, 0x73, 0xbe, 0x03, 0x3f, 0x6d, 0xc3, 0xde, 0x99, 0xa1, 0x7f, 0x41, 0xe8, 0x37, 0xb7,
+    0x6f, 0x7b, 0xf7, 0xcd, 0x1e, 0x40, 0x76, 0x02, 0x6c, 0x47, 0x0e, 0x3f, 0x50, 0x68, 0x5b, 0x21,
+    0x9c, 0x04, 0xcc, 0x0a, 0xa3, 0x47, 0xb8, 0x7e, 0xc4, 0x21, 0x1e, 0x71, 0x1d, 0xd7, 0x47, 0xcf,
+    0x51, 0xad, 0x35, 0x60, 0x71, 0x6b, 0xee, 0xcc, 0xbe, 0x98, 0xbc, 0x0c, 0xe1, 0xcf, 0x02, 0xdd,
+    0xce, 0x64, 0x7c, 0xcb, 0xa8, 0x6b, 0xe0, 0x23, 0xec, 0x46, 0x19, 0x87, 0xc1, 0x86, 0x95, 0xea,
+    0x65, 0x01, 0x26, 0xfc, 0x7a, 0x84, 0xce, 0xf5, 0xfc, 0xf5, 0xf4, 0x83, 0x89, 0x6a, 0x2e, 0x06,
+    0xcf, 0xd6, 0x58, 0xbd, 0xde, 0xea, 0x04, 0x3d, 0xa5, 0xb8, 0x52, 0x2c, 0xc5, 0x12, 0x9b, 0xde,
+    0xc0, 0x95, 0x2b, 0x61, 0x06, 0x12, 0x87, 0x3b, 0x75, 0x2c, 0x26, 0x65, 0x62, 0x99, 0x48, 0x55,
+    0x77, 0x82, 0x6a, 0xdf, 0x68, 0x10, 0x40, 0xd9, 0x9b, 0x55, 0xd2, 0xd7, 0x15, 0xa1, 0xf8, 0xbe,
+    0x09, 0x7a, 0xe0, 0x91, 0xdb, 0x29, 0x0f, 0xd2, 0x8b, 0x71, 0x0d, 0x8d, 0x89, 0x59, 0xad, 0x96,
+    0x2d, 0xd6, 0xe3, 0x10, 0xbf, 0xe9, 0x85, 0x34, 0xe0, 0xb5, 0x2e, 0xa4, 0xb0, 0x6f, 0x3b, 0xec,
+    0xaa, 0xb8, 0x12, 0x90, 0x1b, 0xf4, 0x82, 0x98, 0x74, 0x25, 0x22, 0x7b, 0xdc, 0x9d, 0xc3, 0x17,
+    0x43, 0x2a, 0x69, 0x88, 0x2f, 0xce, 0x2f, 0xaf, 0xf0, 0xfd, 0xff, 0x0e, 0xee, 0xe6, 0x49, 0x0f,
+    0x6f, 0xda, 0x4e, 0xfa, 0xfe, 0x3d, 0x44, 0x57, 0xe7, 0xd5, 0xfb, 0xb7, 0x3c, 0x6f, 0xc1, 0xbe,
+    0x59, 0xb4, 0x6d, 0xe0, 0xc5, 0xbb, 0x07, 0xdd, 0x6e, 0x17, 0xae, 0x60, 0x22, 0xfd, 0x04, 0xc2,
+    0x32, 0xaa, 0xde, 0xb5, 0x9d, 0xea, 0x6b, 0xe9, 0x3f, 0x73, 0x63, 0x9e, 0xa4, 0x45, 0x09, 0x00,
+    0x00,
+};
@@ -0,0 +1,158 @@
+#include "FirestoreBatch.h"
+
+// Room kept free in the body for the next write (a status merge write with
+// its update mask is the largest, ~1 KB)
+const size_t WRITE_RESERVE = 1024;
+
+void FirestoreBatch::begin(HttpTransport& transport, size_t maxWrites, unsigned long flushDeadlineMs,
+                           char* body, size_t bodySize) {
+    _transport = &transport;
+    _maxWrites = maxWrites;
+    _flushDeadlineMs = flushDeadlineMs;
+    _body = body;
+    _bodySize = bodySize;
+}
+
+void FirestoreBatch::setDatabase(const FirestorePaths& paths) {
+    _paths = &paths;
+}
+
+JsonObject FirestoreBatch::add(const char* parentPath, const char* documentId, bool merge) {
+    char name[192];
+    int length = snprintf(name, sizeof(name), "%s/documents/%s%s%s",
+                          _paths ? _paths->databaseName : "", parentPath,
+                          documentId ? "/" : "", documentId ? documentId : "");
+    if (!_paths || length < 0 || (size_t)length >= sizeof(name)) {
+        _dropped++;
+        return JsonObject();  // Writes to a null object are ignored
+    }
+    makeRoom();
+
+    if (_count == 0) {
+        _firstQueuedAt = millis();
+    }
+
+    JsonObject write = _doc["writes"].add<JsonObject>();
+    write["update"]["name"] = static_cast<char*>(name);  // char* is copied into the document
+    if (merge) {
+        // Filled from the field names at flush time
+        write["updateMask"]["fieldPaths"].to<JsonArray>();
+    }
+    _count++;
+    return write["update"]["fields"].to<JsonObject>();
+}
+
+bool FirestoreBatch::flushIfDue() {
+    if (_count == 0) return false;
+    if (_count >= _maxWrites || bodyFull() || millis() - _firstQueuedAt >= _flushDeadlineMs) {
+        return flush();
+    }
+    return false;
+}
+
+bool FirestoreBatch::bodyFull() {
+    return measureJson(_doc) + WRITE_RESERVE >= _bodySize;
+}
+
+bool FirestoreBatch::arenaFull() const {
+    return _arena && _arena->used() + WRITE_RESERVE > _arena->capacity();
+}
+
+void FirestoreBatch::dropOldest() {
+    _doc["writes"].as<JsonArray>().remove(0);
+    _count--;
+    _dropped++;
+    _evicted++;
+}
+
+// Keep the queue inside the body buffer and the arena: send early while
+// commits go through, otherwise the oldest writes make way for new ones
+void FirestoreBatch::makeRoom() {
+    if (_count == 0 || !(bodyFull() || arenaFull())) return;
+    if (!_retrying && flush()) return;
+
+    while (_count > 0 && bodyFull()) {
+        dropOldest();
+    }
+    // Dropped writes leave holes the arena only reclaims once it is empty
+    if (_count > 0 && arenaFull()) {
+        Serial.printf_P(PSTR("⚠ [FIREBASE] Batch arena full, dropping %u queued writes\n"), (unsigned)_count);
+        _dropped += _count;
+        _evicted += _count;
+        _doc.clear();
+        _count = 0;
+    }
+}
+
+void FirestoreBatch::logWrites() {
+    for (JsonObject write : _doc["writes"].as<JsonArray>()) {
+        const char* name = write["update"]["name"] | "";
+        const char* document = strstr(name, "/documents/");
+        Serial.printf_P(PSTR("   Discarded %s\n"), document ? document + 11 : name);
+    }
+}
+
+bool FirestoreBatch::flush() {
+    if (_count == 0 || !_transport || !_paths || !_body) return true;
+
+    // Build update masks for merge writes from the fields they carry
+    for (JsonObject write : _doc["writes"].as<JsonArray>()) {
+        JsonArray mask = write["updateMask"]["fieldPaths"];
+        if (mask.isNull()) continue;
+        mask.clear();
+        for (JsonPair field : write["update"]["fields"].as<JsonObject>()) {
+            mask.add(field.key());
+        }
+    }
+
+    // Writes queued while commits kept failing may outgrow the buffer
+    while (_count > 0 && measureJson(_doc) >= _bodySize) {
+        dropOldest();
+    }
+    if (_count == 0) {
+        _doc.clear();
+        return false;
+    }
+    serializeJson(_doc, _body, _bodySize);
+    _rejected = false;
+
+    // Enough of an error body to diagnose a failure; a successful commit's
+    // writeResults don't fit and come back as HTTP_RESPONSE_TRUNCATED
+    char response[201];
+    int httpCode = _transport->request("POST", _paths->commitPath, _body,
+                                       response, sizeof(response));
+    if (httpCode == HTTP_RESPONSE_TRUNCATED) {
+        httpCode = 200;
+    }
+
+    if (httpCode == 200) {
+        _commits++;
+        _writesCommitted += _count;
+        Serial.printf_P(PSTR("✓ [FIREBASE] Commit sent → %u writes\n"), (unsigned)_count);
+        _retrying = false;
+    } else {
+        _failures++;
+        Serial.printf_P(PSTR("✗ [FIREBASE] Commit failed (HTTP %d, %u writes)\n"), httpCode, (unsigned)_count);
+        if (httpCode > 0) {
+            Serial.printf_P(PSTR("   Response: %s\n"), response);
+        }
+
+        // Transport errors and server-side failures are retried on the next
+        // deadline; a rejected request (4xx) would fail again, so drop it.
+        // The commit is atomic and the error doesn't say which write was at
+        // fault, so name them all.
+        if (httpCode < 0 || httpCode >= 500) {
+            _firstQueuedAt = millis();
+            _retrying = true;
+            return false;
+        }
+        logWrites();
+        _dropped += _count;
+        _retrying = false;
+        _rejected = true;
+    }
+
+    _doc.clear();
+    _count = 0;
+    return httpCode == 200;
+}
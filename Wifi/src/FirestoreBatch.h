@@ -0,0 +1,86 @@
+/*
+ * FirestoreBatch - collects Firestore document writes and sends them
+ * as a single documents:commit request
+ *
+ * Log documents, the status heartbeat and event records are queued and
+ * flushed together once the deadline passes or the size limit is hit,
+ * so one sync interval costs one HTTPS round trip instead of several.
+ * The request is serialized into a caller-owned static buffer (measured
+ * first with measureJson), so a commit never builds its body on the heap.
+ * While commits keep failing the queue is capped by that buffer and the
+ * arena: the oldest writes are dropped (and counted) to make room.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Hal.h"
+#include "FirestorePaths.h"
+#include "JsonArena.h"
+
+class FirestoreBatch {
+public:
+    // Queued writes live in arena when given
+    explicit FirestoreBatch(JsonArena* arena = nullptr) : _doc(arena), _arena(arena) {}
+
+    // body holds the serialized request; a batch that would not fit is
+    // flushed early
+    void begin(HttpTransport& transport, size_t maxWrites, unsigned long flushDeadlineMs,
+               char* body, size_t bodySize);
+
+    // Database name and commit URL; paths must outlive the batch
+    void setDatabase(const FirestorePaths& paths);
+
+    // Queue a write for parentPath/documentId relative to the database root
+    // (e.g. "plantData/<id>/logs" + "<logId>"; documentId may be nullptr when
+    // parentPath is the document itself) and return its "fields" object.
+    // With merge=true only the fields that get set are written (update mask);
+    // otherwise the document is created or replaced.
+    JsonObject add(const char* parentPath, const char* documentId, bool merge = false);
+
+    // Flush when the size limit, the body buffer or the deadline has been reached
+    bool flushIfDue();
+
+    // Send all queued writes now. Returns true if the commit succeeded
+    // (or there was nothing to send).
+    bool flush();
+
+    size_t pending() const { return _count; }
+
+    // The last commit was refused (4xx) and its writes discarded
+    bool lastCommitRejected() const { return _rejected; }
+
+    uint32_t commitCount() const { return _commits; }
+    uint32_t writeCount() const { return _writesCommitted; }
+    uint32_t failureCount() const { return _failures; }
+    uint32_t droppedCount() const { return _dropped; }
+    uint32_t evictedCount() const { return _evicted; }  // Dropped for room while commits failed
+
+private:
+    bool bodyFull();
+    bool arenaFull() const;
+    void dropOldest();
+    void makeRoom();
+    void logWrites();
+
+    HttpTransport* _transport = nullptr;
+    const FirestorePaths* _paths = nullptr;
+
+    JsonDocument _doc;
+    JsonArena* _arena;
+    size_t _count = 0;
+    char* _body = nullptr;
+    size_t _bodySize = 0;
+    size_t _maxWrites = 20;
+    unsigned long _flushDeadlineMs = 30000;
+    unsigned long _firstQueuedAt = 0;
+    bool _retrying = false;         // Last commit failed and its writes are queued for retry
+    bool _rejected = false;
+
+    uint32_t _commits = 0;
+    uint32_t _writesCommitted = 0;
+    uint32_t _failures = 0;
+    uint32_t _dropped = 0;
+    uint32_t _evicted = 0;
+};
@@ -0,0 +1,120 @@
+#include "HttpsSession.h"
+#include "TraceRecorder.h"
+
+const uint16_t HTTPS_TIMEOUT_MS = 5000;
+
+void HttpsSession::begin(const String& host, uint16_t port, bool tls) {
+    if (host != _host || port != _port || tls != _tls) {
+        close();
+    }
+    _host = host;
+    _port = port;
+    _tls = tls;
+
+    _secureClient.setInsecure();
+    _http.setReuse(true);  // HTTP/1.1 keep-alive
+    _http.setTimeout(HTTPS_TIMEOUT_MS);
+}
+
+// Receives a response body from HTTPClient::writeToStream: keeps what fits
+// in the caller's buffer and counts the rest, so the body is always drained
+class BodySink : public Stream {
+public:
+    BodySink(char* buffer, size_t size) : _buffer(buffer), _size(size) {
+        if (_buffer && _size > 0) _buffer[0] = '\0';
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t length) override {
+        if (_buffer && _length + 1 < _size) {
+            size_t count = std::min(length, _size - 1 - _length);
+            memcpy(_buffer + _length, data, count);
+            _length += count;
+            _buffer[_length] = '\0';
+        }
+        _total += length;
+        return length;  // Anything short of length aborts the transfer
+    }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    bool truncated() const { return _total > _length; }
+
+private:
+    char* _buffer;
+    size_t _size;
+    size_t _length = 0;
+    size_t _total = 0;
+};
+
+static bool transportFailed(int httpCode) {
+    return httpCode < 0 && httpCode != HTTP_RESPONSE_TRUNCATED;
+}
+
+int HttpsSession::request(const char* method, const char* path, const char* body,
+                          char* response, size_t responseSize) {
+    TRACE_SCOPE(TRACE_HTTPS_REQUEST);
+    bool reusing = client().connected();
+    int httpCode = send(method, path, body, response, responseSize);
+
+    // The server may have closed an idle keep-alive connection between our
+    // requests. Retry once on a fresh connection before reporting failure.
+    if (transportFailed(httpCode) && reusing) {
+        close();
+        httpCode = send(method, path, body, response, responseSize);
+    }
+
+    if (transportFailed(httpCode)) {
+        _failures++;
+        close();
+    }
+    TRACE_SCOPE_RESULT(httpCode > 0 ? httpCode : 0);
+    return httpCode;
+}
+
+int HttpsSession::send(const char* method, const char* path, const char* body,
+                       char* response, size_t responseSize) {
+    bool reusing = client().connected();
+    if (!_http.begin(client(), _host, _port, path, _tls)) {
+        return HTTPC_ERROR_CONNECTION_FAILED;
+    }
+
+    _http.addHeader("Content-Type", "application/json");
+    int httpCode = _http.sendRequest(method, (const uint8_t*)body, body ? strlen(body) : 0);
+
+    // A fresh connection only counts as a handshake once TCP and TLS are up
+    if (reusing) {
+        _reused++;
+    } else if (httpCode == HTTPC_ERROR_CONNECTION_FAILED) {
+        _connectFailures++;
+    } else {
+        _handshakes++;
+    }
+
+    // Always drain the body so the connection stays usable for the next request
+    bool bodyCut = false;
+    if (httpCode > 0) {
+        BodySink sink(response, responseSize);
+        bodyCut = _http.writeToStream(&sink) < 0;
+        if ((bodyCut || sink.truncated()) && httpCode >= 200 && httpCode < 300) {
+            httpCode = HTTP_RESPONSE_TRUNCATED;
+        }
+    }
+
+    _http.end();  // Keeps the socket open when the server allows keep-alive
+    if (bodyCut) {
+        client().stop();  // Unread bytes would be taken for the next response
+    }
+    return httpCode;
+}
+
+void HttpsSession::close() {
+    _http.end();
+    client().stop();
+}
+
+bool HttpsSession::isConnected() {
+    return client().connected();
+}
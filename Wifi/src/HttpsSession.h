@@ -0,0 +1,61 @@
+/*
+ * HttpsSession - long-lived HTTPS connection for Firestore traffic
+ *
+ * Keeps a single TLS connection open with HTTP/1.1 keep-alive so consecutive
+ * requests skip the handshake. The connection is only re-established when the
+ * server closes it or a request fails. Plain HTTP is used when talking to a
+ * fleet gateway on the LAN (Gateway/), which forwards to Firestore over TLS.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ESP8266HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include "Hal.h"
+
+class HttpsSession : public HttpTransport {
+public:
+    // Set the remote endpoint (e.g. firestore.googleapis.com:443, a local
+    // stand-in, or a gateway with tls false)
+    void begin(const String& host, uint16_t port = 443, bool tls = true);
+
+    // Issue a request on the shared connection. Returns the HTTP status code,
+    // a negative HTTPClient error code on transport failure, or
+    // HTTP_RESPONSE_TRUNCATED. The response body is streamed straight into
+    // the caller's buffer (and discarded past its end), never into a String.
+    int request(const char* method, const char* path, const char* body,
+                char* response = nullptr, size_t responseSize = 0) override;
+
+    // Drop the connection (e.g. after WiFi loss); the next request reconnects
+    void close();
+
+    bool isConnected();
+    const String& host() const { return _host; }
+    uint16_t port() const { return _port; }
+    bool tls() const { return _tls; }
+
+    // Counters for verifying connection reuse
+    uint32_t handshakeCount() const { return _handshakes; }
+    uint32_t reusedCount() const { return _reused; }
+    uint32_t connectFailureCount() const { return _connectFailures; }  // TCP or TLS setup failed
+    uint32_t failureCount() const { return _failures; }
+
+private:
+    int send(const char* method, const char* path, const char* body,
+             char* response, size_t responseSize);
+
+    WiFiClient& client() { return _tls ? _secureClient : _plainClient; }
+
+    BearSSL::WiFiClientSecure _secureClient;
+    WiFiClient _plainClient;
+    HTTPClient _http;
+    String _host;
+    uint16_t _port = 443;
+    bool _tls = true;
+
+    uint32_t _handshakes = 0;
+    uint32_t _reused = 0;
+    uint32_t _connectFailures = 0;
+    uint32_t _failures = 0;
+};
@@ -0,0 +1,189 @@
+#include "LoopMetrics.h"
+
+#ifdef LOOP_METRICS
+
+// Stage durations in microseconds
+const uint32_t STAGE_BOUNDS_US[] = {
+    10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+
+// Threshold-to-pump latency in milliseconds
+const uint32_t LATENCY_BOUNDS_MS[] = {
+    10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000
+};
+
+// Largest-free-block sampling period; walking the free list is not free
+const uint32_t HEAP_SAMPLE_INTERVAL_MS = 1000;
+
+const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "web", "sensor", "button", "led", "wifi", "sync", "remote", "queue", "display", "pump", "loop"
+};
+
+LoopMetrics loopMetrics;
+
+LoopMetrics::LoopMetrics()
+    : _thresholdToPump(LATENCY_BOUNDS_MS, sizeof(LATENCY_BOUNDS_MS) / sizeof(uint32_t)) {
+    for (LatencyHistogram& stage : _stages) {
+        stage = LatencyHistogram(STAGE_BOUNDS_US, sizeof(STAGE_BOUNDS_US) / sizeof(uint32_t));
+    }
+}
+
+uint32_t LoopMetrics::loopStarted() {
+    uint32_t now = micros();
+    if (_lastLoopStartUs != 0) {
+        _lastLoopGapUs = now - _lastLoopStartUs;
+        if (_lastLoopGapUs > _maxLoopGapUs) _maxLoopGapUs = _lastLoopGapUs;
+    }
+    _lastLoopStartUs = now;
+
+    uint32_t nowMs = millis();
+    if (_heapMaxBlock == 0 || nowMs - _lastHeapSampleMs >= HEAP_SAMPLE_INTERVAL_MS) {
+        sampleHeap(nowMs);
+    }
+    return ESP.getCycleCount();
+}
+
+void LoopMetrics::sampleHeap(uint32_t nowMs) {
+    _lastHeapSampleMs = nowMs;
+    _heapFree = ESP.getFreeHeap();
+    _heapMaxBlock = ESP.getMaxFreeBlockSize();
+    _heapFragmentation = ESP.getHeapFragmentation();
+    if (_heapMaxBlock < _heapMaxBlockMin) _heapMaxBlockMin = _heapMaxBlock;
+}
+
+void LoopMetrics::watchArena(const char* name, const JsonArena& arena) {
+    for (uint8_t i = 0; i < MAX_ARENAS; i++) {
+        if (!_arenas[i]) {
+            _arenaNames[i] = name;
+            _arenas[i] = &arena;
+            return;
+        }
+    }
+}
+
+void LoopMetrics::recordStage(LoopStage stage, uint32_t cycles) {
+    _stages[stage].record(cycles / ESP.getCpuFreqMHz());
+}
+
+void LoopMetrics::recordThresholdToPump(uint32_t sinceMs) {
+    _thresholdToPump.record(millis() - sinceMs);
+}
+
+// One histogram per chunk, formatted into a static buffer (no heap).
+// labels is "" or a comma-free label list such as stage="web".
+static void writeHistogram(ESP8266WebServer& server, const char* name, const char* labels,
+                           const LatencyHistogram& histogram, float scale) {
+    static char chunk[1536];  // 18 lines of at most ~80 bytes
+    size_t length = 0;
+    const char* separator = labels[0] ? "," : "";
+
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < histogram.boundCount(); i++) {
+        cumulative += histogram.count(i);
+        length += snprintf(chunk + length, sizeof(chunk) - length, "%s_bucket{%s%sle=\"%g\"} %u\n",
+                           name, labels, separator, histogram.bound(i) * scale, cumulative);
+    }
+    length += snprintf(chunk + length, sizeof(chunk) - length, "%s_bucket{%s%sle=\"+Inf\"} %u\n",
+                       name, labels, separator, histogram.total());
+
+    const char* open = labels[0] ? "{" : "";
+    const char* close = labels[0] ? "}" : "";
+    length += snprintf(chunk + length, sizeof(chunk) - length, "%s_sum%s%s%s %g\n%s_count%s%s%s %u\n",
+                       name, open, labels, close, (double)histogram.sum() * scale,
+                       name, open, labels, close, histogram.total());
+    server.sendContent(chunk, length < sizeof(chunk) ? length : sizeof(chunk) - 1);
+}
+
+void LoopMetrics::writePrometheus(ESP8266WebServer& server, const LiveGauges& live) {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+
+    server.sendContent("# HELP irrigation_loop_stage_seconds Time spent in each loop() stage\n"
+                       "# TYPE irrigation_loop_stage_seconds histogram\n");
+    char labels[24];
+    for (uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", STAGE_NAMES[stage]);
+        writeHistogram(server, "irrigation_loop_stage_seconds", labels, _stages[stage], 1e-6f);
+    }
+
+    server.sendContent("# HELP irrigation_threshold_to_pump_seconds Dry reading to automatic pump start\n"
+                       "# TYPE irrigation_threshold_to_pump_seconds histogram\n");
+    writeHistogram(server, "irrigation_threshold_to_pump_seconds", "", _thresholdToPump, 1e-3f);
+
+    char gauges[640];
+    snprintf(gauges, sizeof(gauges),
+             "# HELP irrigation_loop_gap_max_seconds Longest time between loop() starts\n"
+             "# TYPE irrigation_loop_gap_max_seconds gauge\n"
+             "irrigation_loop_gap_max_seconds %g\n"
+             "# HELP irrigation_loop_gap_seconds Time between the last two loop() starts\n"
+             "# TYPE irrigation_loop_gap_seconds gauge\n"
+             "irrigation_loop_gap_seconds %g\n",
+             _maxLoopGapUs * 1e-6, _lastLoopGapUs * 1e-6);
+    server.sendContent(gauges);
+
+    snprintf(gauges, sizeof(gauges),
+             "# HELP irrigation_heap_free_bytes Free heap\n"
+             "# TYPE irrigation_heap_free_bytes gauge\n"
+             "irrigation_heap_free_bytes %u\n"
+             "# HELP irrigation_heap_max_block_bytes Largest free heap block\n"
+             "# TYPE irrigation_heap_max_block_bytes gauge\n"
+             "irrigation_heap_max_block_bytes %u\n"
+             "# HELP irrigation_heap_max_block_min_bytes Lowest largest-free-block since boot\n"
+             "# TYPE irrigation_heap_max_block_min_bytes gauge\n"
+             "irrigation_heap_max_block_min_bytes %u\n"
+             "# HELP irrigation_heap_fragmentation_percent Heap fragmentation\n"
+             "# TYPE irrigation_heap_fragmentation_percent gauge\n"
+             "irrigation_heap_fragmentation_percent %u\n",
+             _heapFree, _heapMaxBlock, _heapMaxBlockMin, _heapFragmentation);
+    server.sendContent(gauges);
+
+    snprintf(gauges, sizeof(gauges),
+             "# HELP irrigation_moisture_raw Unsmoothed median of the latest sensor burst\n"
+             "# TYPE irrigation_moisture_raw gauge\n"
+             "irrigation_moisture_raw %u\n"
+             "# HELP irrigation_moisture_sample_age_seconds Time since the latest sensor burst\n"
+             "# TYPE irrigation_moisture_sample_age_seconds gauge\n"
+             "irrigation_moisture_sample_age_seconds %g\n"
+             "# HELP irrigation_adc_reads_total ADC conversions since boot\n"
+             "# TYPE irrigation_adc_reads_total counter\n"
+             "irrigation_adc_reads_total %lu\n",
+             live.moistureRaw, live.sampleAgeMs * 1e-3, (unsigned long)live.adcReads);
+    server.sendContent(gauges);
+
+    snprintf(gauges, sizeof(gauges),
+             "# HELP irrigation_adc_deferred_total Sensor bursts postponed after radio activity\n"
+             "# TYPE irrigation_adc_deferred_total counter\n"
+             "irrigation_adc_deferred_total %lu\n"
+             "# HELP irrigation_dry_rate_per_hour Drying model, counts per hour expected now\n"
+             "# TYPE irrigation_dry_rate_per_hour gauge\n"
+             "irrigation_dry_rate_per_hour %.2f\n",
+             (unsigned long)live.adcDeferred, live.dryRatePerHour);
+    server.sendContent(gauges);
+
+    snprintf(gauges, sizeof(gauges),
+             "# HELP irrigation_seconds_to_dry Predicted time to the dry threshold, -1 if none\n"
+             "# TYPE irrigation_seconds_to_dry gauge\n"
+             "irrigation_seconds_to_dry %ld\n"
+             "# HELP irrigation_duty_cycle_percent Estimated time fully awake since boot\n"
+             "# TYPE irrigation_duty_cycle_percent gauge\n"
+             "irrigation_duty_cycle_percent %.1f\n"
+             "# HELP irrigation_radio_on_percent Estimated radio-on time since boot\n"
+             "# TYPE irrigation_radio_on_percent gauge\n"
+             "irrigation_radio_on_percent %.1f\n",
+             (long)live.secondsToDry, live.dutyCyclePct, live.radioOnPct);
+    server.sendContent(gauges);
+
+    for (uint8_t i = 0; i < MAX_ARENAS && _arenas[i]; i++) {
+        snprintf(gauges, sizeof(gauges),
+                 "irrigation_json_arena_high_water_bytes{arena=\"%s\"} %u\n"
+                 "irrigation_json_arena_capacity_bytes{arena=\"%s\"} %u\n"
+                 "irrigation_json_arena_heap_fallbacks_total{arena=\"%s\"} %u\n",
+                 _arenaNames[i], (unsigned)_arenas[i]->highWater(),
+                 _arenaNames[i], (unsigned)_arenas[i]->capacity(),
+                 _arenaNames[i], (unsigned)_arenas[i]->heapFallbackCount());
+        server.sendContent(gauges);
+    }
+    server.sendContent("");  // Terminating chunk
+}
+
+#endif  // LOOP_METRICS
@@ -0,0 +1,120 @@
+/*
+ * LoopMetrics - per-stage loop() timing exported on /metrics
+ *
+ * Each stage is timed with the CPU cycle counter and recorded into a
+ * fixed-bucket histogram; loop gaps and dry-threshold-to-pump-on latency
+ * are tracked too, along with heap health (free bytes, largest free block
+ * and its low-water mark) for soak testing. Sensor readings and estimates
+ * that change every sample are exported here too, since /status only
+ * carries values that change on events. Built only with -D LOOP_METRICS; without it the
+ * LOOP_BEGIN/LOOP_STAGE/LOOP_END markers compile to nothing and /metrics
+ * is not registered.
+ */
+
+#pragma once
+
+#ifdef LOOP_METRICS
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include "LatencyHistogram.h"
+#include "JsonArena.h"
+
+enum LoopStage : uint8_t {
+    STAGE_WEB,          // server.handleClient
+    STAGE_SENSOR,       // Moisture sampling
+    STAGE_BUTTON,       // readButton and the resulting action
+    STAGE_LED,
+    STAGE_WIFI,         // checkWiFi
+    STAGE_SYNC,         // syncWithFirestore
+    STAGE_REMOTE,       // checkForRemoteUpdates (config + commands)
+    STAGE_QUEUE,        // Offline backlog drain and batch flush
+    STAGE_DISPLAY,      // Serial status line
+    STAGE_PUMP,         // Pump state machine
+    STAGE_LOOP,         // Whole loop() body except the trailing delay
+    STAGE_COUNT
+};
+
+// Readings and estimates that change every sample (kept off /status so its
+// cached body stays valid between events), filled in per /metrics request
+struct LiveGauges {
+    uint16_t moistureRaw = 0;       // Unsmoothed median of the latest burst
+    uint32_t sampleAgeMs = 0;       // Since the latest burst
+    uint32_t adcReads = 0;
+    uint32_t adcDeferred = 0;       // Bursts postponed after radio activity
+    float dryRatePerHour = 0;       // Drying model, rate expected now
+    int32_t secondsToDry = -1;      // Predicted dry crossing, -1 if none
+    float dutyCyclePct = 100;       // Estimated time fully awake since boot
+    float radioOnPct = 100;         // Estimated radio-on time since boot
+};
+
+class LoopMetrics {
+public:
+    LoopMetrics();
+
+    // Call first thing in loop(); tracks the gap since the previous pass
+    // and returns the cycle count the loop stage is timed from
+    uint32_t loopStarted();
+    void recordStage(LoopStage stage, uint32_t cycles);
+
+    // Dry reading seen at sinceMs, automatic pump start now
+    void recordThresholdToPump(uint32_t sinceMs);
+
+    // Report an arena's high-water mark and heap fallbacks (up to MAX_ARENAS)
+    void watchArena(const char* name, const JsonArena& arena);
+
+    // Stream everything in Prometheus text format
+    void writePrometheus(ESP8266WebServer& server, const LiveGauges& live);
+
+private:
+    static const uint8_t MAX_ARENAS = 2;
+
+    void sampleHeap(uint32_t nowMs);
+
+    LatencyHistogram _stages[STAGE_COUNT];
+    LatencyHistogram _thresholdToPump;
+    uint32_t _lastLoopStartUs = 0;
+    uint32_t _lastLoopGapUs = 0;
+    uint32_t _maxLoopGapUs = 0;
+
+    uint32_t _lastHeapSampleMs = 0;
+    uint32_t _heapFree = 0;
+    uint32_t _heapMaxBlock = 0;
+    uint32_t _heapMaxBlockMin = UINT32_MAX;
+    uint8_t _heapFragmentation = 0;
+
+    const char* _arenaNames[MAX_ARENAS] = {};
+    const JsonArena* _arenas[MAX_ARENAS] = {};
+};
+
+extern LoopMetrics loopMetrics;
+
+// Times the enclosing scope
+class StageTimer {
+public:
+    explicit StageTimer(LoopStage stage) : _stage(stage), _start(ESP.getCycleCount()) {}
+    ~StageTimer() { loopMetrics.recordStage(_stage, ESP.getCycleCount() - _start); }
+
+private:
+    LoopStage _stage;
+    uint32_t _start;
+};
+
+#define LOOP_STAGE_TIMER(stage) StageTimer _stageTimer(stage)
+#define LOOP_BEGIN_TIMER() uint32_t _loopStartCycles = loopMetrics.loopStarted()
+#define LOOP_END_TIMER() loopMetrics.recordStage(STAGE_LOOP, ESP.getCycleCount() - _loopStartCycles)
+
+#else
+
+#define LOOP_STAGE_TIMER(stage) do {} while (0)
+#define LOOP_BEGIN_TIMER() do {} while (0)
+#define LOOP_END_TIMER() do {} while (0)
+
+#endif  // LOOP_METRICS
+
+// Each stage also lands in the trace ring when built with -D TRACE_EVENTS
+#include "TraceRecorder.h"
+
+#define LOOP_STAGE(stage) LOOP_STAGE_TIMER(stage); TRACE_SCOPE(TRACE_##stage)
+#define LOOP_BEGIN() TRACE_BEGIN(TRACE_LOOP); LOOP_BEGIN_TIMER()
+#define LOOP_END() LOOP_END_TIMER(); TRACE_END(TRACE_LOOP)
@@ -0,0 +1,181 @@
+#include "MqttLink.h"
+
+#ifdef MQTT_TRANSPORT
+
+#include <sys/time.h>
+#include "FirestorePayload.h"
+
+const uint16_t MQTT_KEEPALIVE_SEC = 30;
+const uint32_t MQTT_BACKOFF_BASE_MS = 2000;
+const uint32_t MQTT_BACKOFF_MAX_MS = 60000;
+const size_t MQTT_PAYLOAD_SIZE = 512;
+static const uint32_t COMMAND_LATENCY_BOUNDS_MS[] = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+bool WiFiByteStream::connect(const char* host, uint16_t port) {
+    if (!_client.connect(host, port)) return false;
+    _client.setNoDelay(true);  // Small packets, latency matters more than segments
+    return true;
+}
+
+size_t WiFiByteStream::read(uint8_t* data, size_t length) {
+    int count = _client.read(data, length);
+    return count > 0 ? count : 0;
+}
+
+MqttLink::MqttLink(Clock& clock, JsonArena& arena, MqttFieldsHandler onCommand,
+                   MqttFieldsHandler onConfig)
+    : _client(_stream, clock), _clock(clock), _arena(arena), _onCommand(onCommand),
+      _onConfig(onConfig),
+      _latency(COMMAND_LATENCY_BOUNDS_MS, sizeof(COMMAND_LATENCY_BOUNDS_MS) / sizeof(uint32_t)) {
+    _client.setHandler(this);
+}
+
+void MqttLink::begin(const char* host, uint16_t port, const char* user, const char* password,
+                     const char* deviceId) {
+    strlcpy(_host, host, sizeof(_host));
+    _port = port;
+    strlcpy(_user, user, sizeof(_user));
+    strlcpy(_password, password, sizeof(_password));
+    strlcpy(_clientId, deviceId, sizeof(_clientId));
+    snprintf(_base, sizeof(_base), "irrigation/%s/", deviceId);
+}
+
+void MqttLink::loop() {
+    if (_client.loop()) return;
+    if (_client.state() != MqttClient::DISCONNECTED || !_host[0]) return;
+    if ((int32_t)(_clock.millis() - _retryAtMs) < 0) return;
+
+    char willTopic[64];
+    topic(willTopic, sizeof(willTopic), "online");
+    MqttOptions options;
+    options.clientId = _clientId;
+    options.username = _user[0] ? _user : nullptr;
+    options.password = _password[0] ? _password : nullptr;
+    options.keepAliveSec = MQTT_KEEPALIVE_SEC;
+    options.cleanSession = false;  // Broker queues QoS 1 commands while we are away
+    options.willTopic = willTopic;
+    options.willPayload = "0";
+
+    if (_client.connect(_host, _port, options)) {
+        Serial.printf_P(PSTR("[MQTT] Connecting to %s:%u\n"), _host, _port);
+    } else {
+        Serial.printf_P(PSTR("✗ [MQTT] Cannot reach %s:%u\n"), _host, _port);
+    }
+    // Also covers a CONNACK that never comes or is refused
+    scheduleRetry();
+}
+
+void MqttLink::stop() {
+    _client.disconnect();
+    _retryAtMs = _clock.millis();
+    _backoffMs = 0;
+}
+
+void MqttLink::scheduleRetry() {
+    // Exponential backoff with +/-25% jitter, as for WiFi
+    _backoffMs = _backoffMs ? min(_backoffMs * 2, MQTT_BACKOFF_MAX_MS) : MQTT_BACKOFF_BASE_MS;
+    long jitter = random(-(long)(_backoffMs / 4), (long)(_backoffMs / 4) + 1);
+    _retryAtMs = _clock.millis() + _backoffMs + jitter;
+}
+
+bool MqttLink::publishFields(const char* subtopic, JsonObject fields, bool retain) {
+    if (!_client.connected()) return false;
+    char payload[MQTT_PAYLOAD_SIZE];
+    size_t length;
+    {
+        JsonDocument doc(&_arena);
+        flattenFields(fields, doc.to<JsonObject>());
+        length = serializeJson(doc, payload, sizeof(payload));
+    }
+    if (length == 0 || length >= sizeof(payload)) return false;
+    char name[64];
+    topic(name, sizeof(name), subtopic);
+    return _client.publish(name, payload, length, retain);
+}
+
+void MqttLink::topic(char* out, size_t size, const char* subtopic) const {
+    snprintf(out, size, "%s%s", _base, subtopic);
+}
+
+// MqttHandler
+
+void MqttLink::onConnected(bool sessionPresent) {
+    _connects++;
+    _backoffMs = 0;
+    char name[64];
+    topic(name, sizeof(name), "online");
+    _client.publish(name, "1", 1, true);
+    // Subscribing again also brings the retained config
+    topic(name, sizeof(name), "cmd");
+    _client.subscribe(name, 1);
+    topic(name, sizeof(name), "config");
+    _client.subscribe(name, 1);
+    Serial.printf_P(PSTR("✓ [MQTT] Connected (%s session)\n"), sessionPresent ? "resumed" : "new");
+}
+
+void MqttLink::onMessage(const char* topicName, char* payload, size_t length, bool duplicate) {
+    size_t baseLength = strlen(_base);
+    if (strncmp(topicName, _base, baseLength) != 0) return;
+    const char* subtopic = topicName + baseLength;
+
+    JsonDocument doc(&_arena);
+    if (deserializeJson(doc, payload, length) || !doc.is<JsonObject>()) {
+        Serial.printf_P(PSTR("✗ [MQTT] Ignoring malformed %s message\n"), subtopic);
+        return;  // Still acknowledged: it would not parse on redelivery either
+    }
+
+    if (strcmp(subtopic, "cmd") == 0) {
+        handleCommand(doc.as<JsonObject>());
+    } else if (strcmp(subtopic, "config") == 0) {
+        _onConfig(doc.as<JsonObject>());
+    }
+}
+
+void MqttLink::handleCommand(JsonObject fields) {
+    const char* id = fields["id"] | "";
+    bool repeat = id[0] && seen(id);
+    if (repeat) {
+        _duplicates++;
+    } else {
+        _commands++;
+        _onCommand(fields);
+    }
+
+    // One-way latency from the app's wall clock (issuedAt, epoch ms) to now
+    int32_t latencyMs = -1;
+    double issuedAt = fields["issuedAt"] | 0.0;  // Past 32 bits; exact in a double
+    if (!repeat && issuedAt > 0 && _clock.epoch() != 0) {
+        timeval now;
+        gettimeofday(&now, nullptr);
+        double delta = (double)now.tv_sec * 1000 + now.tv_usec / 1000 - issuedAt;
+        latencyMs = delta < 0 ? 0 : delta > INT32_MAX ? INT32_MAX : (int32_t)delta;  // < 0: clock skew
+        _lastLatencyMs = latencyMs;
+        _latency.record(latencyMs);
+        Serial.printf_P(PSTR("[MQTT] Command %s applied %ld ms after issue\n"), id, (long)latencyMs);
+    }
+
+    char ack[96];
+    size_t length;
+    {
+        JsonDocument doc(&_arena);
+        doc["id"] = id;
+        doc["latencyMs"] = latencyMs;
+        doc["duplicate"] = repeat;
+        length = serializeJson(doc, ack, sizeof(ack));
+    }
+    char name[64];
+    topic(name, sizeof(name), "cmd/ack");
+    _client.publish(name, ack, length);
+}
+
+// Remember the last few command ids; true if id is one of them
+bool MqttLink::seen(const char* id) {
+    for (uint8_t i = 0; i < RECENT_IDS; i++) {
+        if (strcmp(_recentIds[i], id) == 0) return true;
+    }
+    strlcpy(_recentIds[_nextRecent], id, sizeof(_recentIds[0]));
+    _nextRecent = (_nextRecent + 1) % RECENT_IDS;
+    return false;
+}
+
+#endif  // MQTT_TRANSPORT
@@ -0,0 +1,111 @@
+/*
+ * MqttLink - MQTT transport for telemetry and remote commands
+ *
+ * Built with -D MQTT_TRANSPORT (env:nodemcuv2_mqtt) and used when
+ * config.json names an mqttHost: one persistent connection replaces the
+ * Firestore commits and the 5 s batchGet poll, and commands arrive pushed.
+ * Topics under irrigation/<deviceId>/:
+ *   telemetry  log entries and readings stored offline     out, QoS 0
+ *   status     heartbeat (retained)                        out, QoS 0
+ *   events     pump and fault events                       out, QoS 0
+ *   online     "1" (retained); the broker's will sets "0"  out
+ *   cmd        {"id":"a1","waterNow":true,"issuedAt":ms}   in,  QoS 1
+ *   config     settings, published retained by the app     in,  QoS 1
+ *   cmd/ack    {"id":"a1","latencyMs":42}                  out, QoS 0
+ * Payloads are the Firestore field maps flattened to plain JSON. A command
+ * is applied before its PUBACK goes out; a redelivered id is acknowledged
+ * again without being applied twice.
+ */
+
+#pragma once
+
+#ifdef MQTT_TRANSPORT
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "JsonArena.h"
+#include "LatencyHistogram.h"
+#include "MqttClient.h"
+
+// WiFiClient as a ByteStream
+class WiFiByteStream : public ByteStream {
+public:
+    bool connect(const char* host, uint16_t port) override;
+    bool connected() override { return _client.connected(); }
+    size_t available() override { return _client.available(); }
+    size_t read(uint8_t* data, size_t length) override;
+    size_t write(const uint8_t* data, size_t length) override { return _client.write(data, length); }
+    void stop() override { _client.stop(); }
+
+private:
+    WiFiClient _client;
+};
+
+// Receives the fields of a cmd or config message
+typedef void (*MqttFieldsHandler)(JsonObject fields);
+
+class MqttLink : private MqttHandler {
+public:
+    MqttLink(Clock& clock, JsonArena& arena, MqttFieldsHandler onCommand, MqttFieldsHandler onConfig);
+
+    // Broker and identity; user may be empty (anonymous)
+    void begin(const char* host, uint16_t port, const char* user, const char* password,
+               const char* deviceId);
+
+    // Call every loop pass while WiFi is up: connects (with backoff),
+    // dispatches incoming messages and keeps the session alive
+    void loop();
+
+    // WiFi lost: drop the connection, retry as soon as loop() runs again
+    void stop();
+
+    bool connected() const { return _client.connected(); }
+
+    // Publish typed fields (FirestorePayload builders) as plain JSON
+    bool publishFields(const char* subtopic, JsonObject fields, bool retain = false);
+
+    uint32_t commandCount() const { return _commands; }
+    uint32_t duplicateCount() const { return _duplicates; }
+    uint32_t connectCount() const { return _connects; }
+    uint32_t lastLatencyMs() const { return _lastLatencyMs; }
+    // Broker-to-applied latency of commands carrying issuedAt (wall clocks synced)
+    const LatencyHistogram& commandLatency() const { return _latency; }
+
+private:
+    static const uint8_t RECENT_IDS = 4;
+
+    void onConnected(bool sessionPresent) override;
+    void onMessage(const char* topic, char* payload, size_t length, bool duplicate) override;
+    void handleCommand(JsonObject fields);
+    bool seen(const char* id);
+    void topic(char* out, size_t size, const char* subtopic) const;
+    void scheduleRetry();
+
+    WiFiByteStream _stream;
+    MqttClient _client;
+    Clock& _clock;
+    JsonArena& _arena;
+    MqttFieldsHandler _onCommand;
+    MqttFieldsHandler _onConfig;
+
+    char _host[64] = "";
+    uint16_t _port = 1883;
+    char _user[32] = "";
+    char _password[64] = "";
+    char _clientId[32] = "";
+    char _base[48] = "";                // irrigation/<deviceId>/
+
+    uint32_t _retryAtMs = 0;
+    uint32_t _backoffMs = 0;
+
+    char _recentIds[RECENT_IDS][24] = {};
+    uint8_t _nextRecent = 0;
+
+    uint32_t _commands = 0;
+    uint32_t _duplicates = 0;
+    uint32_t _connects = 0;
+    uint32_t _lastLatencyMs = 0;
+    LatencyHistogram _latency;
+};
+
+#endif  // MQTT_TRANSPORT
@@ -0,0 +1,123 @@
+#include "WiFiConnection.h"
+
+static_assert(WiFiConnection::backoffDelayMs(1, 2000, 300000) == 2000, "the first failure waits the base delay");
+static_assert(WiFiConnection::backoffDelayMs(3, 2000, 300000) == 8000, "each further failure doubles it");
+static_assert(WiFiConnection::backoffDelayMs(20, 2000, 300000) == 300000, "up to the cap");
+
+WiFiConnection::WiFiConnection(unsigned long backoffBaseMs, unsigned long backoffMaxMs,
+                               unsigned long attemptTimeoutMs)
+    : _backoffBaseMs(backoffBaseMs), _backoffMaxMs(backoffMaxMs), _attemptTimeoutMs(attemptTimeoutMs) {}
+
+void WiFiConnection::begin(const String& ssid, const String& pass) {
+    _ssid = ssid;
+    _pass = pass;
+    _failures = 0;
+    _gotIp = false;
+    _disconnected = false;
+    _downSince = millis();
+
+    // Event callbacks only raise flags; all work happens in update()
+    _gotIpHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP&) {
+        _gotIp = true;
+    });
+    _disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected&) {
+        _disconnected = true;
+    });
+
+    // We schedule retries ourselves
+    WiFi.setAutoReconnect(false);
+
+    if (WiFi.status() == WL_CONNECTED) {
+        _state = CONNECTED;  // Caller checks isConnected(); no event is raised
+        _wasConnected = true;
+    } else {
+        startAttempt(millis());
+    }
+}
+
+WiFiLinkEvent WiFiConnection::update() {
+    if (_state == IDLE) return WIFI_EVENT_NONE;
+
+    unsigned long now = millis();
+
+    if (_gotIp) {
+        _gotIp = false;
+        _disconnected = false;
+        if (_state != CONNECTED) {
+            unsigned long elapsed = now - _downSince;
+            _state = CONNECTED;
+            _failures = 0;
+            _lastConnectMs = elapsed;
+            if (_wasConnected) {
+                _reconnects++;
+                _lastReconnectMs = elapsed;
+                _totalReconnectMs += elapsed;
+                if (elapsed > _maxReconnectMs) _maxReconnectMs = elapsed;
+            }
+            _wasConnected = true;
+            return WIFI_EVENT_CONNECTED;
+        }
+    }
+
+    if (_disconnected) {
+        _disconnected = false;
+        if (_state == CONNECTED) {
+            _downSince = now;
+            _failures = 0;
+            scheduleRetry(now);
+            return WIFI_EVENT_DISCONNECTED;
+        }
+        if (_state == CONNECTING) {
+            // Attempt rejected (AP missing, bad password, ...)
+            _failures++;
+            scheduleRetry(now);
+        }
+    }
+
+    switch (_state) {
+        case CONNECTING:
+            if (now - _attemptStart >= _attemptTimeoutMs) {
+                _failures++;
+                WiFi.disconnect();
+                scheduleRetry(now);
+            }
+            break;
+
+        case BACKOFF:
+            if ((long)(now - _retryAt) >= 0) {
+                startAttempt(now);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return WIFI_EVENT_NONE;
+}
+
+unsigned long WiFiConnection::nextAttemptInMs() const {
+    if (_state != BACKOFF) return 0;
+    long remaining = (long)(_retryAt - millis());
+    return remaining > 0 ? remaining : 0;
+}
+
+void WiFiConnection::startAttempt(unsigned long now) {
+    _state = CONNECTING;
+    _attemptStart = now;
+    // A late event from the previous attempt's WiFi.disconnect() is not a
+    // failure of this one
+    _disconnected = false;
+    _attempts++;
+    WiFi.begin(_ssid.c_str(), _pass.c_str());
+}
+
+void WiFiConnection::scheduleRetry(unsigned long now) {
+    // Exponential backoff, then +/-25% jitter so a fleet that lost the same
+    // AP doesn't retry in lockstep
+    unsigned long delayMs = backoffDelayMs(_failures, _backoffBaseMs, _backoffMaxMs);
+
+    long jitter = random(-(long)(delayMs / 4), (long)(delayMs / 4) + 1);
+    _retryAt = now + delayMs + jitter;
+    _state = BACKOFF;
+}
@@ -0,0 +1,93 @@
+/*
+ * WiFiConnection - non-blocking station connection manager
+ *
+ * Driven by the SDK's WiFi events instead of polling WiFi.status() in a
+ * busy-wait. Failed attempts are retried with exponential backoff plus
+ * jitter (seconds at first, capped at a few minutes) so the loop never
+ * stalls and a rebooted AP is picked up again quickly.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+enum WiFiLinkEvent {
+    WIFI_EVENT_NONE,
+    WIFI_EVENT_CONNECTED,       // Got an IP (first connect or reconnect)
+    WIFI_EVENT_DISCONNECTED     // Lost an established connection
+};
+
+class WiFiConnection {
+public:
+    enum State {
+        IDLE,           // No credentials yet
+        CONNECTING,     // WiFi.begin() issued, waiting for an IP
+        CONNECTED,
+        BACKOFF         // Waiting before the next attempt
+    };
+
+    WiFiConnection(unsigned long backoffBaseMs, unsigned long backoffMaxMs, unsigned long attemptTimeoutMs);
+
+    // Start managing the station with these credentials. If the station is
+    // already connected (e.g. right after the config portal) no new attempt is
+    // made and no WIFI_EVENT_CONNECTED is raised; check isConnected() afterwards.
+    void begin(const String& ssid, const String& pass);
+
+    // Advance the state machine; call every loop pass. Never blocks.
+    WiFiLinkEvent update();
+
+    bool isConnected() const { return _state == CONNECTED; }
+    State state() const { return _state; }
+    unsigned long nextAttemptInMs() const;
+
+    // Backoff before the next attempt after failures consecutive failed
+    // ones: baseMs after the first (or a dropped link), doubling up to
+    // maxMs; jitter is added on top
+    static constexpr unsigned long backoffDelayMs(uint8_t failures, unsigned long baseMs, unsigned long maxMs) {
+        return baseMs >= maxMs ? maxMs
+             : failures <= 1   ? baseMs
+                               : backoffDelayMs(failures - 1, baseMs * 2, maxMs);
+    }
+
+    // Time from begin() or link loss to the latest got-IP
+    unsigned long lastConnectMs() const { return _lastConnectMs; }
+
+    // Reconnect metrics (time from link loss to got-IP); the first
+    // connection after boot is not a reconnect
+    uint32_t attemptCount() const { return _attempts; }
+    uint32_t reconnectCount() const { return _reconnects; }
+    unsigned long lastReconnectMs() const { return _lastReconnectMs; }
+    unsigned long maxReconnectMs() const { return _maxReconnectMs; }
+    unsigned long averageReconnectMs() const { return _reconnects ? _totalReconnectMs / _reconnects : 0; }
+
+private:
+    void startAttempt(unsigned long now);
+    void scheduleRetry(unsigned long now);
+
+    unsigned long _backoffBaseMs;
+    unsigned long _backoffMaxMs;
+    unsigned long _attemptTimeoutMs;
+
+    String _ssid;
+    String _pass;
+    State _state = IDLE;
+
+    WiFiEventHandler _gotIpHandler;
+    WiFiEventHandler _disconnectedHandler;
+    volatile bool _gotIp = false;
+    volatile bool _disconnected = false;
+
+    uint8_t _failures = 0;              // Consecutive failed attempts
+    unsigned long _attemptStart = 0;
+    unsigned long _retryAt = 0;
+    unsigned long _downSince = 0;
+    bool _wasConnected = false;         // A link was up before: the next got-IP is a reconnect
+
+    uint32_t _attempts = 0;
+    unsigned long _lastConnectMs = 0;
+    uint32_t _reconnects = 0;
+    unsigned long _lastReconnectMs = 0;
+    unsigned long _maxReconnectMs = 0;
+    unsigned long _totalReconnectMs = 0;
+};
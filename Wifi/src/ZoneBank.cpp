@@ -0,0 +1,239 @@
+#include "ZoneBank.h"
+
+#ifdef ZONE_COUNT
+
+#include <Wire.h>
+#include "Crc16.h"
+#include "FirestorePayload.h"
+
+// Four ADS1115s at most (0x48-0x4B)
+static_assert(ZONE_COUNT >= 1 && ZONE_COUNT <= 16, "ZONE_COUNT must be 1-16");
+
+// Expander wiring (D1-D3 and A0 stay with the on-board zone)
+constexpr uint8_t ZONE_I2C_SDA = D6;
+constexpr uint8_t ZONE_I2C_SCL = D5;
+constexpr uint8_t ZONE_SR_DATA = D7;       // 74HC595 SER
+constexpr uint8_t ZONE_SR_CLOCK = D0;      // 74HC595 SRCLK
+constexpr uint8_t ZONE_SR_LATCH = D8;      // 74HC595 RCLK (pulled low at boot)
+
+const char* ZONE_STATE_FILE = "/zones.bin";
+const uint32_t ZONE_SAMPLE_INTERVAL_MS = 250;   // One zone per interval, round robin
+const uint8_t ZONE_EMA_SHIFT = 2;
+const uint32_t ZONE_SAVE_COALESCE_MS = 5000;
+const uint32_t ZONE_START_SPACING_MS = 500;     // Lets one motor's inrush pass before the next
+
+ZoneBank::ZoneBank(Clock& clock, Gpio& pins, FileStore& files, const PumpConfig& config,
+                   ZoneEventSink events)
+    : _clock(clock), _files(files), _events(events),
+      _relays(pins, ZONE_SR_DATA, ZONE_SR_CLOCK, ZONE_SR_LATCH, ZONE_COUNT),
+      _controller(clock, _relays, _zones, ZONE_COUNT, _schedule) {
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        _zones[i].config = &config;
+        _zones[i].relay = i;
+    }
+    _schedule.maxConcurrentPumps = ZONE_MAX_PUMPS;
+    _schedule.startSpacingMs = ZONE_START_SPACING_MS;
+    _controller.setListener(this);
+}
+
+void ZoneBank::begin() {
+    _relays.begin();
+    _controller.begin();
+    Wire.begin(ZONE_I2C_SDA, ZONE_I2C_SCL);
+
+    // The ADS1115 is not disturbed by the radio, so single reads smoothed
+    // by an EMA are enough (no median burst as on A0)
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        uint16_t moisture = _adc.read(i);
+        _emaQ8[i] = (int32_t)moisture << 8;
+        _controller.setMoisture(i, moisture);
+    }
+    _lastSampleMs = _clock.millis();
+    Serial.printf_P(PSTR("✓ %u zones, max %u pumps at once (%lu ADC errors)\n"), ZONE_COUNT,
+                    ZONE_MAX_PUMPS, (unsigned long)_adc.errorCount());
+}
+
+void ZoneBank::update(bool onboardPumpRunning) {
+    uint32_t now = _clock.millis();
+    if (now - _lastSampleMs >= ZONE_SAMPLE_INTERVAL_MS) {
+        _lastSampleMs = now;
+        sampleNext();
+    }
+
+    _controller.setReservedSlots(onboardPumpRunning ? 1 : 0);
+    _controller.update();
+
+    if (_dirtyZones && now - _dirtySinceMs >= ZONE_SAVE_COALESCE_MS) flush();
+}
+
+void ZoneBank::sampleNext() {
+    uint8_t zone = _nextSample;
+    _nextSample = (_nextSample + 1) % ZONE_COUNT;
+
+    int32_t sampleQ8 = (int32_t)_adc.read(zone) << 8;
+    _emaQ8[zone] += (sampleQ8 - _emaQ8[zone]) >> ZONE_EMA_SHIFT;
+    _controller.setMoisture(zone, (uint16_t)((_emaQ8[zone] + 128) >> 8));
+}
+
+int ZoneBank::water(uint8_t zone, ActivationMethod method) {
+    if (zone >= ZONE_COUNT) return 400;
+    if (_zones[zone].persistent.lockedFault) return 403;
+    if (!_controller.checkSafety(zone)) return 429;
+    return _controller.request(zone, method) ? 200 : 429;
+}
+
+uint8_t ZoneBank::clearFaults() {
+    uint8_t cleared = 0;
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        if (_controller.clearFault(i)) cleared++;
+    }
+    return cleared;
+}
+
+uint8_t ZoneBank::lockedCount() const {
+    uint8_t locked = 0;
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        if (_zones[i].persistent.lockedFault) locked++;
+    }
+    return locked;
+}
+
+bool ZoneBank::reportDue(uint16_t moistureDeadband) const {
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        const Zone& zone = _zones[i];
+        const Reported& reported = _reported[i];
+        if (zone.state != reported.pumpState || zone.persistent.lockedFault != reported.lockedFault) {
+            return true;
+        }
+        int32_t delta = (int32_t)zone.moisture - reported.moisture;
+        if (delta >= moistureDeadband || -delta >= moistureDeadband) return true;
+    }
+    return false;
+}
+
+void ZoneBank::queueTelemetry(FirestoreBatch& batch, const char* zonesCollection, uint32_t epoch) {
+    char zoneId[4];
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        const Zone& zone = _zones[i];
+        ZoneTelemetry telemetry;
+        telemetry.moisture = zone.moisture;
+        telemetry.pumpState = zone.state;
+        telemetry.activationMethod = zone.lastMethod;
+        telemetry.lockedFault = zone.persistent.lockedFault;
+        telemetry.noEffectCount = zone.persistent.noEffectCounter;
+        telemetry.lastPumpEndEpoch = zone.persistent.lastPumpEndEpoch;
+        telemetry.epoch = epoch;
+
+        snprintf(zoneId, sizeof(zoneId), "%u", i);
+        buildZoneStatusFields(batch.add(zonesCollection, zoneId, true), i, telemetry);
+        _reported[i] = {zone.moisture, zone.state, zone.persistent.lockedFault};
+    }
+}
+
+// Chunked, one zone per chunk
+void ZoneBank::writeJson(ESP8266WebServer& server) {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+
+    char chunk[192];
+    snprintf(chunk, sizeof(chunk), "{\"maxPumps\":%u,\"running\":%u,\"queued\":%u,\"deferred\":%lu,"
+             "\"maxRunningSeen\":%u,\"adcErrors\":%lu,\"zones\":[",
+             ZONE_MAX_PUMPS, _controller.runningCount(), _controller.queuedCount(),
+             (unsigned long)_controller.deferredCount(), _controller.maxRunningSeen(),
+             (unsigned long)_adc.errorCount());
+    server.sendContent(chunk);
+
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        const Zone& zone = _zones[i];
+        snprintf(chunk, sizeof(chunk), "%s{\"zone\":%u,\"moisture\":%u,\"pumpState\":\"%s\","
+                 "\"queued\":%s,\"lockedFault\":%s,\"noEffectCount\":%u,\"lastPumpEnd\":%lu}",
+                 i ? "," : "", i, zone.moisture, pumpStateName(zone.state),
+                 zone.queuedMethod != ACTIVATION_NONE ? "true" : "false",
+                 zone.persistent.lockedFault ? "true" : "false", zone.persistent.noEffectCounter,
+                 (unsigned long)zone.persistent.lastPumpEndEpoch);
+        server.sendContent(chunk);
+    }
+    server.sendContent("]}");
+    server.sendContent("");  // Terminating chunk
+}
+
+// Persistence: fixed 8-byte record per zone; a record that fails its CRC
+// (never written, torn write) leaves the zone at its defaults
+void ZoneBank::restore() {
+    uint8_t restored = 0;
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        ZoneRecord record;
+        if (_files.read(ZONE_STATE_FILE, i * sizeof(record), &record, sizeof(record)) != sizeof(record) ||
+            crc16(&record, offsetof(ZoneRecord, crc)) != record.crc) {
+            continue;
+        }
+        PumpPersistentState state;
+        state.lastPumpEndEpoch = record.lastPumpEndEpoch;
+        state.lockedFault = record.lockedFault != 0;
+        state.noEffectCounter = record.noEffectCounter;
+        _controller.restore(i, state);
+        restored++;
+    }
+    if (lockedCount() > 0) {
+        Serial.printf_P(PSTR("⚠ %u zones locked (restored %u)\n"), lockedCount(), restored);
+    }
+}
+
+void ZoneBank::save(uint8_t zone) {
+    const PumpPersistentState& state = _zones[zone].persistent;
+    ZoneRecord record;
+    record.lastPumpEndEpoch = state.lastPumpEndEpoch;
+    record.lockedFault = state.lockedFault;
+    record.noEffectCounter = state.noEffectCounter;
+    record.crc = crc16(&record, offsetof(ZoneRecord, crc));
+    _files.write(ZONE_STATE_FILE, zone * sizeof(record), &record, sizeof(record));
+}
+
+void ZoneBank::flush() {
+    for (uint8_t i = 0; _dirtyZones && i < ZONE_COUNT; i++) {
+        if (_dirtyZones & (1UL << i)) {
+            save(i);
+            _dirtyZones &= ~(1UL << i);
+        }
+    }
+}
+
+// ZoneListener
+
+void ZoneBank::onPumpStarted(uint8_t zone, ActivationMethod method, uint16_t moistureBefore) {
+    Serial.printf_P(PSTR("  ZONE %u: PUMP ON (%s, moisture %u, %u running)\n"), zone,
+                    activationMethodName(method), moistureBefore, _controller.runningCount());
+    char details[48];
+    snprintf(details, sizeof(details), "zone=%u,method=%s,moisture=%u", zone,
+             activationMethodName(method), moistureBefore);
+    _events("zone_pump_activated", details);
+}
+
+void ZoneBank::onPumpStopped(uint8_t zone) {
+    Serial.printf_P(PSTR("  ZONE %u: PUMP OFF\n"), zone);
+}
+
+void ZoneBank::onEffectivenessChecked(uint8_t zone, const EffectivenessResult& result) {
+    Serial.printf_P(PSTR("  ZONE %u: %u -> %u %s (%u/%u)\n"), zone, result.moistureBefore,
+                    result.moistureAfter, result.effective ? "effective" : "NO EFFECT",
+                    result.noEffectCount, _zones[zone].config->maxNoEffectRepeats);
+}
+
+void ZoneBank::onFaultLocked(uint8_t zone, uint8_t attempts) {
+    char details[48];
+    snprintf(details, sizeof(details), "Zone %u pump ineffective after %u attempts", zone, attempts);
+    Serial.printf_P(PSTR("  ❌ ZONE %u LOCKED\n"), zone);
+    _events("zone_fault_locked", details);
+}
+
+void ZoneBank::onPersistentStateChanged(uint8_t zone) {
+    if (!_dirtyZones) _dirtySinceMs = _clock.millis();
+    _dirtyZones |= 1UL << zone;
+}
+
+void ZoneBank::onPumpDeferred(uint8_t zone) {
+    Serial.printf_P(PSTR("  ZONE %u: dry, waiting for a pump slot (%u running)\n"), zone,
+                    _controller.runningCount());
+}
+
+#endif  // ZONE_COUNT
@@ -0,0 +1,114 @@
+/*
+ * ZoneBank - expander zones run next to the on-board pump
+ *
+ * Built with -D ZONE_COUNT=<n> (env:nodemcuv2_zones): n moisture sensors
+ * on ADS1115 ADCs and n pump relays on a 74HC595 chain, all driven by one
+ * ZoneController sharing the device PumpConfig. The on-board pump counts
+ * against the ZONE_MAX_PUMPS cap, so the supply never feeds more pumps
+ * than that. Per-zone lockout and last-cycle time survive reboots in
+ * /zones.bin; telemetry goes out as one merge write per zone inside the
+ * regular Firestore commit.
+ */
+
+#pragma once
+
+#ifdef ZONE_COUNT
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include "ArduinoHal.h"
+#include "FirestoreBatch.h"
+#include "ShiftRegisterGpio.h"
+#include "ZoneController.h"
+
+#ifndef ZONE_MAX_PUMPS
+#define ZONE_MAX_PUMPS 2            // Pumps the supply can run at once, on-board pump included
+#endif
+
+// Zone events worth a Firestore log entry (event type, details)
+typedef void (*ZoneEventSink)(const char* eventType, const char* details);
+
+class ZoneBank : private ZoneListener {
+public:
+    ZoneBank(Clock& clock, Gpio& pins, FileStore& files, const PumpConfig& config,
+             ZoneEventSink events);
+
+    // Latch every relay off, start I2C and take a first reading per zone
+    void begin();
+
+    // Load saved lockouts and last-cycle times (file system mounted)
+    void restore();
+
+    // Call every loop pass: reads at most one sensor, steps the scheduler
+    // and saves changed zones once they have settled
+    void update(bool onboardPumpRunning);
+
+    // Queue a manual cycle. Returns 200, or 400 (no such zone), 403 (zone
+    // locked) or 429 (too soon, or already pumping)
+    int water(uint8_t zone, ActivationMethod method);
+
+    // Unlock every locked zone; returns how many were locked
+    uint8_t clearFaults();
+
+    // Write pending zone state now (before a restart)
+    void flush();
+
+    // A zone changed pump state or fault, or moved by at least deadband,
+    // since the last queueTelemetry()
+    bool reportDue(uint16_t moistureDeadband) const;
+
+    // One plantData/<id>/zones/<n> merge write per zone
+    void queueTelemetry(FirestoreBatch& batch, const char* zonesCollection, uint32_t epoch);
+
+    // GET /zones
+    void writeJson(ESP8266WebServer& server);
+
+    uint8_t lockedCount() const;
+    const ZoneController& controller() const { return _controller; }
+
+private:
+    // As stored in /zones.bin, one per zone
+    struct ZoneRecord {
+        uint32_t lastPumpEndEpoch;
+        uint8_t lockedFault;
+        uint8_t noEffectCounter;
+        uint16_t crc;
+    };
+
+    struct Reported {
+        uint16_t moisture;
+        PumpState pumpState;
+        bool lockedFault;
+    };
+
+    void sampleNext();
+    void save(uint8_t zone);
+
+    void onPumpStarted(uint8_t zone, ActivationMethod method, uint16_t moistureBefore) override;
+    void onPumpStopped(uint8_t zone) override;
+    void onEffectivenessChecked(uint8_t zone, const EffectivenessResult& result) override;
+    void onFaultLocked(uint8_t zone, uint8_t attempts) override;
+    void onPersistentStateChanged(uint8_t zone) override;
+    void onPumpDeferred(uint8_t zone) override;
+
+    Clock& _clock;
+    FileStore& _files;
+    ZoneEventSink _events;
+
+    Ads1115Adc _adc;
+    ShiftRegisterGpio _relays;
+    Zone _zones[ZONE_COUNT];
+    ZoneSchedule _schedule;
+    ZoneController _controller;
+
+    int32_t _emaQ8[ZONE_COUNT] = {};    // Filtered readings in 1/256 counts
+    uint8_t _nextSample = 0;
+    uint32_t _lastSampleMs = 0;
+
+    uint32_t _dirtyZones = 0;           // Bit per zone with unsaved state
+    uint32_t _dirtySinceMs = 0;
+
+    Reported _reported[ZONE_COUNT] = {};
+};
+
+#endif  // ZONE_COUNT
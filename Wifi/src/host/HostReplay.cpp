@@ -0,0 +1,512 @@
+/*
+ * HostReplay - runs the shared irrigation logic on Linux with fake peripherals
+ *
+ * Replays a moisture trace through PumpController and reports every
+ * transition, runs a bank of simulated zones through ZoneController
+ * (pump cap, fault lockout, batched zone upload), trains the drying
+ * model on a simulated pot and scores its predictions, runs the loop's
+ * task set through the scheduler for an hour, estimates a day's duty
+ * cycle with and without low-power mode, then times the hot
+ * paths (state machine step, button decoding, Firestore payload building,
+ * offline queue) in virtual time.
+ *
+ *   pio run -e native
+ *   .pio/build/native/program trace.csv
+ *
+ * Trace lines are "<ms>,<moisture>"; without a file a synthetic dry-down
+ * with a working pump is generated.
+ *
+ *   .pio/build/native/program --mqtt localhost:1883 [commands]
+ *
+ * instead times command round trips through a running broker and checks
+ * that commands sent while the device is offline arrive on reconnect
+ * (MqttCheck).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ButtonDecoder.h"
+#include "DryingModel.h"
+#include "FakeHal.h"
+#include "FirestorePayload.h"
+#include "MqttCheck.h"
+#include "PowerManager.h"
+#include "PumpController.h"
+#include "ShiftRegisterGpio.h"
+#include "TaskScheduler.h"
+#include "TelemetryQueue.h"
+#include "ZoneController.h"
+
+namespace {
+
+const uint8_t PUMP_PIN = 5;
+const uint32_t STEP_MS = 10;        // Replay step; the old polling loop delay
+
+// Simulated zone bank: relays on a 74HC595 chain, one pump that delivers nothing
+const uint8_t ZONE_COUNT = 12;
+const uint8_t ZONE_MAX_PUMPS = 3;
+const uint8_t BROKEN_ZONE = ZONE_COUNT - 1;
+const uint8_t SR_DATA_PIN = 12, SR_CLOCK_PIN = 13, SR_LATCH_PIN = 14;
+
+struct Sample {
+    uint32_t ms;
+    uint16_t moisture;
+};
+
+class PrintingListener : public PumpListener {
+public:
+    explicit PrintingListener(Clock& clock) : _clock(clock) {}
+
+    void onPumpStarted(ActivationMethod method, uint16_t moistureBefore) override {
+        printf("%10lu ms  PUMP ON      method=%s moisture=%u\n", now(),
+               activationMethodName(method), moistureBefore);
+        starts++;
+    }
+    void onPumpStopped() override { printf("%10lu ms  PUMP OFF\n", now()); }
+    void onMonitoringResumed() override { printf("%10lu ms  MONITORING\n", now()); }
+    void onEffectivenessChecked(const EffectivenessResult& result) override {
+        printf("%10lu ms  CHECK        before=%u after=%u %s (count %u)\n", now(),
+               result.moistureBefore, result.moistureAfter,
+               result.effective ? "effective" : "NO EFFECT", result.noEffectCount);
+    }
+    void onFaultLocked(uint8_t attempts) override {
+        printf("%10lu ms  FAULT LOCKED after %u attempts\n", now(), attempts);
+    }
+    void onPersistentStateChanged() override { saves++; }
+
+    uint32_t starts = 0;
+    uint32_t saves = 0;
+
+private:
+    unsigned long now() { return _clock.millis(); }
+    Clock& _clock;
+};
+
+double nsPerOp(std::chrono::steady_clock::time_point start, uint32_t ops) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+}
+
+class ZoneCounter : public ZoneListener {
+public:
+    void onPumpStarted(uint8_t zone, ActivationMethod, uint16_t) override { starts[zone]++; }
+    void onFaultLocked(uint8_t zone, uint8_t attempts) override {
+        printf("  zone %2u locked after %u ineffective cycles\n", zone, attempts);
+    }
+    void onPumpDeferred(uint8_t) override { deferrals++; }
+
+    uint32_t starts[ZONE_COUNT] = {};
+    uint32_t deferrals = 0;
+};
+
+struct ZoneReplay {
+    uint32_t steps = 0;
+    uint8_t maxRelaysOn = 0;
+    double stepNs = 0;
+    size_t uploadBytes = 0;
+};
+
+// Zone i dries by 1 count every 40 + 5i seconds and starts 5i counts
+// wetter than the dry threshold; a running pump wets by 20 counts a second.
+// Several zones are dry at once from the start, so the cap is exercised.
+ZoneReplay replayZones(uint32_t durationMs) {
+    FakeClock clock;
+    FakeGpio pins;
+    ShiftRegisterGpio relays(pins, SR_DATA_PIN, SR_CLOCK_PIN, SR_LATCH_PIN, ZONE_COUNT);
+    PumpConfig config;
+    ZoneSchedule schedule;
+    schedule.maxConcurrentPumps = ZONE_MAX_PUMPS;
+    schedule.startSpacingMs = 500;
+
+    Zone zones[ZONE_COUNT];
+    int32_t moisture[ZONE_COUNT];
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        zones[i].config = &config;
+        zones[i].relay = i;
+        moisture[i] = config.dryThreshold + 15 - 5 * i;
+    }
+
+    ZoneController controller(clock, relays, zones, ZONE_COUNT, schedule);
+    ZoneCounter counter;
+    controller.setListener(&counter);
+    relays.begin();
+    controller.begin();
+
+    ZoneReplay result;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t ms = 0; ms < durationMs; ms += STEP_MS) {
+        clock.set(ms);
+        for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+            if (ms % ((40 + 5 * i) * 1000) == 0) moisture[i]++;
+            if (relays.read(i) && i != BROKEN_ZONE && ms % 50 == 0) moisture[i]--;
+            controller.setMoisture(i, (uint16_t)(moisture[i] < 0 ? 0 : moisture[i]));
+        }
+        controller.update();
+        result.steps++;
+
+        uint8_t relaysOn = __builtin_popcount(relays.levels());
+        if (relaysOn > result.maxRelaysOn) result.maxRelaysOn = relaysOn;
+        if (relaysOn > ZONE_MAX_PUMPS) {
+            fprintf(stderr, "pump cap exceeded: %u running at %u ms\n", relaysOn, ms);
+            exit(1);
+        }
+    }
+    result.stepNs = nsPerOp(start, result.steps);
+
+    // One merge write per zone, as queued into a single commit
+    JsonDocument doc;
+    char zoneId[4];
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        const Zone& zone = controller.zone(i);
+        ZoneTelemetry telemetry;
+        telemetry.moisture = zone.moisture;
+        telemetry.pumpState = zone.state;
+        telemetry.activationMethod = zone.lastMethod;
+        telemetry.lockedFault = zone.persistent.lockedFault;
+        telemetry.noEffectCount = zone.persistent.noEffectCounter;
+        telemetry.lastPumpEndEpoch = zone.persistent.lastPumpEndEpoch;
+        telemetry.epoch = clock.epoch();
+        snprintf(zoneId, sizeof(zoneId), "%u", i);
+        buildZoneStatusFields(doc[zoneId].to<JsonObject>(), i, telemetry);
+    }
+    result.uploadBytes = measureJson(doc);
+
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        const Zone& zone = controller.zone(i);
+        printf("  zone %2u  %4u cycles  moisture %4u  %s\n", i, counter.starts[i], zone.moisture,
+               zone.persistent.lockedFault ? "LOCKED" : "ok");
+    }
+    printf("== %u steps, max %u of %u pumps at once, %u deferred starts, %u relay shifts\n",
+           result.steps, result.maxRelaysOn, ZONE_MAX_PUMPS, counter.deferrals,
+           relays.shiftCount());
+    return result;
+}
+
+struct DryingReplay {
+    uint32_t cycles = 0;
+    uint32_t predictions = 0;
+    double meanErrorHours = 0;
+    double stepNs = 0;
+};
+
+// A pot that dries 6 +- 5 counts an hour over the day (fastest at 15:00
+// UTC), read every minute with +-2 counts of noise and watered back by
+// 100 counts when it reaches the dry threshold. Predictions made at least
+// two hours before each crossing, from day 3 on, are scored.
+DryingReplay replayDryingModel(uint32_t days) {
+    FakeClock clock;
+    MemoryFileStore files;
+    DryingModelConfig config;
+    DryingModel model(files, clock, "/drying.bin", config);
+    model.begin();
+    PumpConfig pumpConfig;
+
+    const uint32_t stepSec = 60, settleSec = 1800;
+    double moisture = pumpConfig.wetThreshold;
+    uint32_t quietFromSec = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> predictions;  // (made at, predicted crossing), seconds
+    double errorHours = 0;
+    DryingReplay result;
+    srand(7);
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t steps = 0;
+    for (uint32_t sec = 0; sec < days * 86400; sec += stepSec, steps++) {
+        clock.set(sec * 1000);
+        double hour = (clock.epoch() % 86400) / 3600.0;
+        moisture += (6 + 5 * sin(2 * M_PI * (hour - 9) / 24)) * stepSec / 3600.0;
+        uint16_t reading = (uint16_t)(moisture + (rand() % 5) - 2);
+        bool quiet = sec >= quietFromSec;
+        model.observe(reading, quiet);
+
+        if (quiet && reading >= pumpConfig.dryThreshold) {
+            for (auto& prediction : predictions) {
+                if (sec - prediction.first >= 7200 && sec >= 3 * 86400) {
+                    errorHours += fabs((double)prediction.second - sec) / 3600.0;
+                    result.predictions++;
+                }
+            }
+            predictions.clear();
+            moisture -= 100;
+            model.recordCycle(100 + (rand() % 9) - 4, pumpConfig.pumpRunTimeMs);
+            quietFromSec = sec + settleSec;
+            result.cycles++;
+        } else if (quiet && sec % 3600 == 0) {
+            uint32_t seconds = model.secondsUntil(pumpConfig.dryThreshold, reading, clock.epoch());
+            if (seconds != DryingModel::NO_PREDICTION) predictions.push_back({sec, sec + seconds});
+        }
+    }
+    result.stepNs = nsPerOp(start, steps);
+    result.meanErrorHours = result.predictions ? errorHours / result.predictions : 0;
+
+    model.flush();
+    DryingModel restored(files, clock, "/drying.bin", config);
+    bool reloaded = restored.begin() && restored.meanRate() == model.meanRate() &&
+                    restored.observationCount() == model.observationCount();
+
+    printf("  drying rate  %5.2f counts/h mean (true 6.00), daily amplitude %4.2f (true 5.00)\n",
+           model.meanRate(), hypot(model.dailyCos(), model.dailySin()));
+    printf("  response     %5.1f counts per pump second (true 50.0)\n", model.response());
+    printf("== %u windows, %u skipped, %u cycles, crossing predicted to %.2f h (%u predictions), "
+           "reload %s\n", model.observationCount(), model.skippedWindows(), result.cycles,
+           result.meanErrorHours, result.predictions, reloaded ? "ok" : "FAILED");
+    return result;
+}
+
+// The firmware's task set, with a sync that blocks for 1.5 s (HTTPS
+// handshake) on every 60th run; task functions only cost virtual time
+FakeClock* taskClock = nullptr;
+uint32_t syncRuns = 0;
+
+void quickTask() {}
+void syncTask() {
+    if (++syncRuns % 60 == 0) taskClock->advance(1500);
+}
+
+struct SchedulerReplay {
+    uint32_t passes = 0;
+    double idlePct = 0;
+    double passNs = 0;
+};
+
+SchedulerReplay replayScheduler(uint32_t durationMs) {
+    FakeClock clock;
+    taskClock = &clock;
+    TaskScheduler scheduler(clock);
+    scheduler.add("web", quickTask, 20);
+    scheduler.add("sensor", quickTask, 250);
+    scheduler.add("button", quickTask, 20);
+    scheduler.add("led", quickTask, 50);
+    scheduler.add("wifi", quickTask, 100);
+    scheduler.add("sync", syncTask, 1000, 0, 2000);
+    scheduler.add("remote", quickTask, 5000, 500);
+    scheduler.add("batch", quickTask, 1000, 300);
+    scheduler.add("display", quickTask, 5000);
+    scheduler.add("pump", quickTask, 250);
+    scheduler.add("flush", quickTask, 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    while (clock.millis() < durationMs) {
+        clock.advance(scheduler.runDue());
+    }
+    SchedulerReplay result;
+    result.passes = scheduler.passCount();
+    result.idlePct = scheduler.idleMs() * 100.0 / clock.millis();
+    result.passNs = nsPerOp(start, result.passes);
+
+    for (uint8_t i = 0; i < scheduler.count(); i++) {
+        const TaskStats& task = scheduler.stats(i);
+        printf("  %-8s every %5u ms: %6u runs, %5u skipped, %3u overruns, max late %4u ms\n",
+               task.name, task.periodMs, task.runs, task.skipped, task.overruns, task.maxLateMs);
+    }
+    printf("== %u passes (a 10 ms polling loop: %u), idle %.1f%%\n", result.passes,
+           durationMs / STEP_MS, result.idlePct);
+    return result;
+}
+
+// A day of the loop with and without low-power mode: one report commit
+// (800 ms of TLS and upload) a minute, a 60 s pump cycle every 2 hours
+PowerManager* powerTarget = nullptr;
+uint32_t lastCommitMs = 0;
+
+void powerStep() {
+    bool pumping = taskClock->millis() % 7200000 < 60000;
+    powerTarget->update(pumping);
+}
+
+void commitStep() {
+    if (!powerTarget->networkAllowed() || taskClock->millis() - lastCommitMs < 60000) return;
+    lastCommitMs = taskClock->millis();
+    taskClock->advance(800);
+}
+
+struct PowerReplay {
+    float dutyCyclePct = 0;
+    float radioOnPct = 0;
+    uint32_t windows = 0;
+};
+
+PowerReplay replayPower(bool lowPower, uint32_t durationMs) {
+    FakeClock clock;
+    PowerConfig config;
+    config.lowPower = lowPower;
+    PowerManager power(clock, config);
+    taskClock = &clock;
+    powerTarget = &power;
+    lastCommitMs = 0;
+
+    TaskScheduler scheduler(clock);
+    scheduler.add("web", quickTask, lowPower ? 200 : 20);
+    scheduler.add("button", quickTask, lowPower ? 100 : 20);
+    scheduler.add("led", quickTask, lowPower ? 100 : 50);
+    scheduler.add("sensor", quickTask, 250);
+    scheduler.add("pump", quickTask, 250);
+    scheduler.add("sync", commitStep, 1000);
+    scheduler.add("power", powerStep, 100);
+    while (clock.millis() < durationMs) {
+        uint32_t idle = scheduler.runDue();
+        power.noteIdle(idle);
+        clock.advance(idle);
+    }
+
+    PowerReplay result;
+    result.dutyCyclePct = power.dutyCyclePct();
+    result.radioOnPct = power.radioOnPct();
+    result.windows = power.windowCount();
+    printf("  %-9s duty cycle %5.1f%%, radio on %5.1f%% (%u windows)\n",
+           lowPower ? "low power" : "full", result.dutyCyclePct, result.radioOnPct, result.windows);
+    return result;
+}
+
+std::vector<Sample> loadTrace(const char* path) {
+    std::vector<Sample> trace;
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(1);
+    }
+    unsigned long ms;
+    unsigned moisture;
+    char line[64];
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%lu,%u", &ms, &moisture) == 2) {
+            trace.push_back({(uint32_t)ms, (uint16_t)moisture});
+        }
+    }
+    fclose(file);
+    return trace;
+}
+
+// Soil dries by 1 count a minute; each pump second wets it by 20 counts
+std::vector<Sample> syntheticTrace(uint32_t durationMs) {
+    std::vector<Sample> trace;
+    for (uint32_t ms = 0; ms <= durationMs; ms += 60000) {
+        trace.push_back({ms, (uint16_t)(500 + ms / 60000)});
+    }
+    return trace;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--mqtt") == 0) {
+        return runMqttCheck(argv[2], argc >= 4 ? (unsigned)atoi(argv[3]) : 200);
+    }
+
+    bool synthetic = argc < 2;
+    std::vector<Sample> trace = synthetic ? syntheticTrace(6 * 3600000UL) : loadTrace(argv[1]);
+    if (trace.empty()) {
+        fprintf(stderr, "empty trace\n");
+        return 1;
+    }
+
+    FakeClock clock;
+    FakeGpio gpio;
+    PumpConfig config;
+    PumpController pump(clock, gpio, PUMP_PIN, config);
+    PrintingListener listener(clock);
+    pump.setListener(&listener);
+    pump.begin();
+
+    // Replay in 10 ms steps, holding each sample until the next one
+    printf("== Replay (%zu samples%s)\n", trace.size(), synthetic ? ", synthetic" : "");
+    uint32_t steps = 0;
+    int32_t wetting = 0;
+    auto replayStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < trace.size(); i++) {
+        for (uint32_t ms = trace[i].ms; ms < trace[i + 1].ms; ms += STEP_MS) {
+            clock.set(ms);
+            if (synthetic && gpio.read(PUMP_PIN) && ms % 50 == 0) wetting++;
+            int32_t moisture = (int32_t)trace[i].moisture - (synthetic ? wetting : 0);
+            pump.update((uint16_t)(moisture < 0 ? 0 : moisture));
+            steps++;
+        }
+    }
+    double stepNs = nsPerOp(replayStart, steps);
+    printf("== %u steps, %u pump cycles, %u state saves, fault=%s\n", steps, listener.starts,
+           listener.saves, pump.lockedFault() ? "LOCKED" : "no");
+
+    printf("\n== Zones (%u simulated, max %u pumps, zone %u pump broken)\n", ZONE_COUNT,
+           ZONE_MAX_PUMPS, BROKEN_ZONE);
+    ZoneReplay zoneReplay = replayZones(6 * 3600000UL);
+
+    printf("\n== Drying model (10 simulated days)\n");
+    DryingReplay dryingReplay = replayDryingModel(10);
+
+    printf("\n== Scheduler (1 simulated hour, sync blocks 1.5 s once a minute)\n");
+    SchedulerReplay schedulerReplay = replayScheduler(3600000UL);
+
+    printf("\n== Power (1 simulated day, a commit a minute, a pump cycle every 2 h)\n");
+    replayPower(false, 86400000UL);
+    replayPower(true, 86400000UL);
+
+    // Button decoding: a short press every 2 seconds
+    ButtonDecoder decoder(50, 5000, 800);
+    uint32_t actions = 0;
+    const uint32_t presses = 100000;
+    auto buttonStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < presses; i++) {
+        uint32_t t = i * 2000;
+        decoder.feed({t, true});
+        decoder.advance(t + 60);
+        decoder.feed({t + 120, false});
+        decoder.advance(t + 1000);
+        if (decoder.takeAction() != NONE) actions++;
+    }
+    double buttonNs = nsPerOp(buttonStart, presses);
+
+    // Firestore payloads: one log and one status document per sync
+    TelemetrySnapshot snapshot;
+    snapshot.moisture = 512;
+    snapshot.pumpState = pump.state();
+    snapshot.deviceState = ONLINE;
+    snapshot.activationMethod = ACTIVATION_AUTO;
+    snapshot.uptimeSec = 3600;
+    snapshot.epoch = clock.epoch();
+    const uint32_t payloads = 20000;
+    size_t bytes = 0;
+    auto payloadStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < payloads; i++) {
+        JsonDocument doc;
+        buildLogFields(doc["log"].to<JsonObject>(), snapshot);
+        buildStatusFields(doc["status"].to<JsonObject>(), snapshot);
+        bytes += measureJson(doc);
+    }
+    double payloadNs = nsPerOp(payloadStart, payloads);
+
+    // Offline queue: push and drain through the in-memory store
+    MemoryFileStore files;
+    TelemetryQueue queue(files, clock, "/telemetry.bin", "/telemetry.ack", 512, 60000);
+    queue.begin();
+    const uint32_t records = 20000;
+    auto queueStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < records; i++) {
+        TelemetryRecord record = {};
+        record.type = TELEMETRY_READING;
+        record.moisture = 500;
+        queue.push(record);
+        if (queue.pending() >= 8) {
+            TelemetryRecord batch[8];
+            uint32_t lastSeq;
+            queue.peek(batch, 8, lastSeq);
+            queue.ack(lastSeq);
+        }
+    }
+    double queueNs = nsPerOp(queueStart, records);
+
+    printf("\n== Host timings\n");
+    printf("  pump.update        %8.1f ns/step\n", stepNs);
+    printf("  zones.update       %8.1f ns/step (%u zones)\n", zoneReplay.stepNs, ZONE_COUNT);
+    printf("  zone upload        %8zu bytes/commit (%u writes)\n", zoneReplay.uploadBytes, ZONE_COUNT);
+    printf("  drying model       %8.1f ns/reading\n", dryingReplay.stepNs);
+    printf("  scheduler pass     %8.1f ns/pass\n", schedulerReplay.passNs);
+    printf("  button decode      %8.1f ns/press (%u actions)\n", buttonNs, actions);
+    printf("  log+status payload %8.1f ns/sync (%zu bytes)\n", payloadNs, bytes / payloads);
+    printf("  queue push/drain   %8.1f ns/record (%u file writes)\n", queueNs, files.writeCount());
+    return 0;
+}
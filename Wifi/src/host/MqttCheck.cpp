@@ -0,0 +1,230 @@
+#include "MqttCheck.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+#include "MqttClient.h"
+#include "PosixByteStream.h"
+
+namespace {
+
+const char* DEVICE_ID = "host-check";
+const uint32_t ACK_TIMEOUT_MS = 5000;
+const unsigned OFFLINE_COMMANDS = 10;
+
+class SteadyClock : public Clock {
+public:
+    uint32_t millis() override {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - _start).count();
+    }
+    uint32_t epoch() override { return (uint32_t)time(nullptr); }
+
+private:
+    std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+};
+
+double wallMs() {
+    timeval now;
+    gettimeofday(&now, nullptr);
+    return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+double steadyUs() {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Value of "key": in a flat JSON object written by this check
+std::string jsonValue(const char* json, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    const char* start = strstr(json, pattern.c_str());
+    if (!start) return "";
+    start += pattern.size();
+    if (*start == '"') start++;
+    size_t length = strcspn(start, "\",}");
+    return std::string(start, length);
+}
+
+// Acks every command on cmd/ack, as MqttLink does
+class DeviceSide : public MqttHandler {
+public:
+    explicit DeviceSide(MqttClient& client) : _client(client) {
+        snprintf(_commandTopic, sizeof(_commandTopic), "irrigation/%s/cmd", DEVICE_ID);
+        snprintf(_ackTopic, sizeof(_ackTopic), "irrigation/%s/cmd/ack", DEVICE_ID);
+    }
+
+    void onConnected(bool sessionPresent) override {
+        this->sessionPresent = sessionPresent;
+        if (!sessionPresent) _client.subscribe(_commandTopic, 1);
+    }
+
+    void onMessage(const char* topic, char* payload, size_t length, bool duplicate) override {
+        if (strcmp(topic, _commandTopic) != 0) return;
+        std::string id = jsonValue(payload, "id");
+        double latencyMs = wallMs() - atof(jsonValue(payload, "issuedAt").c_str());
+        if (duplicate) duplicates++;
+        commands++;
+
+        char ack[96];
+        int ackLength = snprintf(ack, sizeof(ack), "{\"id\":\"%s\",\"latencyMs\":%lu,\"duplicate\":%s}",
+                                 id.c_str(), (unsigned long)(latencyMs < 0 ? 0 : latencyMs),
+                                 duplicate ? "true" : "false");
+        _client.publish(_ackTopic, ack, ackLength);
+    }
+
+    unsigned commands = 0;
+    unsigned duplicates = 0;
+    bool sessionPresent = false;
+
+private:
+    MqttClient& _client;
+    char _commandTopic[64];
+    char _ackTopic[64];
+};
+
+class AppSide : public MqttHandler {
+public:
+    void onMessage(const char* topic, char* payload, size_t length, bool duplicate) override {
+        std::string id = jsonValue(payload, "id");
+        if (id.size() < 2) return;
+        unsigned index = (unsigned)atoi(id.c_str() + 1);
+        if (index < sentUs.size() && ackedUs[index] == 0) {
+            ackedUs[index] = steadyUs();
+            acked++;
+        }
+    }
+
+    std::vector<double> sentUs;
+    std::vector<double> ackedUs;
+    unsigned acked = 0;
+};
+
+// False when a connection that was up (or coming up) has gone
+bool pump(MqttClient& device, MqttClient& app) {
+    bool alive = true;
+    if (app.state() != MqttClient::DISCONNECTED) alive = app.loop();
+    if (device.state() != MqttClient::DISCONNECTED) alive = device.loop() && alive;
+    return alive;
+}
+
+template <typename Condition>
+bool waitFor(Clock& clock, MqttClient& device, MqttClient& app, uint32_t timeoutMs, Condition done) {
+    uint32_t start = clock.millis();
+    while (!done()) {
+        if (!pump(device, app) || clock.millis() - start > timeoutMs) return false;
+        usleep(100);
+    }
+    return true;
+}
+
+bool sendCommand(MqttClient& app, AppSide& appSide, const char* topic, unsigned index) {
+    char payload[96];
+    int length = snprintf(payload, sizeof(payload), "{\"id\":\"c%u\",\"waterNow\":true,\"issuedAt\":%.0f}",
+                          index, wallMs());
+    appSide.sentUs[index] = steadyUs();
+    return app.publish(topic, payload, length, false, 1);
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+}  // namespace
+
+int runMqttCheck(const char* broker, unsigned commands) {
+    std::string host = broker;
+    uint16_t port = 1883;
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        port = (uint16_t)atoi(host.c_str() + colon + 1);
+        host.resize(colon);
+    }
+
+    SteadyClock clock;
+    PosixByteStream deviceStream, appStream;
+    MqttClient device(deviceStream, clock), app(appStream, clock);
+    DeviceSide deviceSide(device);
+    AppSide appSide;
+    device.setHandler(&deviceSide);
+    app.setHandler(&appSide);
+
+    char commandTopic[64], ackTopic[64];
+    snprintf(commandTopic, sizeof(commandTopic), "irrigation/%s/cmd", DEVICE_ID);
+    snprintf(ackTopic, sizeof(ackTopic), "irrigation/%s/cmd/ack", DEVICE_ID);
+
+    // Start the device from an empty session, then keep it
+    MqttOptions deviceOptions;
+    deviceOptions.clientId = "host-check-device";
+    deviceOptions.cleanSession = true;
+    MqttOptions appOptions;
+    appOptions.clientId = "host-check-app";
+    appOptions.cleanSession = true;
+
+    printf("== MQTT check against %s:%u\n", host.c_str(), port);
+    if (!device.connect(host.c_str(), port, deviceOptions) ||
+        !waitFor(clock, device, app, 5000, [&] { return device.connected(); })) {
+        fprintf(stderr, "device could not connect (CONNACK %u)\n", device.connectResult());
+        return 1;
+    }
+    device.disconnect();
+    deviceOptions.cleanSession = false;
+    if (!device.connect(host.c_str(), port, deviceOptions) || !app.connect(host.c_str(), port, appOptions) ||
+        !waitFor(clock, device, app, 5000, [&] { return device.connected() && app.connected(); })) {
+        fprintf(stderr, "connect failed (device %u, app %u)\n", device.connectResult(), app.connectResult());
+        return 1;
+    }
+    app.subscribe(ackTopic, 0);
+    // SUBACKs have no callback; one round trip through the broker covers both
+    waitFor(clock, device, app, 200, [] { return false; });
+
+    unsigned total = commands + OFFLINE_COMMANDS;
+    appSide.sentUs.assign(total, 0);
+    appSide.ackedUs.assign(total, 0);
+
+    // Online: one command at a time, each timed until its ack
+    for (unsigned i = 0; i < commands; i++) {
+        if (!sendCommand(app, appSide, commandTopic, i) ||
+            !waitFor(clock, device, app, ACK_TIMEOUT_MS, [&] { return appSide.ackedUs[i] != 0; })) {
+            fprintf(stderr, "command c%u: no ack\n", i);
+            return 1;
+        }
+    }
+
+    // Offline: the broker holds QoS 1 commands for the persistent session
+    device.disconnect();
+    for (unsigned i = commands; i < total; i++) sendCommand(app, appSide, commandTopic, i);
+    waitFor(clock, device, app, 500, [&] { return app.unacknowledgedCount() == 0; });
+    unsigned beforeReconnect = deviceSide.commands;
+    if (!device.connect(host.c_str(), port, deviceOptions) ||
+        !waitFor(clock, device, app, ACK_TIMEOUT_MS, [&] { return appSide.acked == total; })) {
+        fprintf(stderr, "offline commands: %u of %u delivered after reconnect (session present: %s)\n",
+                deviceSide.commands - beforeReconnect, OFFLINE_COMMANDS,
+                deviceSide.sessionPresent ? "yes" : "no");
+        return 1;
+    }
+
+    std::vector<double> roundTripMs;
+    for (unsigned i = 0; i < commands; i++) {
+        roundTripMs.push_back((appSide.ackedUs[i] - appSide.sentUs[i]) / 1000.0);
+    }
+    printf("  online commands   %u acked, round trip p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", commands,
+           percentile(roundTripMs, 0.5), percentile(roundTripMs, 0.99), percentile(roundTripMs, 1.0));
+    printf("  offline commands  %u queued by the broker, %u delivered on reconnect (session present: %s)\n",
+           OFFLINE_COMMANDS, deviceSide.commands - beforeReconnect, deviceSide.sessionPresent ? "yes" : "no");
+    printf("  duplicates        %u, app publishes unacked %u\n", deviceSide.duplicates,
+           app.unacknowledgedCount());
+
+    device.disconnect();
+    app.disconnect();
+    return 0;
+}
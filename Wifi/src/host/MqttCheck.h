@@ -0,0 +1,13 @@
+/*
+ * MqttCheck - command round trip through a real MQTT broker
+ *
+ * A device-side and an app-side MqttClient connect to broker ("host" or
+ * "host:port"). The app sends commands QoS 1 to irrigation/<id>/cmd and
+ * times each one until the device's ack arrives on cmd/ack; then the
+ * device goes away, more commands are sent, and all of them must arrive
+ * once it reconnects to its persistent session. Returns the exit code.
+ */
+
+#pragma once
+
+int runMqttCheck(const char* broker, unsigned commands);
@@ -0,0 +1,96 @@
+/*
+ * PosixByteStream - ByteStream over a non-blocking TCP socket (host builds)
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+
+#include "Hal.h"
+
+class PosixByteStream : public ByteStream {
+public:
+    ~PosixByteStream() override { stop(); }
+
+    bool connect(const char* host, uint16_t port) override {
+        stop();
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        char service[8];
+        snprintf(service, sizeof(service), "%u", port);
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host, service, &hints, &addresses) != 0) return false;
+        for (addrinfo* address = addresses; address && _fd < 0; address = address->ai_next) {
+            int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0) continue;
+            if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                _fd = fd;
+            } else {
+                close(fd);
+            }
+        }
+        freeaddrinfo(addresses);
+        _peerClosed = false;
+        return _fd >= 0;
+    }
+
+    bool connected() override { return _fd >= 0 && !_peerClosed; }
+
+    size_t available() override {
+        if (_fd < 0) return 0;
+        int waiting = 0;
+        if (ioctl(_fd, FIONREAD, &waiting) == 0 && waiting > 0) return waiting;
+        // Nothing buffered: tell an idle socket from a closed one
+        uint8_t probe;
+        ssize_t n = recv(_fd, &probe, 1, MSG_PEEK);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) _peerClosed = true;
+        return n > 0 ? (size_t)n : 0;
+    }
+
+    size_t read(uint8_t* data, size_t length) override {
+        if (_fd < 0) return 0;
+        ssize_t n = recv(_fd, data, length, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) _peerClosed = true;
+        return n > 0 ? (size_t)n : 0;
+    }
+
+    // Small packets on a local socket: a short blocking retry is enough
+    size_t write(const uint8_t* data, size_t length) override {
+        size_t written = 0;
+        for (int attempts = 0; _fd >= 0 && written < length && attempts < 1000; attempts++) {
+            ssize_t n = send(_fd, data + written, length - written, MSG_NOSIGNAL);
+            if (n > 0) {
+                written += n;
+            } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                _peerClosed = true;
+                break;
+            } else {
+                usleep(1000);
+            }
+        }
+        return written;
+    }
+
+    void stop() override {
+        if (_fd >= 0) close(_fd);
+        _fd = -1;
+    }
+
+    int fd() const { return _fd; }
+
+private:
+    int _fd = -1;
+    bool _peerClosed = false;
+};
@@ -12,6 +12,30 @@
 #include <ESP8266HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <time.h>  // For NTP time sync
+#include "ArduinoHal.h"
+#include "IrrigationTypes.h"
+#include "PumpController.h"
+#include "MoistureSampler.h"
+#include "DryingModel.h"
+#include "FirestorePayload.h"
+#include "HttpsSession.h"
+#include "FirestoreBatch.h"
+#include "TelemetryQueue.h"
+#include "WiFiConnection.h"
+#include "ButtonDecoder.h"
+#include "SpscRing.h"
+#include "LoopMetrics.h"
+#include "TraceRecorder.h"
+#include "DashboardAsset.h"
+#include "StatusSnapshot.h"
+#include "FirestorePaths.h"
+#include "JsonArena.h"
+#include "StateJournal.h"
+#include "ReportPolicy.h"
+#include "ZoneBank.h"
+#include "MqttLink.h"
+#include "TaskScheduler.h"
+#include "PowerManager.h"
 
 // Hardware pin configuration
 constexpr uint8_t PUMP_CTRL_PIN = D1;      // ULN2003 IN1
@@ -24,35 +48,40 @@ String firebaseProjectId = "bloom-watch-d6878";
 String firebaseApiKey = "YOURAPIKEY";
 String firebaseDatabaseURL = "YOURDBURL"; //The old ones have been revoked
 String deviceId = "";           // Generated from MAC address
+String firestoreHost = "firestore.googleapis.com";  // Override with a local HTTPS stand-in for testing
+uint16_t firestorePort = 443;
+bool firestoreTls = true;          // false for a fleet gateway on the LAN (plain HTTP)
+#ifdef MQTT_TRANSPORT
+String mqttHost = "";              // Set to send telemetry and take commands over MQTT instead
+uint16_t mqttPort = 1883;
+String mqttUser = "";
+String mqttPass = "";
+#endif
+bool useMqtt = false;              // mqttHost configured (MQTT_TRANSPORT builds only)
+char configUpdateTime[32] = "";    // updateTime of the last applied config/settings document
+char commandsUpdateTime[32] = "";  // updateTime of the last handled commands/pending document
+uint32_t remoteTruncated = 0;      // batchGet requests or responses too large for their buffer (poll skipped)
+
+// Fields read from config/settings and commands/pending
+const char* const REMOTE_FIELD_MASK[] = {
+    "dryThreshold", "wetThreshold", "pumpRunTime", "minIntervalSec",
+    "adaptiveDosing", "maxPulseMs", "reportDeadband", "heartbeatSec", "lowPower",
+    "clearFault", "waterNow",
+#ifdef ZONE_COUNT
+    "waterZone",
+#endif
+};
 
 // File system paths
 const char* CONFIG_FILE = "/config.json";
-const char* PUMP_STATE_FILE = "/pump_state.json";
-
-// Device state machine
-enum DeviceState {
-    AWAITING_CONFIG,    // No WiFi config, portal active
-    ONLINE,             // Connected to WiFi and Firebase
-    OFFLINE,            // WiFi not available, operating locally
-    LOCKED_FAULT        // Critical fault detected, auto watering disabled
-};
-DeviceState deviceState = AWAITING_CONFIG;
+const char* PUMP_JOURNAL_FILE = "/pump_state.bin";
+const char* LEGACY_PUMP_STATE_FILE = "/pump_state.json";  // Migrated into the journal once
+const char* TELEMETRY_QUEUE_FILE = "/telemetry.bin";
+const char* TELEMETRY_ACK_FILE = "/telemetry.ack";
+const char* DRYING_MODEL_FILE = "/drying.bin";
 
-// Pump state machine
-enum PumpState {
-    MONITORING,         // Watching sensor, ready to water
-    PUMP_RUNNING,       // Actively pumping water
-    PUMP_WAITING        // Cooldown period after watering
-};
-PumpState pumpState = MONITORING;
-
-// Button state tracking
-enum ButtonAction {
-    NONE,
-    SHORT_PRESS,        // Manual watering
-    LONG_PRESS,         // Clear fault
-    TRIPLE_PRESS        // Force WiFi reset
-};
+// Device state machine (states in IrrigationTypes.h)
+DeviceState deviceState = AWAITING_CONFIG;
 
 // LED blink patterns
 enum LedPattern {
@@ -67,69 +96,182 @@ enum LedPattern {
 };
 LedPattern currentLedPattern = LED_OFF;
 
-// Configuration parameters (can be updated via Firestore)
-uint16_t DRY_THRESHOLD = 520;           // Moisture level to trigger watering
-uint16_t WET_THRESHOLD = 420;           // Moisture level when soil is wet
-unsigned long PUMP_RUN_TIME = 2000;     // 2 seconds pump runtime
-unsigned long MIN_INTERVAL_SEC = 30;    // 60 seconds minimum between pump activations (production default)
-uint8_t MAX_NO_EFFECT_REPEATS = 10;     // 10 consecutive failures triggers fault (increased for stability)
-unsigned long PUMP_SETTLE_MS = 20000;   // 20 seconds wait after pump to re-read sensor
+// Remote commands acted on from one commands document or message
+struct RemoteCommands {
+    bool clearFault = false;
+    bool waterNow = false;
+    bool waterZone = false;
+    bool any() const { return clearFault || waterNow || waterZone; }
+};
+
+// Configuration parameters (can be updated via Firestore; defaults in PumpConfig)
+PumpConfig pumpConfig;
+SamplerConfig samplerConfig;            // Sensor sampling (sampleIntervalMs in config.json)
+ReportConfig reportConfig;              // Telemetry deadband/heartbeat (reportDeadband, heartbeatSec)
+DryingModelConfig dryingConfig;         // Drying-rate and pump-response estimator
+PowerConfig powerConfig;                // Radio sleep and network windows (lowPower)
 
 // Timing constants
 const unsigned long PORTAL_TIMEOUT = 300000;        // 5 minutes
-const unsigned long DATA_SEND_INTERVAL = 30000;     // 30 seconds (data logging interval)
+const unsigned long REPORT_CHECK_INTERVAL = 1000;   // How often the report policy is consulted
 const unsigned long CONFIG_CHECK_INTERVAL = 5000;  // 5 seconds (check for Firestore config updates)
 const unsigned long DISPLAY_INTERVAL = 5000;        // 5 seconds (status display interval)
-const unsigned long WIFI_CHECK_INTERVAL = 5000;     // 5 seconds
 const unsigned long BUTTON_DEBOUNCE_MS = 50;        // 50ms debounce
 const unsigned long LONG_PRESS_MS = 5000;           // 5 second long press
 const unsigned long TRIPLE_PRESS_WINDOW = 800;      // 0.8 second window for triple press (more responsive)
+const unsigned long BATCH_FLUSH_DEADLINE_MS = 30000;  // Max time a queued Firestore write waits
+const size_t BATCH_MAX_WRITES = 10;                 // Flush early once this many writes are queued
+#ifdef ZONE_COUNT
+const size_t BATCH_ARENA_SIZE = 6144 + ZONE_COUNT * 384;  // Plus one merge write per zone
+#else
+const size_t BATCH_ARENA_SIZE = 6144;               // Static JSON memory for queued writes
+#endif
+#ifdef ZONE_COUNT
+const size_t BATCH_BODY_SIZE = 4096 + ZONE_COUNT * 384;
+#else
+const size_t BATCH_BODY_SIZE = 4096;                // Serialized documents:commit request
+#endif
+const size_t SCRATCH_ARENA_SIZE = 3072;             // Static JSON memory for short-lived documents
+// batchGet response buffer. Firestore pretty-prints: with every masked field
+// set, the config and commands documents come to ~1.5 KB (names, three
+// timestamps each and ~65 bytes per field), so leave room for long project
+// ids and fields added later
+const size_t REMOTE_RESPONSE_SIZE = 2560;
+// batchGet request: both document names at full FirestorePaths capacity,
+// the field mask (~190 bytes) and the JSON around them
+const size_t REMOTE_REQUEST_SIZE = 2 * sizeof(FirestorePaths::configName) + 320;
+const unsigned long OFFLINE_LOG_INTERVAL = 300000;  // 5 minutes (reading stored while offline)
+const unsigned long QUEUE_DRAIN_INTERVAL = 10000;   // 10 seconds between backlog uploads
+const size_t QUEUE_DRAIN_BATCH = 8;                 // Stored records per backlog upload
+const uint16_t QUEUE_CAPACITY = 512;                // Ring slots (20 bytes each)
+const uint16_t QUEUE_MAX_WRITES_PER_HOUR = 30;      // Flash wear limit for the offline queue
+const uint16_t PUMP_JOURNAL_SLOTS = 64;             // Journal slots (16 bytes each)
+const uint32_t PUMP_STATE_COALESCE_MS = 5000;       // Pump state updates merged into one flash write
+const uint32_t RTC_PUMP_SHADOW_OFFSET = 0;          // Byte offset of the journal shadow in RTC memory
+const uint32_t RELAXED_SAMPLE_INTERVAL_MS = 60000;  // Sensor interval while the dry crossing is far off
+const uint32_t DRY_PREDICTION_LEAD_SEC = 1800;      // Back to full-rate sampling this long before it
+const unsigned long PREDICTION_INTERVAL = 60000;    // How often the sampling rate is reconsidered
+
+// Task periods (loop() runs only what is due, then idles until the next deadline)
+const uint32_t WEB_POLL_MS = 20;                    // Bounds request latency while idle
+const uint32_t BUTTON_POLL_MS = 20;                 // Edges are queued by interrupt; this decodes them
+const uint32_t LED_UPDATE_MS = 50;                  // Patterns are built from 100 ms steps
+const uint32_t WIFI_CHECK_MS = 100;
+const uint32_t MQTT_POLL_MS = 20;
+const uint32_t PUMP_ACTIVE_MS = 50;                 // Pump step while running or settling (pulse resolution)
+const uint32_t PUMP_IDLE_MS = 250;                  // While monitoring; each new sample also wakes it
+const uint32_t ZONE_STEP_MS = 50;
+const uint32_t BATCH_CHECK_MS = 1000;               // Queued Firestore writes (30 s deadline)
+const uint32_t FLUSH_CHECK_MS = 1000;               // Pump journal and drying model saves
+const uint32_t POWER_CHECK_MS = 100;                // Radio mode and network windows
+
+// Stretched in low-power mode so the CPU can light-sleep between tasks
+const uint32_t LOW_POWER_WEB_POLL_MS = 200;
+const uint32_t LOW_POWER_BUTTON_POLL_MS = 100;
+const uint32_t LOW_POWER_LED_UPDATE_MS = 100;
+const uint32_t LOW_POWER_WIFI_CHECK_MS = 500;
+const uint32_t LOW_POWER_MQTT_POLL_MS = 250;
+
+// WiFi reconnect backoff (exponential with jitter)
+const unsigned long WIFI_BACKOFF_BASE_MS = 2000;    // 2 seconds after the first failure
+const unsigned long WIFI_BACKOFF_MAX_MS = 300000;   // 5 minutes cap
+const unsigned long WIFI_ATTEMPT_TIMEOUT_MS = 15000; // Give up on a single attempt after 15 seconds
+
+// Global state variables
+// Hardware abstraction (the same interfaces have fakes for host builds)
+ArduinoClock boardClock;
+ArduinoGpio boardGpio;
+ArduinoAdc boardAdc;
+LittleFsStore boardFiles;
+EspRtcMemory boardRtc;
 
-// Smart Retry Intervals (exponential backoff)
-const unsigned long RETRY_INTERVAL_1 = 3600000;     // 1 hour
-const unsigned long RETRY_INTERVAL_2 = 21600000;    // 6 hours
-const unsigned long RETRY_INTERVAL_3 = 86400000;    // 24 hours// Global state variables
 // WiFi & Connectivity
 WiFiManager wm;
 ESP8266WebServer server(80);
+HttpsSession firestore;         // Shared keep-alive connection for all Firestore requests
+FirestorePaths firestorePaths;  // URLs and document names, built once at boot
+
+// JSON documents draw from fixed buffers instead of the heap
+StaticJsonArena<BATCH_ARENA_SIZE> batchArena;
+StaticJsonArena<SCRATCH_ARENA_SIZE> scratchArena;
+FirestoreBatch firestoreBatch(&batchArena);  // Queued writes, sent as one documents:commit
+char batchBody[BATCH_BODY_SIZE];             // Commit request body, serialized in place
+StateJournal pumpJournal(boardFiles, boardClock, &boardRtc, RTC_PUMP_SHADOW_OFFSET,
+                         PUMP_JOURNAL_FILE, PUMP_JOURNAL_SLOTS, PUMP_STATE_COALESCE_MS);
+TelemetryQueue telemetryQueue(boardFiles, boardClock, TELEMETRY_QUEUE_FILE, TELEMETRY_ACK_FILE,
+                              QUEUE_CAPACITY, QUEUE_MAX_WRITES_PER_HOUR);  // Offline store-and-forward
+WiFiConnection wifiLink(WIFI_BACKOFF_BASE_MS, WIFI_BACKOFF_MAX_MS, WIFI_ATTEMPT_TIMEOUT_MS);
 bool wifiConnected = false;
-unsigned long lastReconnectAttempt = 0;
-unsigned long nextRetryInterval = RETRY_INTERVAL_1;
-uint8_t retryCount = 0;
-
-// Timing trackers
-unsigned long lastDataSend = 0;
-unsigned long lastConfigCheck = 0;
-unsigned long lastDisplayTime = 0;
-unsigned long lastWiFiCheck = 0;
-unsigned long lastLedUpdate = 0;
-
-// Pump state tracking
-unsigned long pumpStartTime = 0;
-unsigned long lastPumpEndEpoch = 0;     // Epoch seconds of last pump stop
-unsigned long lastPumpActionTime = 0;
-uint16_t moistureBeforePump = 0;
-uint8_t noEffectCounter = 0;
-bool lockedFault = false;
-String lastActivationMethod = "NONE";
-
-// Button tracking
-bool buttonPressed = false;
-unsigned long buttonPressStart = 0;
-unsigned long lastButtonPress = 0;
-uint8_t pressCount = 0;
-bool longPressHandled = false;
+
+// Everything loop() does, as periodic tasks (registered in registerTasks)
+TaskScheduler scheduler(boardClock);
+uint8_t sensorTaskId = TaskScheduler::NO_TASK;
+uint8_t pumpTaskId = TaskScheduler::NO_TASK;
+uint8_t webTaskId = TaskScheduler::NO_TASK;
+uint8_t buttonTaskId = TaskScheduler::NO_TASK;
+uint8_t ledTaskId = TaskScheduler::NO_TASK;
+uint8_t wifiTaskId = TaskScheduler::NO_TASK;
+uint8_t mqttTaskId = TaskScheduler::NO_TASK;
+uint8_t syncTaskId = TaskScheduler::NO_TASK;
+uint8_t remoteTaskId = TaskScheduler::NO_TASK;
+uint8_t drainTaskId = TaskScheduler::NO_TASK;
+uint8_t batchTaskId = TaskScheduler::NO_TASK;
+uint8_t powerTaskId = TaskScheduler::NO_TASK;
+
+// Low-power mode: network work batched into short windows, radio dozing between them
+PowerManager power(boardClock, powerConfig);
+RadioMode appliedRadioMode = RADIO_AWAKE;
+uint32_t lastWindowCount = 0;
+
+// Pump state machine, safety interval and fault lockout
+PumpController pump(boardClock, boardGpio, PUMP_CTRL_PIN, pumpConfig);
+
+// Single reader of the moisture sensor; everything else uses its snapshot
+MoistureSampler moistureSampler(boardAdc, boardClock, SENSOR_PIN, samplerConfig);
+uint32_t lastHttpRequestCount = 0;
+
+// Learns how fast this pot dries and predicts the next dry crossing
+DryingModel dryingModel(boardFiles, boardClock, DRYING_MODEL_FILE, dryingConfig);
+uint32_t lastModelSequence = 0;
+unsigned long lastPrediction = 0;
+uint32_t secondsToDry = DryingModel::NO_PREDICTION;
+float dryRateNow = 0;                   // Counts/hour expected at this time of day
+
+// Change-driven telemetry
+ReportPolicy reportPolicy(reportConfig);
+
+// /status body, refreshed once per loop tick
+StatusCache statusCache;
+
+#ifdef LOOP_METRICS
+unsigned long drySinceMs = 0;           // First dry reading not yet answered by the pump
+#endif
+
+// Button tracking (edges captured by interrupt, decoded in the loop)
+SpscRing<ButtonEdge, 32> buttonEdges;
+ButtonDecoder buttonDecoder(BUTTON_DEBOUNCE_MS, LONG_PRESS_MS, TRIPLE_PRESS_WINDOW);
+volatile uint32_t buttonEdgeOverflows = 0;
 
 // LED tracking
 bool ledState = false;
 unsigned long ledBlinkStart = 0;
 
 // Function declarations
+// Main loop stages
+void registerTasks();
+void applyPowerMode();
+void sampleMoisture();
+void publishStatus();
+void handleButton(ButtonAction action);
+void printStatusLine();
+
 // Device initialization
 void initializeFileSystem();
 void generateDeviceId();
 void loadOrCreateConfig();
+void saveConfig();
 void loadPumpState();
+bool loadLegacyPumpState(PumpPersistentState& state);
 void savePumpState();
 
 // WiFi management
@@ -137,26 +279,36 @@ void setupWiFi();
 void startConfigurationPortal();
 void attemptWiFiConnection();
 void checkWiFi();
-void handleSmartRetry();
+void handleWiFiConnected();
+void handleWiFiLost();
 
 // Hardware I/O
+void IRAM_ATTR onButtonEdge();
 ButtonAction readButton();
 void updateLED();
 void setLedPattern(LedPattern pattern);
 
 // Pump control
-void handlePumpStateMachine();
+void setupPump();
+uint16_t readMoisture();
 bool checkPumpSafety();
-void activatePump(const String& method);
-void checkPumpEffectiveness();
+void activatePump(ActivationMethod method);
 
 // Firestore integration
 void syncWithFirestore();
-void sendDataToFirestore(uint16_t moisture, const String& pumpStatus, const String& activationMethod);
-void updateMainDeviceStatus(uint16_t moisture, const String& pumpStatus);
-void checkForConfigUpdates();
-void checkForRemoteCommands();
-void logEventToFirestore(const String& eventType, const String& details);
+TelemetrySnapshot captureTelemetry();
+void sendDataToFirestore(const TelemetrySnapshot& snapshot);
+void updateMainDeviceStatus(const TelemetrySnapshot& snapshot);
+void checkForRemoteUpdates();
+bool applyConfigUpdate(JsonObject fields);
+RemoteCommands applyRemoteCommands(JsonObject fields);
+void logEventToFirestore(const char* eventType, const char* details);
+
+// Offline store-and-forward
+void queueOfflineReading();
+void queueOfflineEvent(const char* eventType);
+void drainTelemetryQueue();
+bool queueRecordToFirestore(const TelemetryRecord& record);
 
 // Web server
 void setupWebServer();
@@ -165,27 +317,57 @@ void handleGetStatus();
 void handleManualWater();
 void handleClearFault();
 void handleResetWiFi();
+#ifdef TRACE_EVENTS
+void handleGetTrace();
+#endif
+void handleGetTasks();
 
 // Utility
-String getDeviceStateString();
-String getPumpStateString();
 unsigned long getCurrentEpoch();
 
+#ifdef MQTT_TRANSPORT
+// Pushed commands and config (replaces the batchGet poll when useMqtt)
+void onMqttCommand(JsonObject fields);
+void onMqttConfig(JsonObject fields);
+MqttLink mqttLink(boardClock, scratchArena, onMqttCommand, onMqttConfig);
+
+// Fill typed fields with a FirestorePayload builder and publish them flat
+template <typename Builder>
+bool publishToMqtt(const char* subtopic, bool retain, Builder build) {
+    JsonDocument doc(&scratchArena);
+    JsonObject fields = doc.to<JsonObject>();
+    build(fields);
+    return mqttLink.publishFields(subtopic, fields, retain);
+}
+#endif
+
+#ifdef ZONE_COUNT
+// Expander zones (ADS1115 sensors, 74HC595 relays) sharing pumpConfig
+ZoneBank zoneBank(boardClock, boardGpio, boardFiles, pumpConfig, logEventToFirestore);
+unsigned long lastZoneReport = 0;
+
+void handleGetZones();
+void handleWaterZone();
+#endif
+
 // Setup
 void setup() {
     Serial.begin(115200);
     delay(2000);
-    Serial.println("\n\n====================================");
-    Serial.println("SMART IRRIGATION SYSTEM v3.0");
-    Serial.println("Phase 1: Full Design Implementation");
-    Serial.println("====================================\n");
+    Serial.println(F("\n\n===================================="));
+    Serial.println(F("SMART IRRIGATION SYSTEM v3.0"));
+    Serial.println(F("Phase 1: Full Design Implementation"));
+    Serial.println(F("====================================\n"));
     
     // Initialize hardware pins
-    pinMode(PUMP_CTRL_PIN, OUTPUT);
-    pinMode(BUTTON_PIN, INPUT_PULLUP);
-    pinMode(LED_PIN, OUTPUT);
-    digitalWrite(PUMP_CTRL_PIN, LOW);
-    digitalWrite(LED_PIN, LOW);
+    setupPump();
+    boardGpio.setInputPullup(BUTTON_PIN);
+    boardGpio.setOutput(LED_PIN);
+    boardGpio.write(LED_PIN, false);
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onButtonEdge, CHANGE);
+    
+    // Hardware RNG seed so reconnect jitter differs between devices
+    randomSeed(RANDOM_REG32);
     
     // Initialize file system
     initializeFileSystem();
@@ -193,14 +375,54 @@ void setup() {
     // Generate unique device ID from MAC
     generateDeviceId();
     
-    Serial.println("Device ID: " + deviceId);
-    Serial.println("Firestore Path: plantData/" + deviceId);
+    Serial.printf_P(PSTR("Device ID: %s\n"), deviceId.c_str());
+    Serial.printf_P(PSTR("Firestore Path: plantData/%s\n"), deviceId.c_str());
     
     // Load configuration from LittleFS
     loadOrCreateConfig();
+    firestore.begin(firestoreHost, firestorePort, firestoreTls);
+    firestoreBatch.begin(firestore, BATCH_MAX_WRITES, BATCH_FLUSH_DEADLINE_MS,
+                         batchBody, sizeof(batchBody));
+    if (!firestorePaths.build(firebaseProjectId.c_str(), firebaseApiKey.c_str(), deviceId.c_str())) {
+        Serial.println(F("⚠ Firestore project id or API key too long - paths truncated"));
+    }
+    firestoreBatch.setDatabase(firestorePaths);
+#ifdef MQTT_TRANSPORT
+    useMqtt = mqttHost.length() > 0;
+    if (useMqtt) {
+        mqttLink.begin(mqttHost.c_str(), mqttPort, mqttUser.c_str(), mqttPass.c_str(), deviceId.c_str());
+        Serial.printf_P(PSTR("MQTT: %s:%u, topics irrigation/%s/#\n"), mqttHost.c_str(), mqttPort,
+                        deviceId.c_str());
+    }
+#endif
+#ifdef LOOP_METRICS
+    loopMetrics.watchArena("batch", batchArena);
+    loopMetrics.watchArena("scratch", scratchArena);
+#endif
+    
+    // First filtered reading before anything needs it
+    moistureSampler.begin();
     
     // Load pump state (maintains history across reboots)
     loadPumpState();
+#ifdef ZONE_COUNT
+    zoneBank.restore();
+#endif
+    if (dryingModel.begin()) {
+        Serial.printf_P(PSTR("✓ Drying model loaded (%lu windows, %.2f counts/h, %lu cycles)\n"),
+                        (unsigned long)dryingModel.observationCount(), dryingModel.meanRate(),
+                        (unsigned long)dryingModel.cycleCount());
+    } else {
+        Serial.println(F("ℹ No drying model saved - learning from scratch"));
+    }
+    
+    // Readings and events stored during earlier outages
+    if (telemetryQueue.begin()) {
+        Serial.printf_P(PSTR("✓ Telemetry queue ready (%u pending, %u slots)\n"),
+                      (unsigned)telemetryQueue.pending(), telemetryQueue.capacity());
+    } else {
+        Serial.println(F("✗ Telemetry queue: cannot create ring file"));
+    }
     
     // Setup WiFi
     setupWiFi();
@@ -209,62 +431,377 @@ void setup() {
     // Setup web server
     setupWebServer();
     
-    Serial.println("\n====================================");
-    Serial.println("INITIALIZATION COMPLETE");
-    Serial.println("State: " + getDeviceStateString());
-    Serial.printf("Safety Interval: %lu seconds\n", MIN_INTERVAL_SEC);
-    Serial.println("====================================");
-    Serial.println("ℹ Adjust MIN_INTERVAL_SEC via:");
-    Serial.println("  • Web App Dashboard");
-    Serial.println("  • Firestore: plantData/" + deviceId + "/config/settings");
-    Serial.println("  • Set minIntervalSec to 0-3600 seconds");
-    Serial.println("====================================\n");
+    Serial.println(F("\n===================================="));
+    Serial.println(F("INITIALIZATION COMPLETE"));
+    Serial.printf_P(PSTR("State: %s\n"), deviceStateName(deviceState));
+    Serial.printf_P(PSTR("Safety Interval: %lu seconds\n"), (unsigned long)pumpConfig.minIntervalSec);
+    Serial.println(F("===================================="));
+    Serial.println(F("ℹ Adjust minIntervalSec via:"));
+    Serial.println(F("  • Web App Dashboard"));
+    Serial.printf_P(PSTR("  • Firestore: plantData/%s/config/settings\n"), deviceId.c_str());
+    Serial.println(F("  • Set minIntervalSec to 0-3600 seconds"));
+    Serial.println(F("====================================\n"));
+    
+    registerTasks();
 }
 
-// Main loop
+// Main loop: run the tasks that are due, then idle until the next deadline
+// (delay() yields to the WiFi stack meanwhile)
 void loop() {
-    unsigned long currentTime = millis();
-    
-    // Handle web server
+    uint32_t idleMs;
+    {
+        LOOP_BEGIN();
+        idleMs = scheduler.runDue();
+        LOOP_END();
+    }
+    power.noteIdle(idleMs);
+    delay(idleMs);  // Light sleep in here when the radio is dozing
+}
+
+// Scheduled tasks
+
+// Firestore and MQTT traffic; allowed in LOCKED_FAULT so clear commands still arrive
+bool cloudReachable() {
+    return wifiConnected && (deviceState == ONLINE || deviceState == LOCKED_FAULT);
+}
+
+// Batched network work: inside a window in low-power mode, otherwise whenever reachable
+bool networkWindow() {
+    return cloudReachable() && power.networkAllowed();
+}
+
+void webTask() {
+    LOOP_STAGE(STAGE_WEB);
     server.handleClient();
+}
+
+// Sample the moisture sensor (deferred right after Firestore traffic)
+void sensorTask() {
+    LOOP_STAGE(STAGE_SENSOR);
+    uint32_t sequence = moistureSampler.snapshot().sequence;
+    sampleMoisture();
+    if (moistureSampler.snapshot().sequence != sequence) scheduler.wake(pumpTaskId);
+    scheduler.runIn(sensorTaskId, moistureSampler.msUntilDue());
+}
+
+void buttonTask() {
+    LOOP_STAGE(STAGE_BUTTON);
+    handleButton(readButton());
+}
+
+void ledTask() {
+    LOOP_STAGE(STAGE_LED);
+    updateLED();
+}
+
+// WiFi management (non-blocking; reconnects with backoff)
+void wifiTask() {
+    if (deviceState == AWAITING_CONFIG) return;
+    LOOP_STAGE(STAGE_WIFI);
+    checkWiFi();
+}
+
+#ifdef MQTT_TRANSPORT
+// Commands and config arrive as they are published
+void mqttTask() {
+    if (!useMqtt || !cloudReachable()) return;
+    LOOP_STAGE(STAGE_REMOTE);
+    mqttLink.loop();
+}
+#endif
+
+// Report on change, otherwise on a slow heartbeat
+void syncTask() {
+    if (!cloudReachable()) return;
+    LOOP_STAGE(STAGE_SYNC);
+    syncWithFirestore();
+}
+
+// Poll for config updates and remote commands (pushed over MQTT instead)
+void remoteTask() {
+    if (useMqtt || !networkWindow()) return;
+    LOOP_STAGE(STAGE_REMOTE);
+    checkForRemoteUpdates();
+}
+
+// Upload readings stored while offline, a few at a time
+void drainTask() {
+    if (!networkWindow() || telemetryQueue.pending() == 0) return;
+    LOOP_STAGE(STAGE_QUEUE);
+    drainTelemetryQueue();
+}
+
+// Send queued events once their deadline passes; in low-power mode
+// everything queued goes out with the window
+void batchTask() {
+    if (!networkWindow()) return;
+    LOOP_STAGE(STAGE_QUEUE);
+    if (powerConfig.lowPower) {
+        firestoreBatch.flush();
+    } else {
+        firestoreBatch.flushIfDue();
+    }
+}
+
+// Keep a sparse reading history while offline
+void offlineLogTask() {
+    if (wifiConnected || deviceState == AWAITING_CONFIG) return;
+    LOOP_STAGE(STAGE_QUEUE);
+    queueOfflineReading();
+}
+
+void displayTask() {
+    LOOP_STAGE(STAGE_DISPLAY);
+    printStatusLine();
+}
+
+// Pump state machine (core irrigation logic), then the /status view;
+// stepped quickly while a cycle is under way
+void pumpTask() {
+    LOOP_STAGE(STAGE_PUMP);
+    pump.update(readMoisture());
+    publishStatus();
+    scheduler.runIn(pumpTaskId, pump.state() == MONITORING ? PUMP_IDLE_MS : PUMP_ACTIVE_MS);
+}
+
+#ifdef ZONE_COUNT
+void zoneTask() {
+    LOOP_STAGE(STAGE_PUMP);
+    zoneBank.update(pump.state() == PUMP_RUNNING);
+}
+#endif
+
+void flushTask() {
+    LOOP_STAGE(STAGE_PUMP);
+    pumpJournal.flushIfDue();
+    dryingModel.flushIfDue();
+}
+
+void applyRadioMode(RadioMode mode) {
+    if (mode == appliedRadioMode) return;
+    if (mode == RADIO_DOZE) {
+        WiFi.setSleepMode(WIFI_LIGHT_SLEEP, powerConfig.listenInterval);
+    } else {
+        WiFi.setSleepMode(WIFI_NONE_SLEEP);
+    }
+    appliedRadioMode = mode;
+}
+
+// Radio awake through pump cycles (precise timing) and reconnects; network
+// tasks run at once when a window opens
+void powerTask() {
+    bool stayAwake = pump.state() != MONITORING || !wifiConnected;
+#ifdef ZONE_COUNT
+    stayAwake = stayAwake || zoneBank.controller().runningCount() > 0;
+#endif
+    applyRadioMode(power.update(stayAwake));
+    
+    if (power.windowCount() != lastWindowCount) {
+        lastWindowCount = power.windowCount();
+        scheduler.wake(syncTaskId);
+        scheduler.wake(remoteTaskId);
+        scheduler.wake(drainTaskId);
+        scheduler.wake(batchTaskId);
+    }
+}
+
+// Task periods and radio mode for powerConfig.lowPower
+void applyPowerMode() {
+    bool low = powerConfig.lowPower;
+    scheduler.setPeriod(webTaskId, low ? LOW_POWER_WEB_POLL_MS : WEB_POLL_MS);
+    scheduler.setPeriod(buttonTaskId, low ? LOW_POWER_BUTTON_POLL_MS : BUTTON_POLL_MS);
+    scheduler.setPeriod(ledTaskId, low ? LOW_POWER_LED_UPDATE_MS : LED_UPDATE_MS);
+    scheduler.setPeriod(wifiTaskId, low ? LOW_POWER_WIFI_CHECK_MS : WIFI_CHECK_MS);
+    scheduler.setPeriod(mqttTaskId, low ? LOW_POWER_MQTT_POLL_MS : MQTT_POLL_MS);
+    scheduler.wake(powerTaskId);
+    Serial.printf_P(PSTR("✓ Power mode: %s\n"), low ? "low (network every 60 s, radio dozing)" : "full");
+}
+
+void registerTasks() {
+    webTaskId = scheduler.add("web", webTask, WEB_POLL_MS);
+    sensorTaskId = scheduler.add("sensor", sensorTask, samplerConfig.intervalMs);
+    buttonTaskId = scheduler.add("button", buttonTask, BUTTON_POLL_MS);
+    ledTaskId = scheduler.add("led", ledTask, LED_UPDATE_MS);
+    wifiTaskId = scheduler.add("wifi", wifiTask, WIFI_CHECK_MS);
+#ifdef MQTT_TRANSPORT
+    mqttTaskId = scheduler.add("mqtt", mqttTask, MQTT_POLL_MS);
+#endif
+    // Blocking HTTPS work: budgets above the period, offset from each other
+    syncTaskId = scheduler.add("sync", syncTask, REPORT_CHECK_INTERVAL, 0, 2000);
+    remoteTaskId = scheduler.add("remote", remoteTask, CONFIG_CHECK_INTERVAL, 500, 2000);
+    drainTaskId = scheduler.add("drain", drainTask, QUEUE_DRAIN_INTERVAL, 700, 2000);
+    batchTaskId = scheduler.add("batch", batchTask, BATCH_CHECK_MS, 300, 2000);
+    scheduler.add("offline", offlineLogTask, OFFLINE_LOG_INTERVAL, OFFLINE_LOG_INTERVAL);
+    scheduler.add("display", displayTask, DISPLAY_INTERVAL);
+    pumpTaskId = scheduler.add("pump", pumpTask, PUMP_IDLE_MS);
+#ifdef ZONE_COUNT
+    scheduler.add("zones", zoneTask, ZONE_STEP_MS);
+#endif
+    scheduler.add("flush", flushTask, FLUSH_CHECK_MS, 0, 100);
+    powerTaskId = scheduler.add("power", powerTask, POWER_CHECK_MS);
+    Serial.printf_P(PSTR("✓ %u tasks scheduled\n"), scheduler.count());
+    applyPowerMode();
+}
+
+void publishStatus() {
+    DeviceStatus status;
+    strlcpy(status.deviceId, deviceId.c_str(), sizeof(status.deviceId));
+    const MoistureSnapshot& sample = moistureSampler.snapshot();
+    status.moisture = sample.moisture;
+    status.stateFlashWrites = pumpJournal.flashWriteCount();
+    status.stateCoalesced = pumpJournal.coalescedCount();
+    status.reportsSent = reportPolicy.sentCount();
+    status.reportsSuppressed = reportPolicy.suppressedCount();
+    status.reportStretch = reportPolicy.currentStretch();
+    status.pumpState = pump.state();
+    status.deviceState = deviceState;
+    status.wifiConnected = wifiConnected;
+    status.lockedFault = pump.lockedFault();
+    status.dryThreshold = pumpConfig.dryThreshold;
+    status.wetThreshold = pumpConfig.wetThreshold;
+    status.pumpRunTimeMs = pumpConfig.pumpRunTimeMs;
+    status.minIntervalSec = pumpConfig.minIntervalSec;
+    status.httpsHandshakes = firestore.handshakeCount();
+    status.httpsReused = firestore.reusedCount();
+    status.httpsConnectFailures = firestore.connectFailureCount();
+    status.httpsFailures = firestore.failureCount();
+    status.firestoreCommits = firestoreBatch.commitCount();
+    status.firestoreWrites = firestoreBatch.writeCount();
+    status.firestoreCommitFailures = firestoreBatch.failureCount();
+    status.firestoreDroppedWrites = firestoreBatch.droppedCount();
+    status.firestoreEvictedWrites = firestoreBatch.evictedCount();
+    status.queuePending = telemetryQueue.pending();
+    status.queueStored = telemetryQueue.storedCount();
+    status.queueDrained = telemetryQueue.drainedCount();
+    status.queueRejected = telemetryQueue.rejectedCount();
+    status.remoteTruncated = remoteTruncated;
+    status.queueOverwritten = telemetryQueue.overwrittenCount();
+    status.queueThrottled = telemetryQueue.throttledCount();
+    status.wifiAttempts = wifiLink.attemptCount();
+    status.wifiReconnects = wifiLink.reconnectCount();
+    status.wifiLastReconnectMs = wifiLink.lastReconnectMs();
+    status.wifiMaxReconnectMs = wifiLink.maxReconnectMs();
+    status.wifiAvgReconnectMs = wifiLink.averageReconnectMs();
+    status.sampleIntervalMs = moistureSampler.intervalMs();
+    status.lastPulseMs = pump.pulseMs();
+    status.doseGainPerSec = pump.dose().gainPerSec;
+    status.lowPower = powerConfig.lowPower;
+#ifdef MQTT_TRANSPORT
+    status.mqttConnected = mqttLink.connected();
+    status.mqttCommands = mqttLink.commandCount();
+    status.mqttCommandLatencyMs = mqttLink.lastLatencyMs();
+    status.mqttCommandLatencyMaxMs = mqttLink.commandLatency().max();
+#endif
+    statusCache.publish(status);
+}
+
+void sampleMoisture() {
+    uint32_t httpRequests = firestore.handshakeCount() + firestore.reusedCount();
+    if (httpRequests != lastHttpRequestCount) {
+        moistureSampler.noteRadioActivity();
+        lastHttpRequestCount = httpRequests;
+    }
+    moistureSampler.update();
+    
+    // Drying is learned only between cycles; pumping and settling are not drying
+    const MoistureSnapshot& sample = moistureSampler.snapshot();
+    if (sample.sequence != lastModelSequence) {
+        dryingModel.observe(sample.moisture, pump.state() == MONITORING);
+        lastModelSequence = sample.sequence;
+    }
+    
+    // Sample sparsely while the next dry crossing is predicted well ahead
+    if (millis() - lastPrediction >= PREDICTION_INTERVAL) {
+        uint32_t epoch = getCurrentEpoch();
+        secondsToDry = dryingModel.secondsUntil(pumpConfig.dryThreshold, sample.moisture, epoch);
+        dryRateNow = dryingModel.rateAt(epoch);
+        bool farFromDry = pump.state() == MONITORING && secondsToDry != DryingModel::NO_PREDICTION &&
+                          secondsToDry > DRY_PREDICTION_LEAD_SEC;
+        moistureSampler.setIntervalOverride(farFromDry ? RELAXED_SAMPLE_INTERVAL_MS : 0);
+        lastPrediction = millis();
+    }
+    if (pump.state() != MONITORING) moistureSampler.setIntervalOverride(0);
+#ifdef LOOP_METRICS
+    // Start of a dry spell the pump should answer, for the threshold-to-pump metric
+    if (readMoisture() < pumpConfig.dryThreshold || pump.state() != MONITORING || pump.lockedFault()) {
+        drySinceMs = 0;
+    } else if (drySinceMs == 0) {
+        drySinceMs = moistureSampler.snapshot().timestampMs;
+    }
+#endif
+}
+
+void printStatusLine() {
+    uint16_t moisture = readMoisture();
+    
+    // Compact status line
+    Serial.printf_P(PSTR("[STATUS] M:%d | P:%s | D:%s | W:%s"),
+        moisture,
+        pumpStateName(pump.state()),
+        deviceStateName(deviceState),
+        wifiConnected ? "ON" : "OFF"
+    );
+    
+    // Add extra info if relevant
+    if (pump.lockedFault()) Serial.print(F(" | ⚠️ FAULT"));
+    if (wifiConnected) Serial.printf_P(PSTR(" | RSSI:%ddBm"), WiFi.RSSI());
+    if (wifiLink.state() == WiFiConnection::BACKOFF) {
+        Serial.printf_P(PSTR(" | Retry:%lus"), wifiLink.nextAttemptInMs() / 1000);
+    }
+    if (pump.state() == PUMP_WAITING) {
+        unsigned long currentEpoch = getCurrentEpoch();
+        unsigned long lastPumpEnd = pump.lastPumpEndEpoch();
+        if (currentEpoch > 0 && lastPumpEnd > 0 && currentEpoch >= lastPumpEnd) {
+            unsigned long remaining = pump.safetyWaitSec();
+            if (remaining > 0) {
+                Serial.printf_P(PSTR(" | Next:%lus"), remaining);
+            }
+        }
+    }
+    Serial.println();
+}
+
+void handleButton(ButtonAction action) {
+    if (action != NONE) TRACE_INSTANT(TRACE_BUTTON_ACTION, action);
     
-    // Read and handle button actions
-    ButtonAction action = readButton();
     switch (action) {
         case TRIPLE_PRESS:
-            Serial.println("\n[BUTTON] Triple press detected - Force WiFi reset");
+            Serial.println(F("\n[BUTTON] Triple press detected - Force WiFi reset"));
             setLedPattern(LED_BUTTON_FEEDBACK);
             startConfigurationPortal();
             break;
             
         case LONG_PRESS:
-            Serial.println("\n[BUTTON] Long press detected - Clear fault");
+            Serial.println(F("\n[BUTTON] Long press detected - Clear fault"));
             setLedPattern(LED_BUTTON_FEEDBACK);
-            if (lockedFault) {
-                lockedFault = false;
-                noEffectCounter = 0;
-                savePumpState();
-                deviceState = wifiConnected ? ONLINE : OFFLINE;
+#ifdef ZONE_COUNT
+            if (zoneBank.clearFaults() > 0) {
+                logEventToFirestore("zone_fault_cleared", "User cleared zone faults via button");
+                Serial.println(F("✓ Zone faults cleared"));
+            }
+#endif
+            if (pump.clearFault()) {
+                deviceState = connectedDeviceState(wifiConnected, false);
                 logEventToFirestore("fault_cleared", "User cleared fault via button");
-                Serial.println("✓ Fault cleared successfully");
+                Serial.println(F("✓ Fault cleared successfully"));
             } else {
-                Serial.println("ℹ No fault to clear");
+                Serial.println(F("ℹ No fault to clear"));
             }
             break;
             
         case SHORT_PRESS:
-            Serial.println("\n╔═════════════════════════════════════╗");
-            Serial.println("║ 🔘 BUTTON: Manual Water Request    ║");
-            Serial.println("╚═════════════════════════════════════╝");
+            Serial.println(F("\n╔═════════════════════════════════════╗"));
+            Serial.println(F("║ 🔘 BUTTON: Manual Water Request    ║"));
+            Serial.println(F("╚═════════════════════════════════════╝"));
             setLedPattern(LED_BUTTON_FEEDBACK);
-            if (deviceState != LOCKED_FAULT) {
+            if (!pump.lockedFault()) {
                 if (checkPumpSafety()) {
-                    activatePump("MANUAL");
+                    activatePump(ACTIVATION_MANUAL);
                 } else {
-                    Serial.println("❌ DENIED: Safety interval not met\n");
+                    Serial.println(F("❌ DENIED: Safety interval not met\n"));
                 }
             } else {
-                Serial.println("❌ DENIED: Device in FAULT state\n");
+                Serial.println(F("❌ DENIED: Device in FAULT state\n"));
             }
             break;
             
@@ -272,78 +809,15 @@ void loop() {
             // No button action
             break;
     }
-    
-    // Update LED status
-    updateLED();
-    
-    // WiFi management
-    if (deviceState != AWAITING_CONFIG) {
-        checkWiFi();
-        if (!wifiConnected && deviceState != LOCKED_FAULT) {
-            handleSmartRetry();
-        }
-    }
-    
-    // Firestore sync (only when online)
-    // Allow sync even in LOCKED_FAULT state so we can receive clear commands
-    if (wifiConnected && (deviceState == ONLINE || deviceState == LOCKED_FAULT)) {
-        // Send data periodically
-        if (currentTime - lastDataSend >= DATA_SEND_INTERVAL) {
-            syncWithFirestore();
-            lastDataSend = currentTime;
-        }
-        
-        // Check for config updates
-        if (currentTime - lastConfigCheck >= CONFIG_CHECK_INTERVAL) {
-            checkForConfigUpdates();
-            checkForRemoteCommands();
-            lastConfigCheck = currentTime;
-        }
-    }
-    
-    // Display status on serial
-    if (currentTime - lastDisplayTime >= DISPLAY_INTERVAL) {
-        uint16_t moisture = analogRead(SENSOR_PIN);
-        
-        // Compact status line
-        Serial.printf("[STATUS] M:%d | P:%s | D:%s | W:%s",
-            moisture,
-            getPumpStateString().c_str(),
-            getDeviceStateString().c_str(),
-            wifiConnected ? "ON" : "OFF"
-        );
-        
-        // Add extra info if relevant
-        if (lockedFault) Serial.print(" | ⚠️ FAULT");
-        if (wifiConnected) Serial.printf(" | RSSI:%ddBm", WiFi.RSSI());
-        if (pumpState == PUMP_WAITING) {
-            unsigned long currentEpoch = getCurrentEpoch();
-            if (currentEpoch > 0 && lastPumpEndEpoch > 0 && currentEpoch >= lastPumpEndEpoch) {
-                unsigned long timeSincePump = currentEpoch - lastPumpEndEpoch;
-                if (timeSincePump < MIN_INTERVAL_SEC) {
-                    unsigned long remaining = MIN_INTERVAL_SEC - timeSincePump;
-                    Serial.printf(" | Next:%lus", remaining);
-                }
-            }
-        }
-        Serial.println();
-        
-        lastDisplayTime = currentTime;
-    }
-    
-    // Pump state machine (core irrigation logic)
-    handlePumpStateMachine();
-    
-    delay(10);  // Small delay for stability
 }
 
 // File system functions
 void initializeFileSystem() {
     if (!LittleFS.begin()) {
-        Serial.println("✗ Failed to mount LittleFS");
-        Serial.println("⚠ Running without persistent storage");
+        Serial.println(F("✗ Failed to mount LittleFS"));
+        Serial.println(F("⚠ Running without persistent storage"));
     } else {
-        Serial.println("✓ LittleFS mounted successfully");
+        Serial.println(F("✓ LittleFS mounted successfully"));
     }
 }
 
@@ -361,22 +835,22 @@ void generateDeviceId() {
 
 void loadOrCreateConfig() {
     if (!LittleFS.exists(CONFIG_FILE)) {
-        Serial.println("ℹ No config file found - will create on first WiFi connection");
+        Serial.println(F("ℹ No config file found - will create on first WiFi connection"));
         return;
     }
     
     File configFile = LittleFS.open(CONFIG_FILE, "r");
     if (!configFile) {
-        Serial.println("✗ Failed to open config file");
+        Serial.println(F("✗ Failed to open config file"));
         return;
     }
     
-    JsonDocument doc;
+    JsonDocument doc(&scratchArena);
     DeserializationError error = deserializeJson(doc, configFile);
     configFile.close();
     
     if (error) {
-        Serial.println("✗ Config JSON parse error: " + String(error.c_str()));
+        Serial.printf_P(PSTR("✗ Config JSON parse error: %s\n"), error.c_str());
         return;
     }
     
@@ -387,81 +861,129 @@ void loadOrCreateConfig() {
     if (doc.containsKey("firebaseApiKey")) {
         firebaseApiKey = doc["firebaseApiKey"].as<String>();
     }
+    if (doc.containsKey("firestoreHost")) {
+        firestoreHost = doc["firestoreHost"].as<String>();
+    }
+    firestorePort = doc["firestorePort"] | firestorePort;
+    firestoreTls = doc["firestoreTls"] | firestoreTls;
+#ifdef MQTT_TRANSPORT
+    mqttHost = doc["mqttHost"] | mqttHost.c_str();
+    mqttPort = doc["mqttPort"] | mqttPort;
+    mqttUser = doc["mqttUser"] | mqttUser.c_str();
+    mqttPass = doc["mqttPass"] | mqttPass.c_str();
+#endif
     
     // Load watering parameters
-    DRY_THRESHOLD = doc["dryThreshold"] | DRY_THRESHOLD;
-    WET_THRESHOLD = doc["wetThreshold"] | WET_THRESHOLD;
-    PUMP_RUN_TIME = doc["pumpRunTime"] | PUMP_RUN_TIME;
-    MIN_INTERVAL_SEC = doc["minIntervalSec"] | MIN_INTERVAL_SEC;
-    
-    Serial.println("✓ Configuration loaded");
-    Serial.printf("  Thresholds: Dry=%d, Wet=%d\n", DRY_THRESHOLD, WET_THRESHOLD);
-    Serial.printf("  Pump Time: %lu ms, Min Interval: %lu sec\n", PUMP_RUN_TIME, MIN_INTERVAL_SEC);
+    pumpConfig.dryThreshold = doc["dryThreshold"] | pumpConfig.dryThreshold;
+    pumpConfig.wetThreshold = doc["wetThreshold"] | pumpConfig.wetThreshold;
+    pumpConfig.pumpRunTimeMs = doc["pumpRunTime"] | pumpConfig.pumpRunTimeMs;
+    pumpConfig.minIntervalSec = doc["minIntervalSec"] | pumpConfig.minIntervalSec;
+    pumpConfig.adaptiveDosing = doc["adaptiveDosing"] | pumpConfig.adaptiveDosing;
+    pumpConfig.maxPulseMs = doc["maxPulseMs"] | pumpConfig.maxPulseMs;
+    powerConfig.lowPower = doc["lowPower"] | powerConfig.lowPower;
+    samplerConfig.intervalMs = doc["sampleIntervalMs"] | samplerConfig.intervalMs;
+    reportConfig.moistureDeadband = doc["reportDeadband"] | reportConfig.moistureDeadband;
+    reportConfig.heartbeatMs = (doc["heartbeatSec"] | reportConfig.heartbeatMs / 1000) * 1000UL;
+    strlcpy(configUpdateTime, doc["configUpdateTime"] | "", sizeof(configUpdateTime));
+    
+    Serial.println(F("✓ Configuration loaded"));
+    Serial.printf_P(PSTR("  Thresholds: Dry=%d, Wet=%d\n"), pumpConfig.dryThreshold, pumpConfig.wetThreshold);
+    Serial.printf_P(PSTR("  Pump Time: %lu ms, Min Interval: %lu sec\n"),
+                  (unsigned long)pumpConfig.pumpRunTimeMs, (unsigned long)pumpConfig.minIntervalSec);
+    if (pumpConfig.adaptiveDosing) {
+        Serial.printf_P(PSTR("  Adaptive dosing: %lu-%lu ms pulses\n"),
+                      (unsigned long)pumpConfig.minPulseMs, (unsigned long)pumpConfig.maxPulseMs);
+    }
 }
 
-void loadPumpState() {
-    if (!LittleFS.exists(PUMP_STATE_FILE)) {
-        Serial.println("ℹ No pump state file - starting fresh");
-        savePumpState();  // Create initial state file
-        return;
+// Write current watering parameters back to the config file, keeping WiFi credentials
+void saveConfig() {
+    JsonDocument doc(&scratchArena);
+    File configFile = LittleFS.open(CONFIG_FILE, "r");
+    if (configFile) {
+        deserializeJson(doc, configFile);
+        configFile.close();
     }
     
-    File stateFile = LittleFS.open(PUMP_STATE_FILE, "r");
-    if (!stateFile) {
-        Serial.println("✗ Failed to open pump state file");
+    doc["dryThreshold"] = pumpConfig.dryThreshold;
+    doc["wetThreshold"] = pumpConfig.wetThreshold;
+    doc["pumpRunTime"] = pumpConfig.pumpRunTimeMs;
+    doc["minIntervalSec"] = pumpConfig.minIntervalSec;
+    doc["adaptiveDosing"] = pumpConfig.adaptiveDosing;
+    doc["maxPulseMs"] = pumpConfig.maxPulseMs;
+    doc["lowPower"] = powerConfig.lowPower;
+    doc["reportDeadband"] = reportConfig.moistureDeadband;
+    doc["heartbeatSec"] = reportConfig.heartbeatMs / 1000;
+    doc["configUpdateTime"] = static_cast<char*>(configUpdateTime);
+    
+    TRACE_SCOPE(TRACE_FS_WRITE);
+    configFile = LittleFS.open(CONFIG_FILE, "w");
+    if (!configFile) {
+        Serial.println(F("✗ Failed to save config"));
         return;
     }
-    
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, stateFile);
-    stateFile.close();
-    
-    if (error) {
-        Serial.println("✗ Pump state JSON parse error: " + String(error.c_str()));
+    serializeJson(doc, configFile);
+    configFile.close();
+}
+
+void loadPumpState() {
+    if (!pumpJournal.begin()) {
+        Serial.println(F("✗ Failed to open pump state journal"));
         return;
     }
     
-    lastPumpEndEpoch = doc["lastPumpEndEpoch"] | 0;
-    lockedFault = doc["lockedFault"] | false;
-    noEffectCounter = doc["noEffectCounter"] | 0;
+    PumpPersistentState state;
+    if (pumpJournal.load(state)) {
+        Serial.printf_P(PSTR("✓ Pump state loaded (record #%lu%s)\n"), (unsigned long)pumpJournal.sequence(),
+                        pumpJournal.restoredFromRtc() ? ", unsaved update recovered from RTC" : "");
+    } else if (loadLegacyPumpState(state)) {
+        pumpJournal.update(state);
+        pumpJournal.flush();
+        LittleFS.remove(LEGACY_PUMP_STATE_FILE);
+        Serial.println(F("✓ Pump state migrated from JSON"));
+    } else {
+        Serial.println(F("ℹ No pump state saved - starting fresh"));
+        return;
+    }
+    pump.restore(state);
     
-    Serial.println("✓ Pump state loaded");
-    Serial.printf("  Last Pump: %lu sec ago, Fault: %s, No-Effect Count: %d\n", 
-                  getCurrentEpoch() - lastPumpEndEpoch,
-                  lockedFault ? "YES" : "NO",
-                  noEffectCounter);
+    Serial.printf_P(PSTR("  Last Pump: %lu sec ago, Fault: %s, No-Effect Count: %d\n"), 
+                  getCurrentEpoch() - state.lastPumpEndEpoch,
+                  state.lockedFault ? "YES" : "NO",
+                  state.noEffectCounter);
     
-    if (lockedFault) {
+    if (state.lockedFault) {
         deviceState = LOCKED_FAULT;
         setLedPattern(LED_FAULT);
     }
 }
 
-void savePumpState() {
-    JsonDocument doc;
-    doc["lastPumpEndEpoch"] = lastPumpEndEpoch;
-    doc["lockedFault"] = lockedFault;
-    doc["noEffectCounter"] = noEffectCounter;
-    doc["deviceId"] = deviceId;
-    
-    File stateFile = LittleFS.open(PUMP_STATE_FILE, "w");
-    if (!stateFile) {
-        Serial.println("✗ Failed to save pump state");
-        return;
-    }
-    
-    if (serializeJson(doc, stateFile) == 0) {
-        Serial.println("✗ Failed to write pump state JSON");
-    }
+// Firmware before the binary journal kept pump state in a JSON file
+bool loadLegacyPumpState(PumpPersistentState& state) {
+    if (!LittleFS.exists(LEGACY_PUMP_STATE_FILE)) return false;
+    File stateFile = LittleFS.open(LEGACY_PUMP_STATE_FILE, "r");
+    if (!stateFile) return false;
     
+    JsonDocument doc(&scratchArena);
+    DeserializationError error = deserializeJson(doc, stateFile);
     stateFile.close();
+    if (error) return false;
+    
+    state.lastPumpEndEpoch = doc["lastPumpEndEpoch"] | 0;
+    state.lockedFault = doc["lockedFault"] | false;
+    state.noEffectCounter = doc["noEffectCounter"] | 0;
+    return true;
+}
+
+// Shadowed in RTC memory at once; reaches flash when updates pause for a few seconds
+void savePumpState() {
+    pumpJournal.update(pump.persistentState());
 }
 
 // WiFi management
 void setupWiFi() {
     WiFi.mode(WIFI_STA);
-    WiFi.setSleepMode(WIFI_NONE_SLEEP);
-    WiFi.setAutoReconnect(true);
+    WiFi.setSleepMode(WIFI_NONE_SLEEP);  // Until the power task dozes it (lowPower)
     WiFi.persistent(true);
     
     wm.setConnectTimeout(30);
@@ -469,7 +991,7 @@ void setupWiFi() {
 }
 
 void startConfigurationPortal() {
-    Serial.println("\n[WiFi] Starting configuration portal");
+    Serial.println(F("\n[WiFi] Starting configuration portal"));
     deviceState = AWAITING_CONFIG;
     setLedPattern(LED_PORTAL_ACTIVE);
     
@@ -477,7 +999,9 @@ void startConfigurationPortal() {
     delay(1000);
     
     if (!wm.startConfigPortal("Irrigation-Setup", "plant123456")) {
-        Serial.println("✗ Portal timeout - restarting");
+        Serial.println(F("✗ Portal timeout - restarting"));
+        pumpJournal.flush();
+        dryingModel.flush();
         ESP.restart();
         return;
     }
@@ -486,59 +1010,41 @@ void startConfigurationPortal() {
     String ssid = WiFi.SSID();
     String pass = WiFi.psk();
     
-    JsonDocument doc;
+    JsonDocument doc(&scratchArena);
     doc["ssid"] = ssid;
     doc["pass"] = pass;
     doc["firebaseProjectId"] = firebaseProjectId;
     doc["firebaseApiKey"] = firebaseApiKey;
-    doc["dryThreshold"] = DRY_THRESHOLD;
-    doc["wetThreshold"] = WET_THRESHOLD;
-    doc["pumpRunTime"] = PUMP_RUN_TIME;
-    doc["minIntervalSec"] = MIN_INTERVAL_SEC;
-    
+    doc["firestoreHost"] = firestoreHost;
+    doc["firestorePort"] = firestorePort;
+    doc["firestoreTls"] = firestoreTls;
+#ifdef MQTT_TRANSPORT
+    doc["mqttHost"] = mqttHost;
+    doc["mqttPort"] = mqttPort;
+    doc["mqttUser"] = mqttUser;
+    doc["mqttPass"] = mqttPass;
+#endif
+    doc["dryThreshold"] = pumpConfig.dryThreshold;
+    doc["wetThreshold"] = pumpConfig.wetThreshold;
+    doc["pumpRunTime"] = pumpConfig.pumpRunTimeMs;
+    doc["minIntervalSec"] = pumpConfig.minIntervalSec;
+    
+    TRACE_SCOPE(TRACE_FS_WRITE);
     File configFile = LittleFS.open(CONFIG_FILE, "w");
     if (configFile) {
         serializeJson(doc, configFile);
         configFile.close();
-        Serial.println("✓ Configuration saved");
-    }
-    
-    wifiConnected = true;
-    deviceState = ONLINE;
-    setLedPattern(LED_ONLINE);
-    retryCount = 0;
-    nextRetryInterval = RETRY_INTERVAL_1;
-    
-    // Initialize NTP for accurate timestamps (UTC+0)
-    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-    Serial.print("⏰ Syncing time with NTP");
-    
-    // Wait up to 10 seconds for time sync
-    int retries = 0;
-    while (time(nullptr) < 100000 && retries < 20) {
-        delay(500);
-        Serial.print(".");
-        retries++;
+        Serial.println(F("✓ Configuration saved"));
     }
     
-    time_t now = time(nullptr);
-    if (now >= 100000) {
-        Serial.println(" ✓");
-        Serial.printf("  Unix timestamp: %lu (GMT)\n", (unsigned long)now);
-        struct tm timeinfo;
-        gmtime_r(&now, &timeinfo);
-        Serial.printf("  Date/Time: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
-                     timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
-                     timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-    } else {
-        Serial.println(" ✗ FAILED");
-        Serial.println("  ⚠️  Timestamps will be 0 until sync succeeds");
-    }
+    // Portal left the station connected; hand it to the connection manager
+    wifiLink.begin(ssid, pass);
+    handleWiFiConnected();
 }
 
 void attemptWiFiConnection() {
     if (!LittleFS.exists(CONFIG_FILE)) {
-        Serial.println("ℹ No WiFi config - starting portal");
+        Serial.println(F("ℹ No WiFi config - starting portal"));
         startConfigurationPortal();
         return;
     }
@@ -550,7 +1056,7 @@ void attemptWiFiConnection() {
         return;
     }
     
-    JsonDocument doc;
+    JsonDocument doc(&scratchArena);
     DeserializationError error = deserializeJson(doc, configFile);
     configFile.close();
     
@@ -567,185 +1073,76 @@ void attemptWiFiConnection() {
         return;
     }
     
-    Serial.println("\n[WiFi] Attempting connection to: " + ssid);
-    setLedPattern(LED_CONNECTING);
-    
-    WiFi.begin(ssid.c_str(), pass.c_str());
+    Serial.printf_P(PSTR("\n[WiFi] Connecting to: %s\n"), ssid.c_str());
+    deviceState = connectedDeviceState(false, pump.lockedFault());
+    setLedPattern(pump.lockedFault() ? LED_FAULT : LED_CONNECTING);
     
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < 15000) {
-        delay(500);
-        Serial.print(".");
-    }
-    Serial.println();
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        wifiConnected = true;
-        deviceState = lockedFault ? LOCKED_FAULT : ONLINE;
-        setLedPattern(lockedFault ? LED_FAULT : LED_ONLINE);
-        Serial.println("✓ WiFi connected");
-        Serial.println("  IP: " + WiFi.localIP().toString());
-        
-        // Initialize NTP for accurate timestamps (UTC+0)
-        configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-        Serial.print("⏰ Syncing time with NTP");
-        
-        // Wait up to 10 seconds for time sync
-        int retries = 0;
-        while (time(nullptr) < 100000 && retries < 20) {
-            delay(500);
-            Serial.print(".");
-            retries++;
-        }
-        
-        time_t now = time(nullptr);
-        if (now >= 100000) {
-            Serial.println(" ✓");
-            Serial.printf("  Unix timestamp: %lu (GMT)\n", (unsigned long)now);
-            struct tm timeinfo;
-            gmtime_r(&now, &timeinfo);
-            Serial.printf("  Date/Time: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
-                         timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
-                         timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-        } else {
-            Serial.println(" ✗ FAILED");
-            Serial.println("  ⚠️  Timestamps will be 0 until sync succeeds");
-        }
-        
-        retryCount = 0;
-        nextRetryInterval = RETRY_INTERVAL_1;
-    } else {
-        wifiConnected = false;
-        deviceState = lockedFault ? LOCKED_FAULT : OFFLINE;
-        setLedPattern(lockedFault ? LED_FAULT : LED_OFFLINE);
-        Serial.println("✗ WiFi connection failed - entering offline mode");
-        Serial.println("  Next retry in: " + String(nextRetryInterval / 60000) + " minutes");
-        lastReconnectAttempt = millis();
+    // Returns immediately; progress is reported through checkWiFi()
+    wifiLink.begin(ssid, pass);
+    if (wifiLink.isConnected()) {
+        handleWiFiConnected();
     }
 }
 
 void checkWiFi() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastWiFiCheck < WIFI_CHECK_INTERVAL) return;
-    lastWiFiCheck = currentTime;
-    
-    if (WiFi.status() != WL_CONNECTED) {
-        if (wifiConnected) {
-            Serial.println("✗ WiFi connection lost");
-            wifiConnected = false;
-            deviceState = lockedFault ? LOCKED_FAULT : OFFLINE;
-            setLedPattern(lockedFault ? LED_FAULT : LED_OFFLINE);
-            lastReconnectAttempt = currentTime;
-        }
-    } else if (!wifiConnected) {
-        Serial.println("✓ WiFi reconnected");
-        wifiConnected = true;
-        deviceState = lockedFault ? LOCKED_FAULT : ONLINE;
-        setLedPattern(lockedFault ? LED_FAULT : LED_ONLINE);
-        
-        // Re-sync NTP time after reconnection
-        configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-        Serial.println("⏰ Re-syncing NTP time...");
-        retryCount = 0;
-        nextRetryInterval = RETRY_INTERVAL_1;
+    switch (wifiLink.update()) {
+        case WIFI_EVENT_CONNECTED:
+            handleWiFiConnected();
+            break;
+        case WIFI_EVENT_DISCONNECTED:
+            handleWiFiLost();
+            break;
+        case WIFI_EVENT_NONE:
+            break;
     }
 }
 
-void handleSmartRetry() {
-    unsigned long currentTime = millis();
-    
-    if (currentTime - lastReconnectAttempt >= nextRetryInterval) {
-        Serial.println("\n[WiFi] Smart retry attempt #" + String(retryCount + 1));
-        WiFi.reconnect();
-        
-        delay(10000);  // Wait 10 seconds for connection
-        
-        if (WiFi.status() != WL_CONNECTED) {
-            retryCount++;
-            // Exponential backoff: 1h -> 6h -> 24h (max)
-            if (retryCount == 1) {
-                nextRetryInterval = RETRY_INTERVAL_2;
-            } else if (retryCount >= 2) {
-                nextRetryInterval = RETRY_INTERVAL_3;
-            }
-            Serial.println("  Failed. Next retry in: " + String(nextRetryInterval / 3600000) + " hours");
-        }
-        
-        lastReconnectAttempt = currentTime;
-    }
+void handleWiFiConnected() {
+    wifiConnected = true;
+    deviceState = connectedDeviceState(true, pump.lockedFault());
+    setLedPattern(pump.lockedFault() ? LED_FAULT : LED_ONLINE);
+    Serial.printf_P(PSTR("✓ WiFi connected (%lu ms, attempt #%u)\n"),
+                  wifiLink.lastConnectMs(), wifiLink.attemptCount());
+    Serial.printf_P(PSTR("  IP: %s\n"), WiFi.localIP().toString().c_str());
+    
+    // NTP sync for accurate timestamps (UTC+0) runs in the background;
+    // getCurrentEpoch() returns 0 until it completes
+    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+    Serial.println(F("⏰ Syncing NTP time..."));
+}
+
+void handleWiFiLost() {
+    Serial.println(F("✗ WiFi connection lost - reconnecting in background"));
+    wifiConnected = false;
+    firestore.close();
+#ifdef MQTT_TRANSPORT
+    mqttLink.stop();
+#endif
+    deviceState = connectedDeviceState(false, pump.lockedFault());
+    setLedPattern(pump.lockedFault() ? LED_FAULT : LED_OFFLINE);
 }
 
 // Hardware I/O - Button
+// Runs on every button edge; only timestamps the edge and queues it
+void IRAM_ATTR onButtonEdge() {
+    ButtonEdge edge = { millis(), digitalRead(BUTTON_PIN) == LOW };  // LOW = pressed (pull-up)
+    if (!buttonEdges.push(edge)) {
+        buttonEdgeOverflows++;
+    }
+}
+
 ButtonAction readButton() {
-    static bool lastButtonState = HIGH;  // Pulled up = HIGH when not pressed
-    bool currentButtonState = digitalRead(BUTTON_PIN);
+    // Sample the time before draining so every edge up to now is in the queue
     unsigned long currentTime = millis();
     
-    // Debounce
-    if (currentButtonState != lastButtonState) {
-        delay(BUTTON_DEBOUNCE_MS);
-        currentButtonState = digitalRead(BUTTON_PIN);
-    }
-    
-    // Button pressed (LOW because of pull-up)
-    if (currentButtonState == LOW && lastButtonState == HIGH) {
-        buttonPressed = true;
-        buttonPressStart = currentTime;
-        longPressHandled = false;
-        
-        // Check for triple press
-        if (currentTime - lastButtonPress < TRIPLE_PRESS_WINDOW) {
-            pressCount++;
-            if (pressCount >= 3) {
-                // Triple press detected immediately on third press
-                pressCount = 0;
-                lastButtonState = currentButtonState;
-                return TRIPLE_PRESS;
-            }
-        } else {
-            pressCount = 1;
-        }
-        lastButtonPress = currentTime;
-    }
-    
-    // Button released
-    if (currentButtonState == HIGH && lastButtonState == LOW) {
-        unsigned long pressDuration = currentTime - buttonPressStart;
-        buttonPressed = false;
-        
-        if (!longPressHandled && pressDuration < LONG_PRESS_MS) {
-            // Don't immediately return SHORT_PRESS - wait to see if it's part of triple press
-            // We'll handle short press only after the triple press window expires
-            lastButtonState = currentButtonState;
-            return NONE;
-        }
-        
-        longPressHandled = false;
-    }
-    
-    // Check for long press while button is still held
-    if (buttonPressed && !longPressHandled) {
-        if (currentTime - buttonPressStart >= LONG_PRESS_MS) {
-            longPressHandled = true;
-            pressCount = 0;
-            lastButtonState = currentButtonState;
-            return LONG_PRESS;
-        }
-    }
-    
-    // Handle delayed short press - only after triple press window expires
-    if (!buttonPressed && pressCount == 1 && (currentTime - lastButtonPress > TRIPLE_PRESS_WINDOW)) {
-        pressCount = 0;
-        return SHORT_PRESS;
+    ButtonEdge edge;
+    while (buttonEdges.pop(edge)) {
+        buttonDecoder.feed(edge);
     }
+    buttonDecoder.advance(currentTime);
     
-    // Reset incomplete triple press after window expires
-    if (!buttonPressed && pressCount >= 2 && (currentTime - lastButtonPress > TRIPLE_PRESS_WINDOW)) {
-        pressCount = 0;
-    }
-    
-    lastButtonState = currentButtonState;
-    return NONE;
+    // One action per loop pass; any others stay queued in the decoder
+    return buttonDecoder.takeAction();
 }
 
 // Hardware I/O - LED
@@ -760,50 +1157,50 @@ void updateLED() {
     
     switch (currentLedPattern) {
         case LED_OFF:
-            digitalWrite(LED_PIN, LOW);
+            boardGpio.write(LED_PIN, false);
             break;
             
         case LED_PORTAL_ACTIVE:
             // Fast double-blink: 100ms on, 100ms off, 100ms on, 700ms off (1 second cycle)
             if (elapsed % 1000 < 100 || (elapsed % 1000 >= 200 && elapsed % 1000 < 300)) {
-                digitalWrite(LED_PIN, HIGH);
+                boardGpio.write(LED_PIN, true);
             } else {
-                digitalWrite(LED_PIN, LOW);
+                boardGpio.write(LED_PIN, false);
             }
             break;
             
         case LED_CONNECTING:
             // Fast single blink: 200ms on, 800ms off
-            digitalWrite(LED_PIN, (elapsed % 1000 < 200) ? HIGH : LOW);
+            boardGpio.write(LED_PIN, elapsed % 1000 < 200);
             break;
             
         case LED_ONLINE:
             // Slow heartbeat: 100ms on, 2900ms off
-            digitalWrite(LED_PIN, (elapsed % 3000 < 100) ? HIGH : LOW);
+            boardGpio.write(LED_PIN, elapsed % 3000 < 100);
             break;
             
         case LED_OFFLINE:
             // Single blink every 3 seconds: 500ms on, 2500ms off
-            digitalWrite(LED_PIN, (elapsed % 3000 < 500) ? HIGH : LOW);
+            boardGpio.write(LED_PIN, elapsed % 3000 < 500);
             break;
             
         case LED_PUMPING:
             // Solid on
-            digitalWrite(LED_PIN, HIGH);
+            boardGpio.write(LED_PIN, true);
             break;
             
         case LED_FAULT:
             // Slow error blink: 500ms on, 1500ms off
-            digitalWrite(LED_PIN, (elapsed % 2000 < 500) ? HIGH : LOW);
+            boardGpio.write(LED_PIN, elapsed % 2000 < 500);
             break;
             
         case LED_BUTTON_FEEDBACK:
             // Three quick flashes then return to previous state
             if (elapsed < 600) {
-                digitalWrite(LED_PIN, (elapsed % 200 < 100) ? HIGH : LOW);
+                boardGpio.write(LED_PIN, elapsed % 200 < 100);
             } else {
                 // Return to appropriate state
-                if (lockedFault) {
+                if (pump.lockedFault()) {
                     setLedPattern(LED_FAULT);
                 } else if (deviceState == ONLINE) {
                     setLedPattern(LED_ONLINE);
@@ -818,439 +1215,554 @@ void updateLED() {
 }
 
 // Pump control
-void handlePumpStateMachine() {
-    unsigned long currentTime = millis();
-    
-    switch (pumpState) {
-        case MONITORING:
-            // Only auto-water if not in fault state
-            if (deviceState != LOCKED_FAULT) {
-                uint16_t moisture = analogRead(SENSOR_PIN);
-                if (moisture >= DRY_THRESHOLD) {
-                    if (checkPumpSafety()) {
-                        activatePump("AUTO");
-                    }
-                }
-            }
-            break;
-            
-        case PUMP_RUNNING:
-            if (currentTime - pumpStartTime >= PUMP_RUN_TIME) {
-                digitalWrite(PUMP_CTRL_PIN, LOW);
-                pumpState = PUMP_WAITING;
-                lastPumpActionTime = currentTime;
-                lastPumpEndEpoch = getCurrentEpoch();
-                savePumpState();
-                
-                Serial.println("  PUMP: OFF (cycle completed)");
-                
-                // Check effectiveness after pump settles
-                // Note: We'll check after settle time in PUMP_WAITING state
-            }
-            break;
-            
-        case PUMP_WAITING:
-            // After settle time, check pump effectiveness
-            if (currentTime - lastPumpActionTime >= PUMP_SETTLE_MS && 
-                lastActivationMethod == "AUTO" && moistureBeforePump > 0) {
-                checkPumpEffectiveness();
-                moistureBeforePump = 0;  // Clear for next cycle
-            }
-            
-            // Return to monitoring after full wait period
-            if (currentTime - lastPumpActionTime >= (MIN_INTERVAL_SEC * 1000)) {
-                pumpState = MONITORING;
-                Serial.println("  STATE: Resuming monitoring");
-                
-                // Update LED if pump was running
-                if (currentLedPattern == LED_PUMPING) {
-                    if (lockedFault) {
-                        setLedPattern(LED_FAULT);
-                    } else if (wifiConnected) {
-                        setLedPattern(LED_ONLINE);
-                    } else {
-                        setLedPattern(LED_OFFLINE);
-                    }
-                }
-            }
-            break;
-    }
+// Latest filtered reading; never touches the ADC
+uint16_t readMoisture() {
+    return moistureSampler.moisture();
 }
 
 bool checkPumpSafety() {
-    unsigned long currentEpoch = getCurrentEpoch();
-    unsigned long timeSinceLastPump = currentEpoch - lastPumpEndEpoch;
-    
-    if (timeSinceLastPump < MIN_INTERVAL_SEC) {
-        Serial.printf("  ✗ Safety: Only %lu sec since last pump (need %lu sec)\n", 
-                      timeSinceLastPump, MIN_INTERVAL_SEC);
+    if (!pump.checkSafety()) {
+        Serial.printf_P(PSTR("  ✗ Safety: Only %lu sec since last pump (need %lu sec)\n"), 
+                      (unsigned long)(pumpConfig.minIntervalSec - pump.safetyWaitSec()),
+                      (unsigned long)pumpConfig.minIntervalSec);
         return false;
     }
     
     return true;
 }
 
-void activatePump(const String& method) {
-    moistureBeforePump = analogRead(SENSOR_PIN);
-    lastActivationMethod = method;
-    
-    digitalWrite(PUMP_CTRL_PIN, HIGH);
-    pumpState = PUMP_RUNNING;
-    pumpStartTime = millis();
-    setLedPattern(LED_PUMPING);
-    
-    Serial.println("\n┌─────────────────────────────────────┐");
-    Serial.printf("│ PUMP ACTIVATED: %s%-14s│\n", method.c_str(), "");
-    Serial.printf("│ Moisture Before: %-18d│\n", moistureBeforePump);
-    Serial.printf("│ Run Time: %d ms%-20s│\n", PUMP_RUN_TIME, "");
-    Serial.println("└─────────────────────────────────────┘");
-    
-    // Log to Firestore if online
-    if (wifiConnected) {
-        logEventToFirestore("pump_activated", 
-                           "method=" + method + ",moisture=" + String(moistureBeforePump));
-    }
+void activatePump(ActivationMethod method) {
+    pump.activate(method, readMoisture());
 }
 
-void checkPumpEffectiveness() {
-    yield(); // Prevent watchdog timeout
-    uint16_t moistureAfter = analogRead(SENSOR_PIN);
-    int16_t delta = moistureAfter - moistureBeforePump;  // For capacitive sensors: negative = wetter
-    
-    Serial.println("\n┌─────────────────────────────────────┐");
-    Serial.println("│ PUMP EFFECTIVENESS CHECK            │");
-    Serial.printf("│ Before: %-27d│\n", moistureBeforePump);
-    Serial.printf("│ After:  %-27d│\n", moistureAfter);
-    Serial.printf("│ Delta:  %-27d│\n", delta);
-    
-    // For capacitive sensors: higher=dry, lower=wet
-    // We expect moisture to DECREASE (become wetter)
-    // So delta (After - Before) should be negative
-    // Effective if: moistureAfter < moistureBeforePump - 5
-    // i.e. delta <= -5
-    
-    const int16_t REQUIRED_DROP = 5; // Must drop by at least 5 units
+// Reporting, LED and persistence for pump state machine transitions
+class PumpEvents : public PumpListener {
+public:
+    void onPumpStarted(ActivationMethod method, uint16_t moistureBefore) override {
+        TRACE_PHASE(TRACE_PUMP_RUNNING, method);
+        setLedPattern(LED_PUMPING);
+        scheduler.runIn(pumpTaskId, PUMP_ACTIVE_MS);  // Started outside the pump task (button, web, remote)
+        scheduler.wake(powerTaskId);                   // Radio awake for the cycle
+#ifdef LOOP_METRICS
+        if (method == ACTIVATION_AUTO && drySinceMs != 0) {
+            loopMetrics.recordThresholdToPump(drySinceMs);
+            drySinceMs = 0;
+        }
+#endif
+        
+        Serial.println(F("\n┌─────────────────────────────────────┐"));
+        Serial.printf_P(PSTR("│ PUMP ACTIVATED: %s%-14s│\n"), activationMethodName(method), "");
+        Serial.printf_P(PSTR("│ Moisture Before: %-18d│\n"), moistureBefore);
+        Serial.printf_P(PSTR("│ Run Time: %lu ms%-20s│\n"), (unsigned long)pump.pulseMs(), "");
+        Serial.println(F("└─────────────────────────────────────┘"));
+        
+        // Log to Firestore (stored locally while offline)
+        char details[48];
+        snprintf(details, sizeof(details), "method=%s,moisture=%u", activationMethodName(method), moistureBefore);
+        logEventToFirestore("pump_activated", details);
+    }
     
-    bool effective = (moistureBeforePump - moistureAfter) >= REQUIRED_DROP;
+    void onPumpStopped() override {
+        TRACE_PHASE(TRACE_PUMP_WAITING, 0);
+        Serial.println(F("  PUMP: OFF (cycle completed)"));
+    }
     
-    if (!effective) {
-        noEffectCounter++;
-        Serial.printf("│ ⚠️  NO EFFECT! Count: %d/%d%-10s│\n", 
-                      noEffectCounter, MAX_NO_EFFECT_REPEATS, "");
+    void onMonitoringResumed() override {
+        TRACE_PHASE(TRACE_NONE, 0);
+        Serial.println(F("  STATE: Resuming monitoring"));
         
-        if (noEffectCounter >= MAX_NO_EFFECT_REPEATS) {
-            Serial.println("│                                     │");
-            Serial.println("│ ❌ CRITICAL FAULT DETECTED!         │");
-            Serial.println("│ → Pump ineffective                  │");
-            Serial.println("│ → Auto-watering LOCKED              │");
-            lockedFault = true;
-            deviceState = LOCKED_FAULT;
-            savePumpState();
-            setLedPattern(LED_FAULT);
-            
-            if (wifiConnected) {
-                logEventToFirestore("fault_locked", 
-                                   "Pump ineffective after " + String(MAX_NO_EFFECT_REPEATS) + " attempts");
+        // Update LED if pump was running
+        if (currentLedPattern == LED_PUMPING) {
+            if (pump.lockedFault()) {
+                setLedPattern(LED_FAULT);
+            } else if (wifiConnected) {
+                setLedPattern(LED_ONLINE);
+            } else {
+                setLedPattern(LED_OFFLINE);
             }
         }
-    } else {
-        Serial.println("│ ✅ PUMP EFFECTIVE - Soil wetter     │");
-        if (noEffectCounter > 0) {
-            Serial.printf("│ Counter reset: %d → 0%-15s│\n", noEffectCounter, "");
+    }
+    
+    void onEffectivenessChecked(const EffectivenessResult& result) override {
+        dryingModel.recordCycle((int32_t)result.moistureBefore - result.moistureAfter, pump.pulseMs());
+        
+        Serial.println(F("\n┌─────────────────────────────────────┐"));
+        Serial.println(F("│ PUMP EFFECTIVENESS CHECK            │"));
+        Serial.printf_P(PSTR("│ Before: %-27d│\n"), result.moistureBefore);
+        Serial.printf_P(PSTR("│ After:  %-27d│\n"), result.moistureAfter);
+        Serial.printf_P(PSTR("│ Delta:  %-27d│\n"), (int)result.moistureAfter - (int)result.moistureBefore);
+        
+        if (!result.effective) {
+            Serial.printf_P(PSTR("│ ⚠️  NO EFFECT! Count: %d/%d%-10s│\n"), 
+                          result.noEffectCount, pumpConfig.maxNoEffectRepeats, "");
+            if (result.faultLocked) {
+                Serial.println(F("│                                     │"));
+                Serial.println(F("│ ❌ CRITICAL FAULT DETECTED!         │"));
+                Serial.println(F("│ → Pump ineffective                  │"));
+                Serial.println(F("│ → Auto-watering LOCKED              │"));
+            }
+        } else {
+            Serial.println(F("│ ✅ PUMP EFFECTIVE - Soil wetter     │"));
+            if (result.previousNoEffectCount > 0) {
+                Serial.printf_P(PSTR("│ Counter reset: %d → 0%-15s│\n"), result.previousNoEffectCount, "");
+            }
         }
-        noEffectCounter = 0;
+        Serial.println(F("└─────────────────────────────────────┘\n"));
+    }
+    
+    void onFaultLocked(uint8_t attempts) override {
+        TRACE_INSTANT(TRACE_FAULT_LOCKED, attempts);
+        deviceState = LOCKED_FAULT;
+        setLedPattern(LED_FAULT);
+        char details[40];
+        snprintf(details, sizeof(details), "Pump ineffective after %u attempts", attempts);
+        logEventToFirestore("fault_locked", details);
+    }
+    
+    void onPersistentStateChanged() override {
         savePumpState();
     }
-    Serial.println("└─────────────────────────────────────┘\n");
+};
+PumpEvents pumpEvents;
+
+void setupPump() {
+    pump.setListener(&pumpEvents);
+    pump.begin();
+#ifdef ZONE_COUNT
+    zoneBank.begin();
+#endif
 }
 
 // Firestore integration
 void syncWithFirestore() {
-    uint16_t moisture = analogRead(SENSOR_PIN);
-    String pumpStatus = getPumpStateString();
-    
-    sendDataToFirestore(moisture, pumpStatus, lastActivationMethod);
-    updateMainDeviceStatus(moisture, pumpStatus);
+    TelemetrySnapshot snapshot = captureTelemetry();
+    ReportReason reason = reportPolicy.evaluate(snapshot, millis(), snapshot.wifiRSSI,
+                                                ESP.getMaxFreeBlockSize());
+    // Low power: a fault or state change opens a window now, anything else
+    // waits for the next one
+    if (!power.networkAllowed()) {
+        if (reason != REPORT_FIRST && reason != REPORT_FAULT && reason != REPORT_STATE) return;
+        power.openWindow();
+        applyRadioMode(power.mode());
+    }
+#ifdef ZONE_COUNT
+    // Every zone rides along with a device report; zone changes alone are
+    // reported no more often than the device minimum interval. Zone
+    // documents are Firestore only.
+    bool zonesDue = !useMqtt &&
+                    (reason != REPORT_NONE ||
+                     (millis() - lastZoneReport >= reportConfig.minIntervalMs &&
+                      zoneBank.reportDue(reportConfig.moistureDeadband)));
+    if (zonesDue) {
+        zoneBank.queueTelemetry(firestoreBatch, firestorePaths.zonesCollection, snapshot.epoch);
+        lastZoneReport = millis();
+        if (reason == REPORT_NONE) firestoreBatch.flush();
+    }
+#endif
+    if (reason == REPORT_NONE) return;
+    
+    // Log, heartbeat and any queued events go out in one commit
+    sendDataToFirestore(snapshot);
+    updateMainDeviceStatus(snapshot);
+    firestoreBatch.flush();
+    reportPolicy.markSent(snapshot, reason, millis());
+    Serial.printf_P(PSTR("  (report: %s, %lu sent / %lu suppressed)\n"), reportReasonName(reason),
+                    (unsigned long)reportPolicy.sentCount(), (unsigned long)reportPolicy.suppressedCount());
 }
 
-void sendDataToFirestore(uint16_t moisture, const String& pumpStatus, const String& activationMethod) {
+TelemetrySnapshot captureTelemetry() {
+    TelemetrySnapshot snapshot;
+    snapshot.moisture = readMoisture();
+    snapshot.pumpState = pump.state();
+    snapshot.deviceState = deviceState;
+    snapshot.activationMethod = pump.lastActivationMethod();
+    snapshot.lockedFault = pump.lockedFault();
+    snapshot.noEffectCount = pump.noEffectCounter();
+    snapshot.wifiRSSI = WiFi.RSSI();
+    snapshot.uptimeSec = millis() / 1000;
+    snapshot.epoch = getCurrentEpoch();
+    snapshot.dryingTrained = dryingModel.trained();
+    snapshot.dryRateMean = dryingModel.meanRate();
+    snapshot.dryRateDailyCos = dryingModel.dailyCos();
+    snapshot.dryRateDailySin = dryingModel.dailySin();
+    snapshot.pumpResponse = dryingModel.response();
+    snapshot.predictedDryEpoch = snapshot.epoch && secondsToDry != DryingModel::NO_PREDICTION
+                                 ? snapshot.epoch + secondsToDry : 0;
+    snapshot.lowPower = powerConfig.lowPower;
+    snapshot.dutyCyclePct = power.dutyCyclePct();
+    snapshot.radioOnSec = power.radioOnSec();
+    return snapshot;
+}
+
+void sendDataToFirestore(const TelemetrySnapshot& snapshot) {
     if (!wifiConnected) return;
     
-    WiFiClientSecure client;
-    HTTPClient https;
-    client.setInsecure();
-    
-    // Create document in logs subcollection with timestamp-based ID
-    unsigned long timestamp = getCurrentEpoch();
-    String logId = String(timestamp) + "_" + String(millis() % 1000);
-    String url = "https://firestore.googleapis.com/v1/projects/" + firebaseProjectId + 
-                 "/databases/(default)/documents/plantData/" + deviceId + "/logs?documentId=" + logId + 
-                 "&key=" + firebaseApiKey;
-    
-    if (!https.begin(client, url)) {
-        Serial.println("✗ [FIREBASE] Connection failed");
+#ifdef MQTT_TRANSPORT
+    if (useMqtt) {
+        publishToMqtt("telemetry", false, [&](JsonObject fields) { buildLogFields(fields, snapshot); });
         return;
     }
+#endif
     
-    https.addHeader("Content-Type", "application/json");
-    
-    // Enhanced Firestore log with more details
-    JsonDocument doc;
-    doc["fields"]["moisture"]["integerValue"] = moisture;
-    doc["fields"]["pumpStatus"]["stringValue"] = pumpStatus;
-    doc["fields"]["activationMethod"]["stringValue"] = activationMethod;
-    doc["fields"]["deviceState"]["stringValue"] = getDeviceStateString();
-    doc["fields"]["wifiRSSI"]["integerValue"] = WiFi.RSSI();  // Signal strength
-    doc["fields"]["uptime"]["integerValue"] = millis() / 1000;  // Device uptime in seconds
-    doc["fields"]["lockedFault"]["booleanValue"] = lockedFault;
-    doc["fields"]["noEffectCount"]["integerValue"] = noEffectCounter;
-    doc["fields"]["timestamp"]["integerValue"] = timestamp;
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    
-    int httpCode = https.POST(jsonString);
-    
-    if (httpCode == 200 || httpCode == 201) {
-        Serial.printf("✓ [FIREBASE] Log sent → Moisture:%d, Pump:%s, State:%s\n", 
-                     moisture, pumpStatus.c_str(), getDeviceStateString().c_str());
-    } else {
-        Serial.printf("✗ [FIREBASE] Log failed (HTTP %d)\n", httpCode);
-        if (httpCode > 0) {
-            String response = https.getString();
-            Serial.println("   Response: " + response.substring(0, 200));  // First 200 chars
-        }
-    }
+    // Create document in logs subcollection with timestamp-based ID
+    char logId[24];
+    snprintf(logId, sizeof(logId), "%lu_%lu", (unsigned long)snapshot.epoch, millis() % 1000);
+    buildLogFields(firestoreBatch.add(firestorePaths.logsCollection, logId), snapshot);
     
-    https.end();
+    Serial.printf_P(PSTR("✓ [FIREBASE] Log queued → Moisture:%d, Pump:%s, State:%s\n"), 
+                 snapshot.moisture, pumpStateName(snapshot.pumpState),
+                 deviceStateName(snapshot.deviceState));
 }
 
-void updateMainDeviceStatus(uint16_t moisture, const String& pumpStatus) {
+void updateMainDeviceStatus(const TelemetrySnapshot& snapshot) {
     if (!wifiConnected) return;
     
-    WiFiClientSecure client;
-    HTTPClient https;
-    client.setInsecure();
-    
-    // Update main device document with heartbeat
+    // Update main device document with heartbeat (merge, so other fields are kept)
     // NOTE: We intentionally update status even in LOCKED_FAULT state
     // so the app knows the device is online and can send clear commands
-    String url = "https://firestore.googleapis.com/v1/projects/" + firebaseProjectId + 
-                 "/databases/(default)/documents/plantData/" + deviceId + 
-                 "?updateMask.fieldPaths=currentMoisture" +
-                 "&updateMask.fieldPaths=currentPumpStatus" +
-                 "&updateMask.fieldPaths=lockedFault" +
-                 "&updateMask.fieldPaths=lastSeen" +
-                 "&updateMask.fieldPaths=wifiRSSI" +
-                 "&updateMask.fieldPaths=uptime" +
-                 "&key=" + firebaseApiKey;
-    
-    if (!https.begin(client, url)) {
+#ifdef MQTT_TRANSPORT
+    if (useMqtt) {
+        publishToMqtt("status", true, [&](JsonObject fields) { buildStatusFields(fields, snapshot); });
         return;
     }
-    
-    https.addHeader("Content-Type", "application/json");
-    
-    JsonDocument doc;
-    doc["fields"]["currentMoisture"]["integerValue"] = moisture;
-    doc["fields"]["currentPumpStatus"]["stringValue"] = pumpStatus;
-    doc["fields"]["lockedFault"]["booleanValue"] = lockedFault;
-    // Use current Unix timestamp (seconds since epoch)
-    doc["fields"]["lastSeen"]["integerValue"] = getCurrentEpoch();
-    doc["fields"]["wifiRSSI"]["integerValue"] = WiFi.RSSI();
-    doc["fields"]["uptime"]["integerValue"] = millis() / 1000;
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    
-    int httpCode = https.PATCH(jsonString);
-    
-    if (httpCode == 200) {
-        Serial.printf("✓ [FIREBASE] Status updated → Last seen: %lu\n", getCurrentEpoch());
-    } else if (httpCode > 0) {
-        Serial.printf("✗ [FIREBASE] Status update failed (HTTP %d)\n", httpCode);
-    }
-    
-    https.end();
+#endif
+    buildStatusFields(firestoreBatch.add(firestorePaths.deviceDocument, nullptr, true), snapshot);
 }
 
-void checkForConfigUpdates() {
+void checkForRemoteUpdates() {
     if (!wifiConnected) return;
     
-    WiFiClientSecure client;
-    HTTPClient https;
-    client.setInsecure();
-    
-    // Get config document
-    String url = "https://firestore.googleapis.com/v1/projects/" + firebaseProjectId + 
-                 "/databases/(default)/documents/plantData/" + deviceId + "/config/settings" +
-                 "?key=" + firebaseApiKey;
+    // One batchGet for both documents, masked to the fields we act on
+    char body[REMOTE_REQUEST_SIZE];
+    {
+        JsonDocument request(&scratchArena);
+        request["documents"].add(firestorePaths.configName);
+        request["documents"].add(firestorePaths.commandsName);
+        JsonArray mask = request["mask"]["fieldPaths"].to<JsonArray>();
+        for (const char* field : REMOTE_FIELD_MASK) {
+            mask.add(field);
+        }
+        size_t n = serializeJson(request, body, sizeof(body));
+        if (n == 0 || n >= sizeof(body)) {
+            // A cut-off request is invalid JSON; Firestore would only answer 400
+            remoteTruncated++;
+            Serial.printf_P(PSTR("✗ [FIREBASE] Config/commands request over %u bytes, not sent (%lu times)\n"),
+                            (unsigned)sizeof(body), (unsigned long)remoteTruncated);
+            return;
+        }
+    }
     
-    if (!https.begin(client, url)) {
+    static char response[REMOTE_RESPONSE_SIZE];
+    int httpCode = firestore.request("POST", firestorePaths.batchGetPath, body,
+                                     response, sizeof(response));
+    if (httpCode == HTTP_RESPONSE_TRUNCATED) {
+        // Parsing a cut-off array would drop a command without a trace
+        remoteTruncated++;
+        Serial.printf_P(PSTR("✗ [FIREBASE] Config/commands response over %u bytes, ignored (%lu times)\n"),
+                        (unsigned)sizeof(response), (unsigned long)remoteTruncated);
         return;
     }
+    if (httpCode != 200) return;
+    
+    // Keep only what we need from the response
+    JsonDocument filter(&scratchArena);
+    filter[0]["found"]["name"] = true;
+    filter[0]["found"]["updateTime"] = true;
+    filter[0]["found"]["fields"] = true;
     
-    int httpCode = https.GET();
+    JsonDocument doc(&scratchArena);
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+    if (error) return;
     
-    if (httpCode == 200) {
-        String response = https.getString();
+    for (JsonObject result : doc.as<JsonArray>()) {
+        JsonObject found = result["found"];
+        if (found.isNull()) continue;  // Document does not exist
         
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, response);
+        const char* name = found["name"] | "";
+        const char* updateTime = found["updateTime"] | "";
         
-        if (!error && doc.containsKey("fields")) {
-            JsonObject fields = doc["fields"];
-            
-            bool changed = false;
-            
-            if (fields.containsKey("dryThreshold")) {
-                uint16_t newDry = fields["dryThreshold"]["integerValue"].as<uint16_t>();
-                if (newDry != DRY_THRESHOLD) {
-                    DRY_THRESHOLD = newDry;
-                    changed = true;
-                }
-            }
+        // Skip documents that haven't changed since the last poll
+        if (strcmp(firestorePaths.configName, name) == 0) {
+            if (strcmp(configUpdateTime, updateTime) == 0) continue;
+            strlcpy(configUpdateTime, updateTime, sizeof(configUpdateTime));
+            applyConfigUpdate(found["fields"]);
+            saveConfig();  // Even when values match, so the stored updateTime stays current
+        } else if (strcmp(firestorePaths.commandsName, name) == 0) {
+            if (strcmp(commandsUpdateTime, updateTime) == 0) continue;
+            strlcpy(commandsUpdateTime, updateTime, sizeof(commandsUpdateTime));
+            RemoteCommands handled = applyRemoteCommands(found["fields"]);
             
-            if (fields.containsKey("wetThreshold")) {
-                uint16_t newWet = fields["wetThreshold"]["integerValue"].as<uint16_t>();
-                if (newWet != WET_THRESHOLD) {
-                    WET_THRESHOLD = newWet;
-                    changed = true;
-                }
-            }
-            
-            if (fields.containsKey("pumpRunTime")) {
-                unsigned long newTime = fields["pumpRunTime"]["integerValue"].as<unsigned long>();
-                if (newTime != PUMP_RUN_TIME) {
-                    PUMP_RUN_TIME = newTime;
-                    changed = true;
-                }
-            }
-            
-            if (fields.containsKey("minIntervalSec")) {
-                unsigned long newInterval = fields["minIntervalSec"]["integerValue"].as<unsigned long>();
-                if (newInterval != MIN_INTERVAL_SEC) {
-                    MIN_INTERVAL_SEC = newInterval;
-                    changed = true;
-                }
-            }
-            
-            if (changed) {
-                Serial.println("✓ Config updated from Firestore");
-                // TODO: Save to local config file
+            // Clear handled command fields right away so the next poll doesn't repeat them
+            if (handled.any()) {
+                JsonObject clear = firestoreBatch.add(firestorePaths.commandsDocument, nullptr, true);
+                if (handled.clearFault) clear["clearFault"]["booleanValue"] = false;
+                if (handled.waterNow) clear["waterNow"]["booleanValue"] = false;
+                if (handled.waterZone) clear["waterZone"]["integerValue"] = -1;
+                firestoreBatch.flush();
             }
         }
     }
-    
-    https.end();
 }
 
-void checkForRemoteCommands() {
-    if (!wifiConnected) return;
+// Fields come typed from Firestore or plain from MQTT (fieldValue reads both).
+// Returns true if any value changed; the caller saves the config.
+bool applyConfigUpdate(JsonObject fields) {
+    bool changed = false;
+    
+    if (!fieldValue(fields, "dryThreshold").isNull()) {
+        uint16_t newDry = fieldValue(fields, "dryThreshold").as<uint16_t>();
+        if (newDry != pumpConfig.dryThreshold) {
+            pumpConfig.dryThreshold = newDry;
+            changed = true;
+        }
+    }
     
-    WiFiClientSecure client;
-    HTTPClient https;
-    client.setInsecure();
+    if (!fieldValue(fields, "wetThreshold").isNull()) {
+        uint16_t newWet = fieldValue(fields, "wetThreshold").as<uint16_t>();
+        if (newWet != pumpConfig.wetThreshold) {
+            pumpConfig.wetThreshold = newWet;
+            changed = true;
+        }
+    }
     
-    // Get pending commands document
-    String url = "https://firestore.googleapis.com/v1/projects/" + firebaseProjectId + 
-                 "/databases/(default)/documents/plantData/" + deviceId + "/commands/pending" +
-                 "?key=" + firebaseApiKey;
+    if (!fieldValue(fields, "pumpRunTime").isNull()) {
+        unsigned long newTime = fieldValue(fields, "pumpRunTime").as<unsigned long>();
+        if (newTime != pumpConfig.pumpRunTimeMs) {
+            pumpConfig.pumpRunTimeMs = newTime;
+            changed = true;
+        }
+    }
     
-    if (!https.begin(client, url)) {
-        return;
+    if (!fieldValue(fields, "minIntervalSec").isNull()) {
+        unsigned long newInterval = fieldValue(fields, "minIntervalSec").as<unsigned long>();
+        if (newInterval != pumpConfig.minIntervalSec) {
+            pumpConfig.minIntervalSec = newInterval;
+            changed = true;
+        }
     }
     
-    int httpCode = https.GET();
+    if (!fieldValue(fields, "adaptiveDosing").isNull()) {
+        bool newAdaptive = fieldValue(fields, "adaptiveDosing").as<bool>();
+        if (newAdaptive != pumpConfig.adaptiveDosing) {
+            pumpConfig.adaptiveDosing = newAdaptive;
+            changed = true;
+        }
+    }
     
-    if (httpCode == 200) {
-        String response = https.getString();
-        
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, response);
-        
-        if (!error && doc.containsKey("fields")) {
-            JsonObject fields = doc["fields"];
-            
-            // Check for clearFault command
-            if (fields.containsKey("clearFault") && 
-                fields["clearFault"]["booleanValue"].as<bool>()) {
-                
-                Serial.println("✓ Remote command: Clear Fault");
-                
-                if (lockedFault) {
-                    lockedFault = false;
-                    noEffectCounter = 0;
-                    savePumpState();
-                    deviceState = ONLINE;
-                    setLedPattern(LED_ONLINE);
-                    logEventToFirestore("fault_cleared", "Remote clear via app");
-                }
-                
-                // Clear the clearFault field
-                HTTPClient httpsPatch;
-                if (httpsPatch.begin(client, url + "&updateMask.fieldPaths=clearFault")) {
-                    httpsPatch.addHeader("Content-Type", "application/json");
-                    String clearPayload = "{\"fields\":{\"clearFault\":{\"booleanValue\":false}}}";
-                    httpsPatch.PATCH(clearPayload);
-                    httpsPatch.end();
-                }
-            }
-            
-            // Check for waterNow command
-            if (fields.containsKey("waterNow") && 
-                fields["waterNow"]["booleanValue"].as<bool>()) {
-                
-                Serial.println("✓ Remote command: Water Now");
-                
-                if (deviceState != LOCKED_FAULT && checkPumpSafety()) {
-                    activatePump("REMOTE");
-                } else {
-                    Serial.println("✗ Remote water command denied (safety/fault)");
-                }
-                
-                // Clear the waterNow field
-                HTTPClient httpsPatch;
-                if (httpsPatch.begin(client, url + "&updateMask.fieldPaths=waterNow")) {
-                    httpsPatch.addHeader("Content-Type", "application/json");
-                    String clearPayload = "{\"fields\":{\"waterNow\":{\"booleanValue\":false}}}";
-                    httpsPatch.PATCH(clearPayload);
-                    httpsPatch.end();
-                }
-            }
+    if (!fieldValue(fields, "maxPulseMs").isNull()) {
+        uint32_t newMaxPulse = fieldValue(fields, "maxPulseMs").as<uint32_t>();
+        if (newMaxPulse >= pumpConfig.minPulseMs && newMaxPulse != pumpConfig.maxPulseMs) {
+            pumpConfig.maxPulseMs = newMaxPulse;
+            changed = true;
+        }
+    }
+    
+    if (!fieldValue(fields, "reportDeadband").isNull()) {
+        uint16_t newDeadband = fieldValue(fields, "reportDeadband").as<uint16_t>();
+        if (newDeadband != reportConfig.moistureDeadband) {
+            reportConfig.moistureDeadband = newDeadband;
+            changed = true;
+        }
+    }
+    
+    if (!fieldValue(fields, "heartbeatSec").isNull()) {
+        uint32_t newHeartbeatMs = fieldValue(fields, "heartbeatSec").as<uint32_t>() * 1000UL;
+        if (newHeartbeatMs != 0 && newHeartbeatMs != reportConfig.heartbeatMs) {
+            reportConfig.heartbeatMs = newHeartbeatMs;
+            changed = true;
         }
     }
     
-    https.end();
+    if (!fieldValue(fields, "lowPower").isNull()) {
+        bool newLowPower = fieldValue(fields, "lowPower").as<bool>();
+        if (newLowPower != powerConfig.lowPower) {
+            powerConfig.lowPower = newLowPower;
+            applyPowerMode();
+            changed = true;
+        }
+    }
+    
+    if (changed) {
+        Serial.println(F("✓ Config updated remotely"));
+    }
+    return changed;
 }
 
-void logEventToFirestore(const String& eventType, const String& details) {
-    if (!wifiConnected) return;
+RemoteCommands applyRemoteCommands(JsonObject fields) {
+    RemoteCommands handled;
     
-    WiFiClientSecure client;
-    HTTPClient https;
-    client.setInsecure();
+    // Check for clearFault command
+    if (fieldValue(fields, "clearFault").as<bool>()) {
+        
+        Serial.println(F("✓ Remote command: Clear Fault"));
+        
+        if (pump.clearFault()) {
+            deviceState = ONLINE;
+            setLedPattern(LED_ONLINE);
+            logEventToFirestore("fault_cleared", "Remote clear via app");
+        }
+#ifdef ZONE_COUNT
+        if (zoneBank.clearFaults() > 0) {
+            logEventToFirestore("zone_fault_cleared", "Remote clear via app");
+        }
+#endif
+        
+        handled.clearFault = true;
+    }
     
-    String logId = String(millis());
-    String url = "https://firestore.googleapis.com/v1/projects/" + firebaseProjectId + 
-                 "/databases/(default)/documents/plantData/" + deviceId + "/logs?documentId=" + logId + 
-                 "&key=" + firebaseApiKey;
+    // Check for waterNow command
+    if (fieldValue(fields, "waterNow").as<bool>()) {
+        
+        Serial.println(F("✓ Remote command: Water Now"));
+        
+        if (!pump.lockedFault() && checkPumpSafety()) {
+            activatePump(ACTIVATION_REMOTE);
+        } else {
+            Serial.println(F("✗ Remote water command denied (safety/fault)"));
+        }
+        
+        handled.waterNow = true;
+    }
     
-    if (!https.begin(client, url)) {
-        return;
+#ifdef ZONE_COUNT
+    // waterZone: zone number to water (-1 when there is nothing to do)
+    JsonVariant zoneValue = fieldValue(fields, "waterZone");
+    int waterZone = zoneValue.isNull() ? -1 : zoneValue.as<int>();
+    if (waterZone >= 0) {
+        int result = zoneBank.water(waterZone, ACTIVATION_REMOTE);
+        Serial.printf_P(PSTR("%s Remote command: Water zone %d (%d)\n"),
+                        result == 200 ? "✓" : "✗", waterZone, result);
+        handled.waterZone = true;
     }
+#endif
     
-    https.addHeader("Content-Type", "application/json");
+    return handled;
+}
+
+#ifdef MQTT_TRANSPORT
+void onMqttCommand(JsonObject fields) {
+    applyRemoteCommands(fields);  // Acknowledged by the broker session, nothing to clear
+}
+
+void onMqttConfig(JsonObject fields) {
+    // The retained config comes again on every reconnect; save only changes
+    if (applyConfigUpdate(fields)) saveConfig();
+}
+#endif
+
+void logEventToFirestore(const char* eventType, const char* details) {
+    if (!wifiConnected) {
+        queueOfflineEvent(eventType);
+        return;
+    }
     
-    JsonDocument doc;
-    doc["fields"]["eventType"]["stringValue"] = eventType;
-    doc["fields"]["details"]["stringValue"] = details;
+#ifdef MQTT_TRANSPORT
+    if (useMqtt) {
+        // Kept for later like an offline event if the broker is unreachable
+        if (!publishToMqtt("events", false, [&](JsonObject fields) {
+                buildEventFields(fields, eventType, details);
+            })) {
+            queueOfflineEvent(eventType);
+        }
+        return;
+    }
+#endif
     
-    String jsonString;
-    serializeJson(doc, jsonString);
+    // Queued; goes out with the next commit
+    char logId[12];
+    snprintf(logId, sizeof(logId), "%lu", millis());
+    buildEventFields(firestoreBatch.add(firestorePaths.logsCollection, logId),
+                     eventType, details);
+}
+
+// Offline store-and-forward
+void queueOfflineReading() {
+    TelemetryRecord record = {};
+    record.type = TELEMETRY_READING;
+    record.epoch = getCurrentEpoch();
+    record.uptimeSec = millis() / 1000;
+    record.moisture = readMoisture();
+    record.pumpState = pump.state();
+    record.flags = pump.lockedFault() ? TELEMETRY_FLAG_LOCKED_FAULT : 0;
+    
+    if (telemetryQueue.push(record)) {
+        Serial.printf_P(PSTR("ℹ [QUEUE] Offline reading stored (%u pending)\n"), (unsigned)telemetryQueue.pending());
+    }
+}
+
+void queueOfflineEvent(const char* eventType) {
+    TelemetryRecord record = {};
+    record.epoch = getCurrentEpoch();
+    record.uptimeSec = millis() / 1000;
+    record.moisture = readMoisture();
+    record.pumpState = pump.state();
+    record.flags = pump.lockedFault() ? TELEMETRY_FLAG_LOCKED_FAULT : 0;
+    
+    if (strcmp(eventType, "pump_activated") == 0) {
+        record.type = TELEMETRY_PUMP_ACTIVATED;
+        record.moisture = pump.moistureBeforePump();
+        record.detail = pump.lastActivationMethod();
+    } else if (strcmp(eventType, "fault_locked") == 0) {
+        record.type = TELEMETRY_FAULT_LOCKED;
+        record.detail = pump.noEffectCounter();
+    } else if (strcmp(eventType, "fault_cleared") == 0) {
+        record.type = TELEMETRY_FAULT_CLEARED;
+    } else {
+        return;
+    }
     
-    https.POST(jsonString);
-    https.end();
+    if (!telemetryQueue.push(record)) {
+        Serial.println(F("⚠ [QUEUE] Event not stored (write budget or storage)"));
+    }
+}
+
+void drainTelemetryQueue() {
+    // Send what is already queued first, so the backlog commit carries
+    // stored records only and a rejection can be pinned on them
+    if (firestoreBatch.pending() > 0 && !firestoreBatch.flush()) return;
+    
+    TelemetryRecord records[QUEUE_DRAIN_BATCH];
+    uint32_t lastSeq;
+    size_t count = telemetryQueue.peek(records, QUEUE_DRAIN_BATCH, lastSeq);
+    
+    bool sent = true;
+    uint32_t evicted = firestoreBatch.evictedCount();
+    for (size_t i = 0; i < count && sent; i++) {
+        sent = queueRecordToFirestore(records[i]);
+    }
+    if (!sent) return;
+    
+    // Acknowledge only once the commit is confirmed; a lost ack just
+    // re-sends the same document IDs. Transient failures keep the records
+    // for the next attempt; a rejected commit would be rejected forever, so
+    // those records are skipped and counted.
+    bool committed = firestoreBatch.flush();
+    if (committed && firestoreBatch.evictedCount() == evicted) {
+        telemetryQueue.ack(lastSeq);
+        if (count > 0) {
+            Serial.printf_P(PSTR("✓ [QUEUE] Uploaded %u stored records (%u left)\n"),
+                          (unsigned)count, (unsigned)telemetryQueue.pending());
+        }
+    } else if (!committed && firestoreBatch.lastCommitRejected()) {
+        telemetryQueue.reject(lastSeq);
+        Serial.printf_P(PSTR("✗ [QUEUE] Skipped %u rejected records (%lu so far)\n"),
+                      (unsigned)count, (unsigned long)telemetryQueue.rejectedCount());
+    }
+}
+
+// False if the record could not be sent (MQTT only; commits fail in flush)
+bool queueRecordToFirestore(const TelemetryRecord& record) {
+#ifdef MQTT_TRANSPORT
+    if (useMqtt) {
+        return publishToMqtt("telemetry", false, [&](JsonObject fields) {
+            buildStoredRecordFields(fields, record);
+        });
+    }
+#endif
+    char logId[24];
+    storedRecordLogId(record, logId, sizeof(logId));
+    buildStoredRecordFields(firestoreBatch.add(firestorePaths.logsCollection, logId), record);
+    return true;
 }
 
 // Web server
@@ -1260,76 +1772,66 @@ void setupWebServer() {
     server.on("/water", HTTP_POST, handleManualWater);
     server.on("/clearFault", HTTP_POST, handleClearFault);
     server.on("/resetWiFi", HTTP_POST, handleResetWiFi);
+#ifdef LOOP_METRICS
+    server.on("/metrics", HTTP_GET, []() {
+        const MoistureSnapshot& sample = moistureSampler.snapshot();
+        LiveGauges live;
+        live.moistureRaw = sample.lastMedian;
+        live.sampleAgeMs = millis() - sample.timestampMs;
+        live.adcReads = moistureSampler.adcReadCount();
+        live.adcDeferred = moistureSampler.deferredCount();
+        live.dryRatePerHour = dryRateNow;
+        live.secondsToDry = secondsToDry == DryingModel::NO_PREDICTION ? -1 : (int32_t)secondsToDry;
+        live.dutyCyclePct = power.dutyCyclePct();
+        live.radioOnPct = power.radioOnPct();
+        loopMetrics.writePrometheus(server, live);
+    });
+#endif
+#ifdef TRACE_EVENTS
+    server.on("/trace", HTTP_GET, handleGetTrace);
+#endif
+    server.on("/tasks", HTTP_GET, handleGetTasks);
+#ifdef ZONE_COUNT
+    server.on("/zones", HTTP_GET, handleGetZones);
+    server.on("/zones/water", HTTP_POST, handleWaterZone);
+#endif
     
     server.onNotFound([]() {
         server.send(404, "text/plain", "Not Found");
     });
     
+    // Request headers are only kept when asked for (ETag revalidation)
+    static const char* requestHeaders[] = {"If-None-Match"};
+    server.collectHeaders(requestHeaders, 1);
+    
     server.begin();
-    Serial.println("✓ Web server started on port 80");
+    Serial.println(F("✓ Web server started on port 80"));
 }
 
+// Static gzip page from flash; live values come from /status in the browser.
+// no-cache makes browsers revalidate, and a matching ETag costs a 304 only.
 void handleRoot() {
-    String html = "<!DOCTYPE html><html><head><title>Smart Irrigation</title>";
-    html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-    html += "<style>body{font-family:Arial;margin:20px;} .status{padding:10px;margin:10px 0;border-radius:5px;} ";
-    html += ".online{background:#d4edda;} .offline{background:#f8d7da;} .fault{background:#ff6b6b;color:white;} ";
-    html += "button{padding:10px 20px;margin:5px;font-size:16px;cursor:pointer;}</style></head><body>";
-    
-    html += "<h1>🌱 Smart Irrigation System</h1>";
-    html += "<div class='status " + String(lockedFault ? "fault" : (wifiConnected ? "online" : "offline")) + "'>";
-    html += "<h2>Status: " + getDeviceStateString() + "</h2>";
-    html += "<p><strong>Device ID:</strong> " + deviceId + "</p>";
-    html += "<p><strong>Moisture:</strong> " + String(analogRead(SENSOR_PIN)) + "</p>";
-    html += "<p><strong>Pump:</strong> " + getPumpStateString() + "</p>";
-    html += "<p><strong>WiFi:</strong> " + String(wifiConnected ? "Connected" : "Disconnected") + "</p>";
-    
-    if (lockedFault) {
-        html += "<p>⚠️ <strong>FAULT LOCKED</strong> - Pump appears ineffective</p>";
-    }
-    
-    html += "</div>";
-    
-    html += "<h3>Controls</h3>";
-    html += "<button onclick='fetch(\"/water\",{method:\"POST\"}).then(()=>location.reload())'>💧 Water Now</button>";
-    
-    if (lockedFault) {
-        html += "<button onclick='fetch(\"/clearFault\",{method:\"POST\"}).then(()=>location.reload())'>✓ Clear Fault</button>";
+    server.sendHeader("ETag", DASHBOARD_ETAG);
+    server.sendHeader("Cache-Control", "no-cache");
+    if (server.header("If-None-Match") == DASHBOARD_ETAG) {
+        server.send(304);
+        return;
     }
-    
-    html += "<button onclick='if(confirm(\"Reset WiFi?\")){fetch(\"/resetWiFi\",{method:\"POST\"})}'>🔄 Reset WiFi</button>";
-    
-    html += "<h3>Configuration</h3>";
-    html += "<p>Dry Threshold: " + String(DRY_THRESHOLD) + "</p>";
-    html += "<p>Wet Threshold: " + String(WET_THRESHOLD) + "</p>";
-    html += "<p>Pump Run Time: " + String(PUMP_RUN_TIME) + " ms</p>";
-    html += "<p>Min Interval: " + String(MIN_INTERVAL_SEC) + " sec</p>";
-    
-    html += "</body></html>";
-    
-    server.send(200, "text/html", html);
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, "text/html", (PGM_P)DASHBOARD_GZ, DASHBOARD_GZ_LENGTH);
 }
 
+// Served from the snapshot published by the last loop tick; see StatusSnapshot.h
 void handleGetStatus() {
-    JsonDocument doc;
-    doc["deviceId"] = deviceId;
-    doc["moisture"] = analogRead(SENSOR_PIN);
-    doc["pumpState"] = getPumpStateString();
-    doc["deviceState"] = getDeviceStateString();
-    doc["wifiConnected"] = wifiConnected;
-    doc["lockedFault"] = lockedFault;
-    doc["dryThreshold"] = DRY_THRESHOLD;
-    doc["wetThreshold"] = WET_THRESHOLD;
-    doc["pumpRunTime"] = PUMP_RUN_TIME;
-    doc["minIntervalSec"] = MIN_INTERVAL_SEC;
-    
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    size_t length;
+    const char* body = statusCache.body(length);
+    server.setContentLength(length);
+    server.send(200, "application/json", "");
+    server.sendContent(body, length);
 }
 
 void handleManualWater() {
-    if (deviceState == LOCKED_FAULT) {
+    if (pump.lockedFault()) {
         server.send(403, "application/json", "{\"error\":\"Device in fault state\"}");
         return;
     }
@@ -1339,16 +1841,22 @@ void handleManualWater() {
         return;
     }
     
-    activatePump("WEB");
+    activatePump(ACTIVATION_WEB);
     server.send(200, "application/json", "{\"status\":\"Pump activated\"}");
 }
 
 void handleClearFault() {
-    if (lockedFault) {
-        lockedFault = false;
-        noEffectCounter = 0;
-        savePumpState();
-        deviceState = wifiConnected ? ONLINE : OFFLINE;
+#ifdef ZONE_COUNT
+    if (zoneBank.clearFaults() > 0) {
+        logEventToFirestore("zone_fault_cleared", "Cleared via web interface");
+        if (!pump.lockedFault()) {
+            server.send(200, "application/json", "{\"status\":\"Zone faults cleared\"}");
+            return;
+        }
+    }
+#endif
+    if (pump.clearFault()) {
+        deviceState = connectedDeviceState(wifiConnected, false);
         setLedPattern(wifiConnected ? LED_ONLINE : LED_OFFLINE);
         logEventToFirestore("fault_cleared", "Cleared via web interface");
         server.send(200, "application/json", "{\"status\":\"Fault cleared\"}");
@@ -1366,29 +1874,71 @@ void handleResetWiFi() {
     }
     
     WiFi.disconnect(true);
+    pumpJournal.flush();
+    dryingModel.flush();
+#ifdef ZONE_COUNT
+    zoneBank.flush();
+#endif
     ESP.restart();
 }
 
-// Utility functions
-String getDeviceStateString() {
-    switch (deviceState) {
-        case AWAITING_CONFIG: return "AWAITING_CONFIG";
-        case ONLINE: return "ONLINE";
-        case OFFLINE: return "OFFLINE";
-        case LOCKED_FAULT: return "LOCKED_FAULT";
-        default: return "UNKNOWN";
+#ifdef TRACE_EVENTS
+// Stream the trace ring as Chrome Trace Event JSON (load in ui.perfetto.dev)
+void handleGetTrace() {
+    server.sendHeader("Content-Disposition", "attachment; filename=\"irrigation-trace.json\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    traceRecorder.writeChromeJson([](const char* chunk) { server.sendContent(chunk); });
+    server.sendContent("");  // Terminating chunk
+}
+#endif
+
+// Per-task scheduler stats, chunked, one task per chunk
+void handleGetTasks() {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    
+    char chunk[224];
+    uint32_t uptimeMs = millis();
+    snprintf(chunk, sizeof(chunk), "{\"passes\":%lu,\"idlePct\":%.1f,\"tasks\":[",
+             (unsigned long)scheduler.passCount(),
+             uptimeMs ? scheduler.idleMs() * 100.0 / uptimeMs : 0.0);
+    server.sendContent(chunk);
+    
+    for (uint8_t i = 0; i < scheduler.count(); i++) {
+        const TaskStats& task = scheduler.stats(i);
+        snprintf(chunk, sizeof(chunk), "%s{\"name\":\"%s\",\"periodMs\":%lu,\"runs\":%lu,"
+                 "\"overruns\":%lu,\"skipped\":%lu,\"maxLateMs\":%lu,\"maxRunUs\":%lu,"
+                 "\"avgRunUs\":%lu}",
+                 i ? "," : "", task.name, (unsigned long)task.periodMs, (unsigned long)task.runs,
+                 (unsigned long)task.overruns, (unsigned long)task.skipped,
+                 (unsigned long)task.maxLateMs, (unsigned long)task.maxRunUs,
+                 (unsigned long)(task.runs ? task.totalRunUs / task.runs : 0));
+        server.sendContent(chunk);
     }
+    server.sendContent("]}");
+    server.sendContent("");  // Terminating chunk
 }
 
-String getPumpStateString() {
-    switch (pumpState) {
-        case MONITORING: return "MONITORING";
-        case PUMP_RUNNING: return "PUMP_RUNNING";
-        case PUMP_WAITING: return "PUMP_WAITING";
-        default: return "UNKNOWN";
+#ifdef ZONE_COUNT
+void handleGetZones() {
+    zoneBank.writeJson(server);
+}
+
+// POST /zones/water?zone=<n>; the cycle starts when a pump slot is free
+void handleWaterZone() {
+    int zone = server.hasArg("zone") ? server.arg("zone").toInt() : -1;
+    int result = zone < 0 ? 400 : zoneBank.water(zone, ACTIVATION_WEB);
+    switch (result) {
+        case 200: server.send(200, "application/json", "{\"status\":\"Zone queued\"}"); break;
+        case 403: server.send(403, "application/json", "{\"error\":\"Zone in fault state\"}"); break;
+        case 429: server.send(429, "application/json", "{\"error\":\"Too soon or already watering\"}"); break;
+        default: server.send(400, "application/json", "{\"error\":\"No such zone\"}"); break;
     }
 }
+#endif
 
+// Utility functions
 unsigned long getCurrentEpoch() {
     // Get current Unix timestamp from NTP-synchronized time
     time_t now = time(nullptr);
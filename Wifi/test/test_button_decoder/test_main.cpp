@@ -0,0 +1,180 @@
+/*
+ * ButtonDecoder host tests - synthetic edge streams in, decoded actions out
+ *
+ *   pio test -e native -f test_button_decoder
+ *
+ * Timings match the firmware: 50 ms debounce, 5 s long press, 800 ms
+ * triple-press window.
+ */
+
+#include <unity.h>
+#include "ButtonDecoder.h"
+#include "SpscRing.h"
+
+const uint32_t DEBOUNCE_MS = 50;
+const uint32_t LONG_PRESS_MS = 5000;
+const uint32_t TRIPLE_WINDOW_MS = 800;
+
+ButtonDecoder decoder(DEBOUNCE_MS, LONG_PRESS_MS, TRIPLE_WINDOW_MS);
+
+void setUp() {
+    decoder = ButtonDecoder(DEBOUNCE_MS, LONG_PRESS_MS, TRIPLE_WINDOW_MS);
+}
+
+void tearDown() {}
+
+static void edge(uint32_t timeMs, bool pressed) {
+    decoder.feed(ButtonEdge{timeMs, pressed});
+}
+
+// Clean press held for holdMs
+static void press(uint32_t atMs, uint32_t holdMs) {
+    edge(atMs, true);
+    edge(atMs + holdMs, false);
+}
+
+void test_short_press_after_triple_window() {
+    press(1000, 120);
+
+    // Still inside the window a second press could extend
+    decoder.advance(1000 + TRIPLE_WINDOW_MS);
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+
+    decoder.advance(1000 + TRIPLE_WINDOW_MS + 1);
+    TEST_ASSERT_EQUAL(SHORT_PRESS, decoder.takeAction());
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_long_press_fires_while_held() {
+    edge(1000, true);
+    decoder.advance(1000 + LONG_PRESS_MS - 1);
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+    TEST_ASSERT_TRUE(decoder.isPressed());
+
+    decoder.advance(1000 + LONG_PRESS_MS);
+    TEST_ASSERT_EQUAL(LONG_PRESS, decoder.takeAction());
+
+    // Releasing afterwards is not also a short press
+    edge(7000, false);
+    decoder.advance(20000);
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_triple_press_reported_on_third_press() {
+    press(1000, 80);
+    press(1250, 80);
+    edge(1500, true);
+
+    // Reported once the third press is debounced, not after the window
+    decoder.advance(1500 + DEBOUNCE_MS);
+    TEST_ASSERT_EQUAL(TRIPLE_PRESS, decoder.takeAction());
+
+    edge(1580, false);
+    decoder.advance(10000);
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_presses_outside_window_are_separate() {
+    press(1000, 80);
+    press(1000 + TRIPLE_WINDOW_MS + 100, 80);
+    decoder.advance(5000);
+    TEST_ASSERT_EQUAL(SHORT_PRESS, decoder.takeAction());
+    TEST_ASSERT_EQUAL(SHORT_PRESS, decoder.takeAction());
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_double_press_expires_without_action() {
+    press(1000, 80);
+    press(1300, 80);
+    decoder.advance(5000);
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_bounce_shorter_than_debounce_is_ignored() {
+    // Contact chatter that never stays down for 50 ms
+    edge(1000, true);
+    edge(1010, false);
+    edge(1020, true);
+    edge(1030, false);
+    edge(1045, true);
+    edge(1060, false);
+    decoder.advance(5000);
+    TEST_ASSERT_FALSE(decoder.isPressed());
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_bouncy_press_counts_once() {
+    // Chatter on both edges of one real press
+    edge(1000, true);
+    edge(1004, false);
+    edge(1008, true);
+    edge(1200, false);
+    edge(1203, true);
+    edge(1207, false);
+    decoder.advance(3000);
+    TEST_ASSERT_EQUAL(SHORT_PRESS, decoder.takeAction());
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_late_drain_decodes_the_same() {
+    // Edges timestamped at interrupt time, drained seconds later in one go
+    press(1000, 100);
+    press(1200, 100);
+    press(1400, 100);
+    decoder.advance(9000);
+    TEST_ASSERT_EQUAL(TRIPLE_PRESS, decoder.takeAction());
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+}
+
+void test_action_queue_drops_when_full() {
+    // Five long presses with nobody taking actions; the queue holds four
+    for (uint32_t i = 0; i < 5; i++) {
+        uint32_t start = 1000 + i * 10000;
+        edge(start, true);
+        decoder.advance(start + LONG_PRESS_MS);
+        edge(start + LONG_PRESS_MS + 100, false);
+    }
+    decoder.advance(60000);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(LONG_PRESS, decoder.takeAction());
+    }
+    TEST_ASSERT_EQUAL(NONE, decoder.takeAction());
+
+    // Room again once drained
+    press(70000, 100);
+    decoder.advance(72000);
+    TEST_ASSERT_EQUAL(SHORT_PRESS, decoder.takeAction());
+}
+
+void test_edge_ring_refuses_when_full() {
+    // The interrupt-side ring keeps one slot free
+    SpscRing<ButtonEdge, 8> ring;
+    for (uint32_t i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(ring.push(ButtonEdge{i, (i % 2) == 0}));
+    }
+    TEST_ASSERT_FALSE(ring.push(ButtonEdge{7, false}));
+
+    // Edges that made it come out in order
+    ButtonEdge out;
+    for (uint32_t i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL_UINT32(i, out.timeMs);
+    }
+    TEST_ASSERT_FALSE(ring.pop(out));
+    TEST_ASSERT_TRUE(ring.push(ButtonEdge{8, true}));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_short_press_after_triple_window);
+    RUN_TEST(test_long_press_fires_while_held);
+    RUN_TEST(test_triple_press_reported_on_third_press);
+    RUN_TEST(test_presses_outside_window_are_separate);
+    RUN_TEST(test_double_press_expires_without_action);
+    RUN_TEST(test_bounce_shorter_than_debounce_is_ignored);
+    RUN_TEST(test_bouncy_press_counts_once);
+    RUN_TEST(test_late_drain_decodes_the_same);
+    RUN_TEST(test_action_queue_drops_when_full);
+    RUN_TEST(test_edge_ring_refuses_when_full);
+    return UNITY_END();
+}
@@ -0,0 +1,262 @@
+/*
+ * PumpController host tests - the single-pump state machine on FakeHal
+ *
+ *   pio test -e native -f test_pump_controller
+ *
+ * Readings of 600 (dry) and 400 (wet) against the default PumpConfig: dry
+ * at 520, wet at 420, 2 s pulse, 30 s minimum interval, effectiveness
+ * re-read 20 s after the pump stops. The fault locks after 3 ineffective
+ * cycles instead of 10.
+ */
+
+#include <unity.h>
+#include "FakeHal.h"
+#include "PumpController.h"
+
+const uint8_t PUMP_PIN = 5;
+const uint16_t DRY = 600;
+const uint16_t WET = 400;
+
+class RecordingListener : public PumpListener {
+public:
+    void onPumpStarted(ActivationMethod method, uint16_t moistureBefore) override {
+        started++;
+        lastMethod = method;
+        lastMoistureBefore = moistureBefore;
+    }
+    void onPumpStopped() override { stopped++; }
+    void onMonitoringResumed() override { resumed++; }
+    void onEffectivenessChecked(const EffectivenessResult& result) override {
+        checks++;
+        lastResult = result;
+    }
+    void onFaultLocked(uint8_t attempts) override { faultAttempts = attempts; }
+    void onPersistentStateChanged() override { saves++; }
+
+    int started = 0;
+    int stopped = 0;
+    int resumed = 0;
+    int checks = 0;
+    int saves = 0;
+    uint8_t faultAttempts = 0;
+    ActivationMethod lastMethod = ACTIVATION_NONE;
+    uint16_t lastMoistureBefore = 0;
+    EffectivenessResult lastResult = {};
+};
+
+FakeClock* fakeClock = nullptr;
+FakeGpio* gpio = nullptr;
+PumpConfig* config = nullptr;
+PumpController* pump = nullptr;
+RecordingListener* listener = nullptr;
+
+void setUp() {
+    fakeClock = new FakeClock();
+    gpio = new FakeGpio();
+    config = new PumpConfig();
+    config->maxNoEffectRepeats = 3;
+    listener = new RecordingListener();
+    pump = new PumpController(*fakeClock, *gpio, PUMP_PIN, *config);
+    pump->setListener(listener);
+    pump->begin();
+}
+
+void tearDown() {
+    delete pump;
+    delete listener;
+    delete config;
+    delete gpio;
+    delete fakeClock;
+}
+
+// Run the state machine for ms at a fixed reading, 100 ms per tick
+static void run(uint32_t ms, uint16_t moisture) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += 100) {
+        fakeClock->advance(100);
+        pump->update(moisture);
+    }
+}
+
+// One automatic cycle from a dry reading to monitoring again, with the
+// soil reading afterMoisture once watered
+static void autoCycle(uint16_t afterMoisture) {
+    pump->update(DRY);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+    run(config->minIntervalSec * 1000 + config->pumpRunTimeMs, afterMoisture);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+}
+
+void test_stays_idle_while_wet() {
+    run(60000, config->dryThreshold - 1);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+    TEST_ASSERT_EQUAL(0, listener->started);
+    TEST_ASSERT_FALSE(gpio->read(PUMP_PIN));
+}
+
+void test_dry_reading_runs_a_full_cycle() {
+    pump->update(DRY);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+    TEST_ASSERT_TRUE(gpio->read(PUMP_PIN));
+    TEST_ASSERT_EQUAL(1, listener->started);
+    TEST_ASSERT_EQUAL(ACTIVATION_AUTO, listener->lastMethod);
+    TEST_ASSERT_EQUAL(DRY, listener->lastMoistureBefore);
+
+    // Pump stays on for the pulse, then waits
+    run(config->pumpRunTimeMs - 100, DRY);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+    run(100, DRY);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, pump->state());
+    TEST_ASSERT_FALSE(gpio->read(PUMP_PIN));
+    TEST_ASSERT_EQUAL(1, listener->stopped);
+    TEST_ASSERT_EQUAL(fakeClock->epoch(), pump->lastPumpEndEpoch());
+
+    // Back to monitoring once the minimum interval is over
+    run(config->minIntervalSec * 1000 - 100, WET);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, pump->state());
+    run(100, WET);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+    TEST_ASSERT_EQUAL(1, listener->resumed);
+    TEST_ASSERT_EQUAL(1, listener->started);
+}
+
+void test_effective_cycle_checked_after_settle() {
+    pump->update(DRY);
+    run(config->pumpRunTimeMs, DRY);
+    run(config->settleMs - 100, WET);
+    TEST_ASSERT_EQUAL(0, listener->checks);
+    run(100, WET);
+    TEST_ASSERT_EQUAL(1, listener->checks);
+    TEST_ASSERT_TRUE(listener->lastResult.effective);
+    TEST_ASSERT_EQUAL(DRY, listener->lastResult.moistureBefore);
+    TEST_ASSERT_EQUAL(WET, listener->lastResult.moistureAfter);
+    TEST_ASSERT_EQUAL(0, pump->noEffectCounter());
+}
+
+void test_safety_interval_blocks_restart() {
+    // Last cycle ended 10 s ago (restored after a reboot)
+    PumpPersistentState state;
+    state.lastPumpEndEpoch = fakeClock->epoch() - 10;
+    pump->restore(state);
+
+    TEST_ASSERT_FALSE(pump->checkSafety());
+    TEST_ASSERT_EQUAL_UINT32(config->minIntervalSec - 10, pump->safetyWaitSec());
+    run(19000, DRY);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+    TEST_ASSERT_EQUAL(0, listener->started);
+
+    run(1000, DRY);
+    TEST_ASSERT_TRUE(pump->checkSafety());
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+}
+
+void test_ineffective_cycles_lock_fault() {
+    // Watering never lowers the reading
+    for (uint8_t cycle = 1; cycle < config->maxNoEffectRepeats; cycle++) {
+        autoCycle(DRY);
+        TEST_ASSERT_EQUAL(cycle, pump->noEffectCounter());
+        TEST_ASSERT_FALSE(pump->lockedFault());
+        TEST_ASSERT_FALSE(listener->lastResult.effective);
+    }
+    autoCycle(DRY);
+    TEST_ASSERT_TRUE(pump->lockedFault());
+    TEST_ASSERT_TRUE(listener->lastResult.faultLocked);
+    TEST_ASSERT_EQUAL(config->maxNoEffectRepeats, listener->faultAttempts);
+
+    // Locked: a dry reading no longer starts the pump
+    int started = listener->started;
+    run(120000, DRY);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+    TEST_ASSERT_EQUAL(started, listener->started);
+}
+
+void test_drop_below_required_is_no_effect() {
+    autoCycle(DRY - (PumpController::REQUIRED_DROP - 1));
+    TEST_ASSERT_EQUAL(1, pump->noEffectCounter());
+    autoCycle(DRY - PumpController::REQUIRED_DROP);
+    TEST_ASSERT_EQUAL(0, pump->noEffectCounter());
+}
+
+void test_manual_cycle_skips_effectiveness_check() {
+    pump->activate(ACTIVATION_MANUAL, WET);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+    run(config->pumpRunTimeMs + config->minIntervalSec * 1000, WET);
+    TEST_ASSERT_EQUAL(MONITORING, pump->state());
+    TEST_ASSERT_EQUAL(0, listener->checks);
+    TEST_ASSERT_EQUAL(ACTIVATION_MANUAL, pump->lastActivationMethod());
+}
+
+void test_clear_fault_resumes_auto_watering() {
+    for (uint8_t cycle = 0; cycle < config->maxNoEffectRepeats; cycle++) {
+        autoCycle(DRY);
+    }
+    TEST_ASSERT_TRUE(pump->lockedFault());
+
+    int saves = listener->saves;
+    TEST_ASSERT_TRUE(pump->clearFault());
+    TEST_ASSERT_FALSE(pump->lockedFault());
+    TEST_ASSERT_EQUAL(0, pump->noEffectCounter());
+    TEST_ASSERT_EQUAL(saves + 1, listener->saves);
+    TEST_ASSERT_FALSE(pump->clearFault());
+
+    pump->update(DRY);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pump->state());
+}
+
+void test_phase_survives_a_rebuilt_controller() {
+    // A deep-sleep wake: same clock, fresh controller, phase from RTC memory
+    config->pumpUntilWet = true;
+    pump->update(DRY);
+    run(config->pumpRunTimeMs, DRY);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, pump->state());
+    ZonePhase saved = pump->phase();
+
+    PumpController woken(*fakeClock, *gpio, PUMP_PIN, *config);
+    woken.begin();
+    woken.restorePhase(saved);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, woken.state());
+    fakeClock->advance(config->minIntervalSec * 1000 - 100);
+    woken.update(DRY);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, woken.state());
+
+    // Still dry when the wait is over: the automatic cycle goes again
+    fakeClock->advance(100);
+    woken.update(DRY);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, woken.state());
+    TEST_ASSERT_EQUAL(ACTIVATION_AUTO, woken.lastActivationMethod());
+}
+
+void test_restored_run_counts_as_done() {
+    pump->update(DRY);
+    ZonePhase saved = pump->phase();
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, saved.state);
+
+    // Reset mid-run: the relay came up off and stays off
+    fakeClock->advance(500);
+    PumpController woken(*fakeClock, *gpio, PUMP_PIN, *config);
+    woken.begin();
+    woken.restorePhase(saved);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, woken.state());
+    TEST_ASSERT_FALSE(gpio->read(PUMP_PIN));
+    TEST_ASSERT_EQUAL_UINT32(fakeClock->millis(), woken.phase().sinceMs);
+    fakeClock->advance(config->minIntervalSec * 1000 - 100);
+    woken.update(WET);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, woken.state());
+    fakeClock->advance(100);
+    woken.update(WET);
+    TEST_ASSERT_EQUAL(MONITORING, woken.state());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stays_idle_while_wet);
+    RUN_TEST(test_dry_reading_runs_a_full_cycle);
+    RUN_TEST(test_effective_cycle_checked_after_settle);
+    RUN_TEST(test_safety_interval_blocks_restart);
+    RUN_TEST(test_ineffective_cycles_lock_fault);
+    RUN_TEST(test_drop_below_required_is_no_effect);
+    RUN_TEST(test_manual_cycle_skips_effectiveness_check);
+    RUN_TEST(test_clear_fault_resumes_auto_watering);
+    RUN_TEST(test_phase_survives_a_rebuilt_controller);
+    RUN_TEST(test_restored_run_counts_as_done);
+    return UNITY_END();
+}
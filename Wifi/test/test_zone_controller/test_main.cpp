@@ -0,0 +1,234 @@
+/*
+ * ZoneController host tests - several zones sharing a pump supply
+ *
+ *   pio test -e native -f test_zone_controller
+ *
+ * Four zones on relays 0-3 with one shared PumpConfig (2 s pulse, 30 s
+ * interval, fault after 3 ineffective cycles) and at most two pumps at once.
+ */
+
+#include <unity.h>
+#include "FakeHal.h"
+#include "ZoneController.h"
+
+const uint8_t ZONES = 4;
+const uint16_t DRY = 600;
+const uint16_t WET = 400;
+
+class RecordingZoneListener : public ZoneListener {
+public:
+    void onPumpStarted(uint8_t zone, ActivationMethod, uint16_t) override {
+        startOrder[starts++ % 8] = zone;
+    }
+    void onPumpDeferred(uint8_t) override { deferred++; }
+    void onFaultLocked(uint8_t zone, uint8_t) override { lockedZones |= 1 << zone; }
+
+    uint8_t startOrder[8] = {};
+    int starts = 0;
+    int deferred = 0;
+    uint8_t lockedZones = 0;
+};
+
+FakeClock* fakeClock = nullptr;
+FakeGpio* relays = nullptr;
+PumpConfig config;
+ZoneSchedule schedule;
+Zone zones[ZONES];
+ZoneController* controller = nullptr;
+RecordingZoneListener* listener = nullptr;
+
+void setUp() {
+    fakeClock = new FakeClock();
+    relays = new FakeGpio();
+    config = PumpConfig();
+    config.maxNoEffectRepeats = 3;
+    schedule = ZoneSchedule();
+    schedule.maxConcurrentPumps = 2;
+    for (uint8_t i = 0; i < ZONES; i++) {
+        zones[i] = Zone();
+        zones[i].config = &config;
+        zones[i].relay = i;
+        zones[i].moisture = WET;
+    }
+    listener = new RecordingZoneListener();
+    controller = new ZoneController(*fakeClock, *relays, zones, ZONES, schedule);
+    controller->setListener(listener);
+    controller->begin();
+}
+
+void tearDown() {
+    delete controller;
+    delete listener;
+    delete relays;
+    delete fakeClock;
+}
+
+// Step every zone for ms, 100 ms per tick, checking the pump cap on each
+static void run(uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += 100) {
+        fakeClock->advance(100);
+        controller->update();
+        TEST_ASSERT_LESS_OR_EQUAL(schedule.maxConcurrentPumps, controller->runningCount());
+    }
+}
+
+static void setAll(uint16_t moisture) {
+    for (uint8_t i = 0; i < ZONES; i++) controller->setMoisture(i, moisture);
+}
+
+void test_zones_keep_their_own_state() {
+    controller->setMoisture(1, DRY);
+    controller->update();
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(0).state);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(1).state);
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(2).state);
+    TEST_ASSERT_TRUE(relays->read(1));
+    TEST_ASSERT_FALSE(relays->read(0));
+    TEST_ASSERT_FALSE(relays->read(2));
+
+    // Zone 2 dries out while zone 1 is waiting; zone 1's wait is its own
+    controller->setMoisture(1, WET);
+    run(config.pumpRunTimeMs + 10000);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, controller->zone(1).state);
+    controller->setMoisture(2, DRY);
+    run(100);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(2).state);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, controller->zone(1).state);
+    TEST_ASSERT_TRUE(relays->read(2));
+    TEST_ASSERT_FALSE(relays->read(1));
+}
+
+void test_pump_cap_queues_extra_zones() {
+    setAll(DRY);
+    controller->update();
+    TEST_ASSERT_EQUAL(2, controller->runningCount());
+    TEST_ASSERT_EQUAL(2, controller->queuedCount());
+    TEST_ASSERT_EQUAL_UINT32(2, controller->deferredCount());
+    TEST_ASSERT_EQUAL(2, listener->deferred);
+
+    // Lowest index wins a tie; the queued pair starts as the first pair stops
+    TEST_ASSERT_EQUAL(0, listener->startOrder[0]);
+    TEST_ASSERT_EQUAL(1, listener->startOrder[1]);
+    run(config.pumpRunTimeMs);
+    TEST_ASSERT_EQUAL(PUMP_WAITING, controller->zone(0).state);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(2).state);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(3).state);
+    TEST_ASSERT_EQUAL(0, controller->queuedCount());
+
+    run(config.pumpRunTimeMs);
+    TEST_ASSERT_EQUAL(0, controller->runningCount());
+    TEST_ASSERT_EQUAL(4, listener->starts);
+    TEST_ASSERT_EQUAL(2, controller->maxRunningSeen());
+}
+
+void test_longest_waiting_zone_starts_first() {
+    schedule.maxConcurrentPumps = 1;
+    controller->setMoisture(0, DRY);
+    controller->update();
+    run(500);
+    controller->setMoisture(3, DRY);
+    run(500);
+    controller->setMoisture(2, DRY);
+    run(500);
+    TEST_ASSERT_EQUAL(2, controller->queuedCount());
+
+    run(config.pumpRunTimeMs);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(3).state);
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(2).state);
+    run(config.pumpRunTimeMs);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(2).state);
+}
+
+void test_reserved_slots_count_against_cap() {
+    // The on-board pump runs outside the controller
+    controller->setReservedSlots(1);
+    setAll(DRY);
+    controller->update();
+    TEST_ASSERT_EQUAL(1, controller->runningCount());
+    TEST_ASSERT_EQUAL(3, controller->queuedCount());
+}
+
+void test_queued_zone_dropped_when_wet_again() {
+    schedule.maxConcurrentPumps = 1;
+    controller->setMoisture(0, DRY);
+    controller->setMoisture(1, DRY);
+    controller->update();
+    TEST_ASSERT_EQUAL(1, controller->queuedCount());
+
+    // Rain before zone 1's turn
+    controller->setMoisture(1, WET);
+    run(config.pumpRunTimeMs + 100);
+    TEST_ASSERT_EQUAL(0, controller->queuedCount());
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(1).state);
+    TEST_ASSERT_EQUAL(1, listener->starts);
+}
+
+void test_manual_request_waits_for_a_slot() {
+    schedule.maxConcurrentPumps = 1;
+    controller->setMoisture(0, DRY);
+    controller->update();
+    TEST_ASSERT_FALSE(controller->request(0, ACTIVATION_MANUAL));  // Already pumping
+    TEST_ASSERT_TRUE(controller->request(2, ACTIVATION_MANUAL));
+    run(100);
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(2).state);
+
+    controller->setMoisture(0, WET);
+    run(config.pumpRunTimeMs);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(2).state);
+    TEST_ASSERT_EQUAL(ACTIVATION_MANUAL, controller->zone(2).lastMethod);
+}
+
+void test_start_spacing_spreads_starts() {
+    schedule.startSpacingMs = 1000;
+    setAll(DRY);
+    controller->update();
+    TEST_ASSERT_EQUAL(1, controller->runningCount());
+    run(900);
+    TEST_ASSERT_EQUAL(1, controller->runningCount());
+    run(100);
+    TEST_ASSERT_EQUAL(2, controller->runningCount());
+}
+
+void test_fault_locks_only_the_failing_zone() {
+    // Zone 0's sensor never sees water; zone 1 dries out as often and does
+    uint8_t cycles = config.maxNoEffectRepeats;
+    for (uint8_t cycle = 0; cycle < cycles; cycle++) {
+        controller->setMoisture(0, DRY);
+        controller->setMoisture(1, DRY);
+        run(100);
+        TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(0).state);
+        TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(1).state);
+        controller->setMoisture(1, WET);
+        run(config.pumpRunTimeMs + config.minIntervalSec * 1000);
+    }
+    TEST_ASSERT_TRUE(controller->zone(0).persistent.lockedFault);
+    TEST_ASSERT_EQUAL(1 << 0, listener->lockedZones);
+    TEST_ASSERT_FALSE(controller->zone(1).persistent.lockedFault);
+    TEST_ASSERT_EQUAL(0, controller->zone(1).persistent.noEffectCounter);
+
+    // Zone 0 stays dry and idle; zone 1 still waters, and gets the slot
+    controller->setMoisture(1, DRY);
+    run(100);
+    TEST_ASSERT_EQUAL(MONITORING, controller->zone(0).state);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(1).state);
+
+    // Clearing zone 0 leaves zone 1 alone
+    TEST_ASSERT_FALSE(controller->clearFault(1));
+    TEST_ASSERT_TRUE(controller->clearFault(0));
+    TEST_ASSERT_FALSE(controller->zone(0).persistent.lockedFault);
+    run(100);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, controller->zone(0).state);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_zones_keep_their_own_state);
+    RUN_TEST(test_pump_cap_queues_extra_zones);
+    RUN_TEST(test_longest_waiting_zone_starts_first);
+    RUN_TEST(test_reserved_slots_count_against_cap);
+    RUN_TEST(test_queued_zone_dropped_when_wet_again);
+    RUN_TEST(test_manual_request_waits_for_a_slot);
+    RUN_TEST(test_start_spacing_spreads_starts);
+    RUN_TEST(test_fault_locks_only_the_failing_zone);
+    return UNITY_END();
+}
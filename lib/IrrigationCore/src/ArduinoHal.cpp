@@ -0,0 +1,163 @@
+#ifdef ARDUINO
+
+#include "ArduinoHal.h"
+#include "TraceRecorder.h"
+#include <time.h>
+#include <Wire.h>
+
+#ifdef ARDUINO_ARCH_ESP8266
+#include <LittleFS.h>
+#endif
+
+uint32_t ArduinoClock::millis() {
+    return ::millis();
+}
+
+uint32_t ArduinoClock::micros() {
+    return ::micros();
+}
+
+uint32_t ArduinoClock::epoch() {
+    // NTP-synchronized time; anything this small means it hasn't synced yet
+    time_t now = time(nullptr);
+    return now < 100000 ? 0 : (uint32_t)now;
+}
+
+void ArduinoGpio::setOutput(uint8_t pin) {
+    pinMode(pin, OUTPUT);
+}
+
+void ArduinoGpio::setInputPullup(uint8_t pin) {
+    pinMode(pin, INPUT_PULLUP);
+}
+
+void ArduinoGpio::write(uint8_t pin, bool high) {
+    digitalWrite(pin, high ? HIGH : LOW);
+}
+
+bool ArduinoGpio::read(uint8_t pin) {
+    return digitalRead(pin) == HIGH;
+}
+
+uint16_t ArduinoAdc::read(uint8_t channel) {
+    return analogRead(channel);
+}
+
+static const uint8_t ADS1115_BASE_ADDRESS = 0x48;
+static const uint8_t ADS1115_CONVERSION = 0x00;
+static const uint8_t ADS1115_CONFIG = 0x01;
+// Start single-shot, +-4.096 V range, 860 SPS, comparator off; MUX added per read
+static const uint16_t ADS1115_SINGLE_SHOT = 0x8000 | 0x0200 | 0x0100 | 0x00E0 | 0x0003;
+static const int32_t ADS1115_COUNTS_3V3 = 26400;   // 3.3 V / 125 uV per count
+
+static bool ads1115Register(uint8_t address, uint8_t reg, uint16_t& value) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0 || Wire.requestFrom(address, (uint8_t)2) != 2) return false;
+    value = (uint16_t)Wire.read() << 8;
+    value |= Wire.read();
+    return true;
+}
+
+uint16_t Ads1115Adc::read(uint8_t channel) {
+    uint8_t address = ADS1115_BASE_ADDRESS + (channel / 4) % 4;
+    uint16_t config = ADS1115_SINGLE_SHOT | (uint16_t)(0x4 + channel % 4) << 12;  // AINx vs GND
+
+    Wire.beginTransmission(address);
+    Wire.write(ADS1115_CONFIG);
+    Wire.write(config >> 8);
+    Wire.write(config & 0xFF);
+    if (Wire.endTransmission() != 0) {
+        _errors++;
+        return 0;
+    }
+
+    // OS bit reads back 1 once the conversion is done
+    uint16_t status = 0;
+    uint32_t start = micros();
+    do {
+        delayMicroseconds(200);
+        if (!ads1115Register(address, ADS1115_CONFIG, status)) break;
+    } while (!(status & 0x8000) && micros() - start < 3000);
+
+    uint16_t raw;
+    if (!(status & 0x8000) || !ads1115Register(address, ADS1115_CONVERSION, raw)) {
+        _errors++;
+        return 0;
+    }
+    int32_t counts = (int16_t)raw;
+    if (counts <= 0) return 0;
+    return (uint16_t)min((int32_t)1023, counts * 1023 / ADS1115_COUNTS_3V3);
+}
+
+#ifdef ARDUINO_ARCH_ESP8266
+bool LittleFsStore::exists(const char* path) {
+    return LittleFS.exists(path);
+}
+
+int32_t LittleFsStore::size(const char* path) {
+    File file = LittleFS.open(path, "r");
+    if (!file) return -1;
+    int32_t fileSize = file.size();
+    file.close();
+    return fileSize;
+}
+
+bool LittleFsStore::create(const char* path, uint32_t size) {
+    TRACE_SCOPE(TRACE_FS_WRITE);
+    File file = LittleFS.open(path, "w");
+    if (!file) return false;
+
+    uint8_t zeros[64] = {0};
+    for (uint32_t written = 0; written < size; written += sizeof(zeros)) {
+        size_t chunk = min((uint32_t)sizeof(zeros), size - written);
+        if (file.write(zeros, chunk) != chunk) {
+            file.close();
+            return false;
+        }
+    }
+    file.close();
+    return true;
+}
+
+size_t LittleFsStore::read(const char* path, uint32_t offset, void* data, size_t length) {
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+    size_t bytesRead = file.seek(offset, SeekSet) ? file.read((uint8_t*)data, length) : 0;
+    file.close();
+    return bytesRead;
+}
+
+size_t LittleFsStore::write(const char* path, uint32_t offset, const void* data, size_t length) {
+    TRACE_SCOPE(TRACE_FS_WRITE);
+    File file = LittleFS.open(path, LittleFS.exists(path) ? "r+" : "w");
+    if (!file) return 0;
+    size_t written = file.seek(offset, SeekSet) ? file.write((const uint8_t*)data, length) : 0;
+    file.close();
+    TRACE_SCOPE_RESULT(written);
+    return written;
+}
+
+bool LittleFsStore::remove(const char* path) {
+    return LittleFS.remove(path);
+}
+
+const uint32_t RTC_RESERVED_BYTES = 128;  // Used by eboot during OTA
+
+bool EspRtcMemory::read(uint32_t offset, void* data, size_t length) {
+    uint32_t words[SIZE / 4];
+    if (offset % 4 || length % 4 || offset + length > SIZE) return false;
+    if (!ESP.rtcUserMemoryRead((RTC_RESERVED_BYTES + offset) / 4, words, length)) return false;
+    memcpy(data, words, length);  // data may be a packed struct
+    return true;
+}
+
+bool EspRtcMemory::write(uint32_t offset, const void* data, size_t length) {
+    uint32_t words[SIZE / 4];
+    if (offset % 4 || length % 4 || offset + length > SIZE) return false;
+    memcpy(words, data, length);
+    return ESP.rtcUserMemoryWrite((RTC_RESERVED_BYTES + offset) / 4, words, length);
+}
+#endif  // ARDUINO_ARCH_ESP8266
+
+#endif  // ARDUINO
@@ -0,0 +1,69 @@
+/*
+ * ArduinoHal - HAL implementations backed by the Arduino/ESP8266 core
+ */
+
+#pragma once
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include "Hal.h"
+
+class ArduinoClock : public Clock {
+public:
+    uint32_t millis() override;
+    uint32_t micros() override;
+    uint32_t epoch() override;
+};
+
+class ArduinoGpio : public Gpio {
+public:
+    void setOutput(uint8_t pin) override;
+    void setInputPullup(uint8_t pin) override;
+    void write(uint8_t pin, bool high) override;
+    bool read(uint8_t pin) override;
+};
+
+// Channel is the analog pin number (A0 on the ESP8266)
+class ArduinoAdc : public Adc {
+public:
+    uint16_t read(uint8_t channel) override;
+};
+
+// Up to four ADS1115 16-bit I2C ADCs at 0x48-0x4B: channel n is input
+// n % 4 of the chip at 0x48 + n / 4. Each read is a single-shot
+// conversion (~1.2 ms at 860 SPS) scaled to the 0-1023 range A0 gives for
+// 0-3.3 V on the NodeMCU, so thresholds carry over from the on-board
+// sensor. A failed transfer reads as 0 (wet), which never starts a pump.
+// Call Wire.begin() first.
+class Ads1115Adc : public Adc {
+public:
+    uint16_t read(uint8_t channel) override;
+    uint32_t errorCount() const { return _errors; }
+
+private:
+    uint32_t _errors = 0;
+};
+
+#ifdef ARDUINO_ARCH_ESP8266
+class LittleFsStore : public FileStore {
+public:
+    bool exists(const char* path) override;
+    int32_t size(const char* path) override;
+    bool create(const char* path, uint32_t size) override;
+    size_t read(const char* path, uint32_t offset, void* data, size_t length) override;
+    size_t write(const char* path, uint32_t offset, const void* data, size_t length) override;
+    bool remove(const char* path) override;
+};
+
+// RTC user memory; offset 0 is the first byte after the 128 bytes the
+// OTA bootloader may overwrite
+class EspRtcMemory : public RtcMemory {
+public:
+    static const size_t SIZE = 384;
+    bool read(uint32_t offset, void* data, size_t length) override;
+    bool write(uint32_t offset, const void* data, size_t length) override;
+};
+#endif
+
+#endif  // ARDUINO
@@ -0,0 +1,88 @@
+#include "ButtonDecoder.h"
+
+ButtonDecoder::ButtonDecoder(uint32_t debounceMs, uint32_t longPressMs, uint32_t multiPressWindowMs)
+    : _debounceMs(debounceMs), _longPressMs(longPressMs), _multiPressWindowMs(multiPressWindowMs) {}
+
+void ButtonDecoder::feed(const ButtonEdge& edge) {
+    // Settle any earlier candidate that stayed stable until this edge
+    advance(edge.timeMs);
+
+    if (_candidatePending) {
+        // Bounced back before the debounce time: discard the candidate
+        if (edge.pressed == _pressed) {
+            _candidatePending = false;
+        }
+        return;
+    }
+
+    if (edge.pressed != _pressed) {
+        _candidatePending = true;
+        _candidateLevel = edge.pressed;
+        _candidateTime = edge.timeMs;
+    }
+}
+
+void ButtonDecoder::advance(uint32_t nowMs) {
+    if (_candidatePending && reached(nowMs, _candidateTime, _debounceMs)) {
+        _candidatePending = false;
+        commit(_candidateLevel, _candidateTime);
+    }
+    checkTimers(nowMs);
+}
+
+ButtonAction ButtonDecoder::takeAction() {
+    if (_actionCount == 0) return NONE;
+    ButtonAction action = _actions[_actionHead];
+    _actionHead = (_actionHead + 1) % ACTION_QUEUE_SIZE;
+    _actionCount--;
+    return action;
+}
+
+void ButtonDecoder::commit(bool pressed, uint32_t timeMs) {
+    // Timers that expired before this edge fire first
+    checkTimers(timeMs);
+
+    if (pressed) {
+        _pressed = true;
+        _pressStart = timeMs;
+        _longPressHandled = false;
+
+        if (_pressCount > 0 && !reached(timeMs, _lastPress, _multiPressWindowMs)) {
+            _pressCount++;
+            if (_pressCount >= 3) {
+                // Triple press reported immediately on the third press
+                _pressCount = 0;
+                emit(TRIPLE_PRESS);
+            }
+        } else {
+            _pressCount = 1;
+        }
+        _lastPress = timeMs;
+    } else {
+        _pressed = false;
+        _longPressHandled = false;
+    }
+}
+
+void ButtonDecoder::checkTimers(uint32_t nowMs) {
+    // Long press fires while the button is still held
+    if (_pressed && !_longPressHandled && reached(nowMs, _pressStart, _longPressMs)) {
+        _longPressHandled = true;
+        _pressCount = 0;
+        emit(LONG_PRESS);
+    }
+
+    // A single press is only a short press once the triple-press window has passed
+    if (!_pressed && _pressCount > 0 && reached(nowMs, _lastPress, _multiPressWindowMs + 1)) {
+        if (_pressCount == 1) {
+            emit(SHORT_PRESS);
+        }
+        _pressCount = 0;  // Incomplete triple press expires
+    }
+}
+
+void ButtonDecoder::emit(ButtonAction action) {
+    if (_actionCount == ACTION_QUEUE_SIZE) return;  // Drop if the loop isn't keeping up
+    _actions[(_actionHead + _actionCount) % ACTION_QUEUE_SIZE] = action;
+    _actionCount++;
+}
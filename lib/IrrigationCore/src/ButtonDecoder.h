@@ -0,0 +1,70 @@
+/*
+ * ButtonDecoder - short/long/triple press detection from timestamped edges
+ *
+ * Works purely on edge timestamps captured at interrupt time, so the
+ * result is the same whether the main loop drains the edges immediately
+ * or seconds later. Has no Arduino dependencies and can be driven with
+ * synthetic edge streams on the host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum ButtonAction {
+    NONE,
+    SHORT_PRESS,        // Manual watering
+    LONG_PRESS,         // Clear fault
+    TRIPLE_PRESS        // Force WiFi reset
+};
+
+// Raw edge as captured by the GPIO interrupt
+struct ButtonEdge {
+    uint32_t timeMs;
+    bool pressed;       // Level after the edge (true = button down)
+};
+
+class ButtonDecoder {
+public:
+    ButtonDecoder(uint32_t debounceMs, uint32_t longPressMs, uint32_t multiPressWindowMs);
+
+    // Feed raw edges in time order (bouncing allowed)
+    void feed(const ButtonEdge& edge);
+
+    // Evaluate debounce and press timers up to nowMs
+    void advance(uint32_t nowMs);
+
+    // Next decoded action, or NONE
+    ButtonAction takeAction();
+
+    bool isPressed() const { return _pressed; }
+
+private:
+    void commit(bool pressed, uint32_t timeMs);
+    void checkTimers(uint32_t nowMs);
+    void emit(ButtonAction action);
+
+    static bool reached(uint32_t nowMs, uint32_t sinceMs, uint32_t durationMs) {
+        return (int32_t)(nowMs - sinceMs) >= (int32_t)durationMs;
+    }
+
+    uint32_t _debounceMs;
+    uint32_t _longPressMs;
+    uint32_t _multiPressWindowMs;
+
+    // Debounce: a level change is accepted once it has been stable for _debounceMs
+    bool _candidatePending = false;
+    bool _candidateLevel = false;
+    uint32_t _candidateTime = 0;
+
+    bool _pressed = false;
+    uint32_t _pressStart = 0;
+    uint32_t _lastPress = 0;
+    uint8_t _pressCount = 0;
+    bool _longPressHandled = false;
+
+    static const uint8_t ACTION_QUEUE_SIZE = 4;
+    ButtonAction _actions[ACTION_QUEUE_SIZE];
+    uint8_t _actionHead = 0;
+    uint8_t _actionCount = 0;
+};
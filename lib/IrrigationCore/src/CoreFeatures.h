@@ -0,0 +1,56 @@
+/*
+ * CoreFeatures - compile-time selection of the optional parts of the
+ * pump state machine
+ *
+ * PlatformIO builds the shared libraries once per firmware, with that
+ * firmware's build flags, so each feature is a constexpr switch taken from
+ * a -D flag: code behind a disabled feature is folded away by the
+ * compiler, not skipped at run time. The default is everything (Wifi
+ * firmware, simulator, host replay). CORE_MINIMAL turns every feature off;
+ * a single one can be turned back on with its own flag, as the IO build
+ * does with -D CORE_MINIMAL -D CORE_LOGGING=1.
+ *
+ * Networking is not a switch here: Firestore/MQTT payloads and status
+ * rendering live in the IrrigationNet library, which a firmware only
+ * compiles (with ArduinoJson) when it includes one of its headers.
+ */
+
+#pragma once
+
+#ifdef CORE_MINIMAL
+#define CORE_FEATURE_DEFAULT 0
+#else
+#define CORE_FEATURE_DEFAULT 1
+#endif
+
+#ifndef CORE_FAULT_LOCK
+#define CORE_FAULT_LOCK CORE_FEATURE_DEFAULT
+#endif
+#ifndef CORE_EFFECTIVENESS_CHECK
+#define CORE_EFFECTIVENESS_CHECK CORE_FEATURE_DEFAULT
+#endif
+#ifndef CORE_PERSISTENCE
+#define CORE_PERSISTENCE CORE_FEATURE_DEFAULT
+#endif
+#ifndef CORE_ADAPTIVE_DOSING
+#define CORE_ADAPTIVE_DOSING CORE_FEATURE_DEFAULT
+#endif
+#ifndef CORE_LOGGING
+#define CORE_LOGGING CORE_FEATURE_DEFAULT
+#endif
+
+struct CoreFeatures {
+    // Re-read the sensor settleMs after an automatic cycle and count cycles without effect
+    static constexpr bool effectivenessCheck = CORE_EFFECTIVENESS_CHECK;
+    // Lock auto-watering after maxNoEffectRepeats cycles without effect
+    static constexpr bool faultLock = CORE_FAULT_LOCK;
+    // Stamp the last pump end in epoch time and ask the listener to save state changes
+    static constexpr bool persistence = CORE_PERSISTENCE;
+    // Size automatic pulses from the error (PumpConfig::adaptiveDosing)
+    static constexpr bool adaptiveDosing = CORE_ADAPTIVE_DOSING;
+    // Event callbacks the firmware logs and reports from (PumpListener, ZoneListener)
+    static constexpr bool logging = CORE_LOGGING;
+};
+
+static_assert(!CoreFeatures::faultLock || CoreFeatures::effectivenessCheck,
+              "fault locking counts cycles the effectiveness check found without effect");
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE, used to validate records stored in flash and RTC memory
+inline uint16_t crc16(const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint16_t crc = 0xFFFF;
+    while (length--) {
+        crc ^= (uint16_t)(*bytes++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
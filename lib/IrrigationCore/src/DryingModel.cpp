@@ -0,0 +1,180 @@
+#include "DryingModel.h"
+#include <math.h>
+#include <string.h>
+#include "Crc16.h"
+
+static const uint32_t DRYING_MODEL_MAGIC = 0x44524D31;  // "DRM1"
+static const float INITIAL_COVARIANCE = 100.0f;         // Weak prior: rates are a few counts/hour
+static const float INITIAL_RESPONSE_COVARIANCE = 10.0f;
+static const uint32_t SECONDS_PER_DAY = 86400;
+static const uint32_t PREDICTION_STEP_SEC = 900;        // 15 min integration steps
+static const float TWO_PI = 6.2831853f;
+
+DryingModel::DryingModel(FileStore& store, Clock& clock, const char* path,
+                         const DryingModelConfig& config)
+    : _store(store), _clock(clock), _path(path), _config(config) {
+    reset();
+}
+
+void DryingModel::reset() {
+    memset(&_record, 0, sizeof(_record));
+    _record.magic = DRYING_MODEL_MAGIC;
+    for (uint8_t i = 0; i < 3; i++) _record.covariance[i * 3 + i] = INITIAL_COVARIANCE;
+    _record.responseCovariance = INITIAL_RESPONSE_COVARIANCE;
+}
+
+bool DryingModel::begin() {
+    _lastSaveMs = _clock.millis();
+    DryingModelRecord record;
+    if (_store.read(_path, 0, &record, sizeof(record)) != sizeof(record) ||
+        record.magic != DRYING_MODEL_MAGIC || crc16(&record, offsetof(DryingModelRecord, crc)) != record.crc) {
+        return false;
+    }
+    _record = record;
+    return true;
+}
+
+void DryingModel::resetWindow() {
+    _windowOpen = false;
+    _n = 0;
+    _sumT = _sumM = _sumTT = _sumTM = 0;
+}
+
+void DryingModel::observe(uint16_t moisture, bool quiet) {
+    uint32_t now = _clock.millis();
+    if (!quiet) {
+        resetWindow();
+        return;
+    }
+    if (!_windowOpen) {
+        uint32_t epoch = _clock.epoch();
+        if (epoch == 0) return;  // Time of day unknown
+        _windowOpen = true;
+        _windowStartMs = now;
+        _windowStartEpoch = epoch;
+        _windowFirst = moisture;
+        _windowMax = moisture;
+    }
+
+    // Watered by hand (or rain): not drying behaviour
+    if (moisture > _windowMax) _windowMax = moisture;
+    if (moisture + _config.wettingDrop <= _windowMax) {
+        _skipped++;
+        resetWindow();
+        return;
+    }
+
+    float t = (now - _windowStartMs) / 3600000.0f;
+    float m = (float)moisture - _windowFirst;
+    _n++;
+    _sumT += t;
+    _sumM += m;
+    _sumTT += t * t;
+    _sumTM += t * m;
+
+    if (now - _windowStartMs < _config.windowMs) return;
+
+    float denominator = _n * _sumTT - _sumT * _sumT;
+    if (_n >= 4 && denominator > 0) {
+        float rate = (_n * _sumTM - _sumT * _sumM) / denominator;
+        update(rate, _windowStartEpoch + _config.windowMs / 2000);
+    } else {
+        _skipped++;  // Too few readings to fit a slope
+    }
+    resetWindow();
+}
+
+// RLS step: theta += k (y - x.theta), k = P x / (lambda + x' P x),
+// P = (P - k x' P) / lambda
+void DryingModel::update(float rate, uint32_t epoch) {
+    float angle = TWO_PI * (epoch % SECONDS_PER_DAY) / SECONDS_PER_DAY;
+    float x[3] = {1.0f, cosf(angle), sinf(angle)};
+    float* theta = _record.theta;
+    float* p = _record.covariance;
+
+    // Forgetting only while the covariance is below its prior, so long
+    // stretches of similar windows cannot wind it up. The gain and the
+    // covariance update share the factor.
+    float trace = p[0] + p[4] + p[8];
+    float lambda = trace < 3 * INITIAL_COVARIANCE ? _config.forgetting : 1.0f;
+
+    float px[3];
+    for (uint8_t i = 0; i < 3; i++) px[i] = p[i * 3] * x[0] + p[i * 3 + 1] * x[1] + p[i * 3 + 2] * x[2];
+    float denominator = lambda + x[0] * px[0] + x[1] * px[1] + x[2] * px[2];
+    float error = rate - (theta[0] * x[0] + theta[1] * x[1] + theta[2] * x[2]);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        float gain = px[i] / denominator;
+        theta[i] += gain * error;
+        for (uint8_t j = 0; j < 3; j++) p[i * 3 + j] = (p[i * 3 + j] - gain * px[j]) / lambda;
+    }
+
+    _record.observations++;
+    _dirty = true;
+}
+
+void DryingModel::recordCycle(int32_t drop, uint32_t runMs) {
+    if (runMs == 0) return;
+    float x = runMs / 1000.0f;
+    float p = _record.responseCovariance;
+    float gain = p * x / (_config.responseForgetting + x * p * x);
+    _record.response += gain * (drop - _record.response * x);
+    _record.responseCovariance = (1 - gain * x) * p / _config.responseForgetting;
+    if (_record.responseCovariance > INITIAL_RESPONSE_COVARIANCE) {
+        _record.responseCovariance = INITIAL_RESPONSE_COVARIANCE;
+    }
+    _record.cycles++;
+    _dirty = true;
+}
+
+float DryingModel::rateAt(uint32_t epoch) const {
+    if (epoch == 0) return _record.theta[0];
+    float angle = TWO_PI * (epoch % SECONDS_PER_DAY) / SECONDS_PER_DAY;
+    return _record.theta[0] + _record.theta[1] * cosf(angle) + _record.theta[2] * sinf(angle);
+}
+
+uint32_t DryingModel::secondsUntil(uint16_t threshold, uint16_t moisture, uint32_t epoch) const {
+    if (!trained()) return NO_PREDICTION;
+    if (moisture >= threshold) return 0;
+    if (epoch == 0) {
+        float rate = _record.theta[0];
+        if (rate <= 0) return NO_PREDICTION;
+        float seconds = (threshold - moisture) / rate * 3600.0f;
+        return seconds < _config.horizonSec ? (uint32_t)seconds : NO_PREDICTION;
+    }
+
+    // Walk forward in steps, rotating the time-of-day terms instead of
+    // calling cos/sin per step
+    float angle = TWO_PI * (epoch % SECONDS_PER_DAY) / SECONDS_PER_DAY;
+    float c = cosf(angle), s = sinf(angle);
+    const float stepAngle = TWO_PI * PREDICTION_STEP_SEC / SECONDS_PER_DAY;
+    const float stepCos = cosf(stepAngle), stepSin = sinf(stepAngle);
+    const float stepHours = PREDICTION_STEP_SEC / 3600.0f;
+
+    float level = moisture;
+    for (uint32_t elapsed = 0; elapsed < _config.horizonSec; elapsed += PREDICTION_STEP_SEC) {
+        float rate = _record.theta[0] + _record.theta[1] * c + _record.theta[2] * s;
+        if (rate > 0 && level + rate * stepHours >= threshold) {
+            return elapsed + (uint32_t)((threshold - level) / rate * 3600.0f);
+        }
+        if (rate > 0) level += rate * stepHours;
+        float nextC = c * stepCos - s * stepSin;
+        s = s * stepCos + c * stepSin;
+        c = nextC;
+    }
+    return NO_PREDICTION;
+}
+
+bool DryingModel::flushIfDue() {
+    if (!_dirty || _clock.millis() - _lastSaveMs < _config.saveIntervalMs) return false;
+    return flush();
+}
+
+bool DryingModel::flush() {
+    if (!_dirty) return true;
+    _record.crc = crc16(&_record, offsetof(DryingModelRecord, crc));
+    _lastSaveMs = _clock.millis();
+    if (_store.write(_path, 0, &_record, sizeof(_record)) != sizeof(_record)) return false;
+    _dirty = false;
+    return true;
+}
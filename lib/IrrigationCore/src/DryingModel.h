@@ -0,0 +1,110 @@
+/*
+ * DryingModel - online estimate of how fast the soil dries and how much a
+ * pump cycle wets it, for predicting the next threshold crossing
+ *
+ * Drying: every window of quiet monitoring (no pump cycle, no sudden
+ * wetting) yields one least-squares slope in counts per hour. Recursive
+ * least squares with forgetting fits
+ *     rate(t) = mean + daily.cos * cos(2 pi t / 24 h) + daily.sin * sin(...)
+ * so a pot that dries fast in the afternoon and barely at night is
+ * predicted as such. The daily terms need wall-clock time; windows without
+ * it are not used.
+ *
+ * Response: a scalar RLS of the moisture drop measured by each
+ * effectiveness check against the pump run time (counts per pump second).
+ *
+ * State is a few dozen floats whatever the history length, saved to a
+ * CRC-checked file at most once per saveIntervalMs.
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+struct DryingModelConfig {
+    uint32_t windowMs = 600000;         // One rate observation per 10 min of quiet monitoring
+    float forgetting = 0.998f;          // Per observation: ~500 windows (3.5 days) of memory
+    float responseForgetting = 0.9f;    // Per pump cycle
+    uint16_t wettingDrop = 10;          // A window that wets this much was watered by hand: skipped
+    uint16_t minObservations = 12;      // Before predictions are made
+    uint32_t horizonSec = 172800;       // Predictions further out than 48 h are not made
+    uint32_t saveIntervalMs = 3600000;  // Flash write rate limit
+};
+
+// As stored in the model file
+struct DryingModelRecord {
+    uint32_t magic;
+    float theta[3];                     // mean, daily cos, daily sin (counts/hour)
+    float covariance[9];
+    float response;                     // Counts per pump second
+    float responseCovariance;
+    uint32_t observations;
+    uint32_t cycles;
+    uint16_t reserved;
+    uint16_t crc;
+};
+static_assert(sizeof(DryingModelRecord) == 72, "DryingModelRecord is stored as is");
+
+class DryingModel {
+public:
+    static const uint32_t NO_PREDICTION = UINT32_MAX;
+
+    DryingModel(FileStore& store, Clock& clock, const char* path, const DryingModelConfig& config);
+
+    // Load the saved model; false (and an untrained model) if there is none
+    bool begin();
+
+    // Feed every new filtered reading. quiet: the pump is monitoring, not
+    // running or settling; a reading that is not quiet discards the window.
+    void observe(uint16_t moisture, bool quiet);
+
+    // A pump cycle of runMs lowered the reading by drop counts
+    void recordCycle(int32_t drop, uint32_t runMs);
+
+    // Drying rate (counts/hour) expected at epoch; the mean rate if epoch is 0
+    float rateAt(uint32_t epoch) const;
+
+    // Seconds until moisture reaches threshold at the modelled rate, from
+    // now (epoch), or NO_PREDICTION (untrained, not drying, beyond horizon)
+    uint32_t secondsUntil(uint16_t threshold, uint16_t moisture, uint32_t epoch) const;
+
+    bool trained() const { return _record.observations >= _config.minObservations; }
+    float meanRate() const { return _record.theta[0]; }
+    float dailyCos() const { return _record.theta[1]; }
+    float dailySin() const { return _record.theta[2]; }
+    float response() const { return _record.response; }
+    uint32_t observationCount() const { return _record.observations; }
+    uint32_t cycleCount() const { return _record.cycles; }
+    uint32_t skippedWindows() const { return _skipped; }
+
+    // Save a changed model once saveIntervalMs has passed since the last save
+    bool flushIfDue();
+    // Save a changed model now
+    bool flush();
+
+private:
+    void reset();
+    void resetWindow();
+    void update(float rate, uint32_t epoch);
+
+    FileStore& _store;
+    Clock& _clock;
+    const char* _path;
+    const DryingModelConfig& _config;
+
+    DryingModelRecord _record;
+    bool _dirty = false;
+    uint32_t _lastSaveMs = 0;
+
+    // Current window: least-squares sums over (hours since start, counts
+    // since the first reading)
+    bool _windowOpen = false;
+    uint32_t _windowStartMs = 0;
+    uint32_t _windowStartEpoch = 0;
+    uint16_t _windowFirst = 0;
+    uint16_t _windowMax = 0;            // Highest (driest) reading so far
+    uint32_t _n = 0;
+    float _sumT = 0, _sumM = 0, _sumTT = 0, _sumTM = 0;
+
+    uint32_t _skipped = 0;
+};
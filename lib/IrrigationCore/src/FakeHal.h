@@ -0,0 +1,168 @@
+/*
+ * FakeHal - in-memory HAL implementations for host builds
+ *
+ * Time only moves when advance() is called, so state machines can be
+ * stepped through hours of virtual time instantly and deterministically.
+ */
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "Hal.h"
+
+class FakeClock : public Clock {
+public:
+    explicit FakeClock(uint32_t startEpoch = 1700000000) : _startEpoch(startEpoch) {}
+
+    uint32_t millis() override { return _nowMs; }
+    uint32_t epoch() override { return _startEpoch ? _startEpoch + _nowMs / 1000 : 0; }
+
+    void advance(uint32_t ms) { _nowMs += ms; }
+    void set(uint32_t ms) { _nowMs = ms; }
+
+private:
+    uint32_t _startEpoch;
+    uint32_t _nowMs = 0;
+};
+
+class FakeGpio : public Gpio {
+public:
+    static const uint8_t PIN_COUNT = 64;
+
+    void setOutput(uint8_t) override {}
+    void setInputPullup(uint8_t pin) override { _levels[pin % PIN_COUNT] = true; }
+    void write(uint8_t pin, bool high) override {
+        _levels[pin % PIN_COUNT] = high;
+        _writes++;
+    }
+    bool read(uint8_t pin) override { return _levels[pin % PIN_COUNT]; }
+
+    uint32_t writeCount() const { return _writes; }
+
+private:
+    bool _levels[PIN_COUNT] = {};
+    uint32_t _writes = 0;
+};
+
+class FakeAdc : public Adc {
+public:
+    static const uint8_t CHANNEL_COUNT = 32;
+
+    uint16_t read(uint8_t channel) override {
+        _reads++;
+        return _values[channel % CHANNEL_COUNT];
+    }
+    void set(uint8_t channel, uint16_t value) { _values[channel % CHANNEL_COUNT] = value; }
+
+    uint32_t readCount() const { return _reads; }
+
+private:
+    uint16_t _values[CHANNEL_COUNT] = {};
+    uint32_t _reads = 0;
+};
+
+class MemoryFileStore : public FileStore {
+public:
+    bool exists(const char* path) override { return _files.count(path) > 0; }
+
+    int32_t size(const char* path) override {
+        auto it = _files.find(path);
+        return it == _files.end() ? -1 : (int32_t)it->second.size();
+    }
+
+    bool create(const char* path, uint32_t size) override {
+        _files[path].assign(size, 0);
+        _writes++;
+        return true;
+    }
+
+    size_t read(const char* path, uint32_t offset, void* data, size_t length) override {
+        auto it = _files.find(path);
+        if (it == _files.end() || offset >= it->second.size()) return 0;
+        size_t count = std::min(length, it->second.size() - offset);
+        memcpy(data, it->second.data() + offset, count);
+        return count;
+    }
+
+    size_t write(const char* path, uint32_t offset, const void* data, size_t length) override {
+        std::vector<uint8_t>& file = _files[path];
+        if (file.size() < offset + length) file.resize(offset + length);
+        memcpy(file.data() + offset, data, length);
+        _writes++;
+        return length;
+    }
+
+    bool remove(const char* path) override { return _files.erase(path) > 0; }
+
+    uint32_t writeCount() const { return _writes; }
+
+private:
+    std::map<std::string, std::vector<uint8_t>> _files;
+    uint32_t _writes = 0;
+};
+
+class FakeRtcMemory : public RtcMemory {
+public:
+    static const size_t SIZE = 384;
+
+    bool read(uint32_t offset, void* data, size_t length) override {
+        if (offset + length > SIZE) return false;
+        memcpy(data, _bytes + offset, length);
+        return true;
+    }
+
+    bool write(uint32_t offset, const void* data, size_t length) override {
+        if (offset + length > SIZE) return false;
+        memcpy(_bytes + offset, data, length);
+        _writes++;
+        return true;
+    }
+
+    // Power loss: contents become garbage
+    void scramble() { memset(_bytes, 0xA5, SIZE); }
+    uint32_t writeCount() const { return _writes; }
+
+private:
+    uint8_t _bytes[SIZE] = {};
+    uint32_t _writes = 0;
+};
+
+// Records requests and answers them with a fixed status and body
+class FakeHttpTransport : public HttpTransport {
+public:
+    int request(const char* method, const char* path, const char* body,
+                char* response, size_t responseSize) override {
+        _requests++;
+        lastMethod = method;
+        lastPath = path;
+        lastBody = body ? body : "";
+        if (response && responseSize > 0) {
+            size_t count = std::min(responseBody.size(), responseSize - 1);
+            memcpy(response, responseBody.data(), count);
+            response[count] = '\0';
+            if (count < responseBody.size() && status >= 200 && status < 300) {
+                return HTTP_RESPONSE_TRUNCATED;
+            }
+        }
+        return status;
+    }
+
+    uint32_t requestCount() const { return _requests; }
+
+    int status = 200;
+    std::string responseBody = "{}";
+    std::string lastMethod;
+    std::string lastPath;
+    std::string lastBody;
+
+private:
+    uint32_t _requests = 0;
+};
+
+#endif  // !ARDUINO
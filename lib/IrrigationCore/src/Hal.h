@@ -0,0 +1,91 @@
+/*
+ * Hal - thin hardware abstraction layer
+ *
+ * Control logic talks to these interfaces instead of calling millis(),
+ * digitalWrite(), analogRead(), LittleFS, RTC memory, HTTPClient or WiFiClient directly, so it
+ * can run on the board (ArduinoHal.h) or on a Linux host with fake
+ * peripherals (FakeHal.h).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual uint32_t millis() = 0;
+    // For timing short work; clocks without a finer source use millis()
+    virtual uint32_t micros() { return millis() * 1000UL; }
+    // Unix time in seconds, or 0 if wall-clock time is not known yet
+    virtual uint32_t epoch() = 0;
+};
+
+class Gpio {
+public:
+    virtual ~Gpio() {}
+    virtual void setOutput(uint8_t pin) = 0;
+    virtual void setInputPullup(uint8_t pin) = 0;
+    virtual void write(uint8_t pin, bool high) = 0;
+    virtual bool read(uint8_t pin) = 0;
+};
+
+class Adc {
+public:
+    virtual ~Adc() {}
+    virtual uint16_t read(uint8_t channel) = 0;
+};
+
+// Random-access file storage (LittleFS on the board, memory on the host)
+class FileStore {
+public:
+    virtual ~FileStore() {}
+    virtual bool exists(const char* path) = 0;
+    // File size in bytes, or -1 if the file does not exist
+    virtual int32_t size(const char* path) = 0;
+    // Replace the file with size zero bytes
+    virtual bool create(const char* path, uint32_t size) = 0;
+    virtual size_t read(const char* path, uint32_t offset, void* data, size_t length) = 0;
+    // Write at offset, creating the file if needed
+    virtual size_t write(const char* path, uint32_t offset, const void* data, size_t length) = 0;
+    virtual bool remove(const char* path) = 0;
+};
+
+// Small memory that survives resets and deep sleep but not power loss
+// (ESP8266 RTC user memory). Offsets and lengths are multiples of 4.
+class RtcMemory {
+public:
+    virtual ~RtcMemory() {}
+    virtual bool read(uint32_t offset, void* data, size_t length) = 0;
+    virtual bool write(uint32_t offset, const void* data, size_t length) = 0;
+};
+
+// A 2xx response whose body did not fit the caller's buffer; the first
+// responseSize - 1 bytes are still there, but parsing them would fail
+const int HTTP_RESPONSE_TRUNCATED = -100;
+
+// Request/response HTTP(S) transport to a fixed host
+class HttpTransport {
+public:
+    virtual ~HttpTransport() {}
+    // Returns the HTTP status code, or a negative value on transport failure.
+    // Up to responseSize - 1 bytes of the body are copied into response when
+    // given; a 2xx body that does not fit returns HTTP_RESPONSE_TRUNCATED.
+    virtual int request(const char* method, const char* path, const char* body,
+                        char* response = nullptr, size_t responseSize = 0) = 0;
+};
+
+// TCP byte stream to a fixed server (WiFiClient on the board, a socket on
+// the host). available() and read() never block.
+class ByteStream {
+public:
+    virtual ~ByteStream() {}
+    virtual bool connect(const char* host, uint16_t port) = 0;
+    virtual bool connected() = 0;
+    virtual size_t available() = 0;
+    // Up to length bytes; returns how many were read (0 if none are waiting)
+    virtual size_t read(uint8_t* data, size_t length) = 0;
+    virtual size_t write(const uint8_t* data, size_t length) = 0;
+    virtual void stop() = 0;
+};
@@ -0,0 +1,67 @@
+/*
+ * IrrigationTypes - device, pump and activation enums shared by the
+ * firmware, stored telemetry records and host builds
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Device state machine
+enum DeviceState : uint8_t {
+    AWAITING_CONFIG,    // No WiFi config, portal active
+    ONLINE,             // Connected to WiFi and Firebase
+    OFFLINE,            // WiFi not available, operating locally
+    LOCKED_FAULT        // Critical fault detected, auto watering disabled
+};
+
+// Pump state machine
+enum PumpState : uint8_t {
+    MONITORING,         // Watching sensor, ready to water
+    PUMP_RUNNING,       // Actively pumping water
+    PUMP_WAITING        // Cooldown period after watering
+};
+
+// What started a watering cycle; the value is stored in telemetry records
+enum ActivationMethod : uint8_t {
+    ACTIVATION_NONE = 0,
+    ACTIVATION_AUTO,
+    ACTIVATION_MANUAL,
+    ACTIVATION_REMOTE,
+    ACTIVATION_WEB
+};
+
+inline const char* deviceStateName(DeviceState state) {
+    switch (state) {
+        case AWAITING_CONFIG: return "AWAITING_CONFIG";
+        case ONLINE: return "ONLINE";
+        case OFFLINE: return "OFFLINE";
+        case LOCKED_FAULT: return "LOCKED_FAULT";
+        default: return "UNKNOWN";
+    }
+}
+
+inline const char* pumpStateName(PumpState state) {
+    switch (state) {
+        case MONITORING: return "MONITORING";
+        case PUMP_RUNNING: return "PUMP_RUNNING";
+        case PUMP_WAITING: return "PUMP_WAITING";
+        default: return "UNKNOWN";
+    }
+}
+
+inline const char* activationMethodName(ActivationMethod method) {
+    switch (method) {
+        case ACTIVATION_AUTO: return "AUTO";
+        case ACTIVATION_MANUAL: return "MANUAL";
+        case ACTIVATION_REMOTE: return "REMOTE";
+        case ACTIVATION_WEB: return "WEB";
+        default: return "NONE";
+    }
+}
+
+// Device state once the link state is known; a locked fault overrides both
+inline DeviceState connectedDeviceState(bool wifiConnected, bool lockedFault) {
+    if (lockedFault) return LOCKED_FAULT;
+    return wifiConnected ? ONLINE : OFFLINE;
+}
@@ -0,0 +1,47 @@
+/*
+ * LatencyHistogram - fixed-bucket histogram for timing measurements
+ *
+ * Recording is a short linear scan over the upper bounds, no allocation
+ * and no floating point, so it can run on every loop pass. Units are up
+ * to the caller (microseconds for loop stages, milliseconds for latency).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class LatencyHistogram {
+public:
+    static const uint8_t MAX_BUCKETS = 16;
+
+    // bounds: ascending upper bounds (inclusive), must outlive the histogram.
+    // Values above the last bound land in an implicit +Inf bucket.
+    LatencyHistogram() : _bounds(nullptr), _boundCount(0) {}
+    LatencyHistogram(const uint32_t* bounds, uint8_t boundCount)
+        : _bounds(bounds), _boundCount(boundCount > MAX_BUCKETS ? MAX_BUCKETS : boundCount) {}
+
+    void record(uint32_t value) {
+        uint8_t bucket = 0;
+        while (bucket < _boundCount && value > _bounds[bucket]) bucket++;
+        _counts[bucket]++;
+        _total++;
+        _sum += value;
+        if (value > _max) _max = value;
+    }
+
+    uint8_t boundCount() const { return _boundCount; }
+    uint32_t bound(uint8_t bucket) const { return _bounds[bucket]; }
+    // Observations in this bucket only (bucket == boundCount() is +Inf)
+    uint32_t count(uint8_t bucket) const { return _counts[bucket]; }
+    uint32_t total() const { return _total; }
+    uint64_t sum() const { return _sum; }
+    uint32_t max() const { return _max; }
+
+private:
+    const uint32_t* _bounds;
+    uint8_t _boundCount;
+    uint32_t _counts[MAX_BUCKETS + 1] = {};
+    uint32_t _total = 0;
+    uint64_t _sum = 0;
+    uint32_t _max = 0;
+};
@@ -0,0 +1,67 @@
+#include "MoistureSampler.h"
+
+const uint8_t MAX_OVERSAMPLE = 15;
+
+MoistureSampler::MoistureSampler(Adc& adc, Clock& clock, uint8_t channel,
+                                 const SamplerConfig& config)
+    : _adc(adc), _clock(clock), _channel(channel), _config(config) {}
+
+void MoistureSampler::begin() {
+    uint16_t median = readMedian();
+    _emaQ8 = (int32_t)median << 8;
+    _lastSampleMs = _clock.millis();
+    _lastRadioMs = _lastSampleMs - _config.radioGuardMs;
+
+    _snapshot.moisture = median;
+    _snapshot.lastMedian = median;
+    _snapshot.timestampMs = _lastSampleMs;
+    _snapshot.sequence++;
+}
+
+void MoistureSampler::update() {
+    uint32_t now = _clock.millis();
+    if (now - _lastSampleMs < intervalMs()) return;
+
+    // Wait for the radio to go quiet; the next pass will try again
+    if (now - _lastRadioMs < _config.radioGuardMs) {
+        _deferred++;
+        return;
+    }
+
+    uint16_t median = readMedian();
+    _emaQ8 += (((int32_t)median << 8) - _emaQ8) >> _config.emaShift;
+    _lastSampleMs = now;
+
+    _snapshot.moisture = (uint16_t)((_emaQ8 + 128) >> 8);
+    _snapshot.lastMedian = median;
+    _snapshot.timestampMs = now;
+    _snapshot.sequence++;
+}
+
+uint32_t MoistureSampler::msUntilDue() {
+    uint32_t now = _clock.millis();
+    uint32_t sinceSample = now - _lastSampleMs;
+    if (sinceSample < intervalMs()) return intervalMs() - sinceSample;
+    uint32_t sinceRadio = now - _lastRadioMs;
+    return sinceRadio < _config.radioGuardMs ? _config.radioGuardMs - sinceRadio : 0;
+}
+
+uint16_t MoistureSampler::readMedian() {
+    uint8_t count = _config.oversample;
+    if (count < 1) count = 1;
+    if (count > MAX_OVERSAMPLE) count = MAX_OVERSAMPLE;
+
+    // Insertion sort; bursts are tiny
+    uint16_t samples[MAX_OVERSAMPLE];
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t value = _adc.read(_channel);
+        uint8_t j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+    _adcReads += count;
+    return samples[count / 2];
+}
@@ -0,0 +1,71 @@
+/*
+ * MoistureSampler - the only reader of the moisture ADC
+ *
+ * Samples at a fixed interval instead of on every consumer's whim: each
+ * sample is the median of a short burst of reads (rejects spikes), then
+ * smoothed with an integer EMA. Sampling is skipped shortly after radio
+ * activity, since ADC reads while the ESP8266 transmits are both noisy
+ * and disruptive to WiFi. Consumers read the published snapshot.
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+struct SamplerConfig {
+    uint32_t intervalMs = 250;      // Time between sample bursts
+    uint8_t oversample = 5;         // Reads per burst (median taken), max 15
+    uint8_t emaShift = 2;           // EMA weight 1/2^shift for each new sample
+    uint32_t radioGuardMs = 20;     // Quiet time required after radio activity
+};
+
+struct MoistureSnapshot {
+    uint16_t moisture = 0;          // Filtered value, ADC counts (higher = drier)
+    uint16_t lastMedian = 0;        // Unsmoothed median of the latest burst
+    uint32_t timestampMs = 0;       // When the latest burst was taken
+    uint32_t sequence = 0;          // Increments with every published sample
+};
+
+class MoistureSampler {
+public:
+    MoistureSampler(Adc& adc, Clock& clock, uint8_t channel, const SamplerConfig& config);
+
+    // Take the first burst right away so the snapshot is valid from boot
+    void begin();
+
+    // Call when msUntilDue() reaches 0 (or every loop pass); samples when the
+    // interval is due and the radio is quiet
+    void update();
+
+    // Sample every intervalMs instead of config.intervalMs (0: the config again)
+    void setIntervalOverride(uint32_t intervalMs) { _intervalOverrideMs = intervalMs; }
+    uint32_t intervalMs() const { return _intervalOverrideMs ? _intervalOverrideMs : _config.intervalMs; }
+    // Time until update() would sample (0: due now, or waiting for the radio to go quiet)
+    uint32_t msUntilDue();
+
+    // Mark that the radio just transmitted (HTTP request, served page, ...)
+    void noteRadioActivity() { _lastRadioMs = _clock.millis(); }
+
+    const MoistureSnapshot& snapshot() const { return _snapshot; }
+    uint16_t moisture() const { return _snapshot.moisture; }
+
+    uint32_t adcReadCount() const { return _adcReads; }
+    uint32_t deferredCount() const { return _deferred; }
+
+private:
+    uint16_t readMedian();
+
+    Adc& _adc;
+    Clock& _clock;
+    uint8_t _channel;
+    const SamplerConfig& _config;
+
+    MoistureSnapshot _snapshot;
+    int32_t _emaQ8 = 0;             // EMA in 1/256 counts
+    uint32_t _lastSampleMs = 0;
+    uint32_t _lastRadioMs = 0;
+    uint32_t _intervalOverrideMs = 0;
+
+    uint32_t _adcReads = 0;
+    uint32_t _deferred = 0;
+};
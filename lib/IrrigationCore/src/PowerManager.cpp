@@ -0,0 +1,57 @@
+#include "PowerManager.h"
+
+PowerManager::PowerManager(Clock& clock, const PowerConfig& config)
+    : _clock(clock), _config(config), _lastUpdateMs(clock.millis()) {}
+
+RadioMode PowerManager::update(bool stayAwake) {
+    uint32_t now = _clock.millis();
+    account(now);
+
+    if (!_config.lowPower) {
+        _windowOpen = false;
+        _mode = RADIO_AWAKE;
+        return _mode;
+    }
+
+    if (_windowOpen && now - _windowStartMs >= _config.windowMs) _windowOpen = false;
+    if (!_windowOpen && (_windows == 0 || now - _windowStartMs >= _config.windowPeriodMs)) {
+        openWindow();
+    }
+    _mode = _windowOpen || stayAwake ? RADIO_AWAKE : RADIO_DOZE;
+    return _mode;
+}
+
+void PowerManager::openWindow() {
+    if (!_config.lowPower || _windowOpen) return;
+    _windowOpen = true;
+    _windowStartMs = _clock.millis();
+    _windows++;
+    _mode = RADIO_AWAKE;
+}
+
+// Attribute the time since the last update to the mode it was spent in
+void PowerManager::account(uint32_t now) {
+    uint32_t elapsed = now - _lastUpdateMs;
+    uint32_t idle = _idleMs < elapsed ? _idleMs : elapsed;
+    _lastUpdateMs = now;
+    _idleMs = 0;
+
+    _elapsedMs += elapsed;
+    if (_mode == RADIO_AWAKE) {
+        _awakeMs += elapsed;
+        _radioOnUs += elapsed * 1000ULL;
+    } else {
+        uint32_t busy = elapsed - idle;
+        _awakeMs += busy;
+        uint32_t listenMs = (uint32_t)_config.beaconIntervalMs * (_config.listenInterval ? _config.listenInterval : 1);
+        _radioOnUs += elapsed * 1000ULL * _config.beaconRxMs / listenMs;
+    }
+}
+
+float PowerManager::dutyCyclePct() const {
+    return _elapsedMs ? _awakeMs * 100.0f / _elapsedMs : 100.0f;
+}
+
+float PowerManager::radioOnPct() const {
+    return _elapsedMs ? _radioOnUs * 0.1f / _elapsedMs : 100.0f;
+}
@@ -0,0 +1,72 @@
+/*
+ * PowerManager - low-power mode: radio asleep between short network windows
+ *
+ * With lowPower set, network work (reports, config polls, backlog uploads,
+ * MQTT) is held back and done together in a window of windowMs every
+ * windowPeriodMs; urgent work (a fault or state change) opens one early.
+ * Outside windows the radio dozes, waking only for every listenInterval-th
+ * beacon, and the CPU light-sleeps while the loop idles. The radio stays
+ * awake while the caller says so (a pump cycle under way, so its timing
+ * is not stretched by a sleeping CPU; a WiFi reconnect).
+ *
+ * Duty cycle and radio-on time are estimates from the time spent in each
+ * mode: awake counts in full, a doze counts the loop's busy time and one
+ * beacon reception of beaconRxMs per listen interval.
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+struct PowerConfig {
+    bool lowPower = false;
+    uint32_t windowPeriodMs = 60000;    // Network work batched into one window a minute
+    uint32_t windowMs = 4000;           // Long enough for a TLS handshake and one commit
+    uint8_t listenInterval = 3;         // Beacons per wake-up while dozing
+    uint16_t beaconIntervalMs = 102;    // 100 TU
+    uint8_t beaconRxMs = 3;             // Radio on per beacon received
+};
+
+enum RadioMode : uint8_t {
+    RADIO_AWAKE,        // No sleep
+    RADIO_DOZE          // Modem and light sleep between beacons
+};
+
+class PowerManager {
+public:
+    PowerManager(Clock& clock, const PowerConfig& config);
+
+    // Call periodically; returns the radio mode wanted now
+    RadioMode update(bool stayAwake);
+
+    // Network work may run now (always without lowPower)
+    bool networkAllowed() const { return !_config.lowPower || _windowOpen; }
+    // Urgent work: open a window now (no-op without lowPower)
+    void openWindow();
+
+    // Time the loop is about to idle, for the duty cycle
+    void noteIdle(uint32_t ms) { _idleMs += ms; }
+
+    RadioMode mode() const { return _mode; }
+    uint32_t windowCount() const { return _windows; }
+    float dutyCyclePct() const;
+    float radioOnPct() const;
+    uint32_t radioOnSec() const { return (uint32_t)(_radioOnUs / 1000000); }
+
+private:
+    void account(uint32_t now);
+
+    Clock& _clock;
+    const PowerConfig& _config;
+
+    RadioMode _mode = RADIO_AWAKE;
+    bool _windowOpen = false;
+    uint32_t _windowStartMs = 0;
+    uint32_t _windows = 0;
+
+    uint32_t _lastUpdateMs;
+    uint32_t _idleMs = 0;               // Noted since the last update
+    uint64_t _elapsedMs = 0;
+    uint64_t _awakeMs = 0;
+    uint64_t _radioOnUs = 0;            // Beacon slices are far below a millisecond per update
+};
@@ -0,0 +1,37 @@
+#include "PumpController.h"
+
+PumpController::PumpController(Clock& clock, Gpio& gpio, uint8_t pumpPin, const PumpConfig& config)
+    : _zones(clock, gpio, &_zone, 1, _schedule) {
+    _zone.config = &config;
+    _zone.relay = pumpPin;
+    _zones.setListener(this);
+}
+
+void PumpController::update(uint16_t moisture) {
+    _zones.setMoisture(0, moisture);
+    _zones.update();
+}
+
+void PumpController::onPumpStarted(uint8_t, ActivationMethod method, uint16_t moistureBefore) {
+    if (_listener) _listener->onPumpStarted(method, moistureBefore);
+}
+
+void PumpController::onPumpStopped(uint8_t) {
+    if (_listener) _listener->onPumpStopped();
+}
+
+void PumpController::onMonitoringResumed(uint8_t) {
+    if (_listener) _listener->onMonitoringResumed();
+}
+
+void PumpController::onEffectivenessChecked(uint8_t, const EffectivenessResult& result) {
+    if (_listener) _listener->onEffectivenessChecked(result);
+}
+
+void PumpController::onFaultLocked(uint8_t, uint8_t attempts) {
+    if (_listener) _listener->onFaultLocked(attempts);
+}
+
+void PumpController::onPersistentStateChanged(uint8_t) {
+    if (_listener) _listener->onPersistentStateChanged();
+}
@@ -0,0 +1,86 @@
+/*
+ * PumpController - pump state machine, safety interval and fault lockout
+ *
+ * MONITORING -> PUMP_RUNNING -> PUMP_WAITING -> MONITORING. After an
+ * automatic cycle the soil is re-read once it has settled; too many
+ * cycles without a moisture drop lock auto-watering until the fault is
+ * cleared. Reporting, LEDs and persistence are left to a PumpListener.
+ *
+ * The single on-board pump is a one-zone ZoneController (ZoneController.h
+ * holds the logic and the config/state types).
+ */
+
+#pragma once
+
+#include "Hal.h"
+#include "IrrigationTypes.h"
+#include "ZoneController.h"
+
+class PumpListener {
+public:
+    virtual ~PumpListener() {}
+    virtual void onPumpStarted(ActivationMethod method, uint16_t moistureBefore) {}
+    virtual void onPumpStopped() {}
+    virtual void onMonitoringResumed() {}
+    virtual void onEffectivenessChecked(const EffectivenessResult& result) {}
+    virtual void onFaultLocked(uint8_t attempts) {}
+    // Persistent state changed and should be saved
+    virtual void onPersistentStateChanged() {}
+};
+
+class PumpController : private ZoneListener {
+public:
+    // Moisture must drop by at least this much for a cycle to count as effective
+    static const int16_t REQUIRED_DROP = ZoneController::REQUIRED_DROP;
+
+    PumpController(Clock& clock, Gpio& gpio, uint8_t pumpPin, const PumpConfig& config);
+
+    void setListener(PumpListener* listener) { _listener = listener; }
+
+    // Configure the pin and switch the pump off
+    void begin() { _zones.begin(); }
+    void restore(const PumpPersistentState& state) { _zones.restore(0, state); }
+    // Cycle phase, saved and restored across deep sleeps (ZoneController::restorePhase)
+    ZonePhase phase() const { return _zones.phase(0); }
+    void restorePhase(const ZonePhase& phase) { _zones.restorePhase(0, phase); }
+
+    // Advance the state machine with the current sensor reading
+    void update(uint16_t moisture);
+
+    // True when the minimum interval since the last cycle has passed
+    bool checkSafety() { return _zones.checkSafety(0); }
+    // Seconds left before checkSafety() passes (0 if it already does)
+    uint32_t safetyWaitSec() { return _zones.safetyWaitSec(0); }
+
+    // Start a cycle without any checks (callers check lockedFault/checkSafety)
+    void activate(ActivationMethod method, uint16_t moisture) { _zones.activate(0, method, moisture); }
+
+    // Unlock auto-watering; returns false if there was no fault
+    bool clearFault() { return _zones.clearFault(0); }
+
+    PumpState state() const { return _zone.state; }
+    bool lockedFault() const { return _zone.persistent.lockedFault; }
+    uint8_t noEffectCounter() const { return _zone.persistent.noEffectCounter; }
+    uint32_t lastPumpEndEpoch() const { return _zone.persistent.lastPumpEndEpoch; }
+    uint16_t moistureBeforePump() const { return _zone.moistureBeforePump; }
+    ActivationMethod lastActivationMethod() const { return _zone.lastMethod; }
+    // Length of the running (or last) pulse
+    uint32_t pulseMs() const { return _zone.dose.pulseMs; }
+    const DoseState& dose() const { return _zone.dose; }
+    const PumpPersistentState& persistentState() const { return _zone.persistent; }
+    const PumpConfig& config() const { return *_zone.config; }
+
+private:
+    // ZoneListener, forwarded without the zone index
+    void onPumpStarted(uint8_t, ActivationMethod method, uint16_t moistureBefore) override;
+    void onPumpStopped(uint8_t) override;
+    void onMonitoringResumed(uint8_t) override;
+    void onEffectivenessChecked(uint8_t, const EffectivenessResult& result) override;
+    void onFaultLocked(uint8_t, uint8_t attempts) override;
+    void onPersistentStateChanged(uint8_t) override;
+
+    Zone _zone;
+    ZoneSchedule _schedule;
+    ZoneController _zones;
+    PumpListener* _listener = nullptr;
+};
@@ -0,0 +1,38 @@
+#include "ShiftRegisterGpio.h"
+
+ShiftRegisterGpio::ShiftRegisterGpio(Gpio& pins, uint8_t dataPin, uint8_t clockPin,
+                                     uint8_t latchPin, uint8_t outputCount)
+    : _pins(pins), _dataPin(dataPin), _clockPin(clockPin), _latchPin(latchPin) {
+    if (outputCount > MAX_OUTPUTS) outputCount = MAX_OUTPUTS;
+    _bits = (outputCount + 7) / 8 * 8;
+}
+
+void ShiftRegisterGpio::begin() {
+    _pins.setOutput(_dataPin);
+    _pins.setOutput(_clockPin);
+    _pins.setOutput(_latchPin);
+    _pins.write(_clockPin, false);
+    _levels = 0;
+    shiftOut();
+}
+
+void ShiftRegisterGpio::write(uint8_t output, bool high) {
+    if (output >= _bits) return;
+    uint32_t levels = high ? _levels | (1UL << output) : _levels & ~(1UL << output);
+    if (levels == _levels) return;
+    _levels = levels;
+    shiftOut();
+}
+
+// Farthest register first, most significant bit first; outputs change
+// together on the latch edge
+void ShiftRegisterGpio::shiftOut() {
+    _pins.write(_latchPin, false);
+    for (int8_t bit = _bits - 1; bit >= 0; bit--) {
+        _pins.write(_dataPin, (_levels >> bit) & 1);
+        _pins.write(_clockPin, true);
+        _pins.write(_clockPin, false);
+    }
+    _pins.write(_latchPin, true);
+    _shifts++;
+}
@@ -0,0 +1,43 @@
+/*
+ * ShiftRegisterGpio - relay outputs behind a chain of 74HC595 shift registers
+ *
+ * Output n is bit n of the chain (outputs 0-7 on the register nearest the
+ * MCU). A write updates a shadow and shifts the whole chain out through
+ * three pins of the underlying Gpio, so zone relays sit behind the same
+ * interface as the on-board pump pin and run unchanged on the host.
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+class ShiftRegisterGpio : public Gpio {
+public:
+    static const uint8_t MAX_OUTPUTS = 32;
+
+    ShiftRegisterGpio(Gpio& pins, uint8_t dataPin, uint8_t clockPin, uint8_t latchPin,
+                      uint8_t outputCount);
+
+    // Configure the three pins and latch every output off; call before
+    // anything else so relays do not keep the register's power-up garbage
+    void begin();
+
+    void setOutput(uint8_t) override {}         // Every output is an output
+    void setInputPullup(uint8_t) override {}
+    void write(uint8_t output, bool high) override;
+    bool read(uint8_t output) override { return (_levels >> output) & 1; }  // Last written level
+
+    uint32_t levels() const { return _levels; }
+    uint32_t shiftCount() const { return _shifts; }
+
+private:
+    void shiftOut();
+
+    Gpio& _pins;
+    uint8_t _dataPin;
+    uint8_t _clockPin;
+    uint8_t _latchPin;
+    uint8_t _bits;                  // outputCount rounded up to whole registers
+    uint32_t _levels = 0;
+    uint32_t _shifts = 0;
+};
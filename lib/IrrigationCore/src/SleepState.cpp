@@ -0,0 +1,58 @@
+#include "SleepState.h"
+#include "Crc16.h"
+#include <stddef.h>
+
+const uint32_t SLEEP_RECORD_MAGIC = 0x534C5032;  // "SLP2"
+
+static_assert(sizeof(SleepRecord) % 4 == 0, "RTC memory is accessed in words");
+
+SleepState::SleepState(RtcMemory& rtc, Clock& clock, uint32_t rtcOffset)
+    : _rtc(rtc), _clock(clock), _rtcOffset(rtcOffset) {}
+
+bool SleepState::begin() {
+    SleepRecord record;
+    if (_rtc.read(_rtcOffset, &record, sizeof(record)) && record.magic == SLEEP_RECORD_MAGIC &&
+        record.crc == crc16(&record, offsetof(SleepRecord, crc))) {
+        _record = record;
+        return true;
+    }
+    _record = {};
+    _record.magic = SLEEP_RECORD_MAGIC;
+    return false;
+}
+
+ZonePhase SleepState::phase() const {
+    ZonePhase phase;
+    phase.state = (PumpState)_record.state;
+    phase.sinceMs = _record.phaseSinceMs;
+    phase.moistureBeforePump = _record.moistureBeforePump;
+    phase.lastMethod = (ActivationMethod)_record.lastMethod;
+    return phase;
+}
+
+void SleepState::savePhase(const ZonePhase& phase) {
+    _record.state = phase.state;
+    _record.phaseSinceMs = phase.sinceMs;
+    _record.moistureBeforePump = phase.moistureBeforePump;
+    _record.lastMethod = phase.lastMethod;
+    save();
+}
+
+void SleepState::prepareSleep(uint32_t sleepMs) {
+    uint32_t awakeUs = _clock.micros();  // Since boot, which is since the wake-up
+    _record.clockMs += _clock.millis() + sleepMs;
+    _record.awakeMs += awakeUs / 1000;
+    _record.wakes++;
+    _record.lastAwakeUs = awakeUs;
+    if (awakeUs > _record.maxAwakeUs) _record.maxAwakeUs = awakeUs;
+    save();
+}
+
+float SleepState::dutyCyclePct() const {
+    return _record.clockMs ? _record.awakeMs * 100.0f / _record.clockMs : 100.0f;
+}
+
+void SleepState::save() {
+    _record.crc = crc16(&_record, offsetof(SleepRecord, crc));
+    _rtc.write(_rtcOffset, &_record, sizeof(_record));
+}
@@ -0,0 +1,82 @@
+/*
+ * SleepState - controller state carried across deep sleeps in RTC memory
+ *
+ * A deep-sleep build wakes from the RTC timer as if from reset: RAM is lost
+ * and millis() starts again at 0. The pump controller's phase (see
+ * ZonePhase) and a running clock (time slept plus time awake) live in a
+ * CRC-checked RTC record instead; SleepClock hands that clock to the
+ * controller, so its waits span sleeps. Each wake's length, from boot to the
+ * call before sleeping, is recorded too, so battery life can be sized from
+ * measured awake time. After power-up or a corrupt record, begin() starts
+ * from MONITORING at time 0.
+ *
+ * The running clock follows the RTC sleep timer, which drifts by a few
+ * percent; it is for intervals between wakes, not wall time.
+ */
+
+#pragma once
+
+#include "Hal.h"
+#include "ZoneController.h"
+
+struct __attribute__((packed)) SleepRecord {
+    uint32_t magic;
+    uint64_t clockMs;               // Slept plus awake time since power-up
+    uint64_t awakeMs;               // Awake part of clockMs
+    uint32_t phaseSinceMs;          // Low 32 bits of clockMs when the phase began
+    uint32_t wakes;                 // Completed wakes
+    uint32_t lastAwakeUs;
+    uint32_t maxAwakeUs;
+    uint16_t moisture;              // Reading of the last completed wake
+    uint16_t moistureBeforePump;
+    uint8_t state;                  // PumpState
+    uint8_t lastMethod;             // ActivationMethod
+    uint16_t crc;
+};
+
+class SleepState {
+public:
+    SleepState(RtcMemory& rtc, Clock& clock, uint32_t rtcOffset);
+
+    // Restore the record; false (fresh state) after power-up or corruption
+    bool begin();
+
+    ZonePhase phase() const;
+    // Keep phase and write the record at once, so a reset before the next
+    // sleep resumes from here
+    void savePhase(const ZonePhase& phase);
+
+    void setMoisture(uint16_t moisture) { _record.moisture = moisture; }
+    uint16_t lastMoisture() const { return _record.moisture; }
+
+    // Close this wake and write the record; call right before sleeping sleepMs
+    void prepareSleep(uint32_t sleepMs);
+
+    // Running clock: the record's plus time awake in this wake
+    uint64_t nowMs() const { return _record.clockMs + _clock.millis(); }
+    uint32_t wakeCount() const { return _record.wakes; }
+    uint32_t lastAwakeUs() const { return _record.lastAwakeUs; }
+    uint32_t maxAwakeUs() const { return _record.maxAwakeUs; }
+    uint32_t meanAwakeMs() const { return _record.wakes ? (uint32_t)(_record.awakeMs / _record.wakes) : 0; }
+    float dutyCyclePct() const;
+
+private:
+    void save();
+
+    RtcMemory& _rtc;
+    Clock& _clock;
+    uint32_t _rtcOffset;
+    SleepRecord _record = {};
+};
+
+// The running clock for a controller rebuilt on every wake. Its millis()
+// wrap after 49 days like the board's; there is no wall time (epoch() 0).
+class SleepClock : public Clock {
+public:
+    explicit SleepClock(const SleepState& state) : _state(state) {}
+    uint32_t millis() override { return (uint32_t)_state.nowMs(); }
+    uint32_t epoch() override { return 0; }
+
+private:
+    const SleepState& _state;
+};
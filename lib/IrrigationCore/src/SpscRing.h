@@ -0,0 +1,51 @@
+/*
+ * SpscRing - lock-free single-producer/single-consumer ring buffer
+ *
+ * Safe to push from an interrupt handler while the main loop pops.
+ * Capacity must be a power of two; one slot is kept free.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false when full. Always inlined so an
+    // IRAM interrupt handler never calls into flash.
+    inline __attribute__((always_inline)) bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (Capacity - 1);
+        if (next == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = _items[tail];
+        _tail.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+};
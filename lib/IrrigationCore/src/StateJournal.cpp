@@ -0,0 +1,116 @@
+#include "StateJournal.h"
+#include "Crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+const uint32_t RTC_SHADOW_MAGIC = 0x504A524E;  // "PJRN"
+
+static_assert(sizeof(JournalRecord) == 16, "journal slots are 16 bytes");
+
+StateJournal::StateJournal(FileStore& store, Clock& clock, RtcMemory* rtc, uint32_t rtcOffset,
+                           const char* path, uint16_t slots, uint32_t coalesceMs)
+    : _store(store), _clock(clock), _rtc(rtc), _rtcOffset(rtcOffset), _path(path),
+      _slots(slots), _coalesceMs(coalesceMs) {}
+
+bool StateJournal::begin() {
+    int32_t fileSize = (int32_t)_slots * sizeof(JournalRecord);
+    if (_store.size(_path) != fileSize && !_store.create(_path, fileSize)) {
+        return false;
+    }
+
+    // Newest valid record; the slot after it is the next one to write
+    _current = {};
+    _nextSlot = 0;
+    JournalRecord block[16];
+    for (uint16_t first = 0; first < _slots; first += 16) {
+        size_t bytesRead = _store.read(_path, (uint32_t)first * sizeof(JournalRecord),
+                                       block, sizeof(block));
+        for (size_t i = 0; i < bytesRead / sizeof(JournalRecord); i++) {
+            if (isValid(block[i]) && block[i].seq > _current.seq) {
+                _current = block[i];
+                _nextSlot = (first + i + 1) % _slots;
+            }
+        }
+    }
+
+    // A shadow ahead of the journal holds updates a reset cut off before the flush
+    RtcShadow shadow;
+    if (_rtc && _rtc->read(_rtcOffset, &shadow, sizeof(shadow)) &&
+        shadow.magic == RTC_SHADOW_MAGIC && isValid(shadow.record) &&
+        shadow.record.seq > _current.seq) {
+        _current = shadow.record;
+        _restoredFromRtc = true;
+        _dirty = true;
+        _dirtySince = _clock.millis();
+    }
+
+    _ready = true;
+    return true;
+}
+
+bool StateJournal::load(PumpPersistentState& state) const {
+    if (_current.seq == 0) return false;
+    state.lastPumpEndEpoch = _current.lastPumpEndEpoch;
+    state.lockedFault = _current.lockedFault != 0;
+    state.noEffectCounter = _current.noEffectCounter;
+    return true;
+}
+
+void StateJournal::update(const PumpPersistentState& state) {
+    if (_current.seq != 0 &&
+        _current.lastPumpEndEpoch == state.lastPumpEndEpoch &&
+        (_current.lockedFault != 0) == state.lockedFault &&
+        _current.noEffectCounter == state.noEffectCounter) {
+        return;  // Nothing changed
+    }
+
+    _current.seq++;
+    _current.lastPumpEndEpoch = state.lastPumpEndEpoch;
+    _current.lockedFault = state.lockedFault ? 1 : 0;
+    _current.noEffectCounter = state.noEffectCounter;
+    seal(_current);
+
+    if (_rtc) {
+        RtcShadow shadow = {};
+        shadow.magic = RTC_SHADOW_MAGIC;
+        shadow.record = _current;
+        _rtc->write(_rtcOffset, &shadow, sizeof(shadow));
+    }
+
+    if (_dirty) {
+        _coalesced++;
+    } else {
+        _dirty = true;
+        _dirtySince = _clock.millis();
+    }
+}
+
+bool StateJournal::flushIfDue() {
+    if (!_dirty || _clock.millis() - _dirtySince < _coalesceMs) return false;
+    return flush();
+}
+
+bool StateJournal::flush() {
+    if (!_dirty) return true;
+    if (!_ready) return false;
+
+    uint32_t offset = (uint32_t)_nextSlot * sizeof(JournalRecord);
+    if (_store.write(_path, offset, &_current, sizeof(_current)) != sizeof(_current)) {
+        _dirtySince = _clock.millis();  // Retry after another coalescing period
+        return false;
+    }
+
+    _nextSlot = (_nextSlot + 1) % _slots;
+    _flashWrites++;
+    _dirty = false;
+    return true;
+}
+
+bool StateJournal::isValid(const JournalRecord& record) {
+    return record.seq != 0 && record.crc == crc16(&record, offsetof(JournalRecord, crc));
+}
+
+void StateJournal::seal(JournalRecord& record) {
+    memset(record.reserved, 0, sizeof(record.reserved));
+    record.crc = crc16(&record, offsetof(JournalRecord, crc));
+}
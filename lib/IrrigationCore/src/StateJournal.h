@@ -0,0 +1,83 @@
+/*
+ * StateJournal - pump persistent state as CRC-checked binary records
+ *
+ * Records go into a pre-allocated slot file, one 16-byte slot per flush,
+ * wrapping to the start once full. Every record carries a sequence number,
+ * so the file never needs erasing or rewriting: the highest valid sequence
+ * wins, and superseded records are simply overwritten on the next pass.
+ * A flush torn by power loss fails its CRC and the previous record is used.
+ *
+ * update() only writes an RTC memory shadow and marks the state dirty; the
+ * flash write happens coalesceMs later, so the several updates of one pump
+ * cycle cost a single write. A shadow newer than the journal (reset before
+ * the flush) is adopted at boot.
+ */
+
+#pragma once
+
+#include "Hal.h"
+#include "PumpController.h"
+
+struct __attribute__((packed)) JournalRecord {
+    uint32_t seq;                   // 0 = empty slot
+    uint32_t lastPumpEndEpoch;
+    uint8_t lockedFault;
+    uint8_t noEffectCounter;
+    uint8_t reserved[4];
+    uint16_t crc;
+};
+
+class StateJournal {
+public:
+    // rtc may be nullptr (no shadow: updates are only kept in RAM until flushed)
+    StateJournal(FileStore& store, Clock& clock, RtcMemory* rtc, uint32_t rtcOffset,
+                 const char* path, uint16_t slots, uint32_t coalesceMs);
+
+    // Open or create the journal and recover the latest state. Returns false without storage.
+    bool begin();
+
+    // Latest known state; false if neither journal nor shadow had one
+    bool load(PumpPersistentState& state) const;
+
+    // Record a new state; written to flash by flushIfDue() or flush()
+    void update(const PumpPersistentState& state);
+
+    // Write a dirty state once it has been pending for coalesceMs
+    bool flushIfDue();
+    // Write a dirty state now. Returns false if the write failed.
+    bool flush();
+
+    bool dirty() const { return _dirty; }
+    uint32_t sequence() const { return _current.seq; }
+
+    uint32_t flashWriteCount() const { return _flashWrites; }
+    uint32_t coalescedCount() const { return _coalesced; }
+    bool restoredFromRtc() const { return _restoredFromRtc; }
+
+private:
+    struct RtcShadow {
+        uint32_t magic;
+        JournalRecord record;
+    };
+
+    static bool isValid(const JournalRecord& record);
+    void seal(JournalRecord& record);
+
+    FileStore& _store;
+    Clock& _clock;
+    RtcMemory* _rtc;
+    uint32_t _rtcOffset;
+    const char* _path;
+    uint16_t _slots;
+    uint32_t _coalesceMs;
+    bool _ready = false;
+
+    JournalRecord _current = {};
+    uint16_t _nextSlot = 0;
+    bool _dirty = false;
+    uint32_t _dirtySince = 0;
+
+    uint32_t _flashWrites = 0;
+    uint32_t _coalesced = 0;
+    bool _restoredFromRtc = false;
+};
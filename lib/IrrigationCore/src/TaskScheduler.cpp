@@ -0,0 +1,109 @@
+#include "TaskScheduler.h"
+
+uint8_t TaskScheduler::add(const char* name, TaskFunction function, uint32_t periodMs,
+                           uint32_t firstDelayMs, uint32_t budgetMs) {
+    if (_count >= MAX_TASKS || periodMs == 0) return NO_TASK;
+
+    uint8_t id = _count++;
+    Task& task = _tasks[id];
+    task.function = function;
+    task.dueMs = _clock.millis() + firstDelayMs;
+    task.stats = TaskStats();
+    task.stats.name = name;
+    task.stats.periodMs = periodMs;
+    task.stats.budgetUs = (budgetMs ? budgetMs : periodMs) * 1000UL;
+
+    task.heapIndex = id;
+    _heap[id] = id;
+    siftUp(id);
+    return id;
+}
+
+uint32_t TaskScheduler::runDue() {
+    _passes++;
+    uint32_t now = _clock.millis();
+
+    // At most one run per task per pass, so a task that keeps waking
+    // itself cannot starve the loop
+    for (uint8_t runs = 0; runs < _count; runs++) {
+        uint8_t id = _heap[0];
+        Task& task = _tasks[id];
+        int32_t lateMs = (int32_t)(now - task.dueMs);
+        if (lateMs < 0) break;
+
+        // Next deadline on the period grid, skipping periods already missed
+        TaskStats& stats = task.stats;
+        uint32_t missed = (uint32_t)lateMs / stats.periodMs;
+        stats.skipped += missed;
+        task.dueMs += (missed + 1) * stats.periodMs;
+        siftDown(0);
+
+        uint32_t startUs = _clock.micros();
+        task.function();
+        uint32_t runUs = _clock.micros() - startUs;
+
+        stats.runs++;
+        stats.totalRunUs += runUs;
+        if (runUs > stats.maxRunUs) stats.maxRunUs = runUs;
+        if (runUs > stats.budgetUs) stats.overruns++;
+        if ((uint32_t)lateMs > stats.maxLateMs) stats.maxLateMs = lateMs;
+        now = _clock.millis();
+    }
+
+    uint32_t idle = msUntilNext();
+    _idleMs += idle;
+    return idle;
+}
+
+void TaskScheduler::runIn(uint8_t id, uint32_t ms) {
+    if (id >= _count) return;
+    _tasks[id].dueMs = _clock.millis() + ms;
+    reposition(id);
+}
+
+void TaskScheduler::setPeriod(uint8_t id, uint32_t periodMs) {
+    if (id < _count && periodMs > 0) _tasks[id].stats.periodMs = periodMs;
+}
+
+uint32_t TaskScheduler::msUntilNext() {
+    if (_count == 0) return UINT32_MAX;
+    int32_t remaining = (int32_t)(_tasks[_heap[0]].dueMs - _clock.millis());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+// Heap
+
+void TaskScheduler::swap(uint8_t i, uint8_t j) {
+    uint8_t id = _heap[i];
+    _heap[i] = _heap[j];
+    _heap[j] = id;
+    _tasks[_heap[i]].heapIndex = i;
+    _tasks[_heap[j]].heapIndex = j;
+}
+
+void TaskScheduler::siftUp(uint8_t i) {
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!earlier(_heap[i], _heap[parent])) break;
+        swap(i, parent);
+        i = parent;
+    }
+}
+
+void TaskScheduler::siftDown(uint8_t i) {
+    for (;;) {
+        uint8_t smallest = i;
+        uint8_t left = 2 * i + 1, right = left + 1;
+        if (left < _count && earlier(_heap[left], _heap[smallest])) smallest = left;
+        if (right < _count && earlier(_heap[right], _heap[smallest])) smallest = right;
+        if (smallest == i) break;
+        swap(i, smallest);
+        i = smallest;
+    }
+}
+
+void TaskScheduler::reposition(uint8_t id) {
+    uint8_t i = _tasks[id].heapIndex;
+    siftUp(i);
+    siftDown(_tasks[id].heapIndex);
+}
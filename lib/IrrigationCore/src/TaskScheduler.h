@@ -0,0 +1,89 @@
+/*
+ * TaskScheduler - cooperative deadline scheduler for the main loop
+ *
+ * Tasks are plain functions with a period. A binary min-heap keeps them
+ * ordered by next deadline, so a pass runs only what is due, in deadline
+ * order, and returns how long the caller may idle before the next one.
+ * A task that fell whole periods behind (another task blocked) runs once
+ * and skips the missed periods instead of running back to back; the skips
+ * are counted. A task may move its own deadline from inside its function
+ * (runIn), or another task's (wake), e.g. when new data arrived for it.
+ *
+ * Per task: runs, worst start delay, skipped periods, worst and total run
+ * time, and overruns (runs longer than the task's budget, by default its
+ * period). Nothing is allocated; tasks live in a fixed table.
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+typedef void (*TaskFunction)();
+
+struct TaskStats {
+    const char* name;
+    uint32_t periodMs;
+    uint32_t budgetUs;                  // A run longer than this is an overrun
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t skipped;                   // Periods missed entirely
+    uint32_t maxLateMs;                 // Worst start after the deadline
+    uint32_t maxRunUs;
+    uint64_t totalRunUs;
+};
+
+class TaskScheduler {
+public:
+    static const uint8_t MAX_TASKS = 16;
+    static const uint8_t NO_TASK = 0xFF;
+
+    explicit TaskScheduler(Clock& clock) : _clock(clock) {}
+
+    // Register a task, first due after firstDelayMs. budgetMs 0: the period.
+    // Returns its id, or NO_TASK if the table is full or periodMs is 0.
+    uint8_t add(const char* name, TaskFunction function, uint32_t periodMs, uint32_t firstDelayMs = 0,
+                uint32_t budgetMs = 0);
+
+    // Run every task due now, earliest deadline first; returns the
+    // milliseconds until the next deadline (0 if one is already due)
+    uint32_t runDue();
+
+    // Next run in ms from now (also from inside the task itself, where it
+    // replaces the period step)
+    void runIn(uint8_t id, uint32_t ms);
+    // Run on the next pass
+    void wake(uint8_t id) { runIn(id, 0); }
+    // Takes effect from the next deadline
+    void setPeriod(uint8_t id, uint32_t periodMs);
+
+    uint32_t msUntilNext();
+
+    uint8_t count() const { return _count; }
+    const TaskStats& stats(uint8_t id) const { return _tasks[id].stats; }
+    uint32_t passCount() const { return _passes; }
+    uint64_t idleMs() const { return _idleMs; }        // Sum of the waits runDue() returned
+
+private:
+    struct Task {
+        TaskFunction function;
+        uint32_t dueMs;
+        uint8_t heapIndex;
+        TaskStats stats;
+    };
+
+    bool earlier(uint8_t a, uint8_t b) const {
+        return (int32_t)(_tasks[a].dueMs - _tasks[b].dueMs) < 0;
+    }
+    void swap(uint8_t i, uint8_t j);
+    void siftUp(uint8_t i);
+    void siftDown(uint8_t i);
+    void reposition(uint8_t id);
+
+    Clock& _clock;
+    Task _tasks[MAX_TASKS];
+    uint8_t _heap[MAX_TASKS];           // Task ids, earliest deadline at 0
+    uint8_t _count = 0;
+
+    uint32_t _passes = 0;
+    uint64_t _idleMs = 0;
+};
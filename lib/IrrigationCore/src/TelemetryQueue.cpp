@@ -0,0 +1,150 @@
+#include "TelemetryQueue.h"
+#include "Crc16.h"
+
+const uint32_t BUDGET_WINDOW_MS = 3600000;  // 1 hour
+const uint8_t EVENT_RESERVE_PERCENT = 20;   // Budget share kept back for events
+
+struct __attribute__((packed)) TelemetryAck {
+    uint32_t seq;
+    uint16_t crc;
+};
+
+TelemetryQueue::TelemetryQueue(FileStore& store, Clock& clock, const char* ringPath,
+                               const char* ackPath, uint16_t capacity, uint16_t maxWritesPerHour)
+    : _store(store), _clock(clock), _ringPath(ringPath), _ackPath(ackPath), _capacity(capacity),
+      _maxWritesPerHour(maxWritesPerHour) {}
+
+bool TelemetryQueue::begin() {
+    int32_t ringSize = (int32_t)_capacity * sizeof(TelemetryRecord);
+
+    // Pre-allocate the ring so later writes never grow the file
+    if (_store.size(_ringPath) != ringSize && !_store.create(_ringPath, ringSize)) {
+        return false;
+    }
+
+    // Recover the newest valid record; torn or empty slots fail the CRC check
+    // (read in blocks so the scan costs a few file opens, not one per slot)
+    _headSeq = 0;
+    TelemetryRecord block[16];
+    for (uint16_t first = 0; first < _capacity; first += 16) {
+        size_t bytesRead = _store.read(_ringPath, (uint32_t)first * sizeof(TelemetryRecord),
+                                       block, sizeof(block));
+        for (size_t i = 0; i < bytesRead / sizeof(TelemetryRecord); i++) {
+            if (isValid(block[i]) && block[i].seq > _headSeq) {
+                _headSeq = block[i].seq;
+            }
+        }
+    }
+
+    _tailSeq = 0;
+    TelemetryAck ack;
+    if (_store.read(_ackPath, 0, &ack, sizeof(ack)) == sizeof(ack) &&
+        ack.crc == crc16((const uint8_t*)&ack.seq, sizeof(ack.seq))) {
+        _tailSeq = ack.seq;
+        // Ring recreated (or wiped) since that ack: carry on after it, as
+        // restarting at 1 would reuse IDs of documents already uploaded
+        if (_headSeq < _tailSeq) {
+            _headSeq = _tailSeq;
+        }
+    }
+    if (_headSeq - _tailSeq > _capacity) {
+        _tailSeq = _headSeq - _capacity;
+    }
+
+    _budgetWindowStart = _clock.millis();
+    _ready = true;
+    return true;
+}
+
+bool TelemetryQueue::takeWriteBudget(bool isEvent) {
+    uint32_t now = _clock.millis();
+    if (now - _budgetWindowStart >= BUDGET_WINDOW_MS) {
+        _budgetWindowStart = now;
+        _writesThisWindow = 0;
+    }
+
+    uint16_t limit = _maxWritesPerHour;
+    if (!isEvent) {
+        limit -= (uint32_t)_maxWritesPerHour * EVENT_RESERVE_PERCENT / 100;
+    }
+    if (_writesThisWindow >= limit) {
+        _throttled++;
+        return false;
+    }
+
+    _writesThisWindow++;
+    return true;
+}
+
+bool TelemetryQueue::push(TelemetryRecord record) {
+    if (!_ready) return false;
+    if (!takeWriteBudget(record.type != TELEMETRY_READING)) return false;
+
+    record.seq = _headSeq + 1;
+    record.crc = crc16((const uint8_t*)&record, offsetof(TelemetryRecord, crc));
+
+    uint32_t offset = (record.seq % _capacity) * sizeof(TelemetryRecord);
+    if (_store.write(_ringPath, offset, &record, sizeof(record)) != sizeof(record)) return false;
+
+    _headSeq = record.seq;
+    _stored++;
+
+    // Full ring: the oldest undelivered record was just overwritten
+    if (_headSeq - _tailSeq > _capacity) {
+        _tailSeq = _headSeq - _capacity;
+        _overwritten++;
+    }
+    return true;
+}
+
+size_t TelemetryQueue::peek(TelemetryRecord* out, size_t maxRecords, uint32_t& lastSeq) {
+    lastSeq = _tailSeq;
+    if (!_ready) return 0;
+
+    size_t count = 0;
+    for (uint32_t seq = _tailSeq + 1; seq <= _headSeq && count < maxRecords; seq++) {
+        TelemetryRecord record;
+        // Skip slots lost to a torn write
+        if (readSlot(seq % _capacity, record) && record.seq == seq) {
+            out[count++] = record;
+        }
+        lastSeq = seq;
+    }
+    return count;
+}
+
+void TelemetryQueue::ack(uint32_t seq) {
+    _drained += advanceTail(seq);
+}
+
+void TelemetryQueue::reject(uint32_t seq) {
+    _rejected += advanceTail(seq);
+}
+
+uint32_t TelemetryQueue::advanceTail(uint32_t seq) {
+    if (!_ready || seq <= _tailSeq) return 0;
+    if (seq > _headSeq) seq = _headSeq;
+
+    uint32_t count = seq - _tailSeq;
+    _tailSeq = seq;
+
+    // Not budget-limited: at most one ack write per drained batch. If it is
+    // lost, the batch is resent and overwrites the same Firestore documents.
+    TelemetryAck ackRecord;
+    ackRecord.seq = seq;
+    ackRecord.crc = crc16((const uint8_t*)&ackRecord.seq, sizeof(ackRecord.seq));
+    _store.write(_ackPath, 0, &ackRecord, sizeof(ackRecord));
+    return count;
+}
+
+bool TelemetryQueue::readSlot(uint16_t slot, TelemetryRecord& record) {
+    size_t bytesRead = _store.read(_ringPath, (uint32_t)slot * sizeof(TelemetryRecord),
+                                  &record, sizeof(record));
+
+    return bytesRead == sizeof(record) && isValid(record);
+}
+
+bool TelemetryQueue::isValid(const TelemetryRecord& record) {
+    return record.seq != 0 &&
+           record.crc == crc16((const uint8_t*)&record, offsetof(TelemetryRecord, crc));
+}
@@ -0,0 +1,99 @@
+/*
+ * TelemetryQueue - store-and-forward buffer for offline periods
+ *
+ * Fixed-size records in a pre-allocated ring file (LittleFS on the board). Each slot
+ * carries a sequence number and CRC, so a write torn by a power cut is
+ * simply ignored when the ring is rescanned at boot. The last delivered
+ * sequence is kept in a small ack file; records are drained oldest-first
+ * after reconnect. Flash writes are capped per hour to limit wear.
+ * Sequence numbers (part of the uploaded document IDs) continue from the
+ * ack file when the ring file is lost, so they never restart at 1.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Hal.h"
+
+enum TelemetryRecordType : uint8_t {
+    TELEMETRY_EMPTY = 0,
+    TELEMETRY_READING,          // Periodic moisture reading
+    TELEMETRY_PUMP_ACTIVATED,   // detail = activation method code
+    TELEMETRY_FAULT_LOCKED,     // detail = no-effect count
+    TELEMETRY_FAULT_CLEARED
+};
+
+// Flag bits
+const uint8_t TELEMETRY_FLAG_LOCKED_FAULT = 0x01;
+
+struct __attribute__((packed)) TelemetryRecord {
+    uint32_t seq;           // Assigned by the queue, 0 = empty slot
+    uint32_t epoch;         // Unix time, 0 if NTP was never synced
+    uint32_t uptimeSec;
+    uint16_t moisture;
+    uint8_t type;           // TelemetryRecordType
+    uint8_t pumpState;
+    uint8_t flags;
+    uint8_t detail;
+    uint16_t crc;
+};
+
+class TelemetryQueue {
+public:
+    TelemetryQueue(FileStore& store, Clock& clock, const char* ringPath, const char* ackPath,
+                   uint16_t capacity, uint16_t maxWritesPerHour);
+
+    // Open or create the ring file and recover head/tail. Returns false without storage.
+    bool begin();
+
+    // Append a record. Readings are refused once most of the hourly write
+    // budget is used, so events always have room.
+    bool push(TelemetryRecord record);
+
+    // Copy up to maxRecords of the oldest undelivered records into out.
+    // lastSeq is set to the last sequence examined (pass it to ack()).
+    size_t peek(TelemetryRecord* out, size_t maxRecords, uint32_t& lastSeq);
+
+    // Mark everything up to and including seq as delivered
+    void ack(uint32_t seq);
+
+    // Give up on everything up to and including seq (the server refused it
+    // and would refuse it again); counted apart from delivered records
+    void reject(uint32_t seq);
+
+    size_t pending() const { return _headSeq - _tailSeq; }
+    uint16_t capacity() const { return _capacity; }
+
+    uint32_t storedCount() const { return _stored; }
+    uint32_t drainedCount() const { return _drained; }
+    uint32_t rejectedCount() const { return _rejected; }
+    uint32_t overwrittenCount() const { return _overwritten; }
+    uint32_t throttledCount() const { return _throttled; }
+
+private:
+    bool takeWriteBudget(bool isEvent);
+    uint32_t advanceTail(uint32_t seq);
+    bool readSlot(uint16_t slot, TelemetryRecord& record);
+    static bool isValid(const TelemetryRecord& record);
+
+    FileStore& _store;
+    Clock& _clock;
+    const char* _ringPath;
+    const char* _ackPath;
+    uint16_t _capacity;
+    uint16_t _maxWritesPerHour;
+    bool _ready = false;
+
+    uint32_t _headSeq = 0;          // Next sequence to assign is _headSeq + 1
+    uint32_t _tailSeq = 0;          // Last delivered (or overwritten) sequence
+
+    uint32_t _budgetWindowStart = 0;
+    uint16_t _writesThisWindow = 0;
+
+    uint32_t _stored = 0;
+    uint32_t _drained = 0;
+    uint32_t _rejected = 0;
+    uint32_t _overwritten = 0;
+    uint32_t _throttled = 0;
+};
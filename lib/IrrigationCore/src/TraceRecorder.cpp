@@ -0,0 +1,30 @@
+#include "TraceRecorder.h"
+
+static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of two");
+
+#ifdef TRACE_EVENTS
+TraceRecorder traceRecorder;
+#endif
+
+const char* TraceRecorder::traceName(TraceName name) {
+    switch (name) {
+        case TRACE_STAGE_WEB: return "web";
+        case TRACE_STAGE_SENSOR: return "sensor";
+        case TRACE_STAGE_BUTTON: return "button";
+        case TRACE_STAGE_LED: return "led";
+        case TRACE_STAGE_WIFI: return "wifi";
+        case TRACE_STAGE_SYNC: return "sync";
+        case TRACE_STAGE_REMOTE: return "remote";
+        case TRACE_STAGE_QUEUE: return "queue";
+        case TRACE_STAGE_DISPLAY: return "display";
+        case TRACE_STAGE_PUMP: return "pump";
+        case TRACE_LOOP: return "loop";
+        case TRACE_HTTPS_REQUEST: return "https";
+        case TRACE_FS_WRITE: return "fs_write";
+        case TRACE_PUMP_RUNNING: return "PUMP_RUNNING";
+        case TRACE_PUMP_WAITING: return "PUMP_WAITING";
+        case TRACE_BUTTON_ACTION: return "button_action";
+        case TRACE_FAULT_LOCKED: return "fault_locked";
+        default: return "unknown";
+    }
+}
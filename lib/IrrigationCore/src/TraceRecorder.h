@@ -0,0 +1,158 @@
+/*
+ * TraceRecorder - fixed RAM ring of timing events for post-mortem analysis
+ *
+ * Loop stages, HTTPS requests, flash writes and pump phases record
+ * begin/end events (8 bytes each, oldest overwritten). The ring is
+ * exported as Chrome Trace Event JSON, viewable in chrome://tracing or
+ * ui.perfetto.dev, with pump phases on their own track so overlaps with
+ * network calls are visible.
+ *
+ * Built only with -D TRACE_EVENTS; otherwise the TRACE_* macros compile
+ * to nothing. Record from loop context only, never from an ISR.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef TRACE_CAPACITY
+#define TRACE_CAPACITY 256          // Events kept (power of two)
+#endif
+
+enum TraceName : uint8_t {
+    TRACE_NONE,
+    // Loop stages (names match LoopStage so LOOP_STAGE() can trace them)
+    TRACE_STAGE_WEB,
+    TRACE_STAGE_SENSOR,
+    TRACE_STAGE_BUTTON,
+    TRACE_STAGE_LED,
+    TRACE_STAGE_WIFI,
+    TRACE_STAGE_SYNC,
+    TRACE_STAGE_REMOTE,
+    TRACE_STAGE_QUEUE,
+    TRACE_STAGE_DISPLAY,
+    TRACE_STAGE_PUMP,
+    TRACE_LOOP,
+    // I/O
+    TRACE_HTTPS_REQUEST,            // End arg: HTTP status (0 on transport error)
+    TRACE_FS_WRITE,                 // End arg: bytes written, if known
+    // Pump phases (own track)
+    TRACE_PUMP_RUNNING,             // Begin arg: ActivationMethod
+    TRACE_PUMP_WAITING,
+    // Instants
+    TRACE_BUTTON_ACTION,            // Arg: ButtonAction
+    TRACE_FAULT_LOCKED,
+    TRACE_NAME_COUNT
+};
+
+struct TraceEvent {
+    uint32_t timestampUs;
+    uint8_t name;                   // TraceName
+    char phase;                     // 'B', 'E' or 'i'
+    uint16_t arg;
+};
+
+class TraceRecorder {
+public:
+    void record(TraceName name, char phase, uint32_t timestampUs, uint16_t arg = 0) {
+        TraceEvent& event = _events[_next++ & (TRACE_CAPACITY - 1)];
+        event.timestampUs = timestampUs;
+        event.name = name;
+        event.phase = phase;
+        event.arg = arg;
+    }
+
+    // Close the current pump phase (if any) and open the next one
+    void switchPhase(TraceName next, uint32_t timestampUs, uint16_t arg = 0) {
+        if (_openPhase != TRACE_NONE) record(_openPhase, 'E', timestampUs);
+        if (next != TRACE_NONE) record(next, 'B', timestampUs, arg);
+        _openPhase = next;
+    }
+
+    uint32_t recordedCount() const { return _next; }
+    uint32_t droppedCount() const { return _next > TRACE_CAPACITY ? _next - TRACE_CAPACITY : 0; }
+
+    // Stream the ring, oldest first, as a Chrome Trace Event JSON object.
+    // sink(const char*) is called once per small chunk.
+    template <typename Sink>
+    void writeChromeJson(Sink sink) const {
+        char line[128];
+        sink("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+             "{\"ph\":\"M\",\"pid\":1,\"tid\":1,\"name\":\"thread_name\",\"args\":{\"name\":\"loop\"}},\n"
+             "{\"ph\":\"M\",\"pid\":1,\"tid\":2,\"name\":\"thread_name\",\"args\":{\"name\":\"pump\"}}");
+
+        uint32_t count = _next < TRACE_CAPACITY ? _next : TRACE_CAPACITY;
+        uint32_t first = _next - count;
+        uint64_t wraps = 0;
+        uint32_t previous = 0;
+        for (uint32_t i = first; i != _next; i++) {
+            const TraceEvent& event = _events[i & (TRACE_CAPACITY - 1)];
+            // micros() wraps every ~71 minutes; keep the timeline monotonic
+            if (i != first && event.timestampUs < previous) wraps += 1ULL << 32;
+            previous = event.timestampUs;
+
+            int length = snprintf(line, sizeof(line),
+                                  ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"name\":\"%s\"",
+                                  event.phase, event.name >= TRACE_PUMP_RUNNING &&
+                                  event.name <= TRACE_PUMP_WAITING ? 2 : 1,
+                                  (unsigned long long)(wraps + event.timestampUs),
+                                  traceName((TraceName)event.name));
+            if (event.phase == 'i') {
+                length += snprintf(line + length, sizeof(line) - length, ",\"s\":\"t\"");
+            }
+            if (event.arg != 0) {
+                snprintf(line + length, sizeof(line) - length, ",\"args\":{\"value\":%u}}", event.arg);
+            } else {
+                snprintf(line + length, sizeof(line) - length, "}");
+            }
+            sink(line);
+        }
+        sink("\n]}\n");
+    }
+
+    static const char* traceName(TraceName name);
+
+private:
+    TraceEvent _events[TRACE_CAPACITY];
+    uint32_t _next = 0;
+    TraceName _openPhase = TRACE_NONE;
+};
+
+#ifdef TRACE_EVENTS
+
+#include <Arduino.h>
+
+extern TraceRecorder traceRecorder;
+
+// Records begin on construction and end on destruction
+class TraceScope {
+public:
+    explicit TraceScope(TraceName name) : _name(name) {
+        traceRecorder.record(name, 'B', micros());
+    }
+    ~TraceScope() { traceRecorder.record(_name, 'E', micros(), _arg); }
+    void setResult(uint16_t arg) { _arg = arg; }
+
+private:
+    TraceName _name;
+    uint16_t _arg = 0;
+};
+
+#define TRACE_SCOPE(name) TraceScope _traceScope(name)
+#define TRACE_SCOPE_RESULT(value) _traceScope.setResult(value)
+#define TRACE_BEGIN(name) traceRecorder.record(name, 'B', micros())
+#define TRACE_END(name) traceRecorder.record(name, 'E', micros())
+#define TRACE_INSTANT(name, arg) traceRecorder.record(name, 'i', micros(), arg)
+#define TRACE_PHASE(name, arg) traceRecorder.switchPhase(name, micros(), arg)
+
+#else
+
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_SCOPE_RESULT(value) do {} while (0)
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name) do {} while (0)
+#define TRACE_INSTANT(name, arg) do {} while (0)
+#define TRACE_PHASE(name, arg) do {} while (0)
+
+#endif  // TRACE_EVENTS
@@ -0,0 +1,310 @@
+#include "ZoneController.h"
+
+ZoneController::ZoneController(Clock& clock, Gpio& relays, Zone* zones, uint8_t count,
+                               const ZoneSchedule& schedule)
+    : _clock(clock), _relays(relays), _zones(zones),
+      _count(count > MAX_ZONES ? MAX_ZONES : count), _schedule(schedule) {}
+
+void ZoneController::begin() {
+    for (uint8_t i = 0; i < _count; i++) {
+        _relays.setOutput(_zones[i].relay);
+        _relays.write(_zones[i].relay, false);
+    }
+}
+
+void ZoneController::update() {
+    uint32_t currentTime = _clock.millis();
+    uint8_t running = _reservedSlots;
+    uint32_t newlyQueued = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        Zone& zone = _zones[i];
+        const PumpConfig& config = *zone.config;
+        bool locked = CoreFeatures::faultLock && zone.persistent.lockedFault;
+        if (CoreFeatures::adaptiveDosing && config.adaptiveDosing) trackDose(zone, currentTime);
+
+        switch (zone.state) {
+            case MONITORING:
+                if (zone.queuedMethod == ACTIVATION_AUTO &&
+                    (config.pumpUntilWet ? zone.moisture <= config.wetThreshold
+                                         : zone.moisture < config.dryThreshold)) {
+                    // Wet again before its turn came
+                    zone.queuedMethod = ACTIVATION_NONE;
+                } else if (zone.queuedMethod == ACTIVATION_NONE && !locked &&
+                           zone.moisture >= config.dryThreshold && zone.dose.episodeMs == 0 &&
+                           checkSafety(i)) {
+                    // Only auto-water if not in fault state
+                    zone.queuedMethod = ACTIVATION_AUTO;
+                    zone.phaseSinceMs = currentTime;
+                    newlyQueued |= 1UL << i;
+                }
+                break;
+
+            case PUMP_RUNNING:
+                if (currentTime - zone.phaseSinceMs >= zone.dose.pulseMs) {
+                    stopPump(i, currentTime);
+                } else {
+                    running++;
+                }
+                break;
+
+            case PUMP_WAITING:
+                // After settle time, check pump effectiveness (automatic cycles only)
+                if (CoreFeatures::effectivenessCheck && currentTime - zone.phaseSinceMs >= config.settleMs &&
+                    zone.lastMethod == ACTIVATION_AUTO && zone.moistureBeforePump > 0) {
+                    checkEffectiveness(i);
+                    zone.moistureBeforePump = 0;  // Clear for next cycle
+                }
+
+                // Return to monitoring after full wait period
+                if (currentTime - zone.phaseSinceMs >= config.minIntervalSec * 1000) {
+                    zone.state = MONITORING;
+                    if (CoreFeatures::logging && _listener) _listener->onMonitoringResumed(i);
+
+                    // Still short of wet after an automatic cycle: go again
+                    locked = CoreFeatures::faultLock && zone.persistent.lockedFault;
+                    if (config.pumpUntilWet && zone.lastMethod == ACTIVATION_AUTO && !locked &&
+                        zone.moisture > config.wetThreshold && zone.dose.episodeMs == 0) {
+                        zone.queuedMethod = ACTIVATION_AUTO;
+                        zone.phaseSinceMs = currentTime;
+                        newlyQueued |= 1UL << i;
+                    }
+                }
+                break;
+        }
+    }
+
+    startQueued(running, currentTime);
+
+    // Zones that became due this pass but found no free slot
+    for (uint8_t i = 0; newlyQueued && i < _count; i++) {
+        if ((newlyQueued & (1UL << i)) && _zones[i].queuedMethod != ACTIVATION_NONE) {
+            _deferred++;
+            if (CoreFeatures::logging && _listener) _listener->onPumpDeferred(i);
+        }
+    }
+}
+
+void ZoneController::stopPump(uint8_t index, uint32_t now) {
+    Zone& zone = _zones[index];
+    _relays.write(zone.relay, false);
+    zone.state = PUMP_WAITING;
+    zone.phaseSinceMs = now;
+    if (CoreFeatures::persistence) zone.persistent.lastPumpEndEpoch = _clock.epoch();
+    if (_listener) {
+        if (CoreFeatures::persistence) _listener->onPersistentStateChanged(index);
+        if (CoreFeatures::logging) _listener->onPumpStopped(index);
+    }
+}
+
+// Longest-queued zone first (lowest index on a tie), one start per
+// startSpacingMs
+void ZoneController::startQueued(uint8_t running, uint32_t now) {
+    uint8_t limit = _schedule.maxConcurrentPumps ? _schedule.maxConcurrentPumps : 1;
+    while (running < limit) {
+        if (_started && now - _lastStartMs < _schedule.startSpacingMs) return;
+
+        int16_t next = -1;
+        for (uint8_t i = 0; i < _count; i++) {
+            const Zone& zone = _zones[i];
+            if (zone.queuedMethod == ACTIVATION_NONE || zone.state != MONITORING) continue;
+            if (next < 0 || (int32_t)(zone.phaseSinceMs - _zones[next].phaseSinceMs) < 0) next = i;
+        }
+        if (next < 0) return;
+
+        activate(next, _zones[next].queuedMethod, _zones[next].moisture);
+        running++;
+    }
+}
+
+bool ZoneController::checkSafety(uint8_t zone) {
+    return safetyWaitSec(zone) == 0;
+}
+
+uint32_t ZoneController::safetyWaitSec(uint8_t index) {
+    const Zone& zone = _zones[index];
+    // No cycle on record (or no wall clock): only the wait in PUMP_WAITING applies
+    if (zone.persistent.lastPumpEndEpoch == 0) return 0;
+    uint32_t timeSinceLastPump = _clock.epoch() - zone.persistent.lastPumpEndEpoch;
+    if (timeSinceLastPump >= zone.config->minIntervalSec) return 0;
+    return zone.config->minIntervalSec - timeSinceLastPump;
+}
+
+void ZoneController::activate(uint8_t index, ActivationMethod method, uint16_t moisture) {
+    Zone& zone = _zones[index];
+    zone.moistureBeforePump = moisture;
+    zone.lastMethod = method;
+    zone.queuedMethod = ACTIVATION_NONE;
+    zone.dose.pulseMs = dosePulseMs(zone, method, moisture);
+
+    _relays.write(zone.relay, true);
+    zone.state = PUMP_RUNNING;
+    zone.phaseSinceMs = _clock.millis();
+    _lastStartMs = zone.phaseSinceMs;
+    _started = true;
+
+    uint8_t running = _reservedSlots + runningCount();
+    if (running > _maxRunning) _maxRunning = running;
+
+    if (CoreFeatures::logging && _listener) _listener->onPumpStarted(index, method, moisture);
+}
+
+ZonePhase ZoneController::phase(uint8_t index) const {
+    const Zone& zone = _zones[index];
+    ZonePhase phase;
+    phase.state = zone.state;
+    phase.sinceMs = zone.phaseSinceMs;
+    phase.moistureBeforePump = zone.moistureBeforePump;
+    phase.lastMethod = zone.lastMethod;
+    return phase;
+}
+
+void ZoneController::restorePhase(uint8_t index, const ZonePhase& phase) {
+    Zone& zone = _zones[index];
+    zone.state = phase.state;
+    zone.phaseSinceMs = phase.sinceMs;
+    zone.moistureBeforePump = phase.moistureBeforePump;
+    zone.lastMethod = phase.lastMethod;
+    zone.queuedMethod = ACTIVATION_NONE;
+    if (zone.state == PUMP_RUNNING) {
+        zone.state = PUMP_WAITING;
+        zone.phaseSinceMs = _clock.millis();
+    }
+}
+
+bool ZoneController::request(uint8_t index, ActivationMethod method) {
+    Zone& zone = _zones[index];
+    if (zone.state != MONITORING) return false;
+    // An explicit request takes over a queued automatic cycle and its place
+    if (zone.queuedMethod == ACTIVATION_NONE) zone.phaseSinceMs = _clock.millis();
+    zone.queuedMethod = method;
+    return true;
+}
+
+void ZoneController::checkEffectiveness(uint8_t index) {
+    Zone& zone = _zones[index];
+    PumpPersistentState& persistent = zone.persistent;
+
+    // Capacitive sensor: higher = dry, lower = wet, so an effective cycle
+    // lowers the reading by at least REQUIRED_DROP
+    EffectivenessResult result;
+    result.moistureBefore = zone.moistureBeforePump;
+    result.moistureAfter = zone.moisture;
+    result.effective = (int32_t)zone.moistureBeforePump - zone.moisture >= REQUIRED_DROP;
+    result.previousNoEffectCount = persistent.noEffectCounter;
+    result.faultLocked = false;
+
+    if (result.effective) {
+        persistent.noEffectCounter = 0;
+    } else {
+        persistent.noEffectCounter++;
+        if (CoreFeatures::faultLock && persistent.noEffectCounter >= zone.config->maxNoEffectRepeats) {
+            persistent.lockedFault = true;
+            result.faultLocked = true;
+        }
+    }
+    result.noEffectCount = persistent.noEffectCounter;
+
+    if (!_listener) return;
+    // A repeated no-effect below the limit is not saved, as before
+    if (CoreFeatures::persistence && (result.effective || result.faultLocked)) {
+        _listener->onPersistentStateChanged(index);
+    }
+    if (!CoreFeatures::logging) return;
+    _listener->onEffectivenessChecked(index, result);
+    if (result.faultLocked) _listener->onFaultLocked(index, zone.config->maxNoEffectRepeats);
+}
+
+bool ZoneController::clearFault(uint8_t index) {
+    PumpPersistentState& persistent = _zones[index].persistent;
+    if (!persistent.lockedFault) return false;
+    persistent.lockedFault = false;
+    persistent.noEffectCounter = 0;
+    if (CoreFeatures::persistence && _listener) _listener->onPersistentStateChanged(index);
+    return true;
+}
+
+// Adaptive dosing
+
+uint16_t ZoneController::doseTarget(const PumpConfig& config) {
+    if (config.dryThreshold <= config.wetThreshold) return config.wetThreshold;
+    return config.wetThreshold + (config.dryThreshold - config.wetThreshold) / 4;
+}
+
+// Follow the trough of an open episode. Once the soil dries back from it
+// by REQUIRED_DROP, or it has not moved for three settle times, the dose
+// has soaked in and what it achieved updates the gain and the integral.
+void ZoneController::trackDose(Zone& zone, uint32_t now) {
+    DoseState& dose = zone.dose;
+    if (dose.episodeMs == 0 || zone.state == PUMP_RUNNING) return;
+
+    if (zone.moisture < dose.trough) {
+        dose.trough = zone.moisture;
+        dose.troughMs = now;
+    }
+    if (zone.state != MONITORING) return;
+    if (zone.moisture < dose.trough + REQUIRED_DROP && now - dose.troughMs < 3 * zone.config->settleMs) return;
+
+    const PumpConfig& config = *zone.config;
+    if (dose.before > dose.trough) {
+        float observed = (dose.before - dose.trough) * 1000.0f / dose.episodeMs;
+        dose.gainPerSec = dose.gainPerSec > 0 ? dose.gainPerSec + (observed - dose.gainPerSec) / 4 : observed;
+    }
+    if (!dose.clamped) {
+        // Positive when the dose fell short of the target
+        int32_t limit = (config.dryThreshold - config.wetThreshold) / 2;
+        int32_t correction = dose.correction + ((int32_t)dose.trough - doseTarget(config)) / 2;
+        dose.correction = (int16_t)(correction > limit ? limit : correction < -limit ? -limit : correction);
+    }
+    dose.episodeMs = 0;
+}
+
+uint32_t ZoneController::dosePulseMs(Zone& zone, ActivationMethod method, uint16_t moisture) {
+    const PumpConfig& config = *zone.config;
+    DoseState& dose = zone.dose;
+    bool adaptive = CoreFeatures::adaptiveDosing && config.adaptiveDosing;
+    uint32_t pulseMs = config.pumpRunTimeMs;
+    dose.clamped = true;  // Integrator frozen unless the loop chose the pulse
+
+    // Manual cycles and the first automatic one (nothing learned yet) use
+    // the fixed pulse; it doubles as the probe the gain is learned from
+    if (adaptive && method == ACTIVATION_AUTO && dose.gainPerSec > 0) {
+        float error = (float)moisture - doseTarget(config) + dose.correction;
+        float wanted = error > 0 ? error / dose.gainPerSec * 1000.0f : 0;
+        if (wanted <= config.minPulseMs) {
+            pulseMs = config.minPulseMs;
+        } else if (wanted >= config.maxPulseMs) {
+            pulseMs = config.maxPulseMs;
+        } else {
+            pulseMs = (uint32_t)wanted;
+            dose.clamped = false;
+        }
+    }
+
+    if (!adaptive) return pulseMs;
+
+    // A pulse before the last one soaked in extends its episode
+    if (dose.episodeMs == 0) {
+        dose.before = moisture;
+        dose.trough = dose.before;
+    }
+    dose.troughMs = _clock.millis() + pulseMs;
+    dose.episodeMs += pulseMs;
+    return pulseMs;
+}
+
+uint8_t ZoneController::runningCount() const {
+    uint8_t running = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_zones[i].state == PUMP_RUNNING) running++;
+    }
+    return running;
+}
+
+uint8_t ZoneController::queuedCount() const {
+    uint8_t queued = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_zones[i].queuedMethod != ACTIVATION_NONE) queued++;
+    }
+    return queued;
+}
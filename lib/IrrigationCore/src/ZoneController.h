@@ -0,0 +1,201 @@
+/*
+ * ZoneController - pump state machine, safety interval and fault lockout
+ * for an array of irrigation zones, with a cap on concurrent pumps
+ *
+ * Every zone runs the same cycle (MONITORING -> PUMP_RUNNING ->
+ * PUMP_WAITING -> MONITORING) with its own thresholds, relay output and
+ * persistent state. A zone that is due joins the queue and starts once
+ * fewer than maxConcurrentPumps are running, longest-waiting first, so
+ * the power supply never sees more pumps than it can feed. Zones live in
+ * a caller-owned array of small structs: one update() walks contiguous
+ * memory and the controller keeps no per-zone storage of its own.
+ *
+ * Automatic cycles pump for pumpRunTimeMs, or with adaptiveDosing for a
+ * pulse sized to bring the reading from where it is to the target (a
+ * quarter of the band above wetThreshold). The response per pump second
+ * is learned from how far each dose lowered the reading once it had
+ * soaked in (the trough, once the soil dries back from it or it has held
+ * for three settle times), and an integral of the remaining error
+ * corrects a steady bias. No automatic dose starts while the last one is
+ * still soaking in. Pulses are clamped to minPulseMs..maxPulseMs; the
+ * integral stops while a pulse is clamped. With pumpUntilWet, an
+ * automatic cycle that leaves the reading above wetThreshold is followed
+ * by another once the wait is over, instead of waiting for dryThreshold.
+ *
+ * Effectiveness checks, fault locking, persistence, adaptive dosing and
+ * listener events can be compiled out (CoreFeatures.h).
+ */
+
+#pragma once
+
+#include "CoreFeatures.h"
+#include "Hal.h"
+#include "IrrigationTypes.h"
+
+// Watering parameters (can be updated via Firestore)
+struct PumpConfig {
+    uint16_t dryThreshold = 520;        // Moisture level to trigger watering
+    uint16_t wetThreshold = 420;        // Moisture level when soil is wet
+    uint32_t pumpRunTimeMs = 2000;      // 2 seconds pump runtime
+    uint32_t minIntervalSec = 30;       // Minimum seconds between pump activations
+    uint8_t maxNoEffectRepeats = 10;    // Consecutive failures that trigger a fault
+    uint32_t settleMs = 20000;          // Wait after pump before re-reading the sensor
+    bool adaptiveDosing = false;        // Size automatic pulses from the error (else pumpRunTimeMs)
+    uint32_t minPulseMs = 500;          // Adaptive pulse bounds
+    uint32_t maxPulseMs = 15000;
+    bool pumpUntilWet = false;          // Repeat automatic cycles until at or below wetThreshold
+};
+
+// State that survives reboots
+struct PumpPersistentState {
+    uint32_t lastPumpEndEpoch = 0;      // Epoch seconds of last pump stop
+    bool lockedFault = false;
+    uint8_t noEffectCounter = 0;
+};
+
+struct EffectivenessResult {
+    uint16_t moistureBefore;
+    uint16_t moistureAfter;
+    bool effective;
+    uint8_t previousNoEffectCount;
+    uint8_t noEffectCount;
+    bool faultLocked;                   // This check tripped the fault
+};
+
+// Adaptive dosing bookkeeping; a dose episode is the pulses pumped until
+// the reading has settled at its trough
+struct DoseState {
+    float gainPerSec = 0;               // Learned drop per pump second (0: not yet known)
+    uint32_t pulseMs = 0;               // Current or last pulse
+    uint32_t episodeMs = 0;             // Pumped since the episode began (0: none open)
+    uint32_t troughMs = 0;              // When the trough last moved
+    uint16_t before = 0;                // Reading when the episode began
+    uint16_t trough = 0;                // Lowest reading since
+    int16_t correction = 0;             // Integral of the error left after past episodes
+    bool clamped = false;               // Pulse fixed or at a bound: integral frozen (anti-windup)
+};
+
+// One zone: 48 bytes on the ESP8266, fields used on every pass first
+struct Zone {
+    uint32_t phaseSinceMs = 0;          // Pump start (RUNNING), stop (WAITING) or queued (MONITORING)
+    uint16_t moisture = 0;              // Latest reading (ZoneController::setMoisture)
+    uint16_t moistureBeforePump = 0;
+    PumpState state = MONITORING;
+    ActivationMethod lastMethod = ACTIVATION_NONE;
+    ActivationMethod queuedMethod = ACTIVATION_NONE;  // Waiting for a pump slot
+    uint8_t relay = 0;                  // Output on the relay Gpio
+
+    // Only used on transitions
+    const PumpConfig* config = nullptr; // May be shared between zones
+    PumpPersistentState persistent;
+    DoseState dose;
+};
+
+// Where a zone is in its cycle, for a controller rebuilt on every wake of a
+// deep-sleep build (sinceMs is on the same clock the controller runs on)
+struct ZonePhase {
+    PumpState state = MONITORING;
+    uint32_t sinceMs = 0;
+    uint16_t moistureBeforePump = 0;
+    ActivationMethod lastMethod = ACTIVATION_NONE;
+};
+
+struct ZoneSchedule {
+    uint8_t maxConcurrentPumps = 1;     // Pumps the supply can run at once (at least 1)
+    uint32_t startSpacingMs = 0;        // Gap between two starts, spreads inrush current
+};
+
+class ZoneListener {
+public:
+    virtual ~ZoneListener() {}
+    virtual void onPumpStarted(uint8_t zone, ActivationMethod method, uint16_t moistureBefore) {}
+    virtual void onPumpStopped(uint8_t zone) {}
+    virtual void onMonitoringResumed(uint8_t zone) {}
+    virtual void onEffectivenessChecked(uint8_t zone, const EffectivenessResult& result) {}
+    virtual void onFaultLocked(uint8_t zone, uint8_t attempts) {}
+    // Persistent state of zone changed and should be saved
+    virtual void onPersistentStateChanged(uint8_t zone) {}
+    // Zone became due but every pump slot was taken; it stays queued
+    virtual void onPumpDeferred(uint8_t zone) {}
+};
+
+class ZoneController {
+public:
+    // Moisture must drop by at least this much for a cycle to count as effective
+    static const int16_t REQUIRED_DROP = 5;
+    static const uint8_t MAX_ZONES = 32;
+
+    // zones[i].config and .relay must be set; count is capped at MAX_ZONES
+    ZoneController(Clock& clock, Gpio& relays, Zone* zones, uint8_t count,
+                   const ZoneSchedule& schedule);
+
+    void setListener(ZoneListener* listener) { _listener = listener; }
+
+    // Configure every relay output and switch it off
+    void begin();
+
+    void setMoisture(uint8_t zone, uint16_t moisture) { _zones[zone].moisture = moisture; }
+
+    // Advance every zone with its latest reading, then start queued zones
+    // while pump slots are free
+    void update();
+
+    // Pump slots taken by pumps this controller does not drive (counted
+    // against maxConcurrentPumps from the next update())
+    void setReservedSlots(uint8_t slots) { _reservedSlots = slots; }
+
+    // True when the zone's minimum interval since its last cycle has passed
+    bool checkSafety(uint8_t zone);
+    // Seconds left before checkSafety() passes (0 if it already does)
+    uint32_t safetyWaitSec(uint8_t zone);
+
+    // Start a cycle now, without any checks and ignoring the pump cap
+    // (callers check lockedFault/checkSafety). The pulse is pumpRunTimeMs,
+    // or sized by adaptive dosing for an automatic cycle.
+    void activate(uint8_t zone, ActivationMethod method, uint16_t moisture);
+
+    // Queue a cycle that starts when a pump slot is free (callers check
+    // lockedFault/checkSafety). Returns false if the zone is pumping or
+    // settling.
+    bool request(uint8_t zone, ActivationMethod method);
+
+    // Unlock auto-watering of zone; returns false if there was no fault
+    bool clearFault(uint8_t zone);
+
+    uint8_t count() const { return _count; }
+    const Zone& zone(uint8_t zone) const { return _zones[zone]; }
+    void restore(uint8_t zone, const PumpPersistentState& state) { _zones[zone].persistent = state; }
+
+    ZonePhase phase(uint8_t zone) const;
+    // Resume zone from a saved phase (after begin()). The relay came up off,
+    // so a run the reset cut short counts as done and waits from now.
+    void restorePhase(uint8_t zone, const ZonePhase& phase);
+
+    uint8_t runningCount() const;
+    uint8_t queuedCount() const;
+    uint32_t deferredCount() const { return _deferred; }
+    // Target reading of adaptive dosing
+    static uint16_t doseTarget(const PumpConfig& config);
+    uint8_t maxRunningSeen() const { return _maxRunning; }
+
+private:
+    void stopPump(uint8_t zone, uint32_t now);
+    void startQueued(uint8_t running, uint32_t now);
+    void checkEffectiveness(uint8_t zone);
+    void trackDose(Zone& zone, uint32_t now);
+    uint32_t dosePulseMs(Zone& zone, ActivationMethod method, uint16_t moisture);
+
+    Clock& _clock;
+    Gpio& _relays;
+    Zone* _zones;
+    uint8_t _count;
+    const ZoneSchedule& _schedule;
+    ZoneListener* _listener = nullptr;
+
+    uint8_t _reservedSlots = 0;
+    bool _started = false;              // _lastStartMs is valid
+    uint32_t _lastStartMs = 0;
+
+    uint32_t _deferred = 0;
+    uint8_t _maxRunning = 0;
+};
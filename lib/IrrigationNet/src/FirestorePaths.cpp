@@ -0,0 +1,22 @@
+#include "FirestorePaths.h"
+#include <stdio.h>
+
+// snprintf into a fixed array, reporting truncation
+template <size_t N>
+static bool format(char (&out)[N], const char* pattern, const char* a, const char* b = "") {
+    int length = snprintf(out, N, pattern, a, b);
+    return length >= 0 && (size_t)length < N;
+}
+
+bool FirestorePaths::build(const char* projectId, const char* apiKey, const char* deviceId) {
+    bool ok = format(databaseName, "projects/%s/databases/(default)", projectId);
+    ok &= format(commitPath, "/v1/%s/documents:commit?key=%s", databaseName, apiKey);
+    ok &= format(batchGetPath, "/v1/%s/documents:batchGet?key=%s", databaseName, apiKey);
+    ok &= format(deviceDocument, "plantData/%s", deviceId);
+    ok &= format(logsCollection, "%s/logs", deviceDocument);
+    ok &= format(zonesCollection, "%s/zones", deviceDocument);
+    ok &= format(commandsDocument, "%s/commands/pending", deviceDocument);
+    ok &= format(configName, "%s/documents/%s/config/settings", databaseName, deviceDocument);
+    ok &= format(commandsName, "%s/documents/%s", databaseName, commandsDocument);
+    return ok;
+}
@@ -0,0 +1,30 @@
+/*
+ * FirestorePaths - every Firestore URL and document name the device uses,
+ * formatted once at boot into fixed buffers
+ *
+ * Requests used to concatenate project id, device id and API key into
+ * fresh Strings on each call.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+struct FirestorePaths {
+    // Returns false if any path was truncated (ids or key unexpectedly long)
+    bool build(const char* projectId, const char* apiKey, const char* deviceId);
+
+    char databaseName[80];          // projects/<p>/databases/(default)
+    char commitPath[176];           // /v1/<db>/documents:commit?key=<k>
+    char batchGetPath[176];         // /v1/<db>/documents:batchGet?key=<k>
+
+    // Relative to the database documents root (FirestoreBatch::add)
+    char deviceDocument[40];        // plantData/<id>
+    char logsCollection[48];        // plantData/<id>/logs
+    char zonesCollection[48];       // plantData/<id>/zones (multi-zone builds)
+    char commandsDocument[64];      // plantData/<id>/commands/pending
+
+    // Full resource names (batchGet requests and responses)
+    char configName[176];           // <db>/documents/plantData/<id>/config/settings
+    char commandsName[176];         // <db>/documents/plantData/<id>/commands/pending
+};
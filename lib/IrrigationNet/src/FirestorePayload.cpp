@@ -0,0 +1,97 @@
+#include "FirestorePayload.h"
+#include <stdio.h>
+
+void buildLogFields(JsonObject fields, const TelemetrySnapshot& snapshot) {
+    fields["moisture"]["integerValue"] = snapshot.moisture;
+    fields["pumpStatus"]["stringValue"] = pumpStateName(snapshot.pumpState);
+    fields["activationMethod"]["stringValue"] = activationMethodName(snapshot.activationMethod);
+    fields["deviceState"]["stringValue"] = deviceStateName(snapshot.deviceState);
+    fields["wifiRSSI"]["integerValue"] = snapshot.wifiRSSI;
+    fields["uptime"]["integerValue"] = snapshot.uptimeSec;
+    fields["lockedFault"]["booleanValue"] = snapshot.lockedFault;
+    fields["noEffectCount"]["integerValue"] = snapshot.noEffectCount;
+    fields["timestamp"]["integerValue"] = snapshot.epoch;
+}
+
+void buildStatusFields(JsonObject fields, const TelemetrySnapshot& snapshot) {
+    fields["currentMoisture"]["integerValue"] = snapshot.moisture;
+    fields["currentPumpStatus"]["stringValue"] = pumpStateName(snapshot.pumpState);
+    fields["lockedFault"]["booleanValue"] = snapshot.lockedFault;
+    fields["lastSeen"]["integerValue"] = snapshot.epoch;
+    fields["wifiRSSI"]["integerValue"] = snapshot.wifiRSSI;
+    fields["uptime"]["integerValue"] = snapshot.uptimeSec;
+    if (snapshot.dryingTrained) {
+        fields["dryRateMean"]["doubleValue"] = snapshot.dryRateMean;
+        fields["dryRateDailyCos"]["doubleValue"] = snapshot.dryRateDailyCos;
+        fields["dryRateDailySin"]["doubleValue"] = snapshot.dryRateDailySin;
+        fields["pumpResponse"]["doubleValue"] = snapshot.pumpResponse;
+        fields["predictedDry"]["integerValue"] = snapshot.predictedDryEpoch;
+    }
+    fields["lowPower"]["booleanValue"] = snapshot.lowPower;
+    fields["dutyCycle"]["doubleValue"] = snapshot.dutyCyclePct;
+    fields["radioOnSec"]["integerValue"] = snapshot.radioOnSec;
+}
+
+void buildZoneStatusFields(JsonObject fields, uint8_t zone, const ZoneTelemetry& telemetry) {
+    fields["zone"]["integerValue"] = zone;
+    fields["currentMoisture"]["integerValue"] = telemetry.moisture;
+    fields["currentPumpStatus"]["stringValue"] = pumpStateName(telemetry.pumpState);
+    fields["activationMethod"]["stringValue"] = activationMethodName(telemetry.activationMethod);
+    fields["lockedFault"]["booleanValue"] = telemetry.lockedFault;
+    fields["noEffectCount"]["integerValue"] = telemetry.noEffectCount;
+    fields["lastPumpEnd"]["integerValue"] = telemetry.lastPumpEndEpoch;
+    fields["lastSeen"]["integerValue"] = telemetry.epoch;
+}
+
+void buildEventFields(JsonObject fields, const char* eventType, const char* details) {
+    fields["eventType"]["stringValue"] = eventType;
+    // Non-const pointer so ArduinoJson copies it: details is usually a stack buffer
+    fields["details"]["stringValue"] = const_cast<char*>(details);
+}
+
+void buildStoredRecordFields(JsonObject fields, const TelemetryRecord& record) {
+    char details[48];
+    switch (record.type) {
+        case TELEMETRY_READING:
+            fields["moisture"]["integerValue"] = record.moisture;
+            fields["pumpStatus"]["stringValue"] = pumpStateName((PumpState)record.pumpState);
+            fields["lockedFault"]["booleanValue"] = (record.flags & TELEMETRY_FLAG_LOCKED_FAULT) != 0;
+            break;
+        case TELEMETRY_PUMP_ACTIVATED:
+            snprintf(details, sizeof(details), "method=%s,moisture=%u",
+                     activationMethodName((ActivationMethod)record.detail), record.moisture);
+            buildEventFields(fields, "pump_activated", details);
+            break;
+        case TELEMETRY_FAULT_LOCKED:
+            snprintf(details, sizeof(details), "Pump ineffective after %u attempts", record.detail);
+            buildEventFields(fields, "fault_locked", details);
+            break;
+        case TELEMETRY_FAULT_CLEARED:
+            buildEventFields(fields, "fault_cleared", "Cleared while offline");
+            break;
+    }
+    fields["timestamp"]["integerValue"] = record.epoch;
+    fields["uptime"]["integerValue"] = record.uptimeSec;
+    fields["storedOffline"]["booleanValue"] = true;
+}
+
+void storedRecordLogId(const TelemetryRecord& record, char* out, size_t outSize) {
+    snprintf(out, outSize, "q%lu_%lu", (unsigned long)record.seq,
+             (unsigned long)(record.epoch ? record.epoch : record.uptimeSec));
+}
+
+void flattenFields(JsonObject fields, JsonObject out) {
+    for (JsonPair field : fields) {
+        // Each typed value is a single-member object
+        for (JsonPair typed : field.value().as<JsonObject>()) {
+            out[field.key()] = typed.value();
+        }
+    }
+}
+
+JsonVariant fieldValue(JsonObject fields, const char* name) {
+    JsonVariant value = fields[name];
+    if (!value.is<JsonObject>()) return value;
+    for (JsonPair typed : value.as<JsonObject>()) return typed.value();
+    return JsonVariant();
+}
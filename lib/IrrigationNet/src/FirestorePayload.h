@@ -0,0 +1,78 @@
+/*
+ * FirestorePayload - Firestore REST field maps for logs, status and events
+ *
+ * Builders only fill a "fields" object (as returned by FirestoreBatch::add);
+ * document paths and transport stay with the caller. MQTT messages carry
+ * the same fields as plain JSON (flattenFields).
+ */
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include "IrrigationTypes.h"
+#include "TelemetryQueue.h"
+
+// Everything a periodic log or status heartbeat reports
+struct TelemetrySnapshot {
+    uint16_t moisture = 0;
+    PumpState pumpState = MONITORING;
+    DeviceState deviceState = AWAITING_CONFIG;
+    ActivationMethod activationMethod = ACTIVATION_NONE;
+    bool lockedFault = false;
+    uint8_t noEffectCount = 0;
+    int32_t wifiRSSI = 0;       // Signal strength
+    uint32_t uptimeSec = 0;
+    uint32_t epoch = 0;         // 0 if NTP has not synced
+
+    // Drying model (DryingModel)
+    bool dryingTrained = false;
+    float dryRateMean = 0;      // Counts per hour
+    float dryRateDailyCos = 0;  // Time-of-day terms of the rate
+    float dryRateDailySin = 0;
+    float pumpResponse = 0;     // Counts per pump second
+    uint32_t predictedDryEpoch = 0;  // 0 if no crossing is predicted
+
+    // Power (PowerManager estimates since boot)
+    bool lowPower = false;
+    float dutyCyclePct = 100;   // Time fully awake
+    uint32_t radioOnSec = 0;
+};
+
+// One zone of a multi-zone controller
+struct ZoneTelemetry {
+    uint16_t moisture = 0;
+    PumpState pumpState = MONITORING;
+    ActivationMethod activationMethod = ACTIVATION_NONE;
+    bool lockedFault = false;
+    uint8_t noEffectCount = 0;
+    uint32_t lastPumpEndEpoch = 0;
+    uint32_t epoch = 0;         // 0 if NTP has not synced
+};
+
+// plantData/{id}/logs/{logId}
+void buildLogFields(JsonObject fields, const TelemetrySnapshot& snapshot);
+
+// plantData/{id} heartbeat, written with merge; carries the drying model
+// parameters once it is trained, and the power estimates
+void buildStatusFields(JsonObject fields, const TelemetrySnapshot& snapshot);
+
+// plantData/{id}/zones/{zone}, written with merge; all zones go in one commit
+void buildZoneStatusFields(JsonObject fields, uint8_t zone, const ZoneTelemetry& telemetry);
+
+// plantData/{id}/logs/{logId} event entry
+void buildEventFields(JsonObject fields, const char* eventType, const char* details);
+
+// Log entry for a record stored while offline
+void buildStoredRecordFields(JsonObject fields, const TelemetryRecord& record);
+
+// Deterministic log ID for a stored record, so a re-send overwrites
+// instead of duplicating ("q<seq>_<epoch or uptime>")
+void storedRecordLogId(const TelemetryRecord& record, char* out, size_t outSize);
+
+// Plain copy of typed fields for MQTT: {"moisture":{"integerValue":512}}
+// becomes {"moisture":512}
+void flattenFields(JsonObject fields, JsonObject out);
+
+// A field's value from a Firestore document ({"integerValue":"520"}) or a
+// plain MQTT message (520); null if the field is absent
+JsonVariant fieldValue(JsonObject fields, const char* name);
@@ -0,0 +1,83 @@
+#include "JsonArena.h"
+#include <stdlib.h>
+#include <string.h>
+
+JsonArena::JsonArena(void* buffer, size_t size)
+    : _buffer((uint8_t*)buffer), _size(size & ~(size_t)7) {}
+
+bool JsonArena::owns(const void* pointer) const {
+    return pointer >= _buffer && pointer < _buffer + _size;
+}
+
+JsonArena::Header* JsonArena::headerOf(void* pointer) const {
+    return (Header*)((uint8_t*)pointer - align(sizeof(Header)));
+}
+
+void* JsonArena::allocate(size_t size) {
+    size_t needed = align(sizeof(Header)) + align(size);
+    if (needed > _size - _top) {
+        _fallbacks++;
+        return malloc(size);
+    }
+
+    Header* header = (Header*)(_buffer + _top);
+    header->size = size;
+    header->previous = _lastBlock;
+    _lastBlock = _top;
+    _top += needed;
+    _liveBlocks++;
+    if (_top > _highWater) _highWater = _top;
+    return (uint8_t*)header + align(sizeof(Header));
+}
+
+void JsonArena::deallocate(void* pointer) {
+    if (!pointer) return;
+    if (!owns(pointer)) {
+        free(pointer);
+        return;
+    }
+
+    if (--_liveBlocks == 0) {
+        _top = 0;
+        _lastBlock = SIZE_MAX;
+        return;
+    }
+
+    // Freeing the newest block gives its space back immediately. Space of
+    // blocks below it is only reclaimed when the arena empties.
+    size_t offset = (uint8_t*)headerOf(pointer) - _buffer;
+    if (offset == _lastBlock) {
+        _top = offset;
+        _lastBlock = headerOf(pointer)->previous;
+    }
+}
+
+void* JsonArena::reallocate(void* pointer, size_t size) {
+    if (!pointer) return allocate(size);
+
+    if (owns(pointer)) {
+        Header* header = headerOf(pointer);
+        size_t offset = (uint8_t*)header - _buffer;
+        size_t oldSize = header->size;
+
+        // Newest block: resize in place when it fits
+        if (offset == _lastBlock && align(sizeof(Header)) + align(size) <= _size - offset) {
+            header->size = size;
+            _top = offset + align(sizeof(Header)) + align(size);
+            if (_top > _highWater) _highWater = _top;
+            return pointer;
+        }
+        if (size <= oldSize) {
+            header->size = size;
+            return pointer;
+        }
+
+        void* moved = allocate(size);
+        if (!moved) return nullptr;
+        memcpy(moved, pointer, oldSize);
+        deallocate(pointer);
+        return moved;
+    }
+
+    return realloc(pointer, size);
+}
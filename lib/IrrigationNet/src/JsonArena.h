@@ -0,0 +1,61 @@
+/*
+ * JsonArena - ArduinoJson allocator backed by a fixed static buffer
+ *
+ * Bump allocation with a block count: the buffer rewinds to empty when the
+ * last block is released (JsonDocument::clear() or destruction), and the
+ * newest block can grow or shrink in place. Documents that overflow the
+ * buffer fall back to the heap, so a burst degrades to the old behaviour
+ * instead of failing. Keeping JSON out of the heap stops short-lived
+ * documents from fragmenting the space TLS needs.
+ *
+ * Give long-lived and transient documents separate arenas; a document
+ * that is never cleared keeps its arena from rewinding.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(void* buffer, size_t size);
+
+    void* allocate(size_t size) override;
+    void deallocate(void* pointer) override;
+    void* reallocate(void* pointer, size_t size) override;
+
+    size_t capacity() const { return _size; }
+    size_t used() const { return _top; }
+    size_t highWater() const { return _highWater; }
+    uint32_t heapFallbackCount() const { return _fallbacks; }
+
+private:
+    struct Header {
+        size_t size;
+        size_t previous;            // Offset of the block below (for rewinding)
+    };
+
+    static size_t align(size_t size) { return (size + 7) & ~(size_t)7; }
+    bool owns(const void* pointer) const;
+    Header* headerOf(void* pointer) const;
+
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _top = 0;                // First free byte
+    size_t _lastBlock = SIZE_MAX;   // Header offset of the newest block
+    size_t _liveBlocks = 0;
+    size_t _highWater = 0;
+    uint32_t _fallbacks = 0;
+};
+
+// Static storage for an arena, 8-byte aligned
+template <size_t N>
+class StaticJsonArena : public JsonArena {
+public:
+    StaticJsonArena() : JsonArena(_storage, N) {}
+
+private:
+    alignas(8) uint8_t _storage[N];
+};
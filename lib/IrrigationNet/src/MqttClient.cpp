@@ -0,0 +1,298 @@
+#include "MqttClient.h"
+#include <string.h>
+
+// Packet types (upper nibble of the fixed header)
+static const uint8_t MQTT_CONNECT = 0x10;
+static const uint8_t MQTT_CONNACK = 0x20;
+static const uint8_t MQTT_PUBLISH = 0x30;
+static const uint8_t MQTT_PUBACK = 0x40;
+static const uint8_t MQTT_SUBSCRIBE = 0x82;   // Reserved bits 0010
+static const uint8_t MQTT_SUBACK = 0x90;
+static const uint8_t MQTT_PINGREQ = 0xC0;
+static const uint8_t MQTT_PINGRESP = 0xD0;
+static const uint8_t MQTT_DISCONNECT = 0xE0;
+
+bool MqttClient::connect(const char* host, uint16_t port, const MqttOptions& options) {
+    _stream.stop();
+    _state = DISCONNECTED;
+    _connectResult = 0xFF;
+    resetReceive();
+    _pingOutstanding = false;
+    _unacknowledged = 0;  // Not resent on the new connection
+    if (!_stream.connect(host, port)) return false;
+
+    size_t willTopicLength = options.willTopic ? strlen(options.willTopic) : 0;
+    size_t willPayloadLength = options.willPayload ? strlen(options.willPayload) : 0;
+    size_t remaining = 10 + 2 + strlen(options.clientId);
+    uint8_t flags = options.cleanSession ? 0x02 : 0;
+    if (options.willTopic) {
+        flags |= 0x04 | 0x20;  // Will, retained, QoS 0
+        remaining += 2 + willTopicLength + 2 + willPayloadLength;
+    }
+    if (options.username) {
+        flags |= 0x80;
+        remaining += 2 + strlen(options.username);
+    }
+    if (options.username && options.password) {
+        flags |= 0x40;
+        remaining += 2 + strlen(options.password);
+    }
+
+    bool built = begin(MQTT_CONNECT, remaining) && putString("MQTT") && putByte(4) &&
+                 putByte(flags) && putUint16(options.keepAliveSec) && putString(options.clientId);
+    if (built && options.willTopic) {
+        built = putString(options.willTopic, willTopicLength) &&
+                putString(options.willPayload ? options.willPayload : "", willPayloadLength);
+    }
+    if (built && options.username) built = putString(options.username);
+    if (built && options.username && options.password) built = putString(options.password);
+    if (!built || !send()) {
+        _stream.stop();
+        return false;
+    }
+
+    _keepAliveSec = options.keepAliveSec;
+    _connectStartMs = _clock.millis();
+    _state = CONNECTING;
+    return true;
+}
+
+bool MqttClient::subscribe(const char* topic, uint8_t qos) {
+    if (_state != CONNECTED) return false;
+    size_t topicLength = strlen(topic);
+    return begin(MQTT_SUBSCRIBE, 2 + 2 + topicLength + 1) && putUint16(nextPacketId()) &&
+           putString(topic, topicLength) && putByte(qos > 1 ? 1 : qos) && send();
+}
+
+bool MqttClient::publish(const char* topic, const char* payload, size_t length, bool retain,
+                         uint8_t qos) {
+    if (_state != CONNECTED) return false;
+    size_t topicLength = strlen(topic);
+    uint8_t header = MQTT_PUBLISH | (qos ? 0x02 : 0) | (retain ? 0x01 : 0);
+    if (!begin(header, 2 + topicLength + (qos ? 2 : 0) + length) || !putString(topic, topicLength) ||
+        (qos && !putUint16(nextPacketId())) || _txLength + length > BUFFER_SIZE) {
+        return false;
+    }
+    memcpy(_tx + _txLength, payload, length);
+    _txLength += length;
+    if (!send()) return false;
+    _published++;
+    if (qos) _unacknowledged++;
+    return true;
+}
+
+uint16_t MqttClient::nextPacketId() {
+    uint16_t packetId = _nextPacketId++;
+    if (_nextPacketId == 0) _nextPacketId = 1;
+    return packetId;
+}
+
+bool MqttClient::loop() {
+    if (_state == DISCONNECTED) return false;
+    if (!_stream.connected()) {
+        drop();
+        return false;
+    }
+
+    // A few packets per call, so a burst cannot starve the rest of the loop
+    for (uint8_t packets = 0; packets < 8 && receive(); packets++) {
+        handlePacket();
+        if (_state == DISCONNECTED) return false;
+    }
+
+    uint32_t now = _clock.millis();
+    if (_state == CONNECTING) {
+        if (now - _connectStartMs >= CONNACK_TIMEOUT_MS) drop();
+    } else if (_keepAliveSec > 0) {
+        uint32_t keepAliveMs = _keepAliveSec * 1000UL;
+        if (_pingOutstanding && now - _pingSentMs >= keepAliveMs) {
+            drop();  // Broker or path gone without a TCP reset
+        } else if (!_pingOutstanding && now - _lastSendMs >= keepAliveMs) {
+            if (begin(MQTT_PINGREQ, 0) && send()) {
+                _pingOutstanding = true;
+                _pingSentMs = now;
+            }
+        }
+    }
+    return _state != DISCONNECTED;
+}
+
+void MqttClient::disconnect() {
+    if (_state != DISCONNECTED && begin(MQTT_DISCONNECT, 0)) send();
+    _stream.stop();
+    _state = DISCONNECTED;
+}
+
+void MqttClient::drop() {
+    _stream.stop();
+    _state = DISCONNECTED;
+}
+
+// Outgoing packets
+
+bool MqttClient::begin(uint8_t header, size_t remaining) {
+    _txLength = 0;
+    if (remaining + 5 > BUFFER_SIZE) return false;
+    _tx[_txLength++] = header;
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        _tx[_txLength++] = remaining ? digit | 0x80 : digit;
+    } while (remaining);
+    return true;
+}
+
+bool MqttClient::putByte(uint8_t value) {
+    if (_txLength >= BUFFER_SIZE) return false;
+    _tx[_txLength++] = value;
+    return true;
+}
+
+bool MqttClient::putUint16(uint16_t value) {
+    return putByte(value >> 8) && putByte(value & 0xFF);
+}
+
+bool MqttClient::putString(const char* text, size_t length) {
+    if (length > 0xFFFF || _txLength + 2 + length > BUFFER_SIZE) return false;
+    putUint16(length);
+    memcpy(_tx + _txLength, text, length);
+    _txLength += length;
+    return true;
+}
+
+bool MqttClient::putString(const char* text) {
+    return putString(text, strlen(text));
+}
+
+bool MqttClient::send() {
+    if (_stream.write(_tx, _txLength) != _txLength) {
+        drop();
+        return false;
+    }
+    _lastSendMs = _clock.millis();
+    return true;
+}
+
+// Incoming packets
+
+bool MqttClient::receive() {
+    while (_stream.available() > 0) {
+        if (!_rxLengthDone) {
+            uint8_t byte;
+            if (_stream.read(&byte, 1) != 1) return false;
+            if (_rxHeader == 0) {  // Every packet type is non-zero
+                _rxHeader = byte;
+                continue;
+            }
+            _rxRemaining |= (uint32_t)(byte & 0x7F) << (7 * _rxLengthBytes);
+            _rxLengthBytes++;
+            if (byte & 0x80) {
+                if (_rxLengthBytes >= 4) {  // Malformed length
+                    drop();
+                    return false;
+                }
+                continue;
+            }
+            _rxLengthDone = true;
+        }
+
+        if (_rxRead < _rxRemaining) {
+            uint8_t scratch[64];
+            uint32_t wanted = _rxRemaining - _rxRead;
+            uint8_t* target;
+            if (_rxRead < BUFFER_SIZE - 1) {
+                target = _rx + _rxRead;
+                if (wanted > BUFFER_SIZE - 1 - _rxRead) wanted = BUFFER_SIZE - 1 - _rxRead;
+            } else {
+                target = scratch;  // Past what we keep: read and discard
+                if (wanted > sizeof(scratch)) wanted = sizeof(scratch);
+            }
+            size_t got = _stream.read(target, wanted);
+            if (got == 0) return false;
+            _rxRead += got;
+        }
+        if (_rxRead >= _rxRemaining) return true;
+    }
+    return _rxLengthDone && _rxRead >= _rxRemaining;
+}
+
+void MqttClient::handlePacket() {
+    uint8_t type = _rxHeader & 0xF0;
+    size_t length = _rxRemaining < BUFFER_SIZE - 1 ? _rxRemaining : BUFFER_SIZE - 1;
+
+    switch (type) {
+        case MQTT_CONNACK:
+            if (_state == CONNECTING && length >= 2) {
+                _connectResult = _rx[1];
+                if (_connectResult == 0) {
+                    _state = CONNECTED;
+                    _lastSendMs = _clock.millis();
+                    if (_handler) _handler->onConnected(_rx[0] & 0x01);
+                } else {
+                    drop();
+                }
+            }
+            break;
+        case MQTT_PUBLISH:
+            if (_state == CONNECTED) handlePublish();
+            break;
+        case MQTT_SUBACK:
+            for (size_t i = 2; i < length; i++) {
+                if (_rx[i] == 0x80) _subscribeFailures++;
+            }
+            break;
+        case MQTT_PUBACK:
+            if (_unacknowledged > 0) _unacknowledged--;
+            break;
+        case MQTT_PINGRESP:
+            _pingOutstanding = false;
+            break;
+        default:
+            break;
+    }
+
+    resetReceive();
+}
+
+// Ready for the next fixed header
+void MqttClient::resetReceive() {
+    _rxHeader = 0;
+    _rxLengthBytes = 0;
+    _rxLengthDone = false;
+    _rxRemaining = 0;
+    _rxRead = 0;
+}
+
+void MqttClient::handlePublish() {
+    uint8_t qos = (_rxHeader >> 1) & 0x03;
+    bool duplicate = _rxHeader & 0x08;
+    size_t stored = _rxRemaining < BUFFER_SIZE - 1 ? _rxRemaining : BUFFER_SIZE - 1;
+    if (stored < 2) return;
+
+    size_t topicLength = (size_t)_rx[0] << 8 | _rx[1];
+    size_t offset = 2 + topicLength;
+    uint16_t packetId = 0;
+    if (qos > 0) {
+        if (offset + 2 > stored) return;
+        packetId = (uint16_t)_rx[offset] << 8 | _rx[offset + 1];
+        offset += 2;
+    }
+    if (offset > stored) return;
+
+    _received++;
+    if (_rxRemaining > BUFFER_SIZE - 1 || topicLength >= MAX_TOPIC) {
+        _dropped++;  // Truncated; acknowledged below so it is not redelivered forever
+    } else if (_handler) {
+        char topic[MAX_TOPIC];
+        memcpy(topic, _rx + 2, topicLength);
+        topic[topicLength] = '\0';
+        char* payload = (char*)_rx + offset;
+        size_t payloadLength = _rxRemaining - offset;
+        payload[payloadLength] = '\0';  // Spare byte at the end of _rx
+        _handler->onMessage(topic, payload, payloadLength, duplicate);
+    }
+
+    if (qos == 1 && _state == CONNECTED) {
+        if (begin(MQTT_PUBACK, 2) && putUint16(packetId) && send()) _acknowledged++;
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * MqttClient - MQTT 3.1.1 client over a ByteStream, fixed buffers only
+ *
+ * One persistent connection carries telemetry out and commands in. The
+ * broker keeps the session (clean session off), so QoS 1 messages sent
+ * while the device was offline arrive when it reconnects. An incoming
+ * QoS 1 message is acknowledged (PUBACK) after the handler returns, so a
+ * command counts as delivered only once it has been applied; a reset in
+ * between gets it redelivered (handlers skip ids they have seen).
+ * The device publishes at QoS 0 (every report supersedes the previous
+ * one); QoS 1 publishing is there for tools that send commands, and is
+ * not resent after a reconnect.
+ *
+ * Nothing blocks except the TCP connect inside connect(): CONNACK, SUBACK
+ * and PINGRESP are handled by loop().
+ */
+
+#pragma once
+
+#include "Hal.h"
+
+struct MqttOptions {
+    const char* clientId = "";
+    const char* username = nullptr;     // Optional
+    const char* password = nullptr;
+    uint16_t keepAliveSec = 30;
+    bool cleanSession = false;
+    const char* willTopic = nullptr;    // Published (retained) by the broker if the link dies
+    const char* willPayload = nullptr;
+};
+
+class MqttHandler {
+public:
+    virtual ~MqttHandler() {}
+    // CONNACK accepted; subscribe here (sessionPresent: the broker kept the old session)
+    virtual void onConnected(bool sessionPresent) {}
+    // payload is NUL-terminated; duplicate is the DUP flag of a redelivery
+    virtual void onMessage(const char* topic, char* payload, size_t length, bool duplicate) = 0;
+};
+
+class MqttClient {
+public:
+    static const size_t BUFFER_SIZE = 768;      // Largest packet either way
+    static const size_t MAX_TOPIC = 96;
+    static const uint32_t CONNACK_TIMEOUT_MS = 5000;
+
+    enum State { DISCONNECTED, CONNECTING, CONNECTED };
+
+    MqttClient(ByteStream& stream, Clock& clock) : _stream(stream), _clock(clock) {}
+
+    void setHandler(MqttHandler* handler) { _handler = handler; }
+
+    // Open the TCP connection and send CONNECT; false if either fails.
+    // The session is up once loop() has seen CONNACK (onConnected).
+    bool connect(const char* host, uint16_t port, const MqttOptions& options);
+
+    // Request delivery of topic (wildcards allowed) at qos 0 or 1
+    bool subscribe(const char* topic, uint8_t qos);
+
+    bool publish(const char* topic, const char* payload, size_t length, bool retain = false,
+                 uint8_t qos = 0);
+
+    // Read and dispatch what has arrived and keep the session alive; call
+    // every loop pass. Returns false once the connection is gone.
+    bool loop();
+
+    // Clean DISCONNECT (the will is not published)
+    void disconnect();
+
+    State state() const { return _state; }
+    bool connected() const { return _state == CONNECTED; }
+    // CONNACK return code of the last attempt (0 accepted, 0xFF no answer)
+    uint8_t connectResult() const { return _connectResult; }
+
+    uint32_t receivedCount() const { return _received; }
+    uint32_t acknowledgedCount() const { return _acknowledged; }
+    uint32_t publishedCount() const { return _published; }
+    uint32_t unacknowledgedCount() const { return _unacknowledged; }  // QoS 1 publishes
+    uint32_t droppedCount() const { return _dropped; }  // Oversized incoming messages
+    uint32_t subscribeFailures() const { return _subscribeFailures; }
+
+private:
+    // Packet under construction in _tx
+    bool begin(uint8_t header, size_t remaining);
+    bool putByte(uint8_t value);
+    bool putUint16(uint16_t value);
+    bool putString(const char* text, size_t length);
+    bool putString(const char* text);
+    bool send();
+
+    bool receive();                     // True when _rx holds a whole packet
+    void resetReceive();
+    void handlePacket();
+    void handlePublish();
+    void drop();
+    uint16_t nextPacketId();
+
+    ByteStream& _stream;
+    Clock& _clock;
+    MqttHandler* _handler = nullptr;
+    State _state = DISCONNECTED;
+    uint8_t _connectResult = 0xFF;
+
+    uint8_t _tx[BUFFER_SIZE];
+    size_t _txLength = 0;
+
+    // Incoming packet: fixed header first, then up to BUFFER_SIZE - 1 bytes
+    // of the body (one spare for the payload's NUL); the rest is skipped
+    uint8_t _rx[BUFFER_SIZE];
+    uint8_t _rxHeader = 0;
+    uint8_t _rxLengthBytes = 0;         // Remaining-length bytes read so far
+    bool _rxLengthDone = false;
+    uint32_t _rxRemaining = 0;          // Body length
+    uint32_t _rxRead = 0;               // Body bytes consumed
+
+    uint16_t _keepAliveSec = 0;
+    uint32_t _connectStartMs = 0;
+    uint32_t _lastSendMs = 0;
+    uint32_t _pingSentMs = 0;
+    bool _pingOutstanding = false;
+    uint16_t _nextPacketId = 1;
+
+    uint32_t _received = 0;
+    uint32_t _acknowledged = 0;
+    uint32_t _published = 0;
+    uint32_t _unacknowledged = 0;
+    uint32_t _dropped = 0;
+    uint32_t _subscribeFailures = 0;
+};
@@ -0,0 +1,58 @@
+#include "ReportPolicy.h"
+
+const char* reportReasonName(ReportReason reason) {
+    switch (reason) {
+        case REPORT_FIRST: return "first";
+        case REPORT_FAULT: return "fault";
+        case REPORT_STATE: return "state";
+        case REPORT_MOISTURE: return "moisture";
+        case REPORT_HEARTBEAT: return "heartbeat";
+        default: return "none";
+    }
+}
+
+uint8_t ReportPolicy::stretchFactor(int32_t rssi, uint32_t freeBlockBytes) const {
+    uint8_t factor = 1;
+    if (rssi != 0 && rssi < _config.weakRssiDbm) factor *= 2;
+    if (freeBlockBytes < _config.lowHeapBytes) factor *= 2;
+    return factor > _config.maxStretch ? _config.maxStretch : factor;
+}
+
+ReportReason ReportPolicy::evaluate(const TelemetrySnapshot& snapshot, uint32_t nowMs,
+                                    int32_t rssi, uint32_t freeBlockBytes) {
+    ReportReason reason = REPORT_NONE;
+    _stretch = stretchFactor(rssi, freeBlockBytes);
+    uint32_t sinceLast = nowMs - _lastSentMs;
+
+    if (!_haveLast) {
+        reason = REPORT_FIRST;
+    } else if (snapshot.lockedFault != _last.lockedFault) {
+        reason = REPORT_FAULT;
+    } else if (snapshot.pumpState != _last.pumpState || snapshot.deviceState != _last.deviceState) {
+        reason = REPORT_STATE;
+    } else if (sinceLast >= _config.heartbeatMs * _stretch) {
+        reason = REPORT_HEARTBEAT;
+    } else if (sinceLast >= _config.minIntervalMs * _stretch) {
+        int32_t delta = (int32_t)snapshot.moisture - (int32_t)_last.moisture;
+        if (delta < 0) delta = -delta;
+        if (delta > _config.moistureDeadband) reason = REPORT_MOISTURE;
+    }
+
+    // Count the fixed-cadence reports skipped so far
+    if (_haveLast && reason == REPORT_NONE) {
+        while ((int32_t)(nowMs - _nextBaselineMs) >= 0) {
+            _suppressed++;
+            _nextBaselineMs += _config.baselineIntervalMs;
+        }
+    }
+    return reason;
+}
+
+void ReportPolicy::markSent(const TelemetrySnapshot& snapshot, ReportReason reason, uint32_t nowMs) {
+    _last = snapshot;
+    _haveLast = true;
+    _lastSentMs = nowMs;
+    _nextBaselineMs = nowMs + _config.baselineIntervalMs;
+    _sent++;
+    _sentByReason[reason]++;
+}
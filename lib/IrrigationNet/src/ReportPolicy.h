@@ -0,0 +1,71 @@
+/*
+ * ReportPolicy - decides when a telemetry report is worth sending
+ *
+ * Reports go out when something changed: moisture moved beyond a deadband
+ * since the last report, pump or device state changed, or the fault flag
+ * flipped. Otherwise only a slow heartbeat is sent. The heartbeat (and the
+ * rate limit on moisture-only changes) stretches while the link is weak or
+ * the heap is tight, when a TLS session is most expensive.
+ *
+ * Reports the old fixed cadence would have sent, but this policy skipped,
+ * are counted as suppressed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "FirestorePayload.h"
+
+struct ReportConfig {
+    uint16_t moistureDeadband = 10;     // ADC counts of change that warrant a report
+    uint32_t minIntervalMs = 10000;     // Rate limit for moisture-only changes
+    uint32_t heartbeatMs = 600000;      // Report at least this often (10 min)
+    uint32_t baselineIntervalMs = 30000;  // Former fixed cadence, for the suppressed count
+    int32_t weakRssiDbm = -80;          // Stretch intervals below this signal level
+    uint32_t lowHeapBytes = 12000;      // Stretch intervals below this largest free block
+    uint8_t maxStretch = 4;             // Interval multiplier cap
+};
+
+enum ReportReason : uint8_t {
+    REPORT_NONE,
+    REPORT_FIRST,           // Nothing sent yet since boot
+    REPORT_FAULT,           // Fault flag changed
+    REPORT_STATE,           // Pump or device state changed
+    REPORT_MOISTURE,        // Moved beyond the deadband
+    REPORT_HEARTBEAT,
+    REPORT_REASON_COUNT
+};
+
+const char* reportReasonName(ReportReason reason);
+
+class ReportPolicy {
+public:
+    explicit ReportPolicy(const ReportConfig& config) : _config(config) {}
+
+    // What (if anything) to send for this snapshot. rssi is 0 when unknown.
+    ReportReason evaluate(const TelemetrySnapshot& snapshot, uint32_t nowMs,
+                          int32_t rssi, uint32_t freeBlockBytes);
+
+    // The report for snapshot was sent (or at least handed to the uploader)
+    void markSent(const TelemetrySnapshot& snapshot, ReportReason reason, uint32_t nowMs);
+
+    // 1, 2 or 4 (capped at maxStretch) depending on link and heap health
+    uint8_t stretchFactor(int32_t rssi, uint32_t freeBlockBytes) const;
+
+    uint32_t sentCount() const { return _sent; }
+    uint32_t suppressedCount() const { return _suppressed; }
+    uint32_t sentCount(ReportReason reason) const { return _sentByReason[reason]; }
+    uint8_t currentStretch() const { return _stretch; }
+
+private:
+    const ReportConfig& _config;
+    bool _haveLast = false;
+    TelemetrySnapshot _last;
+    uint32_t _lastSentMs = 0;
+    uint32_t _nextBaselineMs = 0;
+    uint8_t _stretch = 1;
+
+    uint32_t _sent = 0;
+    uint32_t _suppressed = 0;
+    uint32_t _sentByReason[REPORT_REASON_COUNT] = {};
+};
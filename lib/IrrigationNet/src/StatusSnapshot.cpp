@@ -0,0 +1,75 @@
+#include "StatusSnapshot.h"
+#include <stdio.h>
+#include <string.h>
+
+DeviceStatus::DeviceStatus() {
+    memset(this, 0, sizeof(*this));
+}
+
+bool StatusCache::publish(const DeviceStatus& status) {
+    if (_version != 0 && memcmp(&status, &_status, sizeof(status)) == 0) {
+        return false;
+    }
+    memcpy(&_status, &status, sizeof(status));
+    _version++;
+    return true;
+}
+
+const char* StatusCache::body(size_t& length) {
+    if (_renderedVersion == _version) {
+        _hits++;
+        length = _length;
+        return _body;
+    }
+
+    // deviceId is generated from the MAC (hex digits), so needs no escaping
+    const DeviceStatus& s = _status;
+    int written = snprintf(_body, sizeof(_body),
+        "{\"statusVersion\":%lu,\"deviceId\":\"%s\",\"moisture\":%u,"
+        "\"pumpState\":\"%s\",\"deviceState\":\"%s\",\"wifiConnected\":%s,\"lockedFault\":%s,"
+        "\"dryThreshold\":%u,\"wetThreshold\":%u,\"pumpRunTime\":%lu,\"minIntervalSec\":%lu,"
+        "\"httpsHandshakes\":%lu,\"httpsReused\":%lu,"
+        "\"httpsConnectFailures\":%lu,\"httpsFailures\":%lu,"
+        "\"firestoreCommits\":%lu,\"firestoreWrites\":%lu,"
+        "\"firestoreCommitFailures\":%lu,\"firestoreDroppedWrites\":%lu,\"firestoreEvictedWrites\":%lu,"
+        "\"queuePending\":%lu,\"queueStored\":%lu,\"queueDrained\":%lu,\"queueRejected\":%lu,"
+        "\"queueOverwritten\":%lu,\"queueThrottled\":%lu,\"remoteTruncated\":%lu,"
+        "\"wifiAttempts\":%lu,\"wifiReconnects\":%lu,\"wifiLastReconnectMs\":%lu,"
+        "\"wifiMaxReconnectMs\":%lu,\"wifiAvgReconnectMs\":%lu,"
+        "\"stateFlashWrites\":%lu,\"stateCoalesced\":%lu,"
+        "\"reportsSent\":%lu,\"reportsSuppressed\":%lu,\"reportStretch\":%u,"
+        "\"mqttConnected\":%s,\"mqttCommands\":%lu,\"mqttCommandLatencyMs\":%lu,"
+        "\"mqttCommandLatencyMaxMs\":%lu,"
+        "\"sampleIntervalMs\":%lu,"
+        "\"lastPulseMs\":%lu,\"doseGainPerSec\":%.1f,"
+        "\"lowPower\":%s}",
+        (unsigned long)_version, s.deviceId, s.moisture,
+        pumpStateName(s.pumpState), deviceStateName(s.deviceState),
+        s.wifiConnected ? "true" : "false", s.lockedFault ? "true" : "false",
+        s.dryThreshold, s.wetThreshold, (unsigned long)s.pumpRunTimeMs, (unsigned long)s.minIntervalSec,
+        (unsigned long)s.httpsHandshakes, (unsigned long)s.httpsReused,
+        (unsigned long)s.httpsConnectFailures, (unsigned long)s.httpsFailures,
+        (unsigned long)s.firestoreCommits, (unsigned long)s.firestoreWrites,
+        (unsigned long)s.firestoreCommitFailures, (unsigned long)s.firestoreDroppedWrites,
+        (unsigned long)s.firestoreEvictedWrites,
+        (unsigned long)s.queuePending, (unsigned long)s.queueStored, (unsigned long)s.queueDrained,
+        (unsigned long)s.queueRejected,
+        (unsigned long)s.queueOverwritten, (unsigned long)s.queueThrottled, (unsigned long)s.remoteTruncated,
+        (unsigned long)s.wifiAttempts, (unsigned long)s.wifiReconnects, (unsigned long)s.wifiLastReconnectMs,
+        (unsigned long)s.wifiMaxReconnectMs, (unsigned long)s.wifiAvgReconnectMs,
+        (unsigned long)s.stateFlashWrites, (unsigned long)s.stateCoalesced,
+        (unsigned long)s.reportsSent, (unsigned long)s.reportsSuppressed, s.reportStretch,
+        s.mqttConnected ? "true" : "false", (unsigned long)s.mqttCommands,
+        (unsigned long)s.mqttCommandLatencyMs, (unsigned long)s.mqttCommandLatencyMaxMs,
+        (unsigned long)s.sampleIntervalMs,
+        (unsigned long)s.lastPulseMs, s.doseGainPerSec,
+        s.lowPower ? "true" : "false");
+
+    // Worst case (every counter at 10 digits) is ~1250 bytes; never truncates
+    _length = written < 0 ? 0 : (size_t)written;
+    if (_length >= sizeof(_body)) _length = sizeof(_body) - 1;
+    _renderedVersion = _version;
+    _renders++;
+    length = _length;
+    return _body;
+}
@@ -0,0 +1,92 @@
+/*
+ * StatusSnapshot - what GET /status reports, captured once per control tick
+ *
+ * The loop publishes a fresh DeviceStatus every iteration; StatusCache bumps
+ * its version only when a field actually changed. The JSON body is rendered
+ * into a fixed buffer on the first request after a change and reused until
+ * the next one, so dashboard polling costs a memcmp per tick and a socket
+ * write per request - no heap, no ADC reads. Only values that change on
+ * events belong here: per-sample readings, sample counters and drifting
+ * estimates would change the version every tick, so they go to /metrics.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "IrrigationTypes.h"
+
+struct DeviceStatus {
+    // Zero-filled (padding included) so snapshots compare with memcmp
+    DeviceStatus();
+
+    char deviceId[24];
+    uint16_t moisture;
+    PumpState pumpState;
+    DeviceState deviceState;
+    bool wifiConnected;
+    bool lockedFault;
+    uint16_t dryThreshold;
+    uint16_t wetThreshold;
+    uint32_t pumpRunTimeMs;
+    uint32_t minIntervalSec;
+    uint32_t httpsHandshakes;
+    uint32_t httpsReused;
+    uint32_t httpsConnectFailures;
+    uint32_t httpsFailures;
+    uint32_t firestoreCommits;
+    uint32_t firestoreWrites;
+    uint32_t firestoreCommitFailures;
+    uint32_t firestoreDroppedWrites;
+    uint32_t firestoreEvictedWrites; // Oldest writes dropped while commits failed
+    uint32_t queuePending;
+    uint32_t queueStored;
+    uint32_t queueDrained;
+    uint32_t queueRejected;         // Stored records skipped after a 4xx commit
+    uint32_t queueOverwritten;
+    uint32_t queueThrottled;
+    uint32_t remoteTruncated;       // Config/commands polls skipped: request or response too large
+    uint32_t wifiAttempts;
+    uint32_t wifiReconnects;
+    uint32_t wifiLastReconnectMs;
+    uint32_t wifiMaxReconnectMs;
+    uint32_t wifiAvgReconnectMs;
+    uint32_t stateFlashWrites;      // Pump state journal
+    uint32_t stateCoalesced;
+    uint32_t reportsSent;           // Telemetry reports (ReportPolicy)
+    uint32_t reportsSuppressed;
+    uint8_t reportStretch;
+    bool mqttConnected;             // MQTT transport (zero when not in use)
+    uint32_t mqttCommands;
+    uint32_t mqttCommandLatencyMs;  // Latest command, issue to applied
+    uint32_t mqttCommandLatencyMaxMs;
+    uint32_t sampleIntervalMs;      // Current sensor interval (relaxed while far from dry)
+    uint32_t lastPulseMs;           // Last pump pulse (fixed or adaptive)
+    float doseGainPerSec;           // Adaptive dosing, learned drop per pump second (0 if unknown)
+    bool lowPower;
+};
+
+class StatusCache {
+public:
+    static const size_t BODY_SIZE = 1280;
+
+    // Returns true (and bumps the version) if the status differs from the last one
+    bool publish(const DeviceStatus& status);
+
+    // Serialized JSON for the current version; re-rendered only after a change
+    const char* body(size_t& length);
+
+    const DeviceStatus& current() const { return _status; }
+    uint32_t version() const { return _version; }
+    uint32_t renderCount() const { return _renders; }
+    uint32_t hitCount() const { return _hits; }
+
+private:
+    DeviceStatus _status;
+    uint32_t _version = 0;
+    uint32_t _renderedVersion = UINT32_MAX;
+    uint32_t _renders = 0;
+    uint32_t _hits = 0;
+    size_t _length = 0;
+    char _body[BODY_SIZE];
+};
@@ -0,0 +1,85 @@
+"""
+Firmware size report: build every ESP8266 variant and tabulate flash and RAM.
+
+    python scripts/size_report.py                  # all variants
+    python scripts/size_report.py IO:nodemcuv2 Wifi:nodemcuv2 --markdown
+
+Runs `pio run` for each project:environment pair from the repository root
+and reads the Flash/RAM summary PlatformIO prints after linking. RAM is
+static data and bss (the heap is what is left). Exits non-zero if a build
+fails.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+VARIANTS = (
+    ("IO", "nodemcuv2", "IO: shared core, CORE_MINIMAL, no networking"),
+    ("IO", "nodemcuv2_sleep", "IO: deep-sleep sampling"),
+    ("Wifi", "nodemcuv2", "Wifi: full feature set"),
+    ("Wifi", "nodemcuv2_trace", "Wifi: + event trace"),
+    ("Wifi", "nodemcuv2_zones", "Wifi: + 8 expander zones"),
+    ("Wifi", "nodemcuv2_mqtt", "Wifi: + MQTT transport"),
+)
+
+# RAM:   [====      ]  36.6% (used 29984 bytes from 81920 bytes)
+SIZE_LINE = re.compile(r"^(RAM|Flash):\s+\[.*\]\s+[\d.]+% \(used (\d+) bytes from (\d+) bytes\)")
+
+
+def build(root, project, env):
+    result = subprocess.run(
+        ["pio", "run", "-d", os.path.join(root, project), "-e", env],
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    sizes = {}
+    for line in result.stdout.splitlines():
+        match = SIZE_LINE.match(line.strip())
+        if match:
+            sizes[match.group(1)] = (int(match.group(2)), int(match.group(3)))
+    if result.returncode != 0 or len(sizes) != 2:
+        sys.stderr.write(result.stdout[-4000:])
+        return None
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("variants", nargs="*", metavar="PROJECT:ENV",
+                        help="variants to build (default: all)")
+    parser.add_argument("--markdown", action="store_true", help="print a Markdown table")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    variants = VARIANTS
+    if args.variants:
+        variants = [tuple(v.split(":", 1)) + (v,) for v in args.variants]
+
+    rows = []
+    failed = False
+    for project, env, label in variants:
+        sizes = build(root, project, env)
+        if sizes is None:
+            print("%s:%s: build failed" % (project, env), file=sys.stderr)
+            failed = True
+            continue
+        rows.append((label, sizes["Flash"][0], sizes["RAM"][0], sizes["Flash"][1], sizes["RAM"][1]))
+
+    if args.markdown:
+        print("| Variant | Flash (bytes) | RAM (bytes) |")
+        print("|---------|--------------:|------------:|")
+        for label, flash, ram, _, _ in rows:
+            print("| %s | %d | %d |" % (label, flash, ram))
+    else:
+        width = max([len(row[0]) for row in rows] + [7])
+        print("%-*s %10s %7s %8s %7s" % (width, "Variant", "Flash", "", "RAM", ""))
+        for label, flash, ram, flash_max, ram_max in rows:
+            print("%-*s %10d %6.1f%% %8d %6.1f%%" % (
+                width, label, flash, 100.0 * flash / flash_max, ram, 100.0 * ram / ram_max))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())